@@ -0,0 +1,200 @@
+/* vim: set ts=4 expandtab shiftwidth=4: */
+
+/**
+ * @file
+ *
+ * Copyright 2018 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in LICENSE.txt<BR>
+ * Chip Overclock<BR>
+ * mailto:coverclock@diag.com<BR>
+ * http://github.com/coverclock/com-diag-obelisk<BR>
+ *
+ * Decodes the WWVB phase modulated time code from a file or stream of
+ * complex baseband samples, each an interleaved pair of native 32-bit
+ * floating point in-phase (I) and quadrature (Q) values, as produced by
+ * many software defined radios once mixed down and decimated.
+ */
+
+#include <stdio.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+#include <time.h>
+#include "com/diag/diminuto/diminuto_log.h"
+#include "com/diag/diminuto/diminuto_countof.h"
+#include "com/diag/obelisk/obelisk.h"
+#include "com/diag/obelisk/obelisk_pm.h"
+#include "com/diag/obelisk/wwvbtool.h"
+
+#define LOG(_FORMAT_, ...) do { if (debug) { fprintf(stderr, "%s: " _FORMAT_ "\n", program, ## __VA_ARGS__); } } while (0)
+
+static const int SAMPLES_PER_SECOND = 1000;
+static const int SAMPLES_PER_READ = 256;
+
+static const char * program = (const char *)0;
+
+static int debug = 0;
+static int samples_per_second = 0;
+
+static void usage(void)
+{
+    fprintf(stderr, "usage: %s [ -R RATE ] [ -d ] [ -h ] [ FILE ]\n", program);
+    fprintf(stderr, "       -R RATE         Input is RATE I/Q samples per second (%d).\n", SAMPLES_PER_SECOND);
+    fprintf(stderr, "       -d              Display debug output.\n");
+    fprintf(stderr, "       -h              Display help menu.\n");
+    fprintf(stderr, "       FILE            Read I/Q samples from FILE (stdin).\n");
+}
+
+int main(int argc, char ** argv)
+{
+    int xc = 1;
+    int rc = -1;
+    int opt = -1;
+    int error = 0;
+    char * endptr = (char *)0;
+    const char * path = (const char *)0;
+    FILE * fp = (FILE *)0;
+    float (*samples)[2] = (float (*)[2])0;
+    size_t count = 0;
+    obelisk_pm_t pm = { 0 };
+    obelisk_event_t event = OBELISK_EVENT_WAITING;
+    obelisk_buffer_t buffer = 0;
+    obelisk_frame_t frame = { 0 };
+    struct tm time = { 0 };
+    time_t epoch = -1;
+    unsigned long long total = 0;
+
+    diminuto_log_setmask();
+
+    program = strrchr(argv[0], '/');
+    program = (program == (const char *)0) ? argv[0] : program + 1;
+
+    samples_per_second = SAMPLES_PER_SECOND;
+
+    while ((opt = getopt(argc, argv, "R:dh")) >= 0) {
+
+        switch (opt) {
+
+        case 'R':
+            samples_per_second = strtol(optarg, &endptr, 0);
+            if ((*endptr != '\0') || (samples_per_second <= 0) || ((samples_per_second % OBELISK_PM_PHASES) != 0)) {
+                errno = EINVAL;
+                perror(optarg);
+                error = !0;
+            }
+            break;
+
+        case 'd':
+            debug = !0;
+            break;
+
+        case 'h':
+            usage();
+            return 0;
+            break;
+
+        default:
+            usage();
+            return 1;
+            break;
+
+        }
+
+    }
+
+    if (error) {
+        return 1;
+    }
+
+    if (optind >= argc) {
+        path = "-";
+        fp = stdin;
+    } else {
+        path = argv[optind];
+        fp = fopen(path, "r");
+        if (fp == (FILE *)0) {
+            perror(path);
+            return 1;
+        }
+    }
+
+    samples = (float (*)[2])malloc(SAMPLES_PER_READ * sizeof(samples[0]));
+    assert(samples != (float (*)[2])0);
+
+    obelisk_pm_init(&pm, samples_per_second);
+
+    LOG("BEGIN \"%s\" %dsps.", path, samples_per_second);
+
+    while ((count = fread(samples, sizeof(samples[0]), SAMPLES_PER_READ, fp)) > 0) {
+
+        for (size_t ii = 0; ii < count; ++ii) {
+
+            event = obelisk_pm_sample(&pm, samples[ii][0], samples[ii][1], &buffer);
+            ++total;
+
+            if (event != OBELISK_EVENT_FRAME) {
+                continue;
+            }
+
+            LOG("FRAME %llu 0x%016llx %d %d.", total, (long long unsigned int)buffer, pm.phase, pm.polarity);
+
+            rc = obelisk_pm_decode(&frame, buffer);
+            if (rc >= 0) {
+                rc = obelisk_validate(&frame);
+                if (rc >= 0) {
+                    rc = obelisk_decode(&time, &frame);
+                    if (rc >= 0) {
+                        rc = obelisk_revalidate(&time);
+                    }
+                }
+            }
+
+            if (rc < 0) {
+                LOG("CORRUPT %llu %d.", total, rc);
+                continue;
+            }
+
+            /*
+             * The frame is recognized at the end of the minute it encodes.
+             */
+
+            time.tm_sec = 59;
+            epoch = timegm(&time);
+
+            assert((0 <= time.tm_wday) && (time.tm_wday < countof(DAY)));
+            printf("%s: time zulu=%04d-%02d-%02dT%02d:%02d:%02d julian=%04d/%03d day=%s dst=%c lsw=%d epoch=%lds sample=%llu.\n",
+                program,
+                time.tm_year + 1900, time.tm_mon + 1, time.tm_mday,
+                time.tm_hour, time.tm_min, time.tm_sec,
+                time.tm_year + 1900, time.tm_yday + 1,
+                DAY[time.tm_wday],
+                DST[frame.dst],
+                frame.lsw,
+                (long)epoch,
+                total
+            );
+            fflush(stdout);
+
+            xc = 0;
+
+        }
+
+    }
+
+    if (ferror(fp)) {
+        perror(path);
+        xc = 1;
+    }
+
+    if (fp != stdin) {
+        fclose(fp);
+    }
+
+    free(samples);
+
+    LOG("END \"%s\" %llu.", path, total);
+
+    return xc;
+}
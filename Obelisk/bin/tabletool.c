@@ -0,0 +1,214 @@
+/* vim: set ts=4 expandtab shiftwidth=4: */
+
+/**
+ * @file
+ *
+ * Copyright 2018 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in LICENSE.txt<BR>
+ * Chip Overclock<BR>
+ * mailto:coverclock@diag.com<BR>
+ * http://github.com/coverclock/com-diag-obelisk<BR>
+ *
+ * Generates the file containing the frame table for a year, or maps an
+ * existing one into memory and looks up the frame for a time.
+ */
+
+#include <stdio.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "com/diag/diminuto/diminuto_log.h"
+#include "com/diag/obelisk/obelisk.h"
+#include "com/diag/obelisk/obelisk_table.h"
+
+#define LOG(_FORMAT_, ...) do { if (debug) { fprintf(stderr, "%s: " _FORMAT_ "\n", program, ## __VA_ARGS__); } } while (0)
+
+static const char * program = (const char *)0;
+
+static int debug = 0;
+static int year = 0;
+static int dut1 = 0;
+static int month = 0;
+
+static void usage(void)
+{
+    fprintf(stderr, "usage: %s [ -L MONTH ] [ -U DUT1 ] [ -Y YEAR ] [ -d ] [ -h ] [ -l EPOCH ] FILE\n", program);
+    fprintf(stderr, "       -L MONTH        Insert a leap second at the end of MONTH (%d).\n", month);
+    fprintf(stderr, "       -U DUT1         Transmit DUT1 tenths of a second (%d).\n", dut1);
+    fprintf(stderr, "       -Y YEAR         Generate the table for YEAR (this year).\n");
+    fprintf(stderr, "       -d              Display debug output.\n");
+    fprintf(stderr, "       -h              Display help menu.\n");
+    fprintf(stderr, "       -l EPOCH        Look up EPOCH seconds in FILE instead of generating it.\n");
+    fprintf(stderr, "       FILE            Write or read the table in FILE.\n");
+}
+
+int main(int argc, char ** argv)
+{
+    int xc = 1;
+    int rc = -1;
+    int opt = -1;
+    int error = 0;
+    int fd = -1;
+    char * endptr = (char *)0;
+    const char * path = (const char *)0;
+    obelisk_table_t * table = (obelisk_table_t *)0;
+    size_t size = 0;
+    ssize_t length = -1;
+    time_t now = -1;
+    time_t epoch = -1;
+    struct tm today = { 0 };
+    struct stat status = { 0 };
+    obelisk_buffer_t buffer = 0;
+    int lookup = 0;
+
+    diminuto_log_setmask();
+
+    program = strrchr(argv[0], '/');
+    program = (program == (const char *)0) ? argv[0] : program + 1;
+
+    now = time((time_t *)0);
+    gmtime_r(&now, &today);
+    year = today.tm_year + 1900;
+
+    while ((opt = getopt(argc, argv, "L:U:Y:dhl:")) >= 0) {
+
+        switch (opt) {
+
+        case 'L':
+            month = strtol(optarg, &endptr, 0);
+            if ((*endptr != '\0') || (month < 0) || (month > 12)) {
+                errno = EINVAL;
+                perror(optarg);
+                error = !0;
+            }
+            break;
+
+        case 'U':
+            dut1 = strtol(optarg, &endptr, 0);
+            if ((*endptr != '\0') || (dut1 < -9) || (dut1 > 9)) {
+                errno = EINVAL;
+                perror(optarg);
+                error = !0;
+            }
+            break;
+
+        case 'Y':
+            year = strtol(optarg, &endptr, 0);
+            if ((*endptr != '\0') || (year < 2000) || (year > 2199)) {
+                errno = EINVAL;
+                perror(optarg);
+                error = !0;
+            }
+            break;
+
+        case 'd':
+            debug = !0;
+            break;
+
+        case 'h':
+            usage();
+            return 0;
+            break;
+
+        case 'l':
+            epoch = strtoll(optarg, &endptr, 0);
+            if (*endptr != '\0') {
+                errno = EINVAL;
+                perror(optarg);
+                error = !0;
+            }
+            lookup = !0;
+            break;
+
+        default:
+            usage();
+            return 1;
+            break;
+
+        }
+
+    }
+
+    if (error) {
+        return 1;
+    }
+
+    if (optind >= argc) {
+        usage();
+        return 1;
+    }
+
+    path = argv[optind];
+
+    if (!lookup) {
+
+        size = obelisk_table_size(year);
+        table = (obelisk_table_t *)malloc(size);
+        assert(table != (obelisk_table_t *)0);
+
+        rc = obelisk_table_generate(table, size, year, dut1, month);
+        assert(rc >= 0);
+
+        LOG("GENERATE %d %d %d %zu.", year, dut1, month, size);
+
+        fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            perror(path);
+        } else if ((length = write(fd, table, size)) < 0) {
+            perror(path);
+        } else if (length != size) {
+            errno = EIO;
+            perror(path);
+        } else {
+            xc = 0;
+        }
+
+        if (fd >= 0) {
+            if (close(fd) < 0) {
+                perror(path);
+                xc = 1;
+            }
+        }
+
+        free(table);
+
+    } else {
+
+        fd = open(path, O_RDONLY);
+        if (fd < 0) {
+            perror(path);
+        } else if (fstat(fd, &status) < 0) {
+            perror(path);
+        } else if ((table = (obelisk_table_t *)mmap((void *)0, status.st_size, PROT_READ, MAP_SHARED, fd, 0)) == (obelisk_table_t *)MAP_FAILED) {
+            perror(path);
+            table = (obelisk_table_t *)0;
+        } else if (obelisk_table_check(table, status.st_size) < 0) {
+            errno = EINVAL;
+            perror(path);
+        } else if (obelisk_table_frame(table, epoch, &buffer) < 0) {
+            errno = ERANGE;
+            perror(path);
+        } else {
+            LOG("LOOKUP %d %d %u.", table->year, table->dut1, table->minutes);
+            printf("%s: epoch=%llds buffer=0x%016llx.\n", program, (long long)epoch, (long long unsigned int)buffer);
+            xc = 0;
+        }
+
+        if (table != (obelisk_table_t *)0) {
+            (void)munmap(table, status.st_size);
+        }
+
+        if (fd >= 0) {
+            (void)close(fd);
+        }
+
+    }
+
+    return xc;
+}
@@ -11,12 +11,15 @@
  */
 
 #include <stdio.h>
+#include <stdint.h>
 #include <unistd.h>
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
 #include <errno.h>
 #include <signal.h>
+#include <time.h>
+#include <math.h>
 #include <sys/types.h>
 #include <sys/time.h>
 #include <sys/resource.h>
@@ -42,6 +45,18 @@
 #include "com/diag/diminuto/diminuto_ipc6.h"
 #include "com/diag/hazer/hazer.h"
 #include "com/diag/obelisk/obelisk.h"
+#include "com/diag/obelisk/obelisk_discipline.h"
+#include "com/diag/obelisk/obelisk_pll.h"
+#include "com/diag/obelisk/obelisk_stability.h"
+#include "com/diag/obelisk/obelisk_shm.h"
+#include "com/diag/obelisk/obelisk_sock.h"
+#include "com/diag/obelisk/obelisk_schedule.h"
+#include "com/diag/obelisk/obelisk_nmea.h"
+#include "com/diag/obelisk/obelisk_fanout.h"
+#include "com/diag/obelisk/obelisk_multicast.h"
+#include "com/diag/obelisk/obelisk_message.h"
+#include "com/diag/obelisk/obelisk_ntp.h"
+#include "com/diag/obelisk/obelisk_page.h"
 #include "com/diag/obelisk/wwvbtool.h"
 
 #define LOG(_FORMAT_, ...) do { if (debug) { fprintf(stderr, "%s: " _FORMAT_ "\n", program, ## __VA_ARGS__); } } while (0)
@@ -58,6 +73,11 @@ static const int MINUTE_JULIET = 30;
 static const int NICE_MINIMUM = -20;
 static const int NICE_MAXIMUM = 19;
 static const int NICE_NONE = -21;
+static const int PRIOR_SECONDS = 2;
+static const int PREDICT_SECOND = 19;
+static const int PREDICT_MINUTES = 60;
+static const int MISMATCH_MAXIMUM = 2;
+static const int PPS_MILLISECONDS = 200;
 
 static const char * program = (const char *)0;
 
@@ -68,6 +88,7 @@ static int terminate = 0;
 static int unlock = 0;
 static int pps = 0;
 static int nmea = 0;
+static int nmea_extra = 0;
 static int hangup = 0;
 static int pin_out_p1 = -1;
 static int pin_in_t = -1;
@@ -77,13 +98,35 @@ static int background = 0;
 static int set_initially = 0;
 static int set_daily = 0;
 static int set_leap = 0;
+static int early = 0;
+static int follow = 0;
+static int quick = 0;
+static int slewing = 0;
+static int threshold = -1;
+static int tracking = 0;
+static int holdover = 0;
+static int publish = 0;
+static int shm_unit = -1;
+static int scheduling = 0;
+static int trellis = 0;
+static int margin = 0;
 static int hour_juliet = -1;
 static int minute_juliet = -1;
 static int nice_priority = 0;
 static const char * run_path = (char *)0;
 static char nmea_talker[sizeof("GP")] = { '\0', '\0', '\0' };
-static const char * nmea_path = (char *)0;
-static const char * nmea_endpoint = (char *)0;
+static const char * nmea_path[OBELISK_FANOUT_SINKS] = { (char *)0, };
+static int nmea_paths = 0;
+static const char * nmea_endpoint[OBELISK_FANOUT_SINKS] = { (char *)0, };
+static int nmea_endpoints = 0;
+static const char * multicast_endpoint[OBELISK_MULTICAST_DESTINATIONS] = { (char *)0, };
+static int multicast_endpoints = 0;
+static const char * multicast_interface = (char *)0;
+static int multicast_ttl = OBELISK_MULTICAST_TTL;
+static const char * message_destination = (char *)0;
+static int ntp_port = -1;
+static const char * page_name = (char *)0;
+static const char * sock_path = (char *)0;
 static int serial_bitspersecond = DIMINUTO_SERIAL_BITSPERSECOND_NOMINAL;
 static diminuto_serial_databits_t serial_databits = DIMINUTO_SERIAL_DATABITS_NOMINAL;
 static diminuto_serial_paritybit_t serial_paritybit = DIMINUTO_SERIAL_PARITYBIT_NOMINAL;
@@ -94,27 +137,43 @@ static int serial_rtscts = 0;
 
 static void usage(void)
 {
-    fprintf(stderr, "usage: %s [ -1 | -2 ] [ -7 | -8 ] [ -B BAUD ] [ -C NICE ] [ -H HOUR ] [ -L PATH ] [ -M MINUTE ] [ -N TALKER ] [ -O PATH ] [ -P PIN ] [ -S PIN ] [ -T PIN ] [ -U ENDPOINT ] [ -a ] [ -b ] [ -c ] [ -d ] [ -e | -o ] [ -g ] [ -h ] [ -i ] [ -k ] [ -l ] [ -m ] [ -n ] [ -p ]  [ -r ] [ -s ] [ -u ] [ -v ] [ -x ]\n", program);
+    fprintf(stderr, "usage: %s [ -1 | -2 ] [ -7 | -8 ] [ -A MARGIN ] [ -B BAUD ] [ -C NICE ] [ -D ] [ -E ] [ -F ] [ -G ] [ -H HOUR ] [ -I INTERFACE[,TTL] ] [ -J PATH ] [ -K SECONDS ] [ -L PATH ] [ -M MINUTE ] [ -N TALKER ] [ -O PATH ] [ -P PIN ] [ -Q ] [ -R GROUP:PORT ] [ -S PIN ] [ -T PIN ] [ -U ENDPOINT ] [ -V ] [ -W SECONDS ] [ -X MILLISECONDS ] [ -Y SECONDS ] [ -Z UNIT ] [ -a ] [ -b ] [ -c ] [ -d ] [ -e | -o ] [ -f NAME ] [ -g ] [ -h ] [ -i ] [ -k ] [ -l ] [ -m ] [ -n ] [ -p ]  [ -r ] [ -s ] [ -t DESTINATION ] [ -u ] [ -v ] [ -w PORT ] [ -x ] [ -z ]\n", program);
     fprintf(stderr, "       -1              Use one stop bit for OUTPUT (default).\n");
     fprintf(stderr, "       -2              Use two stop bits for OUTPUT.\n");
     fprintf(stderr, "       -7              Use seven data bits for OUTPUT.\n");
     fprintf(stderr, "       -8              Use eight data bits for OUTPUT (default).\n");
+    fprintf(stderr, "       -A MARGIN       Vote on bad frames using recent frames winning by MARGIN (1..%d).\n", OBELISK_ACCUMULATOR_FRAMES);
     fprintf(stderr, "       -B BAUD         Use BAUD bits per second for OUTPUT (%d).\n", serial_bitspersecond);
     fprintf(stderr, "       -C NICE         Set scheduling priority to NICE (%d..%d).\n", NICE_MINIMUM, NICE_MAXIMUM);
+    fprintf(stderr, "       -D              Discipline time of day continuously by slewing instead of setting it.\n");
+    fprintf(stderr, "       -E              Acquire early from partial frames that agree with the system clock.\n");
+    fprintf(stderr, "       -F              Confirm or lose lock bit by bit against the predicted frame.\n");
+    fprintf(stderr, "       -G              Schedule PPS and NMEA for the second edge predicted by the software PLL.\n");
     fprintf(stderr, "       -H HOUR         Set time of day at HOUR local (%d).\n", hour_juliet);
+    fprintf(stderr, "       -I INTERFACE[,TTL] Multicast on INTERFACE with TTL or hop limit TTL (%d).\n", OBELISK_MULTICAST_TTL);
+    fprintf(stderr, "       -J PATH         Send chronyd SOCK reference clock samples to PATH.\n");
+    fprintf(stderr, "       -K SECONDS      Track second edges with a software PLL of time constant SECONDS (%d).\n", OBELISK_PLL_CONSTANT);
     fprintf(stderr, "       -L PATH         Use PATH for lock file (\"%s\").\n", run_path);
     fprintf(stderr, "       -M MINUTE       Set time of day at MINUTE local (%d).\n", minute_juliet);
     fprintf(stderr, "       -N TALKER       Set NMEA TALKER (\"%s\").\n", nmea_talker);
-    fprintf(stderr, "       -O OUTPUT       Write NMEA sentences to OUTPUT (\"%s\").\n", nmea_path);
+    fprintf(stderr, "       -O OUTPUT       Write NMEA sentences to OUTPUT (\"%s\"), which may be repeated.\n", NMEA_PATH);
     fprintf(stderr, "       -P PIN          Use P1 output GPIO PIN (%d).\n", pin_out_p1);
+    fprintf(stderr, "       -Q              Acquire quickly by matching pulses against frames expected from the system clock.\n");
+    fprintf(stderr, "       -R GROUP:PORT   Multicast time announcements to GROUP:PORT, which may be repeated.\n");
     fprintf(stderr, "       -S PIN          Use PPS output GPIO PIN (%d).\n", pin_out_pps);
     fprintf(stderr, "       -T PIN          Use T input GPIO PIN (%d).\n", pin_in_t);
-    fprintf(stderr, "       -U ENDPOINT     Write NMEA sentences to UDP ENDPOINT.\n");
+    fprintf(stderr, "       -U ENDPOINT     Write NMEA sentences to UDP ENDPOINT, which may be repeated.\n");
+    fprintf(stderr, "       -V              Synchronize by maximum likelihood instead of parsing.\n");
+    fprintf(stderr, "       -W SECONDS      Hold over PPS and NMEA from the software PLL for up to SECONDS when the signal is lost.\n");
+    fprintf(stderr, "       -X MILLISECONDS Step instead of slewing time of day only when off by MILLISECONDS (%d).\n", threshold);
+    fprintf(stderr, "       -Y SECONDS      Publish ADEV, TDEV, and MTIE of the second edges every SECONDS.\n");
+    fprintf(stderr, "       -Z UNIT         Write ntpd SHM reference clock UNIT with the edges and UNIT+1 with the PLL.\n");
     fprintf(stderr, "       -a              Set time of day when leap second occurs.\n");
     fprintf(stderr, "       -b              Daemonize into the background.\n");
     fprintf(stderr, "       -c              Use RTS/CTS for OUTPUT.\n");
     fprintf(stderr, "       -d              Display debug output.\n");
     fprintf(stderr, "       -e              Use even parity for OUTPUT.\n");
+    fprintf(stderr, "       -f NAME         Publish the clock page in POSIX shared memory NAME.\n");
     fprintf(stderr, "       -g              Send SIGHUP to the PID in the lock file and exit.\n");
     fprintf(stderr, "       -h              Display help menu and exit.\n");
     fprintf(stderr, "       -i              Set time of day initially when possible.\n");
@@ -126,9 +185,23 @@ static void usage(void)
     fprintf(stderr, "       -p              Generate PPS output.\n");
     fprintf(stderr, "       -r              Reset device initially.\n");
     fprintf(stderr, "       -s              Set time of day initially and also daily when possible.\n");
+    fprintf(stderr, "       -t DESTINATION  Send binary time messages to DESTINATION (PATH, HOST:PORT).\n");
     fprintf(stderr, "       -u              Unexport pins initially ignoring errors.\n");
     fprintf(stderr, "       -v              Display verbose output.\n");
+    fprintf(stderr, "       -w PORT         Serve NTP on UDP PORT (%d) from the disciplined clock.\n", OBELISK_NTP_PORT);
     fprintf(stderr, "       -x              Use XON/XOFF for OUTPUT.\n");
+    fprintf(stderr, "       -z              Follow NMEA RMC with ZDA and PWWVB status sentences.\n");
+}
+
+static int64_t monotonic(void)
+{
+    struct timespec now = { 0 };
+    int rc = -1;
+
+    rc = clock_gettime(CLOCK_MONOTONIC_RAW, &now);
+    assert(rc == 0);
+
+    return ((int64_t)now.tv_sec * 1000000000LL) + now.tv_nsec;
 }
 
 static void emit(FILE *fp, const char * bb)
@@ -141,6 +214,188 @@ static void emit(FILE *fp, const char * bb)
     }
 }
 
+/*
+ * Send a datagram to an IPv6 endpoint for the fan out.
+ */
+static ssize_t datagram6(void * context, int fd, const void * buffer, size_t length)
+{
+    const diminuto_ipc_endpoint_t * endpointp = (const diminuto_ipc_endpoint_t *)context;
+
+    return diminuto_ipc6_datagram_send(fd, buffer, length, endpointp->ipv6, endpointp->udp);
+}
+
+/*
+ * Send a datagram to an IPv4 endpoint for the fan out.
+ */
+static ssize_t datagram4(void * context, int fd, const void * buffer, size_t length)
+{
+    const diminuto_ipc_endpoint_t * endpointp = (const diminuto_ipc_endpoint_t *)context;
+
+    return diminuto_ipc4_datagram_send(fd, buffer, length, endpointp->ipv4, endpointp->udp);
+}
+
+/*
+ * Queue sentences for every output. The fan out thread does the writing,
+ * so a stalled output never holds up sampling; it drops what it can't
+ * queue and counts it instead.
+ */
+static void transmit(obelisk_fanout_t * fanoutp, const char * sentence, size_t length)
+{
+    if (debug) {
+        fprintf(stderr, "%s: NMEA \"", program);
+        emit(stderr, sentence);
+        fputs("\".\n", stderr);
+    }
+    (void)obelisk_fanout_post(fanoutp, sentence, length);
+}
+
+/*
+ * Bring the NMEA emitter to a second, taking the sentences precomputed when
+ * the last frame arrived if the second is among them, and patch the mode
+ * indicator: 'D' (differential) for time from WWVB, or 'E' (estimated) for
+ * time from holdover.
+ */
+static void advance(obelisk_nmea_t * np, const obelisk_nmea_t table[], size_t count, time_t seconds, char mode)
+{
+    time_t index = -1;
+
+    if (count == 0) {
+        /* Do nothing. */
+    } else if ((index = seconds - table[0].seconds) < 0) {
+        /* Do nothing. */
+    } else if (index >= count) {
+        /* Do nothing. */
+    } else {
+        *np = table[index];
+    }
+
+    obelisk_nmea_time(np, seconds);
+    obelisk_nmea_mode(np, mode);
+}
+
+/*
+ * Write the synthesized NMEA sentences for the epoch second that began at
+ * the edge (on the monotonic clock). The fraction of the second is taken
+ * as late as possible, and moved ahead by the delay expected until the
+ * sentences are queued. Returns how long it took from taking the fraction
+ * to queueing the sentences in nanoseconds.
+ */
+static int64_t report(obelisk_fanout_t * fanoutp, obelisk_nmea_t * np, int64_t edge, int64_t delay)
+{
+    int64_t now = -1;
+    long hundredths = -1;
+
+    now = monotonic();
+    hundredths = (now + delay - edge) / (1000000000LL / 100); /* Round down. */
+    if (hundredths < 0) {
+        hundredths = 0;
+    } else if (hundredths > 99) {
+        hundredths = 99;
+    } else {
+        /* Do nothing. */
+    }
+    obelisk_nmea_hundredths(np, hundredths);
+    transmit(fanoutp, np->buffer, np->length);
+
+    return monotonic() - now;
+}
+
+/*
+ * Convert a time on the monotonic clock, in the recent past, to the system
+ * clock.
+ */
+static void realtime(struct timespec * tsp, int64_t then)
+{
+    int rc = -1;
+    int64_t ago = -1;
+
+    rc = clock_gettime(CLOCK_REALTIME, tsp);
+    assert(rc == 0);
+    ago = monotonic() - then;
+    tsp->tv_sec -= ago / 1000000000LL;
+    tsp->tv_nsec -= ago % 1000000000LL;
+    if (tsp->tv_nsec < 0) {
+        tsp->tv_sec -= 1;
+        tsp->tv_nsec += 1000000000LL;
+    }
+}
+
+/*
+ * Send a sample to chronyd, (re)connecting as needed, since chronyd may be
+ * started, or restarted, after we are.
+ */
+static void chrony(int * sockp, const struct timespec * systemp, const struct timespec * referencep, obelisk_sock_leap_t leap)
+{
+    obelisk_sock_sample_t sample = { 0 };
+
+    obelisk_sock_prepare(&sample, systemp, referencep, leap);
+
+    if (*sockp < 0) {
+        *sockp = obelisk_sock_open(sock_path);
+    }
+
+    if (*sockp < 0) {
+        LOG("SOCK \"%s\" %d.", sock_path, errno);
+    } else if (obelisk_sock_send(*sockp, &sample) < 0) {
+        LOG("SOCK \"%s\" %d.", sock_path, errno);
+        (void)obelisk_sock_close(*sockp);
+        *sockp = -1;
+    } else {
+        /* Do nothing. */
+    }
+}
+
+/*
+ * Send a binary time message stamped with the time now, either to a UDP
+ * endpoint, or to a UNIX domain socket (re)connecting as needed, since the
+ * consumer may be started, or restarted, after we are.
+ */
+static void inform(int * sockp, diminuto_ipc_endpoint_t * endpointp, obelisk_message_t * messagep, obelisk_message_lock_t lock, time_t seconds, int64_t elapsed, int64_t uncertainty)
+{
+    ssize_t rc = -1;
+
+    if (elapsed < 0) {
+        elapsed = 0;
+    } else if (elapsed >= 1000000000LL) {
+        elapsed = 1000000000LL - 1;
+    } else {
+        /* Do nothing. */
+    }
+
+    obelisk_message_prepare(messagep, lock, seconds, elapsed, uncertainty);
+
+    if (endpointp != (diminuto_ipc_endpoint_t *)0) {
+        if (!diminuto_ipc6_is_unspecified(&endpointp->ipv6)) {
+            rc = diminuto_ipc6_datagram_send(*sockp, messagep, sizeof(*messagep), endpointp->ipv6, endpointp->udp);
+        } else {
+            rc = diminuto_ipc4_datagram_send(*sockp, messagep, sizeof(*messagep), endpointp->ipv4, endpointp->udp);
+        }
+        if (rc < 0) {
+            LOG("MESSAGE \"%s\" %d.", message_destination, errno);
+        }
+    } else {
+        if (*sockp < 0) {
+            *sockp = obelisk_message_open(message_destination);
+        }
+        if (*sockp < 0) {
+            LOG("MESSAGE \"%s\" %d.", message_destination, errno);
+        } else if (obelisk_message_send(*sockp, messagep) < 0) {
+            LOG("MESSAGE \"%s\" %d.", message_destination, errno);
+            (void)obelisk_message_close(*sockp);
+            *sockp = -1;
+        } else {
+            /* Do nothing. */
+        }
+    }
+}
+
+/*
+ * Smooth a measured delay with an exponentially weighted moving average.
+ */
+static int64_t smooth(int64_t average, int64_t sample)
+{
+    return average + ((sample - average) / 16);
+}
 
 int main(int argc, char ** argv)
 {
@@ -149,17 +404,46 @@ int main(int argc, char ** argv)
     FILE * pin_out_p1_fp = (FILE *)0;
     FILE * pin_out_pps_fp = (FILE *)0;
     FILE * pin_in_t_fp = (FILE *)0;
-    FILE * nmea_out_fp = (FILE *)0;
-    diminuto_ipc_endpoint_t nmea_out_endpoint = { 0 };
+    FILE * nmea_out_fp[OBELISK_FANOUT_SINKS] = { (FILE *)0, };
+    diminuto_ipc_endpoint_t nmea_out_endpoint[OBELISK_FANOUT_SINKS] = { { 0 }, };
+    int nmea_out_sock[OBELISK_FANOUT_SINKS] = { 0 };
     int nmea_out_sock4 = -1;
     int nmea_out_sock6 = -1;
+    obelisk_fanout_t fanout = { 0 };
+    obelisk_fanout_statistics_t statistics = { 0 };
+    obelisk_multicast_t multicast = { 0 };
+    obelisk_message_t message = { 0 };
+    diminuto_ipc_endpoint_t message_endpoint = { 0 };
+    diminuto_ipc_endpoint_t * message_endpointp = (diminuto_ipc_endpoint_t *)0;
+    int message_sock = -1;
+    obelisk_ntp_t ntp = { 0 };
+    obelisk_ntp_statistics_t ntp_statistics = { 0 };
+    obelisk_page_t * page = (obelisk_page_t *)0;
+    obelisk_page_data_t page_data = { 0 };
+    char address[sizeof("[XXXX:XXXX:XXXX:XXXX:XXXX:XXXX:XXXX:XXXX]:65535")];
+    int multicast_port = -1;
+    int sink = -1;
+    obelisk_shm_t * shm_serial = (obelisk_shm_t *)0;
+    obelisk_shm_t * shm_pps = (obelisk_shm_t *)0;
+    struct timespec clock_time = { 0 };
+    struct timespec receive_time = { 0 };
+    obelisk_shm_leap_t leap = (obelisk_shm_leap_t)-1;
+    int sock = -1;
+    obelisk_schedule_t schedule = { 0 };
+    obelisk_nmea_t emitter = { 0 };
+    obelisk_nmea_t sentences[OBELISK_NMEA_SENTENCES];
+    size_t precomputed = 0;
+    uint64_t pulses = 0;
+    int64_t edge_next = -1;
+    int64_t edge_scheduled = -1;
+    int scheduled = -1;
     diminuto_sticks_t ticks_frequency = -1;
     diminuto_ticks_t ticks_delay = -1;
     diminuto_ticks_t ticks_timer = -1;
     diminuto_sticks_t ticks_slack = -1;
     diminuto_sticks_t ticks_now = -1;
-    diminuto_sticks_t ticks_begin = -1;
-    diminuto_sticks_t ticks_end = -1;
+    diminuto_sticks_t ticks_origin = -1;
+    diminuto_sticks_t ticks_minute = -1;
     diminuto_cue_state_t cue = { 0 };
     diminuto_cue_edge_t edge = (diminuto_cue_edge_t)-1;
     int level_raw = -1;
@@ -175,10 +459,39 @@ int main(int argc, char ** argv)
     obelisk_event_t event = (obelisk_event_t)-1;
     obelisk_buffer_t buffer = -1;
     obelisk_frame_t frame = { 0 };
-    hazer_buffer_t sentence = { 0 };
+    obelisk_partial_t partial = { 0 };
+    obelisk_accumulator_t accumulator = { 0 };
+    obelisk_viterbi_t viterbi = { 0 };
+    obelisk_acquire_t acquisition = { 0 };
+    obelisk_discipline_t discipline = { 0 };
+    obelisk_pll_t pll = { 0 };
+    static obelisk_stability_t stability; /* Too large for the stack. */
+    int64_t published = -1;
+    int tau = -1;
+    int cost[OBELISK_VITERBI_TOKENS] = { 0 };
+    obelisk_buffer_t voted = 0;
+    obelisk_buffer_t reference = 0;
+    obelisk_buffer_t expected = 0;
+    obelisk_group_t group = (obelisk_group_t)-1;
     struct tm time = { 0 };
     struct tm * timep = (struct tm *)0;
     struct timeval epoch = { 0 };
+    struct timespec system = { 0 };
+    struct timespec reference_time = { 0 };
+    struct tm tomorrow = { 0 };
+    time_t later = -1;
+    int64_t offset = 0;
+    int64_t edge_raw = -1;
+    int64_t edge_estimated = -1;
+    int64_t edge_pps = -1;
+    int64_t edge_epoch = -1;
+    int64_t seconds_estimated = -1;
+    int64_t now = -1;
+    int64_t tick_prior = -1;
+    int64_t tick_sample = -1;
+    int64_t delay_output = 0;
+    int64_t delay_pps = 0;
+    int64_t residual = 0;
     extern long timezone;
     extern int daylight;
     int field = -1;
@@ -189,7 +502,14 @@ int main(int argc, char ** argv)
     int error = -1;
     int armed = -1;
     int disciplined = -1;
+    int trusted = -1;
+    int leaping = 0;
+    int holding = -1;
+    int raised = -1;
+    int acquired_old = -1;
     int synchronized = -1;
+    int confirmed = -1;
+    int acquiring = -1;
     int year = -1;
     int month = -1;
     int day = -1;
@@ -198,6 +518,12 @@ int main(int argc, char ** argv)
     int second = -1;
     diminuto_ticks_t fraction = (diminuto_ticks_t)-1;
     int acquired = -1;
+    int minutes_elapsed = -1;
+    int minutes_predicted = -1;
+    int reference_minute = -1;
+    int expected_minute = -1;
+    int mismatches = -1;
+    int mismatches_old = -1;
     int cycles = -1;
     int risings = -1;
     int fallings = -1;
@@ -208,6 +534,9 @@ int main(int argc, char ** argv)
     diminuto_ipv6_t address6 = { 0 };
     char printable[sizeof("XXXX:XXXX:XXXX:XXXX:XXXX:XXXX:XXXX:XXXX")];
     diminuto_port_t port = 0;
+    time_t prior = -1;
+    time_t candidate = -1;
+    time_t reference_epoch = -1;
 
     assert(sizeof(obelisk_buffer_t) == sizeof(uint64_t));
     assert(sizeof(obelisk_frame_t) == sizeof(uint64_t));
@@ -228,12 +557,12 @@ int main(int argc, char ** argv)
     hour_juliet = HOUR_JULIET;
     minute_juliet = MINUTE_JULIET;
     strncpy(nmea_talker, HAZER_TALKER_NAME[HAZER_TALKER_RADIO], sizeof(nmea_talker) - 1);
-    nmea_path = NMEA_PATH;
     nice_priority = NICE_NONE;
+    threshold = OBELISK_DISCIPLINE_THRESHOLD;
 
     error = 0;
 
-    while ((opt = getopt(argc, argv, "1278B:C:H:L:M:N:O:P:S:T:U:abcdeghiklmonprsuvx")) >= 0) {
+    while ((opt = getopt(argc, argv, "1278A:B:C:DEFGH:I:J:K:L:M:N:O:P:QR:S:T:U:VW:X:Y:Z:abcdef:ghiklmonprst:uvw:xz")) >= 0) {
 
         switch (opt) {
 
@@ -273,6 +602,15 @@ int main(int argc, char ** argv)
             serial_modemcontrol = !0;
             break;
 
+        case 'A':
+            margin = strtol(optarg, &endptr, 0);
+            if ((*endptr != '\0') || (margin < 1) || (margin > OBELISK_ACCUMULATOR_FRAMES)) {
+                errno = EINVAL;
+                diminuto_perror(optarg);
+                error = !0;
+            }
+            break;
+
         case 'B':
             serial_bitspersecond = strtoul(optarg, &endptr, 0);
             if ((*endptr != '\0') || (serial_bitspersecond < 0)) {
@@ -291,6 +629,22 @@ int main(int argc, char ** argv)
             }
             break;
 
+        case 'D':
+            slewing = !0;
+            break;
+
+        case 'E':
+            early = !0;
+            break;
+
+        case 'F':
+            follow = !0;
+            break;
+
+        case 'G':
+            scheduling = !0;
+            break;
+
         case 'H':
             hour_juliet = strtol(optarg, &endptr, 0);
             if ((*endptr != '\0') || (hour_juliet < 0) || (hour_juliet > 23)) {
@@ -300,6 +654,35 @@ int main(int argc, char ** argv)
             }
             break;
 
+        case 'I':
+            multicast_interface = optarg;
+            if ((endptr = strchr(optarg, ',')) != (char *)0) {
+                *(endptr++) = '\0';
+                multicast_ttl = strtol(endptr, &endptr, 0);
+                if ((*endptr != '\0') || (multicast_ttl < 0) || (multicast_ttl > 255)) {
+                    errno = EINVAL;
+                    diminuto_perror(optarg);
+                    error = !0;
+                }
+            }
+            if (*multicast_interface == '\0') {
+                multicast_interface = (const char *)0;
+            }
+            break;
+
+        case 'J':
+            sock_path = optarg;
+            break;
+
+        case 'K':
+            tracking = strtol(optarg, &endptr, 0);
+            if ((*endptr != '\0') || (tracking < 1)) {
+                errno = EINVAL;
+                diminuto_perror(optarg);
+                error = !0;
+            }
+            break;
+
         case 'L':
             run_path = optarg;
             break;
@@ -324,8 +707,13 @@ int main(int argc, char ** argv)
             break;
 
         case 'O':
-            nmea_path = optarg;
-            nmea_endpoint = (const char *)0;
+            if ((nmea_paths + nmea_endpoints) < OBELISK_FANOUT_SINKS) {
+                nmea_path[nmea_paths++] = optarg;
+            } else {
+                errno = E2BIG;
+                diminuto_perror(optarg);
+                error = !0;
+            }
             break;
 
         case 'P':
@@ -337,6 +725,20 @@ int main(int argc, char ** argv)
             }
             break;
 
+        case 'Q':
+            quick = !0;
+            break;
+
+        case 'R':
+            if (multicast_endpoints < OBELISK_MULTICAST_DESTINATIONS) {
+                multicast_endpoint[multicast_endpoints++] = optarg;
+            } else {
+                errno = E2BIG;
+                diminuto_perror(optarg);
+                error = !0;
+            }
+            break;
+
         case 'S':
             pin_out_pps = strtol(optarg, &endptr, 0);
             if ((*endptr != '\0') || (pin_out_pps < 0)) {
@@ -356,8 +758,53 @@ int main(int argc, char ** argv)
             break;
 
         case 'U':
-            nmea_endpoint = optarg;
-            nmea_path = (const char *)0;
+            if ((nmea_paths + nmea_endpoints) < OBELISK_FANOUT_SINKS) {
+                nmea_endpoint[nmea_endpoints++] = optarg;
+            } else {
+                errno = E2BIG;
+                diminuto_perror(optarg);
+                error = !0;
+            }
+            break;
+
+        case 'V':
+            trellis = !0;
+            break;
+
+        case 'W':
+            holdover = strtol(optarg, &endptr, 0);
+            if ((*endptr != '\0') || (holdover < 1)) {
+                errno = EINVAL;
+                diminuto_perror(optarg);
+                error = !0;
+            }
+            break;
+
+        case 'X':
+            threshold = strtol(optarg, &endptr, 0);
+            if ((*endptr != '\0') || (threshold < 0)) {
+                errno = EINVAL;
+                diminuto_perror(optarg);
+                error = !0;
+            }
+            break;
+
+        case 'Y':
+            publish = strtol(optarg, &endptr, 0);
+            if ((*endptr != '\0') || (publish < 1)) {
+                errno = EINVAL;
+                diminuto_perror(optarg);
+                error = !0;
+            }
+            break;
+
+        case 'Z':
+            shm_unit = strtol(optarg, &endptr, 0);
+            if ((*endptr != '\0') || (shm_unit < 0)) {
+                errno = EINVAL;
+                diminuto_perror(optarg);
+                error = !0;
+            }
             break;
 
         case 'a':
@@ -372,6 +819,10 @@ int main(int argc, char ** argv)
             debug = !0;
             break;
 
+        case 'f':
+            page_name = optarg;
+            break;
+
         case 'g':
             hangup = !0;
             break;
@@ -409,6 +860,10 @@ int main(int argc, char ** argv)
             set_daily = !0;
             break;
 
+        case 't':
+            message_destination = optarg;
+            break;
+
         case 'u':
             unexport = !0;
             break;
@@ -417,6 +872,19 @@ int main(int argc, char ** argv)
             verbose = !0;
             break;
 
+        case 'w':
+            ntp_port = strtol(optarg, &endptr, 0);
+            if ((*endptr != '\0') || (ntp_port < 0) || (ntp_port > 65535)) {
+                errno = EINVAL;
+                diminuto_perror(optarg);
+                error = !0;
+            }
+            break;
+
+        case 'z':
+            nmea_extra = !0;
+            break;
+
         default:
             error = !0;
             break;
@@ -600,138 +1068,327 @@ int main(int argc, char ** argv)
     }
 
     /*
-     * Open NMEA output file if requested. We open for reading and
-     * writing ("a+") so that we don't get a SIGPIPE in the event
+     * Open NMEA output files and sockets if requested. We open for reading
+     * and writing ("a+") so that we don't get a SIGPIPE in the event
      * the user has specified a FIFO and the reader (e.g. gpsd)
      * hasn't opened its end for reading yet. That's also why
      * we delay the fopen(3) until after the GPIO radio initialization
-     * above.
+     * above. Each output is a sink of the fan out, whose thread does the
+     * writing.
      */
 
     if (!nmea) {
 
         /* Do nothing. */
 
-    } else if (nmea_path != (const char *)0) {
+    } else {
 
-        LOG("NMEAPATH \"%s\".", nmea_path);
+        rc = obelisk_fanout_init(&fanout);
+        assert(rc >= 0);
 
-        if (strcmp(nmea_path, NMEA_PATH) == 0) {
-            nmea_out_fp = stdout;
-        } else if ((nmea_out_fp = fopen(nmea_path, "a+")) == (FILE *)0) {
-            diminuto_perror(nmea_path);
-            assert(nmea_out_fp != (FILE *)0);
-        } else if ((fd = fileno(nmea_out_fp)) < 0) {
-            diminuto_perror(nmea_path);
-            assert(fd >= 0);
-        } else if ((rc = isfdtype(fd, S_IFCHR)) < 0) {
-            diminuto_perror(nmea_path);
-            assert(rc >= 0);
-        } else if (rc) {
-            rc = diminuto_serial_set(fd, serial_bitspersecond, serial_databits, serial_paritybit, serial_stopbits, serial_modemcontrol, serial_xonxoff, serial_rtscts);
-            assert(rc >= 0);
-            rc = diminuto_serial_raw(fd);
-            assert(rc >= 0);
-        } else {
-            /* Do nothing. */
+        if ((nmea_paths + nmea_endpoints) == 0) {
+            nmea_path[nmea_paths++] = NMEA_PATH;
         }
 
-    } else if (nmea_endpoint != (const char *)0) {
+        for (sink = 0; sink < nmea_paths; ++sink) {
 
-        LOG("NMEAENDPOINT \"%s\".", nmea_endpoint);
+            LOG("NMEAPATH \"%s\".", nmea_path[sink]);
 
-        if ((rc = diminuto_ipc_endpoint(nmea_endpoint, &nmea_out_endpoint)) < 0) {
-            /* Do nothing. */
-        } else if (nmea_out_endpoint.udp <= 0) {
-            /* Do nothing. */
-        } else if (!diminuto_ipc6_is_unspecified(&nmea_out_endpoint.ipv6)) {
-            nmea_out_sock6 = diminuto_ipc6_datagram_peer(0);
-        } else if (!diminuto_ipc4_is_unspecified(&nmea_out_endpoint.ipv4)) {
-            nmea_out_sock4 = diminuto_ipc4_datagram_peer(0);
-        } else {
-            /* Do nothing. */
-        }
+            if (strcmp(nmea_path[sink], NMEA_PATH) == 0) {
+                nmea_out_fp[sink] = stdout;
+            } else if ((nmea_out_fp[sink] = fopen(nmea_path[sink], "a+")) == (FILE *)0) {
+                diminuto_perror(nmea_path[sink]);
+                assert(nmea_out_fp[sink] != (FILE *)0);
+            } else if ((fd = fileno(nmea_out_fp[sink])) < 0) {
+                diminuto_perror(nmea_path[sink]);
+                assert(fd >= 0);
+            } else if ((rc = isfdtype(fd, S_IFCHR)) < 0) {
+                diminuto_perror(nmea_path[sink]);
+                assert(rc >= 0);
+            } else if (rc) {
+                rc = diminuto_serial_set(fd, serial_bitspersecond, serial_databits, serial_paritybit, serial_stopbits, serial_modemcontrol, serial_xonxoff, serial_rtscts);
+                assert(rc >= 0);
+                rc = diminuto_serial_raw(fd);
+                assert(rc >= 0);
+            } else {
+                /* Do nothing. */
+            }
+
+            rc = obelisk_fanout_add(&fanout, fileno(nmea_out_fp[sink]), (obelisk_fanout_function_t *)0, (void *)0);
+            assert(rc >= 0);
 
-        if (nmea_out_sock6 >= 0) {
-            diminuto_ipc6_nearend(nmea_out_sock6, &address6, &port);
-            diminuto_ipc6_address2string(address6, printable, sizeof(printable));
-            LOG("NMEANEAREND [%s]:%d.", printable, port);
-            diminuto_ipc6_address2string(nmea_out_endpoint.ipv6, printable, sizeof(printable));
-            LOG("NMEAFARREND [%s]:%d.", printable, nmea_out_endpoint.udp);
-        } else if (nmea_out_sock4 >= 0) {
-            diminuto_ipc4_nearend(nmea_out_sock4, &address4, &port);
-            diminuto_ipc4_address2string(address4, printable, sizeof(printable));
-            LOG("NMEANEAREND %s:%d.", printable, port);
-            diminuto_ipc4_address2string(nmea_out_endpoint.ipv4, printable, sizeof(printable));
-            LOG("NMEAFARREND %s:%d.", printable, nmea_out_endpoint.udp);
-        } else {
-            errno = EINVAL;
-            diminuto_perror(nmea_endpoint);
-            assert((nmea_out_sock6 >= 0) || (nmea_out_sock4 >= 0));
         }
 
-    } else {
+        for (sink = 0; sink < nmea_endpoints; ++sink) {
 
-        /* SHould be impossible */
+            LOG("NMEAENDPOINT \"%s\".", nmea_endpoint[sink]);
 
-        nmea = 0;
+            nmea_out_sock[sink] = -1;
+            nmea_out_sock4 = -1;
+            nmea_out_sock6 = -1;
 
-    }
+            if ((rc = diminuto_ipc_endpoint(nmea_endpoint[sink], &nmea_out_endpoint[sink])) < 0) {
+                /* Do nothing. */
+            } else if (nmea_out_endpoint[sink].udp <= 0) {
+                /* Do nothing. */
+            } else if (!diminuto_ipc6_is_unspecified(&nmea_out_endpoint[sink].ipv6)) {
+                nmea_out_sock6 = diminuto_ipc6_datagram_peer(0);
+            } else if (!diminuto_ipc4_is_unspecified(&nmea_out_endpoint[sink].ipv4)) {
+                nmea_out_sock4 = diminuto_ipc4_datagram_peer(0);
+            } else {
+                /* Do nothing. */
+            }
 
-    /*
-    ** Initialize state.
-    */
+            if (nmea_out_sock6 >= 0) {
+                diminuto_ipc6_nearend(nmea_out_sock6, &address6, &port);
+                diminuto_ipc6_address2string(address6, printable, sizeof(printable));
+                LOG("NMEANEAREND [%s]:%d.", printable, port);
+                diminuto_ipc6_address2string(nmea_out_endpoint[sink].ipv6, printable, sizeof(printable));
+                LOG("NMEAFARREND [%s]:%d.", printable, nmea_out_endpoint[sink].udp);
+                nmea_out_sock[sink] = nmea_out_sock6;
+                rc = obelisk_fanout_add(&fanout, nmea_out_sock6, datagram6, &nmea_out_endpoint[sink]);
+                assert(rc >= 0);
+            } else if (nmea_out_sock4 >= 0) {
+                diminuto_ipc4_nearend(nmea_out_sock4, &address4, &port);
+                diminuto_ipc4_address2string(address4, printable, sizeof(printable));
+                LOG("NMEANEAREND %s:%d.", printable, port);
+                diminuto_ipc4_address2string(nmea_out_endpoint[sink].ipv4, printable, sizeof(printable));
+                LOG("NMEAFARREND %s:%d.", printable, nmea_out_endpoint[sink].udp);
+                nmea_out_sock[sink] = nmea_out_sock4;
+                rc = obelisk_fanout_add(&fanout, nmea_out_sock4, datagram4, &nmea_out_endpoint[sink]);
+                assert(rc >= 0);
+            } else {
+                errno = EINVAL;
+                diminuto_perror(nmea_endpoint[sink]);
+                assert((nmea_out_sock6 >= 0) || (nmea_out_sock4 >= 0));
+            }
 
-    LOG("INITIALIZE.");
+        }
 
-    tzset();
+        rc = obelisk_fanout_start(&fanout);
+        assert(rc >= 0);
 
-    milliseconds_pulse = 0;
+    }
 
-    milliseconds_cycle  = 1000 / HERTZ_TIMER;
+    /*
+     * Open the multicast sockets if requested. Each GROUP:PORT is split at
+     * its last colon, and an IPv6 address may be in brackets.
+     */
 
-    cycles_limit = HERTZ_TIMER * 2;
+    if (multicast_endpoints > 0) {
 
-    level_raw = OBELISK_LEVEL_ZERO;
+        rc = obelisk_multicast_init(&multicast, multicast_interface, multicast_ttl);
+        if (rc < 0) { diminuto_perror(multicast_interface); }
+        assert(rc >= 0);
 
-    token = OBELISK_TOKEN_INVALID;
-    state = OBELISK_STATE_START;
+        for (sink = 0; sink < multicast_endpoints; ++sink) {
 
-    rc = diminuto_alarm_install(!0);
-    assert(rc >= 0);
+            LOG("MULTICAST \"%s\".", multicast_endpoint[sink]);
 
-    rc = diminuto_hangup_install(!0);
-    assert(rc >= 0);
+            strncpy(address, multicast_endpoint[sink], sizeof(address));
+            address[sizeof(address) - 1] = '\0';
+            multicast_port = -1;
+            endptr = strrchr(address, ':');
+            if (endptr != (char *)0) {
+                *(endptr++) = '\0';
+                multicast_port = strtol(endptr, &endptr, 0);
+                if (*endptr != '\0') {
+                    multicast_port = -1;
+                }
+            }
 
-    rc = diminuto_terminator_install(0);
-    assert(rc >= 0);
+            if (multicast_port < 0) {
+                errno = EINVAL;
+                rc = -1;
+            } else if ((address[0] == '[') && (address[strlen(address) - 1] == ']')) {
+                address[strlen(address) - 1] = '\0';
+                rc = obelisk_multicast_add(&multicast, &address[1], multicast_port);
+            } else {
+                rc = obelisk_multicast_add(&multicast, address, multicast_port);
+            }
+            if (rc < 0) {
+                diminuto_perror(multicast_endpoint[sink]);
+            }
+            assert(rc >= 0);
 
-    rc = diminuto_interrupter_install(0);
-    assert(rc >= 0);
+        }
 
-    ticks_timer = ticks_frequency / HERTZ_TIMER;
-    if (ticks_timer == 0) {
-    	ticks_timer = 1;
     }
 
-    LOG("PERIODIC %lldticks.", (long long int)ticks_timer);
+    /*
+     * Resolve the binary time message destination if requested. A
+     * DESTINATION with a slash in it is the path of a UNIX domain socket,
+     * connected to later since the consumer may not be running yet;
+     * otherwise it is a UDP endpoint.
+     */
 
-    ticks_slack = diminuto_timer_periodic(ticks_timer);
-    assert(ticks_slack == 0);
+    obelisk_message_init(&message);
 
-    risings = 0;
-    fallings = 0;
-    cycles = 0;
+    if (message_destination == (const char *)0) {
+        /* Do nothing. */
+    } else if (strchr(message_destination, '/') != (char *)0) {
+        LOG("MESSAGE \"%s\".", message_destination);
+    } else {
 
-    initialized = 0;
-    synchronized = !0;
-    acquired = 0;
-    armed = 0;
-    disciplined = 0;
+        LOG("MESSAGE \"%s\".", message_destination);
 
-    buffer = 0;
+        if ((rc = diminuto_ipc_endpoint(message_destination, &message_endpoint)) < 0) {
+            /* Do nothing. */
+        } else if (message_endpoint.udp == 0) {
+            rc = -1;
+        } else if (!diminuto_ipc6_is_unspecified(&message_endpoint.ipv6)) {
+            rc = message_sock = diminuto_ipc6_datagram_peer(0);
+        } else if (!diminuto_ipc4_is_unspecified(&message_endpoint.ipv4)) {
+            rc = message_sock = diminuto_ipc4_datagram_peer(0);
+        } else {
+            rc = -1;
+        }
+        if (rc < 0) {
+            errno = EINVAL;
+            diminuto_perror(message_destination);
+        }
+        assert(rc >= 0);
 
-    /*
+        message_endpointp = &message_endpoint;
+
+    }
+
+    /*
+     * Start the NTP server if requested. It says it is unsynchronized
+     * until the first second we know the time.
+     */
+
+    if (ntp_port >= 0) {
+
+        LOG("NTP %d.", ntp_port);
+
+        rc = obelisk_ntp_init(&ntp, ntp_port);
+        if (rc < 0) { diminuto_perror("obelisk_ntp_init"); }
+        assert(rc >= 0);
+
+        rc = obelisk_ntp_start(&ntp);
+        if (rc < 0) { diminuto_perror("obelisk_ntp_start"); }
+        assert(rc >= 0);
+
+    }
+
+    /*
+     * Create the shared memory clock page if requested. Other processes
+     * read it without system calls or locks using the functions in the
+     * header.
+     */
+
+    page_data.uncertainty = -1;
+
+    if (page_name != (const char *)0) {
+
+        LOG("PAGE \"%s\".", page_name);
+
+        page = obelisk_page_create(page_name);
+        if (page == (obelisk_page_t *)0) { diminuto_perror(page_name); }
+        assert(page != (obelisk_page_t *)0);
+
+    }
+
+    /*
+     * Attach to the ntpd SHM reference clock segments if requested.
+     */
+
+    if (shm_unit < 0) {
+        /* Do nothing. */
+    } else if ((shm_serial = obelisk_shm_attach(shm_unit)) == (obelisk_shm_t *)0) {
+        diminuto_perror("obelisk_shm_attach");
+        assert(shm_serial != (obelisk_shm_t *)0);
+    } else if ((shm_pps = obelisk_shm_attach(shm_unit + 1)) == (obelisk_shm_t *)0) {
+        diminuto_perror("obelisk_shm_attach");
+        assert(shm_pps != (obelisk_shm_t *)0);
+    } else {
+        LOG("SHM %d %d.", shm_unit, shm_unit + 1);
+    }
+
+    /*
+    ** Initialize state.
+    */
+
+    LOG("INITIALIZE.");
+
+    tzset();
+
+    milliseconds_pulse = 0;
+
+    milliseconds_cycle  = 1000 / HERTZ_TIMER;
+
+    cycles_limit = HERTZ_TIMER * 2;
+
+    level_raw = OBELISK_LEVEL_ZERO;
+
+    token = OBELISK_TOKEN_INVALID;
+    state = OBELISK_STATE_START;
+
+    rc = diminuto_alarm_install(!0);
+    assert(rc >= 0);
+
+    rc = diminuto_hangup_install(!0);
+    assert(rc >= 0);
+
+    rc = diminuto_terminator_install(0);
+    assert(rc >= 0);
+
+    rc = diminuto_interrupter_install(0);
+    assert(rc >= 0);
+
+    ticks_timer = ticks_frequency / HERTZ_TIMER;
+    if (ticks_timer == 0) {
+    	ticks_timer = 1;
+    }
+
+    LOG("PERIODIC %lldticks.", (long long int)ticks_timer);
+
+    ticks_slack = diminuto_timer_periodic(ticks_timer);
+    assert(ticks_slack == 0);
+
+    risings = 0;
+    fallings = 0;
+    cycles = 0;
+
+    initialized = 0;
+    synchronized = !0;
+    acquired = 0;
+    armed = 0;
+    disciplined = 0;
+    trusted = 0;
+    confirmed = 0;
+    acquiring = quick && !trellis;
+
+    obelisk_discipline_init(&discipline, threshold, OBELISK_DISCIPLINE_CONSTANT);
+
+    holding = 0;
+    raised = 0;
+    acquired_old = 0;
+
+    if ((holdover || scheduling) && !tracking) {
+        tracking = OBELISK_PLL_CONSTANT;
+    }
+
+    obelisk_schedule_init(&schedule);
+
+    obelisk_nmea_init(&emitter, nmea_talker, nmea_extra);
+    scheduled = 0;
+
+    if (tracking) {
+        obelisk_pll_init(&pll, tracking);
+    }
+
+    obelisk_stability_init(&stability);
+    published = 0;
+
+    buffer = 0;
+
+    obelisk_accumulator_init(&accumulator);
+    obelisk_viterbi_init(&viterbi);
+    minutes_elapsed = 0;
+
+    /*
     ** Begin  work loop.
     */
 
@@ -753,8 +1410,12 @@ int main(int argc, char ** argv)
     	 * transmissions of GPS can be easily jammed, as well.)
     	 */
 
-        rc = pause();
-        assert(rc == -1);
+        if (scheduled) {
+            scheduled = 0;
+        } else {
+            rc = pause();
+            assert(rc == -1);
+        }
 
         /*
          * Check for SIGTERM and if seen leave work loop.
@@ -787,13 +1448,19 @@ int main(int argc, char ** argv)
         /*
          * Poll T input pin state and submit to the debouncer. We also keep
          * track of the raw undebounced change and remember when it occurred
-         * so we can compute the latency later.
+         * so we can compute the latency later. The change happened some
+         * time between the previous poll and this one, so rather than
+         * charging all of the sampling and timer latency to it, we take
+         * the midpoint of the two times at which the pin was read.
          */
 
         if (initialized) {
             level_old = level_raw;
         }
 
+        tick_prior = tick_sample;
+        tick_sample = monotonic();
+
         level_raw = diminuto_pin_get(pin_in_t_fp);
         assert(level_raw >= 0);
         level_raw = !!level_raw;
@@ -807,14 +1474,200 @@ int main(int argc, char ** argv)
         if (level_raw == level_old) {
             /* Do nothing. */
         } else if (level_raw) {
-            ticks_begin = diminuto_time_elapsed();
-            assert(ticks_begin >= 0);
+            edge_raw = (tick_prior < 0) ? tick_sample : tick_prior + ((tick_sample - tick_prior) / 2);
         } else {
             /* Do nothing. */
         }
 
         level_cooked = diminuto_cue_debounce(&cue, level_raw);
 
+        /*
+         * If so instructed, when the signal is lost while the software PLL
+         * is locked, go into holdover: keep counting off seconds at the
+         * edges the PLL estimates from the phase and frequency it last
+         * had, and keep generating PPS and NMEA from them, until either
+         * the signal is acquired again or the holdover has lasted too
+         * long to be believed. NMEA marks these timestamps as estimated.
+         */
+
+        if (!holdover) {
+            /* Do nothing. */
+        } else if (holding) {
+            /* Do nothing. */
+        } else if (!acquired_old) {
+            /* Do nothing. */
+        } else if (acquired) {
+            /* Do nothing. */
+        } else if (!obelisk_pll_locked(&pll)) {
+            /* Do nothing. */
+        } else if (edge_epoch < 0) {
+            /* Do nothing. */
+        } else {
+            holding = !0;
+            DIMINUTO_LOG_NOTICE("%s: holding epoch=%lds.\n", program, epoch.tv_sec);
+        }
+
+        acquired_old = acquired;
+
+        if (!holding) {
+            /* Do nothing. */
+        } else if (acquired) {
+            holding = 0;
+            DIMINUTO_LOG_NOTICE("%s: recovered epoch=%lds.\n", program, epoch.tv_sec);
+        } else {
+            now = monotonic();
+            edge_estimated = obelisk_pll_edge(&pll, now);
+            seconds_estimated = llround((edge_estimated - edge_epoch) / pll.period);
+            if (seconds_estimated <= 0) {
+                /* Do nothing. */
+            } else if ((edge_estimated - pll.phase) > (holdover * pll.period)) {
+                holding = 0;
+                DIMINUTO_LOG_NOTICE("%s: expired epoch=%lds uncertainty=%lldns.\n", program, epoch.tv_sec, (long long int)obelisk_pll_uncertainty(&pll, now));
+            } else {
+                epoch.tv_sec += seconds_estimated;
+                epoch.tv_usec = (now - edge_estimated) / 1000;
+                edge_epoch = edge_estimated;
+                LOG("HOLDOVER %ld.%06lds %lldns.", epoch.tv_sec, epoch.tv_usec, (long long int)obelisk_pll_uncertainty(&pll, now));
+                if (scheduling && (llabs(edge_estimated - edge_scheduled) < (OBELISK_PLL_SECOND / 2))) {
+                    edge_estimated = -1; /* Already reported. */
+                }
+                if (shm_pps != (obelisk_shm_t *)0) {
+                    clock_time.tv_sec = epoch.tv_sec;
+                    clock_time.tv_nsec = 0;
+                    realtime(&receive_time, edge_epoch);
+                    obelisk_shm_post(shm_pps, &clock_time, &receive_time, leaping ? OBELISK_SHM_LEAP_ADDSECOND : OBELISK_SHM_LEAP_NOWARNING, obelisk_shm_precision(obelisk_pll_uncertainty(&pll, now)));
+                }
+                if (sock_path != (const char *)0) {
+                    clock_time.tv_sec = epoch.tv_sec;
+                    clock_time.tv_nsec = 0;
+                    realtime(&receive_time, edge_epoch);
+                    chrony(&sock, &receive_time, &clock_time, leaping ? OBELISK_SOCK_LEAP_INSERT : OBELISK_SOCK_LEAP_NORMAL);
+                }
+                if (page != (obelisk_page_t *)0) {
+                    page_data.edge = edge_epoch;
+                    page_data.seconds = epoch.tv_sec;
+                    page_data.period = pll.period;
+                    page_data.uncertainty = obelisk_pll_uncertainty(&pll, now);
+                    page_data.residual = residual;
+                    page_data.pps = delay_pps;
+                    page_data.lock = OBELISK_PAGE_LOCK_HOLDOVER;
+                    obelisk_page_publish(page, &page_data);
+                }
+                if (ntp_port >= 0) {
+                    realtime(&receive_time, edge_epoch);
+                    obelisk_ntp_update(&ntp, &receive_time, leaping ? OBELISK_NTP_LEAP_ADDSECOND : OBELISK_NTP_LEAP_NOWARNING, obelisk_pll_uncertainty(&pll, now));
+                }
+                if (message_destination != (const char *)0) {
+                    inform(&message_sock, message_endpointp, &message, OBELISK_MESSAGE_LOCK_HOLDOVER, epoch.tv_sec, monotonic() - edge_epoch, obelisk_pll_uncertainty(&pll, now));
+                }
+                if (multicast_endpoints > 0) {
+                    realtime(&receive_time, edge_epoch);
+                    if (obelisk_multicast_send(&multicast, epoch.tv_sec, &receive_time, OBELISK_MULTICAST_FLAG_HOLDOVER | (leaping ? OBELISK_MULTICAST_FLAG_LEAP : 0)) < 0) {
+                        diminuto_perror("obelisk_multicast_send");
+                    }
+                }
+                if (!nmea) {
+                    /* Do nothing. */
+                } else if (edge_estimated < 0) {
+                    /* Do nothing. */
+                } else {
+                    advance(&emitter, sentences, precomputed, epoch.tv_sec, 'E');
+                    delay_output = smooth(delay_output, report(&fanout, &emitter, edge_epoch, delay_output));
+                }
+            }
+            if (!pps) {
+                /* Do nothing. */
+            } else if (!raised) {
+                /* Do nothing. */
+            } else if ((now - edge_pps) < (PPS_MILLISECONDS * 1000000LL)) {
+                /* Do nothing. */
+            } else {
+                rc = diminuto_pin_clear(pin_out_pps_fp);
+                assert(rc >= 0);
+                raised = 0;
+            }
+        }
+
+        /*
+         * Once the software PLL has locked, PPS goes high at the first
+         * poll after the edge it estimates rather than at the debounced
+         * edge, so it carries the smoothed phase instead of the jitter
+         * of the receiver and the debouncer. In holdover, there is no
+         * falling edge, so PPS goes low again after a fixed width. If
+         * PPS is scheduled, it is raised only at the edge itself, never
+         * late by a poll, so its consumers need no fudge for the delay.
+         */
+
+        if (!pps) {
+            /* Do nothing. */
+        } else if (scheduling) {
+            /* Do nothing. */
+        } else if (!(synchronized || holding)) {
+            /* Do nothing. */
+        } else if (!tracking) {
+            /* Do nothing. */
+        } else if (!obelisk_pll_locked(&pll)) {
+            /* Do nothing. */
+        } else {
+            edge_estimated = obelisk_pll_edge(&pll, monotonic());
+            if ((edge_pps < 0) || ((edge_estimated - edge_pps) > (OBELISK_PLL_SECOND / 2))) {
+                rc = diminuto_pin_set(pin_out_pps_fp);
+                assert(rc >= 0);
+                delay_pps = smooth(delay_pps, monotonic() - edge_estimated);
+                edge_pps = edge_estimated;
+                raised = !0;
+            }
+        }
+
+        /*
+         * If so instructed, once the software PLL has locked, don't wait
+         * for the poll after the second edge to produce PPS and NMEA: at
+         * the last poll before the edge the PLL predicts, build the NMEA
+         * sentence ahead of time, sleep until just before the edge (early
+         * by the latency learned from previous outputs), and then raise
+         * PPS and write the sentence. Statistics are kept of how close
+         * to the predicted edge PPS lands.
+         */
+
+        if (scheduling && obelisk_pll_locked(&pll)) {
+            now = monotonic();
+            edge_next = obelisk_pll_edge(&pll, now) + llround(pll.period);
+            if ((edge_next - edge_scheduled) < (OBELISK_PLL_SECOND / 2)) {
+                /* Do nothing. */
+            } else if ((edge_next - now) > (1000000000LL / HERTZ_TIMER)) {
+                /* Do nothing. */
+            } else {
+                if (nmea && (acquired || holding)) {
+                    advance(&emitter, sentences, precomputed, epoch.tv_sec + 1, acquired ? 'D' : 'E');
+                    obelisk_nmea_hundredths(&emitter, 0);
+                }
+                rc = obelisk_schedule_wait(&schedule, edge_next, now);
+                if (rc < 0) {
+                    /*
+                     * Nothing has gone out for this edge, so leave it
+                     * (and every one after it) to the polled path.
+                     */
+                    diminuto_perror("clock_nanosleep");
+                    scheduling = 0;
+                } else {
+                    if (pps && (synchronized || holding)) {
+                        rc = diminuto_pin_set(pin_out_pps_fp);
+                        assert(rc >= 0);
+                        now = monotonic();
+                        edge_pps = edge_next;
+                        raised = !0;
+                        obelisk_schedule_land(&schedule, edge_next, now);
+                        delay_pps = smooth(delay_pps, now - edge_next);
+                    }
+                    if (nmea && (acquired || holding)) {
+                        transmit(&fanout, emitter.buffer, emitter.length);
+                    }
+                    edge_scheduled = edge_next;
+                    scheduled = !0;
+                }
+            }
+        }
+
         /*
          * Look for edge transitions and measure pulse duration.
          */
@@ -840,11 +1693,70 @@ int main(int argc, char ** argv)
 
             if (!pps) {
                 /* Do nothing. */
+            } else if (scheduling) {
+                /* Do nothing. */
             } else if (!synchronized) {
                 /* Do nothing. */
+            } else if (tracking && obelisk_pll_locked(&pll)) {
+                /* Do nothing. */
             } else {
                 rc = diminuto_pin_set(pin_out_pps_fp);
                 assert(rc >= 0);
+                if (edge_raw >= 0) {
+                    delay_pps = smooth(delay_pps, monotonic() - edge_raw);
+                }
+            }
+
+            /*
+             * Feed the raw edge to the software PLL. Edges it rejects as
+             * outliers are otherwise handled as usual.
+             */
+
+            if (!tracking) {
+                /* Do nothing. */
+            } else if (holding) {
+                /* Do nothing. */
+            } else if (edge_raw < 0) {
+                /* Do nothing. */
+            } else if ((rc = obelisk_pll_update(&pll, edge_raw)) < 0) {
+                DIMINUTO_LOG_NOTICE("%s: restarted PLL.\n", program);
+            } else if (rc > 0) {
+                LOG("OUTLIER %lldns %d.", (long long int)(edge_raw - pll.phase), rc);
+            } else {
+                LOG("PLL %.0fns %.0fns %.0fns.", pll.period, pll.error, pll.jitter);
+            }
+
+            /*
+             * If so instructed, characterize the stability of the raw
+             * edges, and publish it periodically. In holdover, the edges
+             * are likely noise.
+             */
+
+            if (!publish) {
+                /* Do nothing. */
+            } else if (holding) {
+                /* Do nothing. */
+            } else if (edge_raw < 0) {
+                /* Do nothing. */
+            } else if ((rc = obelisk_stability_edge(&stability, edge_raw)) < 0) {
+                published = 0;
+                LOG("STABILITY restarted.");
+            } else if (rc > 0) {
+                /* Do nothing. */
+            } else if ((stability.samples - published) < publish) {
+                /* Do nothing. */
+            } else {
+                published = stability.samples;
+                for (tau = 0; tau < OBELISK_STABILITY_TAUS; ++tau) {
+                    if (obelisk_stability_mtie(&stability, tau) < 0) {
+                        break;
+                    }
+                    DIMINUTO_LOG_NOTICE("%s: stability samples=%lld tau=%ds adev=%.3e tdev=%.0fns mtie=%lldns.\n", program, (long long int)stability.samples, obelisk_stability_tau(tau), obelisk_stability_adev(&stability, tau), obelisk_stability_tdev(&stability, tau), (long long int)obelisk_stability_mtie(&stability, tau));
+                }
+                DIMINUTO_LOG_NOTICE("%s: calibration output=%lldns pps=%lldns residual=%lldns.\n", program, (long long int)delay_output, (long long int)delay_pps, (long long int)residual);
+                if (scheduling) {
+                    DIMINUTO_LOG_NOTICE("%s: schedule landed=%lld mean=%.0fns rms=%.0fns minimum=%lldns maximum=%lldns compensation=%lldns.\n", program, (long long int)schedule.count, obelisk_schedule_mean(&schedule), obelisk_schedule_rms(&schedule), (long long int)schedule.minimum, (long long int)schedule.maximum, (long long int)schedule.compensation);
+                }
             }
 
             /*
@@ -852,71 +1764,230 @@ int main(int argc, char ** argv)
              * the start of the next second. This has the useful side effect
              * of keeping the epoch updated in case we want to set the time,
              * and also in the event a leap second was inserted. We also
-             * compute the debounce latency, which may not be useful if it's
-             * less than a hundredth of a second, the resolution of the NMEA
-             * timestamp.
+             * remember the edge at which the second began, from which the
+             * debounce latency is measured whenever the fraction of the
+             * second is needed. If the software PLL has locked, that is
+             * the edge it estimates, so that NMEA and the clock discipline
+             * see the smoothed phase.
              */
 
             if (acquired) {
                 epoch.tv_sec += 1;
-            	ticks_end = diminuto_time_elapsed();
-            	assert(ticks_end >= 0);
-                epoch.tv_usec = diminuto_frequency_ticks2units(ticks_end - ticks_begin, 1000000);
+                now = monotonic();
+                edge_epoch = edge_raw;
+                if (tracking && obelisk_pll_locked(&pll)) {
+                    edge_epoch = obelisk_pll_edge(&pll, now);
+                }
+                epoch.tv_usec = (now - edge_epoch) / 1000;
                 LOG("TOTAL %ld.%06lds.", epoch.tv_sec, epoch.tv_usec);
             }
 
+            /*
+             * Measure the offset of the system clock from WWVB at every
+             * second, once a complete frame has told us what time it is.
+             * Smoothed, it is the residual of our own delays that we
+             * have not been able to measure and remove, at least when
+             * something else is disciplining the system clock. If so
+             * instructed, hand the offset to the kernel PLL. The kernel
+             * slews the clock and estimates its frequency error as it
+             * goes, and we step the clock only if it is so far off that
+             * slewing would take too long.
+             */
+
+            if (!acquired) {
+                /* Do nothing. */
+            } else if (!trusted) {
+                /* Do nothing. */
+            } else if (edge_epoch < 0) {
+                /* Do nothing. */
+            } else {
+                rc = clock_gettime(CLOCK_REALTIME, &system);
+                assert(rc == 0);
+                now = monotonic();
+                reference_time.tv_sec = epoch.tv_sec;
+                reference_time.tv_nsec = now - edge_epoch;
+                offset = obelisk_discipline_offset(&system, &reference_time);
+                if ((-discipline.threshold <= offset) && (offset <= discipline.threshold)) {
+                    residual = smooth(residual, offset);
+                }
+            }
+
+            if (!slewing) {
+                /* Do nothing. */
+            } else if (!acquired) {
+                /* Do nothing. */
+            } else if (!trusted) {
+                /* Do nothing. */
+            } else if (edge_epoch < 0) {
+                /* Do nothing. */
+            } else {
+                rc = obelisk_discipline_adjust(&discipline, offset);
+                if (rc < 0) {
+                    diminuto_perror("adjtimex");
+                    slewing = 0;
+                } else if (rc > 0) {
+                    disciplined = !0;
+                    DIMINUTO_LOG_NOTICE("%s: stepped offset=%lldns.\n", program, (long long int)offset);
+                } else {
+                    disciplined = !0;
+                    LOG("DISCIPLINE %lldns %ld %d.", (long long int)offset, discipline.frequency, discipline.state);
+                }
+            }
+
+            /*
+             * If so instructed, post the second to the ntpd SHM reference
+             * clocks directly instead of going through NMEA and gpsd: the
+             * raw edge to the first unit, like the serial time from gpsd,
+             * and, once the software PLL has locked, the edge it estimates
+             * to the second, like PPS. Both are stamped with the edge
+             * itself, not with when PPS was raised, so the delay in
+             * raising PPS is never in them.
+             */
+
+            if (shm_serial == (obelisk_shm_t *)0) {
+                /* Do nothing. */
+            } else if (!acquired) {
+                /* Do nothing. */
+            } else if (edge_raw < 0) {
+                /* Do nothing. */
+            } else {
+                clock_time.tv_sec = epoch.tv_sec;
+                clock_time.tv_nsec = 0;
+                leap = leaping ? OBELISK_SHM_LEAP_ADDSECOND : OBELISK_SHM_LEAP_NOWARNING;
+                realtime(&receive_time, edge_raw);
+                obelisk_shm_post(shm_serial, &clock_time, &receive_time, leap, obelisk_shm_precision(1000000000LL / HERTZ_TIMER));
+                if (tracking && obelisk_pll_locked(&pll)) {
+                    realtime(&receive_time, edge_epoch);
+                    obelisk_shm_post(shm_pps, &clock_time, &receive_time, leap, obelisk_shm_precision(obelisk_pll_uncertainty(&pll, edge_epoch)));
+                }
+            }
+
+            /*
+             * If so instructed, send the second to chronyd. Once we know
+             * what time it is, each sample has the offset of the system
+             * clock from WWVB at the edge; before that, if the software
+             * PLL has locked, we know where the second begins, if not
+             * which second it is, and send that as a pulse.
+             */
+
+            if (sock_path == (const char *)0) {
+                /* Do nothing. */
+            } else if (acquired && (edge_epoch >= 0)) {
+                clock_time.tv_sec = epoch.tv_sec;
+                clock_time.tv_nsec = 0;
+                realtime(&receive_time, edge_epoch);
+                chrony(&sock, &receive_time, &clock_time, leaping ? OBELISK_SOCK_LEAP_INSERT : OBELISK_SOCK_LEAP_NORMAL);
+            } else if (tracking && obelisk_pll_locked(&pll)) {
+                realtime(&receive_time, obelisk_pll_edge(&pll, monotonic()));
+                chrony(&sock, &receive_time, (struct timespec *)0, OBELISK_SOCK_LEAP_NORMAL);
+            } else {
+                /* Do nothing. */
+            }
+
+            /*
+             * If so instructed, publish this second edge on the clock
+             * page, with the phase and frequency of the PLL if it is
+             * tracking.
+             */
+
+            if (page == (obelisk_page_t *)0) {
+                /* Do nothing. */
+            } else if (!acquired) {
+                /* Do nothing. */
+            } else if (edge_epoch < 0) {
+                /* Do nothing. */
+            } else {
+                page_data.edge = edge_epoch;
+                page_data.seconds = epoch.tv_sec;
+                if (tracking && obelisk_pll_locked(&pll)) {
+                    page_data.period = pll.period;
+                    page_data.uncertainty = obelisk_pll_uncertainty(&pll, edge_epoch);
+                } else {
+                    page_data.period = OBELISK_PLL_SECOND;
+                    page_data.uncertainty = -1;
+                }
+                page_data.residual = residual;
+                page_data.pps = delay_pps;
+                page_data.lock = OBELISK_PAGE_LOCK_ACQUIRED;
+                obelisk_page_publish(page, &page_data);
+            }
+
+            /*
+             * If so instructed, tell the NTP server the clock is right as
+             * of this second edge.
+             */
+
+            if (ntp_port < 0) {
+                /* Do nothing. */
+            } else if (!acquired) {
+                /* Do nothing. */
+            } else if (edge_epoch < 0) {
+                /* Do nothing. */
+            } else {
+                realtime(&receive_time, edge_epoch);
+                if (tracking && obelisk_pll_locked(&pll)) {
+                    obelisk_ntp_update(&ntp, &receive_time, leaping ? OBELISK_NTP_LEAP_ADDSECOND : OBELISK_NTP_LEAP_NOWARNING, obelisk_pll_uncertainty(&pll, edge_epoch));
+                } else {
+                    obelisk_ntp_update(&ntp, &receive_time, leaping ? OBELISK_NTP_LEAP_ADDSECOND : OBELISK_NTP_LEAP_NOWARNING, -1);
+                }
+            }
+
+            /*
+             * If so instructed, send the binary time message, stamped
+             * with the time it is sent.
+             */
+
+            if (message_destination == (const char *)0) {
+                /* Do nothing. */
+            } else if (!acquired) {
+                /* Do nothing. */
+            } else if (edge_epoch < 0) {
+                /* Do nothing. */
+            } else {
+                now = monotonic();
+                if (tracking && obelisk_pll_locked(&pll)) {
+                    inform(&message_sock, message_endpointp, &message, OBELISK_MESSAGE_LOCK_ACQUIRED, epoch.tv_sec, now - edge_epoch, obelisk_pll_uncertainty(&pll, now));
+                } else {
+                    inform(&message_sock, message_endpointp, &message, OBELISK_MESSAGE_LOCK_ACQUIRED, epoch.tv_sec, now - edge_epoch, -1);
+                }
+            }
+
+            /*
+             * If so instructed, announce the second to the multicast
+             * groups. Each announcement also carries how long after its
+             * edge the previous one actually went out.
+             */
+
+            if (multicast_endpoints == 0) {
+                /* Do nothing. */
+            } else if (!acquired) {
+                /* Do nothing. */
+            } else if (edge_epoch < 0) {
+                /* Do nothing. */
+            } else {
+                realtime(&receive_time, edge_epoch);
+                if (obelisk_multicast_send(&multicast, epoch.tv_sec, &receive_time, OBELISK_MULTICAST_FLAG_ACQUIRED | (leaping ? OBELISK_MULTICAST_FLAG_LEAP : 0)) < 0) {
+                    diminuto_perror("obelisk_multicast_send");
+                }
+            }
+
             /*
              * Generate a synthesized NMEA RMC timestamp. Since we
              * do this as the rise of the T pulse, we generate a
              * timestamp every second, phaselocked - subject to measured
-             * latency in the debouncer - to WWVB.
+             * latency in the debouncer and in writing the output - to
+             * WWVB.
              */
 
             if (!nmea) {
                 /* Do nothing. */
             } else if (!acquired) {
                 /* Do nothing. */
+            } else if (scheduling && (llabs(edge_epoch - edge_scheduled) < (OBELISK_PLL_SECOND / 2))) {
+                /* Do nothing. */
             } else {
-                timep = gmtime_r(&epoch.tv_sec, &time);
-                assert(timep == &time);
-                rc = snprintf(
-                    sentence, sizeof(sentence) - 1,
-                    "%c%2.2s%3.3s,%02d%02d%02d.%02ld,A,,,,,,,%02d%02d%02d,,,D%cXX\r\n",
-                    HAZER_STIMULUS_START,
-                    nmea_talker,
-                    HAZER_NMEA_SENTENCE_RMC,
-                    time.tm_hour,
-                    time.tm_min,
-                    time.tm_sec,
-                    epoch.tv_usec / (1000000 / 100), /* Round down. */
-                    time.tm_mday,
-                    time.tm_mon + 1,
-                    (time.tm_year + 1900) % 100,
-                    HAZER_STIMULUS_CHECKSUM
-                );
-                assert(rc < (sizeof(sentence) - 1));
-                sentence[sizeof(sentence) - 1] = '\0';
-                assert(sentence[rc - 4] == 'X');
-                assert(sentence[rc - 3] == 'X');
-                hazer_checksum_buffer(sentence, sizeof(sentence), &sentence[rc - 4], &sentence[rc - 3]);
-                assert(rc >= 0);
-                if (debug) {
-                    fprintf(stderr, "%s: NMEA \"", program);
-                    emit(stderr, sentence);
-                    fputs("\".\n", stderr);
-                }
-                if (nmea_out_fp != (FILE *)0) {
-                    fputs(sentence, nmea_out_fp);
-                    fflush(nmea_out_fp);
-                } else if (nmea_out_sock6 >= 0) {
-                    rc = diminuto_ipc6_datagram_send(nmea_out_sock6, sentence, strlen(sentence), nmea_out_endpoint.ipv6, nmea_out_endpoint.udp);
-                    assert(rc >= 0);
-                } else if (nmea_out_sock4 >= 0) {
-                    rc = diminuto_ipc4_datagram_send(nmea_out_sock4, sentence, strlen(sentence), nmea_out_endpoint.ipv4, nmea_out_endpoint.udp);
-                    assert(rc >= 0);
-                } else {
-                    /* Do nothing. */
-                }
+                advance(&emitter, sentences, precomputed, epoch.tv_sec, 'D');
+                delay_output = smooth(delay_output, report(&fanout, &emitter, edge_epoch, delay_output));
             }
 
             /*
@@ -942,6 +2013,7 @@ int main(int argc, char ** argv)
             if (pps) {
                 rc = diminuto_pin_clear(pin_out_pps_fp);
                 assert(rc >= 0);
+                raised = 0;
             }
 
             /*
@@ -992,10 +2064,22 @@ int main(int argc, char ** argv)
          * acquired:        true if we have received a complete valid frame.
          * armed:           true if we have constructed a valid time stamp.
          * disciplined:     true if we have set the system clock.
+         * holding:         true if we are in holdover.
          */
 
         if (diminuto_hangup_check()) {
-            DIMINUTO_LOG_NOTICE("%s: hungup initialized=%d synchronized=%d acquired=%d disciplined=%d armed=%d risings=%d fallings=%d cycles=%d.\n", program, initialized, synchronized, acquired, disciplined, armed, risings, fallings, cycles);
+            DIMINUTO_LOG_NOTICE("%s: hungup initialized=%d synchronized=%d acquired=%d disciplined=%d armed=%d holding=%d risings=%d fallings=%d cycles=%d output=%lldns pps=%lldns residual=%lldns.\n", program, initialized, synchronized, acquired, disciplined, armed, holding, risings, fallings, cycles, (long long int)delay_output, (long long int)delay_pps, (long long int)residual);
+            for (sink = 0; sink < fanout.count; ++sink) {
+                obelisk_fanout_statistics(&fanout, sink, &statistics);
+                DIMINUTO_LOG_NOTICE("%s: sink %d queued=%llu written=%llu dropped=%llu failed=%llu.\n", program, sink, (unsigned long long)statistics.queued, (unsigned long long)statistics.written, (unsigned long long)statistics.dropped, (unsigned long long)statistics.failed);
+            }
+            if (ntp_port >= 0) {
+                obelisk_ntp_statistics(&ntp, &ntp_statistics);
+                DIMINUTO_LOG_NOTICE("%s: ntp received=%llu answered=%llu ignored=%llu failed=%llu.\n", program, (unsigned long long)ntp_statistics.received, (unsigned long long)ntp_statistics.answered, (unsigned long long)ntp_statistics.ignored, (unsigned long long)ntp_statistics.failed);
+            }
+            if (scheduling) {
+                DIMINUTO_LOG_NOTICE("%s: schedule landed=%lld mean=%.0fns rms=%.0fns minimum=%lldns maximum=%lldns compensation=%lldns.\n", program, (long long int)schedule.count, obelisk_schedule_mean(&schedule), obelisk_schedule_rms(&schedule), (long long int)schedule.minimum, (long long int)schedule.maximum, (long long int)schedule.compensation);
+            }
             disciplined = 0;
         }
 
@@ -1013,13 +2097,61 @@ int main(int argc, char ** argv)
 
         token = obelisk_tokenize(milliseconds_pulse);
 
+        pulses = (pulses << 1) | (token != OBELISK_TOKEN_INVALID);
+
         /*
         ** Parse grammar by transitioning state based on token.
         */
 
         state_old = state;
 
-        event = obelisk_parse(&state, token, &field, &length, &buffer, &frame);
+        if (!trellis) {
+            event = obelisk_parse(&state, token, &field, &length, &buffer, &frame);
+        } else {
+            obelisk_likelihood(cost, milliseconds_pulse);
+            event = obelisk_viterbi(&viterbi, cost, &state, &field, &length, &buffer, &frame);
+            LOG("VITERBI %d %d %d %d :%02d %d.", cost[OBELISK_TOKEN_ZERO], cost[OBELISK_TOKEN_ONE], cost[OBELISK_TOKEN_MARKER], viterbi.locked, viterbi.second, viterbi.confidence);
+        }
+
+        /*
+         * If so instructed, use the system clock, which was presumably set
+         * from the real-time clock at boot, as a prior. Each pulse is
+         * scored against the frames expected for the surrounding minutes
+         * at every second offset near the prior, and as soon as one offset
+         * is unambiguously best the parser carries on from that point in
+         * the frame instead of waiting for the :59 and :00 MARKERs.
+         */
+
+        if (!acquiring) {
+            /* Do nothing. */
+        } else {
+
+            if (acquisition.tokens == 0) {
+                ticks_now = diminuto_time_clock();
+                assert(ticks_now >= 0);
+                prior = ticks_now / ticks_frequency;
+                obelisk_acquire_init(&acquisition, prior);
+                LOG("ACQUIRE %lds.", (long)prior);
+            }
+
+            rc = obelisk_acquire(&acquisition, token, &candidate, &state, &field, &length, &buffer);
+            LOG("ACQUIRE %d %d %d.", acquisition.best - OBELISK_ACQUIRE_SECONDS, acquisition.mismatches[acquisition.best], acquisition.margin);
+
+            if (rc == 0) {
+                /* Do nothing. */
+            } else if (rc < 0) {
+                acquiring = 0;
+                DIMINUTO_LOG_NOTICE("%s: abandoned prior=%lds.\n", program, (long)prior);
+            } else {
+                acquiring = 0;
+                event = OBELISK_EVENT_NOMINAL;
+                epoch.tv_sec = candidate;
+                epoch.tv_usec = 0;
+                acquired = !0;
+                DIMINUTO_LOG_NOTICE("%s: acquired prior epoch=%lds offset=%ds.\n", program, epoch.tv_sec, acquisition.best - OBELISK_ACQUIRE_SECONDS);
+            }
+
+        }
 
         assert((0 <= state_old) && (state_old < countof(STATE)));
         assert((0 <= state) && (state < countof(STATE)));
@@ -1028,6 +2160,152 @@ int main(int argc, char ** argv)
 
         LOG("PARSE %s %s %s %s %d %d 0x%llx.", STATE[state_old], TOKEN[token], STATE[state], EVENT[event], field, length, (long long unsigned int)buffer);
 
+        /*
+         * Keep track of the minute at whose beginning each frame starts, so
+         * that frames received minutes apart can be lined up to be voted
+         * upon or predicted. The state machine clears the buffer at the :00
+         * MARKER by entering either of these states.
+         */
+
+        if ((margin <= 0) && !follow) {
+            /* Do nothing. */
+        } else if (state == state_old) {
+            /* Do nothing. */
+        } else if ((state == OBELISK_STATE_SYNC) || (state == OBELISK_STATE_LEAP)) {
+            ticks_minute = diminuto_time_elapsed();
+            assert(ticks_minute >= 0);
+            if (ticks_origin < 0) {
+                ticks_origin = ticks_minute;
+            }
+            minutes_elapsed = (ticks_minute - ticks_origin + (ticks_frequency * 30)) / (ticks_frequency * 60);
+        } else {
+            /* Do nothing. */
+        }
+
+        /*
+        ** Publish partial results as each group of fields completes.
+        */
+
+        group = obelisk_partial(&partial, state, field, length, buffer);
+
+        if (group != OBELISK_GROUP_NONE) {
+            LOG("PARTIAL :%02d 0x%x 0x%x %02d/%03dT%02d:%02d.", partial.second, partial.complete, partial.confident, partial.year, partial.day, partial.hours, partial.minutes);
+        }
+
+        /*
+         * If so instructed, use the system clock, which was presumably set
+         * from the real-time clock at boot, as a prior. If the minutes,
+         * hours, and day received so far agree with it, we consider the
+         * signal acquired at :34 instead of waiting for the end of the
+         * frame. If the year that follows at :54 disagrees with it, we
+         * change our mind. A complete frame replaces the confirmed time.
+         */
+
+        if (!early) {
+            /* Do nothing. */
+        } else if (group == OBELISK_GROUP_NONE) {
+            /* Do nothing. */
+        } else if ((partial.confident & (OBELISK_GROUP_MINUTES | OBELISK_GROUP_HOURS | OBELISK_GROUP_DAY)) != (OBELISK_GROUP_MINUTES | OBELISK_GROUP_HOURS | OBELISK_GROUP_DAY)) {
+            /* Do nothing. */
+        } else {
+
+            ticks_now = diminuto_time_clock();
+            assert(ticks_now >= 0);
+            prior = ticks_now / ticks_frequency;
+
+            rc = diminuto_time_zulu(ticks_now, &year, (int *)0, (int *)0, (int *)0, (int *)0, (int *)0, (diminuto_ticks_t *)0);
+            assert(rc >= 0);
+
+            memset(&time, 0, sizeof(time));
+            if ((partial.confident & OBELISK_GROUP_YEAR) != 0) {
+                time.tm_year = partial.year + ((partial.year < 17) ? 200 : 100);
+            } else {
+                time.tm_year = year - 1900;
+            }
+            time.tm_mon = 0;
+            time.tm_mday = partial.day; /* Normalized by timegm(3). */
+            time.tm_hour = partial.hours;
+            time.tm_min = partial.minutes;
+            time.tm_sec = partial.second;
+
+            candidate = timegm(&time);
+
+            LOG("PRIOR %lds %lds.", (long)prior, (long)candidate);
+
+            if (((candidate - prior) > PRIOR_SECONDS) || ((prior - candidate) > PRIOR_SECONDS)) {
+                if (confirmed && acquired) {
+                    acquired = 0;
+                    DIMINUTO_LOG_NOTICE("%s: lost prior=%lds candidate=%lds.\n", program, (long)prior, (long)candidate);
+                }
+                confirmed = 0;
+            } else if (acquired) {
+                /* Do nothing. */
+            } else if (group != OBELISK_GROUP_DAY) {
+                /* Do nothing. */
+            } else {
+                epoch.tv_sec = candidate;
+                epoch.tv_usec = 0;
+                acquired = !0;
+                confirmed = !0;
+                DIMINUTO_LOG_NOTICE("%s: acquired early epoch=%lds.\n", program, epoch.tv_sec);
+            }
+
+        }
+
+        /*
+         * Once we've had a valid frame, every bit of the frames that follow
+         * it can be predicted. If so instructed, compare each bit against
+         * the prediction as it arrives. Bits that agree through the hours
+         * confirm lock at :19 instead of at the end of the frame, and bits
+         * that disagree reveal errors just as early.
+         */
+
+        if (!follow) {
+            /* Do nothing. */
+        } else if (reference_minute < 0) {
+            /* Do nothing. */
+        } else if ((minutes_elapsed <= reference_minute) || ((minutes_elapsed - reference_minute) > PREDICT_MINUTES)) {
+            /* Do nothing. */
+        } else if (partial.second <= 0) {
+            /* Do nothing. */
+        } else {
+
+            if (expected_minute != minutes_elapsed) {
+                expected = reference;
+                for (minutes_predicted = reference_minute; minutes_predicted < minutes_elapsed; ++minutes_predicted) {
+                    expected = obelisk_predict(expected);
+                }
+                expected_minute = minutes_elapsed;
+                mismatches_old = 0;
+                LOG("PREDICT %d 0x%016llx.", expected_minute, (long long unsigned int)expected);
+            }
+
+            mismatches = obelisk_mismatch(expected, buffer, partial.second);
+            if (mismatches != mismatches_old) {
+                LOG("MISMATCH :%02d %d.", partial.second, mismatches);
+                mismatches_old = mismatches;
+            }
+
+            if (mismatches > MISMATCH_MAXIMUM) {
+                if (acquired) {
+                    acquired = 0;
+                    DIMINUTO_LOG_NOTICE("%s: lost second=:%02d mismatches=%d.\n", program, partial.second, mismatches);
+                }
+            } else if (acquired) {
+                /* Do nothing. */
+            } else if (mismatches > 0) {
+                /* Do nothing. */
+            } else if (partial.second < PREDICT_SECOND) {
+                /* Do nothing. */
+            } else {
+                epoch.tv_sec = reference_epoch + ((minutes_elapsed - reference_minute) * 60) + (partial.second - 59);
+                epoch.tv_usec = 0;
+                acquired = !0;
+                DIMINUTO_LOG_NOTICE("%s: acquired predicted epoch=%lds.\n", program, epoch.tv_sec);
+            }
+
+        }
+
         switch (event) {
 
         case OBELISK_EVENT_WAITING:
@@ -1058,6 +2336,19 @@ int main(int argc, char ** argv)
                 DIMINUTO_LOG_NOTICE("%s: lost state=%s token=%s state=%s.\n", program, STATE[state_old], TOKEN[token], STATE[state]);
             }
 
+            /*
+             * Whatever part of the frame was received before the error may
+             * still be worth a vote.
+             */
+
+            if (margin > 0) {
+                obelisk_partial(&partial, state_old, field, length, buffer);
+                if (partial.second > 0) {
+                    obelisk_accumulator_add(&accumulator, minutes_elapsed, buffer, partial.second);
+                    LOG("ACCUMULATE %d :%02d 0x%llx.", minutes_elapsed, partial.second, (long long unsigned int)buffer);
+                }
+            }
+
             armed = 0;
 
             break;
@@ -1071,6 +2362,8 @@ int main(int argc, char ** argv)
 
             if (!(set_initially || set_daily || set_leap)) {
                 /* Do nothing. */
+            } else if (slewing) {
+                /* Do nothing. */
             } else if (!armed) {
                 /* Do nothing. */
             } else if (disciplined) {
@@ -1115,6 +2408,7 @@ int main(int argc, char ** argv)
         case OBELISK_EVENT_FRAME:
 
             armed = 0;
+            confirmed = 0;
 
             /*
              * Once we have a complete frame, extract it from the buffer.
@@ -1144,6 +2438,51 @@ int main(int argc, char ** argv)
                 if (rc >= 0) {
                     rc = obelisk_revalidate(&time);
                 }
+            } else {
+                LOG("VERIFY 0x%03x.", obelisk_verify(buffer));
+            }
+
+            /*
+             * At a fringe site a frame may rarely be received intact. If
+             * so instructed, every frame goes into the accumulator, and
+             * when one is corrupt, we try a vote across it and the frames
+             * from recent minutes instead.
+             */
+
+            voted = buffer;
+
+            if (margin <= 0) {
+                /* Do nothing. */
+            } else {
+                obelisk_accumulator_add(&accumulator, minutes_elapsed, buffer, 59);
+                if (rc >= 0) {
+                    /* Do nothing. */
+                } else if ((rc = obelisk_accumulator_vote(&accumulator, margin, &voted, &frame)) < 0) {
+                    LOG("VOTE %d %d.", minutes_elapsed, rc);
+                } else {
+                    LOG("VOTED %d 0x%016llx.", minutes_elapsed, (long long unsigned int)voted);
+                    rc = obelisk_validate(&frame);
+                    if (rc >= 0) {
+                        rc = obelisk_decode(&time, &frame);
+                        if (rc >= 0) {
+                            rc = obelisk_revalidate(&time);
+                        }
+                    }
+                }
+            }
+
+            /*
+             * The validity checks pass hours up to 29, which the Epoch
+             * computation rejects; such a frame is just as corrupt.
+             */
+
+            if (rc < 0) {
+                /* Do nothing. */
+            } else if (obelisk_epoch(voted) < 0) {
+                LOG("EPOCH 0x%016llx.", (long long unsigned int)voted);
+                rc = -1;
+            } else {
+                /* Do nothing. */
             }
 
             if (rc < 0) {
@@ -1193,10 +2532,11 @@ int main(int argc, char ** argv)
 
                 /*
                  * Derive the seconds since the POSIX Epoch that our time
-                 * code represents.
+                 * code represents directly from the buffer; the struct tm
+                 * is just for display.
                  */
 
-                epoch.tv_sec = timegm(&time);
+                epoch.tv_sec = obelisk_epoch(voted) + 59;
 
                 LOG("EPOCH %lds.", epoch.tv_sec);
 
@@ -1205,6 +2545,50 @@ int main(int argc, char ** argv)
                     DIMINUTO_LOG_NOTICE("%s: acquired.\n", program);
                 }
 
+                /*
+                 * This frame is the basis for predicting those that follow.
+                 */
+
+                reference = voted;
+                reference_minute = minutes_elapsed;
+                reference_epoch = epoch.tv_sec;
+
+                /*
+                 * It is also the basis for the NMEA sentences for the
+                 * minute that follows, which are computed now instead of
+                 * in the moment before each of them is written. The
+                 * signal quality is how many of the last sixty pulses
+                 * were valid.
+                 */
+
+                obelisk_nmea_status(&emitter, (frame.dut1sign == OBELISK_SIGN_NEGATIVE) ? -(int)frame.dut1magnitude : (int)frame.dut1magnitude, frame.lsw, frame.dst, __builtin_popcountll(pulses & ((1ULL << 60) - 1)));
+                obelisk_nmea_time(&emitter, epoch.tv_sec);
+                obelisk_message_status(&message, (frame.dut1sign == OBELISK_SIGN_NEGATIVE) ? -(int)frame.dut1magnitude : (int)frame.dut1magnitude, frame.lsw, frame.dst);
+                page_data.frame = voted;
+                page_data.leap = frame.lsw;
+                page_data.dst = frame.dst;
+                page_data.dut1 = (frame.dut1sign == OBELISK_SIGN_NEGATIVE) ? -(int)frame.dut1magnitude : (int)frame.dut1magnitude;
+                obelisk_nmea_precompute(&emitter, sentences, countof(sentences));
+                precomputed = countof(sentences);
+
+                /*
+                 * The clock discipline can trust this time. If a leap
+                 * second is to be inserted at the end of today, the
+                 * time outputs warn of it, and the kernel is told so it
+                 * can insert it at midnight.
+                 */
+
+                trusted = !0;
+
+                later = epoch.tv_sec + (24 * 60 * 60);
+                timep = gmtime_r(&later, &tomorrow);
+                assert(timep == &tomorrow);
+                leaping = frame.lsw && (tomorrow.tm_mday == 1);
+
+                if (slewing) {
+                    discipline.leap = leaping;
+                }
+
                 /*
                  * Logging the received one per hour doesn't overrun
                  * the logging system. And doing so at the 59th minute
@@ -1280,6 +2664,13 @@ int main(int argc, char ** argv)
 
             DIMINUTO_LOG_NOTICE("%s: leap lsw=%d.", program, frame.lsw);
 
+            /*
+             * Our epoch is a second ahead of the kernel, which inserted its
+             * own leap second, until the next frame corrects it.
+             */
+
+            trusted = 0;
+
             if (!set_leap) {
                 /* Do nothing. */
             } else if (!disciplined) {
@@ -1337,21 +2728,85 @@ int main(int argc, char ** argv)
         assert(pin_out_pps_fp == (FILE *)0);
     }
 
-    if (nmea_out_fp != (FILE *)0) {
-        rc = fclose(nmea_out_fp);
-        if (rc != 0) { diminuto_perror(nmea_path); }
-        assert(rc == 0);
+    if (nmea) {
+        rc = obelisk_fanout_stop(&fanout);
+        assert(rc >= 0);
+        for (sink = 0; sink < fanout.count; ++sink) {
+            obelisk_fanout_statistics(&fanout, sink, &statistics);
+            DIMINUTO_LOG_NOTICE("%s: sink %d queued=%llu written=%llu dropped=%llu failed=%llu.\n", program, sink, (unsigned long long)statistics.queued, (unsigned long long)statistics.written, (unsigned long long)statistics.dropped, (unsigned long long)statistics.failed);
+        }
+        obelisk_fanout_fini(&fanout);
+        for (sink = 0; sink < nmea_paths; ++sink) {
+            if (nmea_out_fp[sink] != (FILE *)0) {
+                rc = fclose(nmea_out_fp[sink]);
+                if (rc != 0) { diminuto_perror(nmea_path[sink]); }
+                assert(rc == 0);
+            }
+        }
+        for (sink = 0; sink < nmea_endpoints; ++sink) {
+            if (nmea_out_sock[sink] < 0) {
+                /* Do nothing. */
+            } else if (!diminuto_ipc6_is_unspecified(&nmea_out_endpoint[sink].ipv6)) {
+                rc = diminuto_ipc6_close(nmea_out_sock[sink]);
+                if (rc < 0) { diminuto_perror(nmea_endpoint[sink]); }
+                assert(rc >= 0);
+            } else {
+                rc = diminuto_ipc4_close(nmea_out_sock[sink]);
+                if (rc < 0) { diminuto_perror(nmea_endpoint[sink]); }
+                assert(rc >= 0);
+            }
+        }
+    }
+
+    if (page != (obelisk_page_t *)0) {
+        rc = obelisk_page_destroy(page, page_name);
+        if (rc < 0) { diminuto_perror(page_name); }
+        assert(rc >= 0);
+    }
+
+    if (ntp_port >= 0) {
+        rc = obelisk_ntp_stop(&ntp);
+        assert(rc >= 0);
+        obelisk_ntp_statistics(&ntp, &ntp_statistics);
+        DIMINUTO_LOG_NOTICE("%s: ntp received=%llu answered=%llu ignored=%llu failed=%llu.\n", program, (unsigned long long)ntp_statistics.received, (unsigned long long)ntp_statistics.answered, (unsigned long long)ntp_statistics.ignored, (unsigned long long)ntp_statistics.failed);
+        obelisk_ntp_fini(&ntp);
+    }
+
+    if (multicast_endpoints > 0) {
+        obelisk_multicast_fini(&multicast);
+    }
+
+    if (message_sock < 0) {
+        /* Do nothing. */
+    } else if (message_endpointp == (diminuto_ipc_endpoint_t *)0) {
+        rc = obelisk_message_close(message_sock);
+        if (rc < 0) { diminuto_perror(message_destination); }
+        assert(rc >= 0);
+    } else if (!diminuto_ipc6_is_unspecified(&message_endpoint.ipv6)) {
+        rc = diminuto_ipc6_close(message_sock);
+        if (rc < 0) { diminuto_perror(message_destination); }
+        assert(rc >= 0);
+    } else {
+        rc = diminuto_ipc4_close(message_sock);
+        if (rc < 0) { diminuto_perror(message_destination); }
+        assert(rc >= 0);
+    }
+
+    if (sock >= 0) {
+        rc = obelisk_sock_close(sock);
+        if (rc < 0) { diminuto_perror(sock_path); }
+        assert(rc >= 0);
     }
 
-    if (nmea_out_sock6 >= 0) {
-        rc = diminuto_ipc6_close(nmea_out_sock6);
-        if (rc < 0) { diminuto_perror(nmea_endpoint); }
+    if (shm_serial != (obelisk_shm_t *)0) {
+        rc = obelisk_shm_detach(shm_serial);
+        if (rc < 0) { diminuto_perror("obelisk_shm_detach"); }
         assert(rc >= 0);
     }
 
-    if (nmea_out_sock4 >= 0) {
-        rc = diminuto_ipc4_close(nmea_out_sock4);
-        if (rc < 0) { diminuto_perror(nmea_endpoint); }
+    if (shm_pps != (obelisk_shm_t *)0) {
+        rc = obelisk_shm_detach(shm_pps);
+        if (rc < 0) { diminuto_perror("obelisk_shm_detach"); }
         assert(rc >= 0);
     }
 
@@ -177,6 +177,36 @@ extern obelisk_event_t obelisk_parse(obelisk_state_t * statep, obelisk_token_t t
  */
 extern int obelisk_validate(const obelisk_frame_t * framep);
 
+/**
+ * These are the bits returned by obelisk_verify(), one for each field
+ * that obelisk_validate() checks, in the order in which it checks them.
+ * The two bit DST field can't be out of range so has no bit.
+ */
+typedef enum ObeliskFailure {
+    OBELISK_FAILURE_NONE            = 0,
+    OBELISK_FAILURE_MINUTES10       = (1 << 0),
+    OBELISK_FAILURE_MINUTES1        = (1 << 1),
+    OBELISK_FAILURE_HOURS10         = (1 << 2),
+    OBELISK_FAILURE_HOURS1          = (1 << 3),
+    OBELISK_FAILURE_DAY100          = (1 << 4),
+    OBELISK_FAILURE_DAY10           = (1 << 5),
+    OBELISK_FAILURE_DAY1            = (1 << 6),
+    OBELISK_FAILURE_DUTONESIGN      = (1 << 7),
+    OBELISK_FAILURE_DUTONE1         = (1 << 8),
+    OBELISK_FAILURE_YEAR10          = (1 << 9),
+    OBELISK_FAILURE_YEAR1           = (1 << 10),
+} obelisk_failure_t;
+
+/**
+ * Validate every field of a buffer at once without extracting it into a
+ * frame and without branching. Unlike obelisk_validate(), which stops at
+ * the first field out of range, this reports all of them, which is useful
+ * for signal quality statistics as well as for validating in bulk.
+ * @param buffer is the input buffer.
+ * @return a mask of obelisk_failure_t bits, zero if the buffer is valid.
+ */
+extern int obelisk_verify(obelisk_buffer_t buffer);
+
 /**
  * Convert the frame binary coded decimal fields into binary data in POSIX
  * struct tm form.
@@ -193,4 +223,329 @@ extern int obelisk_decode(struct tm * timep, const obelisk_frame_t * framep);
  */
 extern int obelisk_revalidate(const struct tm * timep);
 
+/**
+ * Convert a buffer directly into the number of seconds since the POSIX
+ * epoch at the start of the minute it encodes, without the intermediate
+ * frame or struct tm, and without timegm(3). Two digit years are placed
+ * in the same century as obelisk_decode() places them. The buffer should
+ * have been validated with obelisk_verify(), but the ranges of the year,
+ * day of the year, hour, and minute are checked anyway.
+ * @param buffer is the input buffer.
+ * @return the seconds since the epoch, or -1 if out of range.
+ */
+extern time_t obelisk_epoch(obelisk_buffer_t buffer);
+
+/**
+ * Convert a buffer directly into a timespec at the start of the minute it
+ * encodes, along with whether a leap second is inserted at the end of
+ * that minute and the DST status.
+ * @param timep points to the output timespec.
+ * @param leapp points to where true is stored if the leap second warning
+ * is set and this is the last minute of the month, or is null.
+ * @param dstp points to where the DST status is stored, or is null.
+ * @param buffer is the input buffer.
+ * @return >=0 for success, <0 if out of range.
+ */
+extern int obelisk_timespec(struct timespec * timep, int * leapp, obelisk_dst_t * dstp, obelisk_buffer_t buffer);
+
+/**
+ * Compose a buffer from its individual fields. The fields are inserted as
+ * given and are not checked against one another, so this can also build
+ * frames that obelisk_epoch() rejects.
+ * @param year is the two digit year [0..99].
+ * @param day is the Julian day of the year [1..366].
+ * @param hour is the hour of the day [0..23].
+ * @param minute is the minute of the hour [0..59].
+ * @param dut1 is UT1 - UTC in tenths of a second [-9..+9].
+ * @param lyi is true for a leap year.
+ * @param lsw is true if a leap second is inserted at the end of the month.
+ * @param dst is the DST status.
+ * @return the buffer.
+ */
+extern obelisk_buffer_t obelisk_compose(int year, int day, int hour, int minute, int dut1, int lyi, int lsw, obelisk_dst_t dst);
+
+/**
+ * Encode the buffer that WWVB transmits during the minute containing the
+ * specified time. This is the inverse of obelisk_epoch() plus the fields
+ * that can't be derived from the time alone. Like the time code itself it
+ * only has a two digit year.
+ * @param epoch is the time in seconds since the POSIX epoch.
+ * @param dut1 is UT1 - UTC in tenths of a second [-9..+9].
+ * @param lyi is true for a leap year, or <0 to derive it from the year.
+ * @param lsw is true if a leap second is inserted at the end of the month.
+ * @param dst is the DST status.
+ * @return the buffer.
+ */
+extern obelisk_buffer_t obelisk_encode(time_t epoch, int dut1, int lyi, int lsw, obelisk_dst_t dst);
+
+/**
+ * These are the groups of fields in the IRIQ timecode frame that can be
+ * published as partial results before the entire frame has arrived. Each
+ * group is complete at the second noted in its comment.
+ */
+typedef enum ObeliskGroup {
+    OBELISK_GROUP_NONE      = 0x0,
+    OBELISK_GROUP_MINUTES   = 0x1,  /* :09 */
+    OBELISK_GROUP_HOURS     = 0x2,  /* :19 */
+    OBELISK_GROUP_DAY       = 0x4,  /* :34 */
+    OBELISK_GROUP_YEAR      = 0x8,  /* :54 */
+    OBELISK_GROUP_ALL       = 0xf,
+} obelisk_group_t;
+
+/**
+ * This structure describes the partial results available from a frame
+ * that is still being received. A group is complete if all of its bits
+ * have arrived, and confident if in addition its binary coded digits are
+ * in range and its unused bits are zero. The values of a group that is not
+ * complete are undefined.
+ */
+typedef struct ObeliskPartial {
+    int second;                 /* Second of the most recent bit or -1. */
+    int minutes;                /* [0..59] */
+    int hours;                  /* [0..23] */
+    int day;                    /* Day of the year [1..366]. */
+    int year;                   /* Year of the century [0..99]. */
+    obelisk_group_t complete;   /* Groups that have been received. */
+    obelisk_group_t confident;  /* Groups that have passed validation. */
+} obelisk_partial_t;
+
+/**
+ * Compute the partial results available from the frame that the finite state
+ * machine is parsing. This is intended to be called after every call to
+ * obelisk_parse() with the same intermediate state. A partial result whose
+ * groups agree with a prior, like the system clock set from a real-time
+ * clock, may let the caller confirm the time well before the end of the
+ * frame.
+ * @param partialp points to the structure into which the results are stored.
+ * @param state is the state of the finite state machine.
+ * @param field is the number of the field being processed.
+ * @param length is the unconsumed number of bits in the field.
+ * @param buffer is the buffer into which the frame is being stored.
+ * @return the group completed by the most recent bit or OBELISK_GROUP_NONE.
+ */
+extern obelisk_group_t obelisk_partial(obelisk_partial_t * partialp, obelisk_state_t state, int field, int length, obelisk_buffer_t buffer);
+
+/**
+ * Advance the time in a buffer by a number of minutes, carrying into the
+ * hours, the day of the year, and the year of the century, and recomputing
+ * the leap year indicator whenever the year changes. The other fields are
+ * unchanged. Fields that are out of range are carried as best we can but
+ * the result is not meaningful.
+ * @param buffer is the input buffer.
+ * @param minutes is the non-negative number of minutes.
+ * @return the advanced buffer.
+ */
+extern obelisk_buffer_t obelisk_advance(obelisk_buffer_t buffer, int minutes);
+
+/**
+ * This is the most frames that the accumulator will vote upon. It is small
+ * enough that the per-bit tallies fit in three bit planes.
+ */
+enum ObeliskAccumulatorConstants {
+    OBELISK_ACCUMULATOR_FRAMES = 7,
+};
+
+/**
+ * This structure describes an accumulator of consecutive, possibly partial
+ * and noisy, frames from which a single frame can be derived by voting on
+ * each bit. The caller does not need to know its contents.
+ */
+typedef struct ObeliskAccumulator {
+    obelisk_buffer_t value[OBELISK_ACCUMULATOR_FRAMES];     /* Bits received. */
+    obelisk_buffer_t known[OBELISK_ACCUMULATOR_FRAMES];     /* Bits valid. */
+    int minute[OBELISK_ACCUMULATOR_FRAMES];                 /* Frame minute. */
+    int count;                                              /* Frames held. */
+    int next;                                               /* Next slot. */
+} obelisk_accumulator_t;
+
+/**
+ * Initialize an accumulator so that it holds no frames.
+ * @param accumulatorp points to the accumulator.
+ */
+extern void obelisk_accumulator_init(obelisk_accumulator_t * accumulatorp);
+
+/**
+ * Add a complete or partial frame to an accumulator, replacing the oldest
+ * frame if the accumulator is full. The minute is any monotonically
+ * increasing count of minutes maintained by the caller, for example minutes
+ * elapsed since the application started, and identifies the minute at
+ * whose beginning the frame started.
+ * @param accumulatorp points to the accumulator.
+ * @param minute is the minute of the frame.
+ * @param buffer is the buffer as filled in by obelisk_parse().
+ * @param second is the second of the most recent bit in the buffer, which
+ * is 59 for a complete frame.
+ */
+extern void obelisk_accumulator_add(obelisk_accumulator_t * accumulatorp, int minute, obelisk_buffer_t buffer, int second);
+
+/**
+ * Vote on each bit of the frames in an accumulator after advancing each
+ * frame to the minute of the most recent one. A bit is decided if the
+ * votes for one value exceed the votes for the other by at least the margin.
+ * If every bit is decided, the resulting buffer and frame are stored.
+ * @param accumulatorp points to the accumulator.
+ * @param margin is the minimum winning margin [1..OBELISK_ACCUMULATOR_FRAMES].
+ * @param bufferp points to the output buffer.
+ * @param framep points to the output frame.
+ * @return >= 0 if every bit was decided, or the negative of the number of
+ * undecided bits otherwise.
+ */
+extern int obelisk_accumulator_vote(const obelisk_accumulator_t * accumulatorp, int margin, obelisk_buffer_t * bufferp, obelisk_frame_t * framep);
+
+/**
+ * Predict the buffer of the frame that follows a valid frame. The time is
+ * advanced by one minute. When the UTC day changes, the DST field becomes
+ * whatever the old day ended with, and when the month changes, the leap
+ * second warning is cleared. The other fields, including dUT1, are
+ * predicted not to change.
+ * @param buffer is the buffer of a valid frame.
+ * @return the predicted buffer.
+ */
+extern obelisk_buffer_t obelisk_predict(obelisk_buffer_t buffer);
+
+/**
+ * Count the bits received so far that do not match a predicted buffer. The
+ * buffer may be partial, as it is while obelisk_parse() fills it in, so
+ * this can be called at every second to keep a running count.
+ * @param expected is the predicted buffer.
+ * @param buffer is the buffer as filled in by obelisk_parse().
+ * @param second is the second of the most recent bit in the buffer, which
+ * is 59 for a complete frame.
+ * @return the number of mismatched bits.
+ */
+extern int obelisk_mismatch(obelisk_buffer_t expected, obelisk_buffer_t buffer, int second);
+
+/**
+ * These are the parameters of the maximum likelihood frame synchronizer.
+ * Costs are negative log likelihoods in arbitrary fixed point units, so
+ * smaller is more likely.
+ */
+enum ObeliskViterbiConstants {
+    OBELISK_VITERBI_STATES      = 61,   /* :00 through :59 plus leap :60. */
+    OBELISK_VITERBI_TOKENS      = 3,    /* ZERO, ONE, and MARKER. */
+    OBELISK_VITERBI_COST        = 64,   /* Maximum cost of one token. */
+    OBELISK_VITERBI_LEAP        = 32,   /* Cost of a leap second. */
+    OBELISK_VITERBI_METRIC      = 4096, /* Maximum path metric. */
+    OBELISK_VITERBI_CONFIDENCE  = 256,  /* Minimum margin over runner up. */
+};
+
+/**
+ * Compute the cost of classifying a pulse as each possible token, based
+ * on its distance from the nominal duration of that token. Unlike
+ * obelisk_tokenize(), nothing is discarded: an ambiguous pulse has
+ * similar costs for two tokens, and a missing or mangled pulse has the
+ * same maximum cost for all of them.
+ * @param cost points to an array of costs indexed by token.
+ * @param milliseconds_pulse is the length of the pulse in milliseconds.
+ */
+extern void obelisk_likelihood(int cost[OBELISK_VITERBI_TOKENS], int milliseconds_pulse);
+
+/**
+ * This structure describes the trellis of the maximum likelihood frame
+ * synchronizer. Each state is the hypothesis that the most recent pulse
+ * was received at a particular second of the minute. The caller does not
+ * need to know its contents except for the most likely second and the
+ * margin by which it is more likely than any other alignment.
+ */
+typedef struct ObeliskViterbi {
+    int metric[OBELISK_VITERBI_STATES];                 /* Path metrics. */
+    obelisk_buffer_t survivor[OBELISK_VITERBI_STATES];  /* Path buffers. */
+    int leap;                                           /* :00 after :60. */
+    int second;                                         /* Most likely. */
+    int confidence;                                     /* Runner up - best. */
+    int locked;                                         /* Synchronized. */
+} obelisk_viterbi_t;
+
+/**
+ * Initialize the synchronizer so that every alignment is equally likely.
+ * @param viterbip points to the synchronizer.
+ */
+extern void obelisk_viterbi_init(obelisk_viterbi_t * viterbip);
+
+/**
+ * Advance the synchronizer by one pulse using the Viterbi algorithm. The
+ * frame structure, the MARKERs at :00, :09, :19, :29, :39, :49 and :59,
+ * the unused bits that are always ZERO, and the possibility of a leap
+ * second MARKER at :60, constrains the path through the trellis. Once
+ * the most likely alignment exceeds any other by the confidence margin,
+ * the results are returned exactly as obelisk_parse() would, including
+ * its events, so the caller can use either one.
+ * @param viterbip points to the synchronizer.
+ * @param cost points to the costs of the pulse from obelisk_likelihood().
+ * @param statep points to the equivalent parser state variable.
+ * @param fieldp points to the equivalent parser field variable.
+ * @param lengthp points to the equivalent parser length variable.
+ * @param bufferp points to the buffer on the most likely path.
+ * @param framep points to the frame into which a complete buffer is
+ * extracted.
+ * @return an event.
+ */
+extern obelisk_event_t obelisk_viterbi(obelisk_viterbi_t * viterbip, const int cost[OBELISK_VITERBI_TOKENS], obelisk_state_t * statep, int * fieldp, int * lengthp, obelisk_buffer_t * bufferp, obelisk_frame_t * framep);
+
+/**
+ * These are the parameters of prior aided acquisition. The prior may be
+ * off by up to half a minute either way, which is every possible second
+ * offset within the minute but never the wrong minute.
+ */
+enum ObeliskAcquireConstants {
+    OBELISK_ACQUIRE_SECONDS     = 29,   /* Prior error tolerated either way. */
+    OBELISK_ACQUIRE_HYPOTHESES  = (2 * OBELISK_ACQUIRE_SECONDS) + 1,
+    OBELISK_ACQUIRE_TOKENS      = 120,  /* Give up after this many pulses. */
+    OBELISK_ACQUIRE_MINUTES     = (((2 * OBELISK_ACQUIRE_SECONDS) + OBELISK_ACQUIRE_TOKENS + 58) / 60) + 1,
+    OBELISK_ACQUIRE_ERRORS      = 2,    /* Maximum mismatches of the best. */
+    OBELISK_ACQUIRE_MARGIN      = 4,    /* Minimum margin over runner up. */
+};
+
+/**
+ * This structure describes the state of prior aided acquisition. Each
+ * hypothesis is that the first pulse was received at a particular second
+ * near the prior, and is scored by how many pulses since then disagree
+ * with the frames expected for the minutes around the prior. The caller
+ * does not need to know its contents except for the most likely
+ * hypothesis and the margin by which it is more likely than any other.
+ */
+typedef struct ObeliskAcquire {
+    obelisk_buffer_t candidate[OBELISK_ACQUIRE_MINUTES];    /* Expected. */
+    obelisk_buffer_t received;                              /* Shifted in. */
+    time_t base;                                            /* Candidate 0. */
+    time_t first;                                           /* Hypothesis 0. */
+    int mismatches[OBELISK_ACQUIRE_HYPOTHESES];             /* Scores. */
+    int tokens;                                             /* Received. */
+    int best;                                               /* Most likely. */
+    int margin;                                             /* Runner up - best. */
+} obelisk_acquire_t;
+
+/**
+ * Initialize prior aided acquisition by generating the expected frames
+ * for the minutes around the prior. Only the fields that follow from the
+ * time itself are compared; dUT1, the leap second warning, and DST can't
+ * be known in advance and match anything but a MARKER.
+ * @param acquirep points to the acquisition state.
+ * @param prior is the time in seconds since the POSIX epoch, from the
+ * system clock or an RTC, at which the first pulse is believed to have
+ * been received.
+ */
+extern void obelisk_acquire_init(obelisk_acquire_t * acquirep, time_t prior);
+
+/**
+ * Score one pulse against every hypothesis, and declare lock as soon as
+ * one hypothesis has no more than OBELISK_ACQUIRE_ERRORS mismatches and
+ * every other has at least OBELISK_ACQUIRE_MARGIN more. Every pulse must
+ * be passed in, including INVALID ones, since each one is a second. Leap
+ * seconds are not hypothesized. On lock the parser variables are set to
+ * what obelisk_parse() would have after this pulse had it been
+ * synchronized all along, so the caller can continue with the parser.
+ * @param acquirep points to the acquisition state.
+ * @param token is the token of the pulse.
+ * @param epochp points to where the time of the second in which this
+ * pulse was received is stored on lock.
+ * @param statep points to the parser state variable.
+ * @param fieldp points to the parser field variable.
+ * @param lengthp points to the parser length variable.
+ * @param bufferp points to the parser buffer.
+ * @return >0 if locked, 0 if not yet, <0 if the prior is not consistent
+ * with the pulses received and acquisition should be abandoned.
+ */
+extern int obelisk_acquire(obelisk_acquire_t * acquirep, obelisk_token_t token, time_t * epochp, obelisk_state_t * statep, int * fieldp, int * lengthp, obelisk_buffer_t * bufferp);
+
 #endif /*  _COM_DIAG_OBELISK_OBELISK_H_ */
@@ -0,0 +1,59 @@
+/* vim: set ts=4 expandtab shiftwidth=4: */
+#ifndef _COM_DIAG_OBELISK_OBELISK_BATCH_H_
+#define _COM_DIAG_OBELISK_OBELISK_BATCH_H_
+
+/**
+ * @file
+ *
+ * Copyright 2018 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in LICENSE.txt<BR>
+ * Chip Overclock<BR>
+ * mailto:coverclock@diag.com<BR>
+ * http://github.com/coverclock/com-diag-obelisk<BR>
+ *
+ * Archives of received frames are decoded many buffers at a time. The
+ * batch decoder validates the BCD digits of several buffers at once in
+ * the lanes of a vector register and computes their epochs the same way
+ * obelisk_epoch() does, using AVX2 on x86_64 processors that have it and
+ * Advanced SIMD (NEON) on 64-bit ARM processors such as the Raspberry Pi 3
+ * and later. The implementation is chosen at run time the first time it
+ * is called, and any other processor falls back to a scalar version.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+#include "com/diag/obelisk/obelisk.h"
+
+/**
+ * Decode an array of buffers to epochs. A buffer is valid if
+ * obelisk_verify() finds no fault with it and obelisk_epoch() can convert
+ * it, in which case its epoch is the start of the minute it encodes.
+ * @param epochs points to the output array of epochs, -1 if invalid.
+ * @param valid points to the output array of flags, true if valid.
+ * @param buffers points to the input array of buffers.
+ * @param count is the number of buffers.
+ * @return the number of valid buffers.
+ */
+extern size_t obelisk_batch(time_t epochs[], uint8_t valid[], const obelisk_buffer_t buffers[], size_t count);
+
+/**
+ * Decode an array of buffers to epochs one at a time. This is what
+ * obelisk_batch() falls back to when no vector instructions are available,
+ * and how the tail of an array not a multiple of the vector width is done.
+ * @param epochs points to the output array of epochs, -1 if invalid.
+ * @param valid points to the output array of flags, true if valid.
+ * @param buffers points to the input array of buffers.
+ * @param count is the number of buffers.
+ * @return the number of valid buffers.
+ */
+extern size_t obelisk_batch_scalar(time_t epochs[], uint8_t valid[], const obelisk_buffer_t buffers[], size_t count);
+
+/**
+ * Return the name of the implementation obelisk_batch() uses on this
+ * processor.
+ * @return "avx2", "neon", or "scalar".
+ */
+extern const char * obelisk_batch_implementation(void);
+
+#endif /*  _COM_DIAG_OBELISK_OBELISK_BATCH_H_ */
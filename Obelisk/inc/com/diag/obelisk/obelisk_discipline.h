@@ -0,0 +1,89 @@
+/* vim: set ts=4 expandtab shiftwidth=4: */
+#ifndef _COM_DIAG_OBELISK_OBELISK_DISCIPLINE_H_
+#define _COM_DIAG_OBELISK_OBELISK_DISCIPLINE_H_
+
+/**
+ * @file
+ *
+ * Copyright 2018 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in LICENSE.txt<BR>
+ * Chip Overclock<BR>
+ * mailto:coverclock@diag.com<BR>
+ * http://github.com/coverclock/com-diag-obelisk<BR>
+ *
+ * Instead of setting the system clock once in a while, which steps it
+ * out from under every other service on the system, the offset of the
+ * system clock from WWVB can be measured at every second and handed to
+ * the kernel's phase-locked loop, which slews the clock and estimates
+ * the frequency error of its oscillator as it goes. The clock is only
+ * stepped if the offset is too large to be slewed away in reasonable
+ * time, typically just once when the discipline begins.
+ *
+ * Offsets are in nanoseconds and are the system clock minus the reference:
+ * a positive offset means the system clock is ahead.
+ */
+
+#include <stdint.h>
+#include <time.h>
+#include <sys/timex.h>
+
+/**
+ * These are the defaults of the clock discipline.
+ */
+enum ObeliskDisciplineConstants {
+    OBELISK_DISCIPLINE_THRESHOLD    = 128,  /* Step above this many milliseconds. */
+    OBELISK_DISCIPLINE_CONSTANT     = 2,    /* Kernel PLL time constant [0..10]. */
+    OBELISK_DISCIPLINE_MAXPHASE     = 500,  /* Kernel slews at most this many milliseconds. */
+};
+
+/**
+ * This structure describes the state of the clock discipline.
+ */
+typedef struct ObeliskDiscipline {
+    int64_t threshold;  /* Step above this many nanoseconds. */
+    int64_t offset;     /* Most recent offset in nanoseconds. */
+    long frequency;     /* Kernel estimate in ppm with a 16-bit fraction. */
+    int constant;       /* Kernel PLL time constant. */
+    int leap;           /* Insert a leap second at the end of this UTC day. */
+    int state;          /* Kernel clock state e.g. TIME_OK. */
+    unsigned int steps; /* Steps so far. */
+    unsigned int slews; /* Slews so far. */
+} obelisk_discipline_t;
+
+/**
+ * Initialize the clock discipline.
+ * @param disciplinep points to the discipline.
+ * @param milliseconds is the offset above which the clock is stepped.
+ * @param constant is the kernel PLL time constant; larger is smoother.
+ */
+extern void obelisk_discipline_init(obelisk_discipline_t * disciplinep, int milliseconds, int constant);
+
+/**
+ * Compute the offset of the system clock from the reference.
+ * @param systemp points to the system clock at some instant.
+ * @param referencep points to the reference time at the same instant.
+ * @return the offset in nanoseconds, positive if the system clock is ahead.
+ */
+extern int64_t obelisk_discipline_offset(const struct timespec * systemp, const struct timespec * referencep);
+
+/**
+ * Prepare the kernel request for an offset, stepping the clock if the
+ * offset exceeds the threshold, slewing it otherwise. Exposed for unit
+ * testing; obelisk_discipline_adjust() calls this.
+ * @param disciplinep points to the discipline.
+ * @param timexp points to the kernel request.
+ * @param offset is the offset in nanoseconds.
+ * @return >0 if this is a step, 0 if it is a slew.
+ */
+extern int obelisk_discipline_prepare(obelisk_discipline_t * disciplinep, struct timex * timexp, int64_t offset);
+
+/**
+ * Discipline the system clock for an offset. This requires CAP_SYS_TIME.
+ * @param disciplinep points to the discipline.
+ * @param offset is the offset in nanoseconds.
+ * @return >0 if the clock was stepped, 0 if it is being slewed, <0 with
+ * errno set if the kernel refused.
+ */
+extern int obelisk_discipline_adjust(obelisk_discipline_t * disciplinep, int64_t offset);
+
+#endif /*  _COM_DIAG_OBELISK_OBELISK_DISCIPLINE_H_ */
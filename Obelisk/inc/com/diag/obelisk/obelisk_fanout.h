@@ -0,0 +1,148 @@
+/* vim: set ts=4 expandtab shiftwidth=4: */
+#ifndef _COM_DIAG_OBELISK_OBELISK_FANOUT_H_
+#define _COM_DIAG_OBELISK_OBELISK_FANOUT_H_
+
+/**
+ * @file
+ *
+ * Copyright 2018 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in LICENSE.txt<BR>
+ * Chip Overclock<BR>
+ * mailto:coverclock@diag.com<BR>
+ * http://github.com/coverclock/com-diag-obelisk<BR>
+ *
+ * These functions fan output out to any number of sinks (files, FIFOs,
+ * serial ports, sockets) without the caller ever waiting on one of them.
+ * Each sink has its own bounded queue. Posting a message copies it onto
+ * every queue that has room, and counts it as dropped for every queue that
+ * doesn't; it never blocks on a sink. A thread drains the queues, writing
+ * to each sink only when poll(2) says it can take more. Every sink is made
+ * non-blocking, since poll(2) saying a sink can take more doesn't mean it
+ * can take all of a message, so a stalled sink (say, a FIFO whose reader
+ * has gone away) fills its own queue and drops its own messages without
+ * holding up the others.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <pthread.h>
+
+/**
+ * These are the limits of the fan out.
+ */
+enum ObeliskFanoutConstants {
+    OBELISK_FANOUT_SINKS    = 8,        /* Most sinks. */
+    OBELISK_FANOUT_DEPTH    = 16,       /* Messages queued per sink. */
+    OBELISK_FANOUT_SIZE     = 256,      /* Largest message in bytes. */
+};
+
+/**
+ * This is the type of a function that writes to a sink instead of
+ * write(2), for example to send a datagram to an address. It returns
+ * what write(2) would.
+ */
+typedef ssize_t (obelisk_fanout_function_t)(void * context, int fd, const void * buffer, size_t length);
+
+/**
+ * These are the statistics of a sink.
+ */
+typedef struct ObeliskFanoutStatistics {
+    uint64_t queued;        /* Messages queued. */
+    uint64_t written;       /* Messages written. */
+    uint64_t dropped;       /* Messages dropped because the queue was full. */
+    uint64_t failed;        /* Messages discarded because a write failed. */
+} obelisk_fanout_statistics_t;
+
+/**
+ * This structure describes a sink and its queue.
+ */
+typedef struct ObeliskFanoutSink {
+    int fd;
+    obelisk_fanout_function_t * functionp;
+    void * context;
+    unsigned int head;                      /* Next message to queue. */
+    unsigned int tail;                      /* Next message to write. */
+    size_t offset;                          /* Written of the tail message. */
+    size_t lengths[OBELISK_FANOUT_DEPTH];
+    char messages[OBELISK_FANOUT_DEPTH][OBELISK_FANOUT_SIZE];
+    obelisk_fanout_statistics_t statistics;
+} obelisk_fanout_sink_t;
+
+/**
+ * This structure describes the fan out.
+ */
+typedef struct ObeliskFanout {
+    pthread_mutex_t mutex;
+    pthread_t thread;
+    int wake[2];                            /* Pipe that wakes the thread. */
+    int running;
+    int stopping;
+    int count;
+    obelisk_fanout_sink_t sinks[OBELISK_FANOUT_SINKS];
+} obelisk_fanout_t;
+
+/**
+ * Initialize the fan out with no sinks.
+ * @param fp points to the fan out.
+ * @return 0 for success, <0 with errno set if an error occurred.
+ */
+extern int obelisk_fanout_init(obelisk_fanout_t * fp);
+
+/**
+ * Add a sink. This must be done before the fan out is started. The file
+ * descriptor is made non-blocking (which affects anything else sharing its
+ * open file description) but still belongs to the caller, who closes it
+ * after the fan out is finished.
+ * @param fp points to the fan out.
+ * @param fd is the file descriptor of the sink, which is polled even if
+ * a function does the writing.
+ * @param functionp points to the function that writes, or is null for
+ * write(2).
+ * @param context is passed to the function.
+ * @return the index of the sink, <0 with errno set if an error occurred.
+ */
+extern int obelisk_fanout_add(obelisk_fanout_t * fp, int fd, obelisk_fanout_function_t * functionp, void * context);
+
+/**
+ * Start the thread that drains the queues. The thread blocks all signals
+ * so they continue to be delivered to the caller.
+ * @param fp points to the fan out.
+ * @return 0 for success, <0 with errno set if an error occurred.
+ */
+extern int obelisk_fanout_start(obelisk_fanout_t * fp);
+
+/**
+ * Queue a message to every sink.
+ * @param fp points to the fan out.
+ * @param buffer points to the message.
+ * @param length is the length of the message in bytes.
+ * @return the number of sinks it was queued to, <0 with errno set if the
+ * message is too large.
+ */
+extern int obelisk_fanout_post(obelisk_fanout_t * fp, const void * buffer, size_t length);
+
+/**
+ * Copy the statistics of a sink.
+ * @param fp points to the fan out.
+ * @param index is the index of the sink.
+ * @param statisticsp points to where the statistics are copied.
+ */
+extern void obelisk_fanout_statistics(obelisk_fanout_t * fp, int index, obelisk_fanout_statistics_t * statisticsp);
+
+/**
+ * Stop the thread, discarding any messages still queued. The statistics
+ * remain available.
+ * @param fp points to the fan out.
+ * @return 0 for success, <0 with errno set if an error occurred.
+ */
+extern int obelisk_fanout_stop(obelisk_fanout_t * fp);
+
+/**
+ * Release the resources of a stopped fan out (but not the file descriptors
+ * of the sinks).
+ * @param fp points to the fan out.
+ */
+extern void obelisk_fanout_fini(obelisk_fanout_t * fp);
+
+#endif /*  _COM_DIAG_OBELISK_OBELISK_FANOUT_H_ */
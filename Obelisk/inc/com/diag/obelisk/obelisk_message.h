@@ -0,0 +1,142 @@
+/* vim: set ts=4 expandtab shiftwidth=4: */
+#ifndef _COM_DIAG_OBELISK_OBELISK_MESSAGE_H_
+#define _COM_DIAG_OBELISK_OBELISK_MESSAGE_H_
+
+/**
+ * @file
+ *
+ * Copyright 2018 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in LICENSE.txt<BR>
+ * Chip Overclock<BR>
+ * mailto:coverclock@diag.com<BR>
+ * http://github.com/coverclock/com-diag-obelisk<BR>
+ *
+ * These functions send and receive a compact binary time message for
+ * consumers on the same host, or on hosts of the same byte order, that
+ * would otherwise parse NMEA text to recover what wwvbtool already has in
+ * binary. A message is a fixed size structure of fixed width, naturally
+ * aligned fields in host byte order, sent whole in one datagram, over a
+ * UNIX domain socket or UDP, so a consumer reads it straight into the
+ * structure and uses it without parsing. The magic number also catches a
+ * sender of the other byte order. The version changes whenever the layout
+ * does.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+#include "com/diag/obelisk/obelisk.h"
+
+/**
+ * These are the constants of the message.
+ */
+enum ObeliskMessageConstants {
+    OBELISK_MESSAGE_MAGIC       = 0x4f424c4b,   /* "OBLK" */
+    OBELISK_MESSAGE_VERSION     = 1,
+    OBELISK_MESSAGE_BATCH       = 16,           /* Most messages per receive. */
+};
+
+/**
+ * These are the lock states of the message.
+ */
+typedef enum ObeliskMessageLock {
+    OBELISK_MESSAGE_LOCK_NONE       = 0,    /* Time is not known. */
+    OBELISK_MESSAGE_LOCK_ACQUIRED   = 1,    /* Time is from WWVB. */
+    OBELISK_MESSAGE_LOCK_HOLDOVER   = 2,    /* Time is from holdover. */
+} obelisk_message_lock_t;
+
+/**
+ * This is the layout of the message, 32 bytes long.
+ */
+typedef struct ObeliskMessage {
+    uint32_t magic;         /* OBELISK_MESSAGE_MAGIC. */
+    uint8_t version;        /* OBELISK_MESSAGE_VERSION. */
+    uint8_t lock;           /* obelisk_message_lock_t. */
+    uint8_t leap;           /* !0 if a leap second ends this month. */
+    uint8_t dst;            /* obelisk_dst_t. */
+    int64_t seconds;        /* Seconds since the Epoch when sent. */
+    int32_t nanoseconds;    /* Nanoseconds after that second when sent. */
+    int32_t uncertainty;    /* Nanoseconds or -1 if unknown. */
+    int16_t dut1;           /* UT1 minus UTC in milliseconds. */
+    uint16_t sequence;      /* Incremented with every message. */
+    uint32_t reserved;      /* Zero. */
+} obelisk_message_t;
+
+/**
+ * Initialize a message to send.
+ * @param mp points to the message.
+ */
+extern void obelisk_message_init(obelisk_message_t * mp);
+
+/**
+ * Update the status fields of a message from the most recent frame.
+ * @param mp points to the message.
+ * @param dut1 is UT1 minus UTC in tenths of a second.
+ * @param leap is !0 if a leap second ends this month.
+ * @param dst is the DST state.
+ */
+extern void obelisk_message_status(obelisk_message_t * mp, int dut1, int leap, obelisk_dst_t dst);
+
+/**
+ * Prepare a message to be sent now, advancing its sequence number.
+ * @param mp points to the message.
+ * @param lock is the lock state.
+ * @param seconds is the seconds since the Epoch.
+ * @param nanoseconds is the nanoseconds after that second.
+ * @param uncertainty is the uncertainty in nanoseconds, or <0 if unknown.
+ */
+extern void obelisk_message_prepare(obelisk_message_t * mp, obelisk_message_lock_t lock, time_t seconds, int32_t nanoseconds, int64_t uncertainty);
+
+/**
+ * Return true if a datagram is a message this library understands.
+ * @param mp points to the datagram.
+ * @param length is the length of the datagram in bytes.
+ * @return !0 if it is valid, 0 otherwise.
+ */
+extern int obelisk_message_valid(const obelisk_message_t * mp, size_t length);
+
+/**
+ * Open a socket to a consumer bound to a UNIX domain datagram socket.
+ * @param path is the path of the socket bound by the consumer.
+ * @return a socket, or <0 with errno set if an error occurred.
+ */
+extern int obelisk_message_open(const char * path);
+
+/**
+ * Bind a UNIX domain datagram socket on which to receive messages. Any
+ * stale socket at the path should be unlinked first.
+ * @param path is the path of the socket.
+ * @return a socket, or <0 with errno set if an error occurred.
+ */
+extern int obelisk_message_bind(const char * path);
+
+/**
+ * Close a socket.
+ * @param sock is the socket.
+ * @return 0 for success, <0 with errno set if an error occurred.
+ */
+extern int obelisk_message_close(int sock);
+
+/**
+ * Send a message on a connected socket.
+ * @param sock is the socket.
+ * @param mp points to the message.
+ * @return the size of the message, or <0 with errno set if an error
+ * occurred, for example if the consumer isn't running.
+ */
+extern int obelisk_message_send(int sock, const obelisk_message_t * mp);
+
+/**
+ * Receive a batch of messages from a UNIX domain or UDP datagram socket,
+ * waiting for the first and taking any more already queued in the same
+ * system call. Datagrams that aren't valid messages are discarded.
+ * @param sock is the socket.
+ * @param messages points to an array of messages.
+ * @param count is the number of messages in the array, at most
+ * OBELISK_MESSAGE_BATCH.
+ * @return the number of valid messages received, which may be zero, or <0
+ * with errno set if an error occurred.
+ */
+extern int obelisk_message_receive(int sock, obelisk_message_t * messages, int count);
+
+#endif /*  _COM_DIAG_OBELISK_OBELISK_MESSAGE_H_ */
@@ -0,0 +1,142 @@
+/* vim: set ts=4 expandtab shiftwidth=4: */
+#ifndef _COM_DIAG_OBELISK_OBELISK_MULTICAST_H_
+#define _COM_DIAG_OBELISK_OBELISK_MULTICAST_H_
+
+/**
+ * @file
+ *
+ * Copyright 2018 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in LICENSE.txt<BR>
+ * Chip Overclock<BR>
+ * mailto:coverclock@diag.com<BR>
+ * http://github.com/coverclock/com-diag-obelisk<BR>
+ *
+ * These functions announce the time once a second to IPv4 and IPv6
+ * multicast groups. Each announcement is a compact fixed length datagram
+ * in network byte order:
+ *
+ * offset   length  field
+ * 0        4       magic "WWVB"
+ * 4        1       version
+ * 5        1       flags
+ * 6        2       sequence
+ * 8        8       seconds since the Epoch at the second edge announced
+ * 16       4       nanoseconds after its second edge that the previous
+ *                  announcement was sent, or -1 if unknown
+ *
+ * The kernel timestamps each datagram as it is sent (SO_TIMESTAMPING), and
+ * since that time is only known afterwards, it is carried in the
+ * announcement that follows, much as a PTP follow up message does. A
+ * receiver that timestamps announcement N on arrival can subtract the
+ * delay carried in announcement N+1 to find where the second began.
+ *
+ * All the destinations of an address family are sent to with one
+ * sendmmsg(2) call.
+ */
+
+#include <stdint.h>
+#include <time.h>
+#include <sys/socket.h>
+
+/**
+ * These are the constants of the announcement.
+ */
+enum ObeliskMulticastConstants {
+    OBELISK_MULTICAST_MAGIC         = 0x57575642,   /* "WWVB" */
+    OBELISK_MULTICAST_VERSION       = 1,
+    OBELISK_MULTICAST_LENGTH        = 20,           /* Bytes on the wire. */
+    OBELISK_MULTICAST_DESTINATIONS  = 8,            /* Most groups and ports. */
+    OBELISK_MULTICAST_TTL           = 1,            /* Default TTL or hop limit. */
+};
+
+/**
+ * These are the flags of the announcement.
+ */
+typedef enum ObeliskMulticastFlags {
+    OBELISK_MULTICAST_FLAG_ACQUIRED = (1 << 0),     /* Time is from WWVB. */
+    OBELISK_MULTICAST_FLAG_HOLDOVER = (1 << 1),     /* Time is from holdover. */
+    OBELISK_MULTICAST_FLAG_LEAP     = (1 << 2),     /* Leap second at end of day. */
+} obelisk_multicast_flags_t;
+
+/**
+ * This structure describes an announcement.
+ */
+typedef struct ObeliskMulticastAnnouncement {
+    uint8_t version;
+    uint8_t flags;
+    uint16_t sequence;
+    int64_t seconds;
+    int32_t previous;
+} obelisk_multicast_announcement_t;
+
+/**
+ * This structure describes the state of the sender.
+ */
+typedef struct ObeliskMulticast {
+    int sock4;
+    int sock6;
+    unsigned int interface;                 /* Index or 0 for the default. */
+    int ttl;                                /* TTL or hop limit. */
+    int count;
+    struct sockaddr_storage destinations[OBELISK_MULTICAST_DESTINATIONS];
+    socklen_t lengths[OBELISK_MULTICAST_DESTINATIONS];
+    uint16_t sequence;                      /* Of the next announcement. */
+    struct timespec edge;                   /* Edge of the last announcement. */
+    int32_t previous;                       /* Delay of the last announcement. */
+} obelisk_multicast_t;
+
+/**
+ * Encode an announcement into a buffer in network byte order.
+ * @param buffer points to a buffer of OBELISK_MULTICAST_LENGTH bytes.
+ * @param ap points to the announcement.
+ */
+extern void obelisk_multicast_encode(uint8_t * buffer, const obelisk_multicast_announcement_t * ap);
+
+/**
+ * Decode an announcement from a buffer in network byte order.
+ * @param ap points to the announcement.
+ * @param buffer points to the buffer.
+ * @param length is the number of bytes in the buffer.
+ * @return 0 for success, <0 if it isn't a valid announcement.
+ */
+extern int obelisk_multicast_decode(obelisk_multicast_announcement_t * ap, const uint8_t * buffer, size_t length);
+
+/**
+ * Initialize the sender with no destinations.
+ * @param mp points to the sender.
+ * @param interface is the name of the interface to send on, or null for
+ * the default.
+ * @param ttl is the TTL (IPv4) or hop limit (IPv6) of the datagrams.
+ * @return 0 for success, <0 with errno set if an error occurred.
+ */
+extern int obelisk_multicast_init(obelisk_multicast_t * mp, const char * interface, int ttl);
+
+/**
+ * Add a destination, opening the socket of its address family if
+ * necessary.
+ * @param mp points to the sender.
+ * @param group is an IPv4 or IPv6 multicast group address.
+ * @param port is the UDP port.
+ * @return 0 for success, <0 with errno set if an error occurred.
+ */
+extern int obelisk_multicast_add(obelisk_multicast_t * mp, const char * group, int port);
+
+/**
+ * Announce a second to every destination.
+ * @param mp points to the sender.
+ * @param seconds is the seconds since the Epoch at the second edge.
+ * @param edgep points to when the second edge occurred on the system
+ * clock.
+ * @param flags are the flags of the announcement.
+ * @return the number of datagrams sent, <0 with errno set if an error
+ * occurred.
+ */
+extern int obelisk_multicast_send(obelisk_multicast_t * mp, time_t seconds, const struct timespec * edgep, int flags);
+
+/**
+ * Release the resources of the sender.
+ * @param mp points to the sender.
+ */
+extern void obelisk_multicast_fini(obelisk_multicast_t * mp);
+
+#endif /*  _COM_DIAG_OBELISK_OBELISK_MULTICAST_H_ */
@@ -0,0 +1,114 @@
+/* vim: set ts=4 expandtab shiftwidth=4: */
+#ifndef _COM_DIAG_OBELISK_OBELISK_NMEA_H_
+#define _COM_DIAG_OBELISK_OBELISK_NMEA_H_
+
+/**
+ * @file
+ *
+ * Copyright 2018 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in LICENSE.txt<BR>
+ * Chip Overclock<BR>
+ * mailto:coverclock@diag.com<BR>
+ * http://github.com/coverclock/com-diag-obelisk<BR>
+ *
+ * These functions emit synthesized NMEA sentences from a template that is
+ * formatted once. Every field is fixed width, so changing the time, the
+ * mode, or the status patches only the characters that differ, and the
+ * checksum of each sentence is updated by XORing out the old character
+ * and XORing in the new one. The RMC sentence is always emitted; the ZDA
+ * sentence and the proprietary PWWVB status sentence, which carries dUT1,
+ * the leap second warning, the DST status, and the signal quality, follow
+ * it in the same buffer if so configured, so they can be written at once.
+ *
+ * $PWWVB,sD.D,L,S,QQ*CS\r\n
+ *
+ * sD.D is dUT1 (UT1 - UTC) in seconds, L is the leap second warning,
+ * S is the DST status (0 off, 1 ends, 2 begins, 3 on), and QQ is how many
+ * of the last sixty pulses were valid.
+ */
+
+#include <stddef.h>
+#include <time.h>
+#include "com/diag/obelisk/obelisk.h"
+
+/**
+ * These are the constants of the emitter.
+ */
+enum ObeliskNmeaConstants {
+    OBELISK_NMEA_SENTENCES  = 60,       /* Sentences precomputed per frame. */
+    OBELISK_NMEA_SIZE       = 128,      /* Room for all three sentences. */
+};
+
+/**
+ * These identify the sentences of the emitter.
+ */
+typedef enum ObeliskNmeaSentence {
+    OBELISK_NMEA_RMC        = 0,
+    OBELISK_NMEA_ZDA        = 1,
+    OBELISK_NMEA_STATUS     = 2,
+    OBELISK_NMEA_COUNT      = 3,
+} obelisk_nmea_sentence_t;
+
+/**
+ * This structure describes the state of the emitter.
+ */
+typedef struct ObeliskNmea {
+    char buffer[OBELISK_NMEA_SIZE];                 /* Sentences to write. */
+    size_t length;                                  /* Length to write. */
+    time_t seconds;                                 /* Seconds since the Epoch. */
+    struct tm time;                                 /* Broken down seconds. */
+    unsigned char checksum[OBELISK_NMEA_COUNT];     /* Checksum of each sentence. */
+} obelisk_nmea_t;
+
+/**
+ * Format the template for the Epoch with hundredths zero, mode 'D', and a
+ * zero status.
+ * @param np points to the emitter.
+ * @param talker is the two character NMEA talker.
+ * @param extra if true appends ZDA and PWWVB to RMC.
+ */
+extern void obelisk_nmea_init(obelisk_nmea_t * np, const char * talker, int extra);
+
+/**
+ * Patch the time. Advancing by one second within a minute, which is by
+ * far the most common case, doesn't even break down the time.
+ * @param np points to the emitter.
+ * @param seconds is the seconds since the Epoch.
+ */
+extern void obelisk_nmea_time(obelisk_nmea_t * np, time_t seconds);
+
+/**
+ * Patch the hundredths of the second.
+ * @param np points to the emitter.
+ * @param hundredths is the hundredths [0..99].
+ */
+extern void obelisk_nmea_hundredths(obelisk_nmea_t * np, int hundredths);
+
+/**
+ * Patch the RMC mode indicator, 'D' (differential) for time from WWVB, or
+ * 'E' (estimated) for time from holdover.
+ * @param np points to the emitter.
+ * @param mode is the mode indicator.
+ */
+extern void obelisk_nmea_mode(obelisk_nmea_t * np, char mode);
+
+/**
+ * Patch the status.
+ * @param np points to the emitter.
+ * @param dut1 is UT1 - UTC in tenths of a second [-9..+9].
+ * @param lsw is true if a leap second is inserted at the end of the month.
+ * @param dst is the DST status.
+ * @param quality is how many of the last sixty pulses were valid [0..60].
+ */
+extern void obelisk_nmea_status(obelisk_nmea_t * np, int dut1, int lsw, obelisk_dst_t dst, int quality);
+
+/**
+ * Precompute the sentences for each of the seconds that follow, each one
+ * patched from the one before it.
+ * @param np points to the emitter.
+ * @param table points to an array of emitters.
+ * @param count is the number of emitters in the array.
+ */
+extern void obelisk_nmea_precompute(const obelisk_nmea_t * np, obelisk_nmea_t table[], size_t count);
+
+#endif /*  _COM_DIAG_OBELISK_OBELISK_NMEA_H_ */
@@ -0,0 +1,185 @@
+/* vim: set ts=4 expandtab shiftwidth=4: */
+#ifndef _COM_DIAG_OBELISK_OBELISK_NTP_H_
+#define _COM_DIAG_OBELISK_OBELISK_NTP_H_
+
+/**
+ * @file
+ *
+ * Copyright 2018 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in LICENSE.txt<BR>
+ * Chip Overclock<BR>
+ * mailto:coverclock@diag.com<BR>
+ * http://github.com/coverclock/com-diag-obelisk<BR>
+ *
+ * These functions implement a minimal NTPv4 server, for isolated networks
+ * that would rather not run ntpd at all. It answers client (mode 3)
+ * requests with server (mode 4) responses from the system clock, which
+ * wwvbtool disciplines, and does nothing else: no symmetric modes, no
+ * broadcast, no control messages, no authentication. The receive
+ * timestamp of each request is the one the kernel took when the datagram
+ * arrived (SO_TIMESTAMPNS). Requests are read, and responses are written,
+ * in batches (recvmmsg(2), sendmmsg(2)) by a thread of their own.
+ *
+ * The leap indicator, stratum, and root dispersion come from the status
+ * the caller updates every second it knows the time. If it stops doing so
+ * for OBELISK_NTP_STALE seconds the server is unsynchronized, and ignores
+ * requests until it is synchronized again, rather than risk a client
+ * mistaking its response for a Kiss-o'-Death.
+ *
+ * REFERENCES
+ *
+ * D. Mills et al., "Network Time Protocol Version 4: Protocol and
+ * Algorithms Specification", RFC 5905, 2010-06
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+
+/**
+ * These are the constants of the server.
+ */
+enum ObeliskNtpConstants {
+    OBELISK_NTP_PORT            = 123,
+    OBELISK_NTP_LENGTH          = 48,       /* Bytes without extensions. */
+    OBELISK_NTP_BATCH           = 32,       /* Most requests per batch. */
+    OBELISK_NTP_STALE           = 4,        /* Seconds until unsynchronized. */
+    OBELISK_NTP_PRECISION       = -20,      /* Log2 seconds, about 1us. */
+    OBELISK_NTP_MODE_CLIENT     = 3,
+    OBELISK_NTP_MODE_SERVER     = 4,
+    OBELISK_NTP_VERSION         = 4,
+    OBELISK_NTP_STRATUM         = 1,        /* Primary server. */
+    OBELISK_NTP_UNSYNCHRONIZED  = 16,       /* Stratum when unsynchronized. */
+};
+
+/**
+ * These are the leap indicators of the server.
+ */
+typedef enum ObeliskNtpLeap {
+    OBELISK_NTP_LEAP_NOWARNING      = 0,
+    OBELISK_NTP_LEAP_ADDSECOND      = 1,
+    OBELISK_NTP_LEAP_DELSECOND      = 2,
+    OBELISK_NTP_LEAP_NOTINSYNC      = 3,
+} obelisk_ntp_leap_t;
+
+/**
+ * This structure describes what the server says about itself.
+ */
+typedef struct ObeliskNtpStatus {
+    struct timespec reference;  /* System time the clock was last set. */
+    int64_t updated;            /* CLOCK_MONOTONIC ns of the last update. */
+    int64_t dispersion;         /* Root dispersion in ns. */
+    int leap;                   /* obelisk_ntp_leap_t. */
+    int stratum;
+} obelisk_ntp_status_t;
+
+/**
+ * These are the statistics of the server.
+ */
+typedef struct ObeliskNtpStatistics {
+    uint64_t received;          /* Datagrams received. */
+    uint64_t answered;          /* Responses sent. */
+    uint64_t ignored;           /* Datagrams not answered: not requests, or unsynchronized. */
+    uint64_t failed;            /* Responses that couldn't be sent. */
+} obelisk_ntp_statistics_t;
+
+/**
+ * This structure describes the server.
+ */
+typedef struct ObeliskNtp {
+    pthread_mutex_t mutex;
+    pthread_t thread;
+    int sock;
+    int port;                   /* Port actually bound. */
+    int wake[2];                /* Pipe that stops the thread. */
+    int running;
+    obelisk_ntp_status_t status;
+    obelisk_ntp_statistics_t statistics;
+} obelisk_ntp_t;
+
+/**
+ * Store a time in an NTP timestamp in network byte order.
+ * @param buffer points to eight bytes.
+ * @param timep points to the time.
+ */
+extern void obelisk_ntp_timestamp(uint8_t * buffer, const struct timespec * timep);
+
+/**
+ * Compose the response to a request.
+ * @param response points to a buffer of OBELISK_NTP_LENGTH bytes.
+ * @param request points to the request.
+ * @param length is the length of the request in bytes.
+ * @param statusp points to the status of the server.
+ * @param receivep points to the system time the request arrived.
+ * @param transmitp points to the system time the response is sent.
+ * @return OBELISK_NTP_LENGTH, or <0 if the request should be ignored,
+ * including when the server is unsynchronized.
+ */
+extern int obelisk_ntp_respond(uint8_t * response, const uint8_t * request, size_t length, const obelisk_ntp_status_t * statusp, const struct timespec * receivep, const struct timespec * transmitp);
+
+/**
+ * Initialize the server, binding a UDP socket that takes both IPv6 and
+ * IPv4 requests, or only IPv4 if IPv6 isn't available.
+ * @param np points to the server.
+ * @param port is the port, or 0 for any.
+ * @return 0 for success, <0 with errno set if an error occurred.
+ */
+extern int obelisk_ntp_init(obelisk_ntp_t * np, int port);
+
+/**
+ * Update the status of the server from the decoder.
+ * @param np points to the server.
+ * @param referencep points to the system time the clock was last known to
+ * be right, for example the most recent second edge.
+ * @param leap is the leap indicator.
+ * @param dispersion is the root dispersion in ns, or <0 if unknown.
+ */
+extern void obelisk_ntp_update(obelisk_ntp_t * np, const struct timespec * referencep, obelisk_ntp_leap_t leap, int64_t dispersion);
+
+/**
+ * Copy the status as the server would use it now, unsynchronized if it
+ * is stale.
+ * @param np points to the server.
+ * @param statusp points to where the status is copied.
+ */
+extern void obelisk_ntp_status(obelisk_ntp_t * np, obelisk_ntp_status_t * statusp);
+
+/**
+ * Answer the requests already queued on the socket, a batch at a time,
+ * without waiting for more.
+ * @param np points to the server.
+ * @return the number of responses sent, or <0 with errno set if an error
+ * occurred.
+ */
+extern int obelisk_ntp_serve(obelisk_ntp_t * np);
+
+/**
+ * Start the thread that answers requests. The thread blocks all signals
+ * so they continue to be delivered to the caller.
+ * @param np points to the server.
+ * @return 0 for success, <0 with errno set if an error occurred.
+ */
+extern int obelisk_ntp_start(obelisk_ntp_t * np);
+
+/**
+ * Copy the statistics of the server.
+ * @param np points to the server.
+ * @param statisticsp points to where the statistics are copied.
+ */
+extern void obelisk_ntp_statistics(obelisk_ntp_t * np, obelisk_ntp_statistics_t * statisticsp);
+
+/**
+ * Stop the thread. The statistics remain available.
+ * @param np points to the server.
+ * @return 0 for success, <0 with errno set if an error occurred.
+ */
+extern int obelisk_ntp_stop(obelisk_ntp_t * np);
+
+/**
+ * Release the resources of a stopped server.
+ * @param np points to the server.
+ */
+extern void obelisk_ntp_fini(obelisk_ntp_t * np);
+
+#endif /*  _COM_DIAG_OBELISK_OBELISK_NTP_H_ */
@@ -0,0 +1,225 @@
+/* vim: set ts=4 expandtab shiftwidth=4: */
+#ifndef _COM_DIAG_OBELISK_OBELISK_PAGE_H_
+#define _COM_DIAG_OBELISK_OBELISK_PAGE_H_
+
+/**
+ * @file
+ *
+ * Copyright 2018 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in LICENSE.txt<BR>
+ * Chip Overclock<BR>
+ * mailto:coverclock@diag.com<BR>
+ * http://github.com/coverclock/com-diag-obelisk<BR>
+ *
+ * These functions publish the state of the clock on a page of POSIX shared
+ * memory, much as the kernel publishes its clocks in the vDSO, so that any
+ * process can read the WWVB time without a system call or a lock. The page
+ * is protected by a sequence lock: the writer makes the sequence odd before
+ * it changes the page and even again afterwards, and a reader that sees it
+ * odd, or sees it change while copying, simply copies again.
+ *
+ * The reader is entirely in this header (the functions are static inline)
+ * so a process need not link against the library to use it. It reads
+ * CLOCK_MONOTONIC_RAW, which the vDSO provides without a system call, and
+ * extrapolates from the most recent second edge using the estimated
+ * frequency of that clock. That is the clock the PLL in wwvbtool runs on,
+ * so both the edge and the period are in its nanoseconds; CLOCK_MONOTONIC
+ * is slewed by NTP and would not agree with either. If the page hasn't
+ * been updated for OBELISK_PAGE_STALE seconds, the time is unknown.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/mman.h>
+#include "com/diag/obelisk/obelisk.h"
+
+/**
+ * These are the constants of the page.
+ */
+enum ObeliskPageConstants {
+    OBELISK_PAGE_MAGIC          = 0x57575650,   /* "WWVP" */
+    OBELISK_PAGE_VERSION        = 2,
+    OBELISK_PAGE_STALE          = 4,            /* Seconds until unknown. */
+};
+
+/**
+ * This is the default name of the page.
+ */
+#define OBELISK_PAGE_NAME "/wwvbtool"
+
+/**
+ * This is the clock on which the edge and the period are measured.
+ */
+#define OBELISK_PAGE_CLOCK CLOCK_MONOTONIC_RAW
+
+/**
+ * These are the lock states of the page.
+ */
+typedef enum ObeliskPageLock {
+    OBELISK_PAGE_LOCK_NONE      = 0,    /* Time is not known. */
+    OBELISK_PAGE_LOCK_ACQUIRED  = 1,    /* Time is from WWVB. */
+    OBELISK_PAGE_LOCK_HOLDOVER  = 2,    /* Time is from holdover. */
+} obelisk_page_lock_t;
+
+/**
+ * This structure describes the state of the clock.
+ */
+typedef struct ObeliskPageData {
+    int64_t edge;                   /* OBELISK_PAGE_CLOCK ns of the last second edge. */
+    int64_t seconds;                /* Seconds since the Epoch at that edge. */
+    double period;                  /* OBELISK_PAGE_CLOCK ns per second. */
+    int64_t uncertainty;            /* ns at that edge, or -1 if unknown. */
+    int64_t residual;               /* Mean ns of the system clock ahead of WWVB. */
+    int64_t pps;                    /* Mean ns PPS is raised after the edge. */
+    obelisk_buffer_t frame;         /* Most recent decoded frame. */
+    int32_t lock;                   /* obelisk_page_lock_t. */
+    int32_t leap;                   /* !0 if a leap second ends this month. */
+    int32_t dst;                    /* obelisk_dst_t. */
+    int32_t dut1;                   /* UT1 minus UTC in tenths of a second. */
+} obelisk_page_data_t;
+
+/**
+ * This is the layout of the page.
+ */
+typedef struct ObeliskPage {
+    uint32_t magic;                 /* OBELISK_PAGE_MAGIC. */
+    uint32_t version;               /* OBELISK_PAGE_VERSION. */
+    uint32_t sequence;              /* Odd while the data is changing. */
+    uint32_t reserved;
+    obelisk_page_data_t data;
+} obelisk_page_t;
+
+/**
+ * Create (or reuse) and map the page read and write for the writer.
+ * @param name is the name of the POSIX shared memory object.
+ * @return a pointer to the page, or NULL with errno set if an error
+ * occurred.
+ */
+extern obelisk_page_t * obelisk_page_create(const char * name);
+
+/**
+ * Publish the state of the clock.
+ * @param pp points to the page.
+ * @param dp points to the state.
+ */
+extern void obelisk_page_publish(obelisk_page_t * pp, const obelisk_page_data_t * dp);
+
+/**
+ * Unmap and remove the page.
+ * @param pp points to the page.
+ * @param name is the name of the POSIX shared memory object.
+ * @return 0 for success, <0 with errno set if an error occurred.
+ */
+extern int obelisk_page_destroy(obelisk_page_t * pp, const char * name);
+
+/**
+ * Map the page read only for a reader.
+ * @param name is the name of the POSIX shared memory object.
+ * @return a pointer to the page, or NULL with errno set if an error
+ * occurred, including EPROTO if it isn't a page this reader understands.
+ */
+static inline const obelisk_page_t * obelisk_page_map(const char * name)
+{
+    const obelisk_page_t * pp = (const obelisk_page_t *)0;
+    void * address = MAP_FAILED;
+    int fd = -1;
+
+    if ((fd = shm_open(name, O_RDONLY, 0)) < 0) {
+        /* Do nothing. */
+    } else if ((address = mmap((void *)0, sizeof(obelisk_page_t), PROT_READ, MAP_SHARED, fd, 0)) == MAP_FAILED) {
+        (void)close(fd);
+    } else if (((const obelisk_page_t *)address)->magic != OBELISK_PAGE_MAGIC) {
+        (void)munmap(address, sizeof(obelisk_page_t));
+        (void)close(fd);
+        errno = EPROTO;
+    } else if (((const obelisk_page_t *)address)->version != OBELISK_PAGE_VERSION) {
+        (void)munmap(address, sizeof(obelisk_page_t));
+        (void)close(fd);
+        errno = EPROTO;
+    } else {
+        (void)close(fd);
+        pp = (const obelisk_page_t *)address;
+    }
+
+    return pp;
+}
+
+/**
+ * Unmap the page for a reader.
+ * @param pp points to the page.
+ * @return 0 for success, <0 with errno set if an error occurred.
+ */
+static inline int obelisk_page_unmap(const obelisk_page_t * pp)
+{
+    return munmap((void *)pp, sizeof(obelisk_page_t));
+}
+
+/**
+ * Copy a consistent snapshot of the state of the clock.
+ * @param pp points to the page.
+ * @param dp points to where the state is copied.
+ */
+static inline void obelisk_page_snapshot(const obelisk_page_t * pp, obelisk_page_data_t * dp)
+{
+    uint32_t before = 0;
+    uint32_t after = 0;
+
+    do {
+        before = __atomic_load_n(&pp->sequence, __ATOMIC_ACQUIRE);
+        memcpy(dp, (const void *)&pp->data, sizeof(*dp));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        after = __atomic_load_n(&pp->sequence, __ATOMIC_RELAXED);
+    } while (((before & 1) != 0) || (before != after));
+}
+
+/**
+ * Read the WWVB time now.
+ * @param pp points to the page.
+ * @param timep points to where the time is stored.
+ * @param dp points to where the state of the clock is copied, or is NULL.
+ * @return the lock state, OBELISK_PAGE_LOCK_NONE (which is zero) if the
+ * time is unknown, in which case the time isn't stored.
+ */
+static inline obelisk_page_lock_t obelisk_page_time(const obelisk_page_t * pp, struct timespec * timep, obelisk_page_data_t * dp)
+{
+    obelisk_page_lock_t lock = OBELISK_PAGE_LOCK_NONE;
+    obelisk_page_data_t data;
+    struct timespec now;
+    int64_t elapsed = -1;
+    int64_t fraction = 0;
+
+    if (dp == (obelisk_page_data_t *)0) {
+        dp = &data;
+    }
+
+    obelisk_page_snapshot(pp, dp);
+
+    if (dp->lock == OBELISK_PAGE_LOCK_NONE) {
+        /* Do nothing. */
+    } else if (dp->period <= 0.0) {
+        /* Do nothing. */
+    } else if (clock_gettime(OBELISK_PAGE_CLOCK, &now) < 0) {
+        /* Do nothing. */
+    } else {
+        elapsed = ((now.tv_sec * 1000000000LL) + now.tv_nsec) - dp->edge;
+    }
+
+    if (elapsed < 0) {
+        /* Do nothing. */
+    } else if (elapsed > (OBELISK_PAGE_STALE * dp->period)) {
+        /* Do nothing. */
+    } else {
+        fraction = elapsed * (1000000000.0 / dp->period);
+        timep->tv_sec = dp->seconds + (fraction / 1000000000LL);
+        timep->tv_nsec = fraction % 1000000000LL;
+        lock = (obelisk_page_lock_t)dp->lock;
+    }
+
+    return lock;
+}
+
+#endif /*  _COM_DIAG_OBELISK_OBELISK_PAGE_H_ */
@@ -0,0 +1,110 @@
+/* vim: set ts=4 expandtab shiftwidth=4: */
+#ifndef _COM_DIAG_OBELISK_OBELISK_PLL_H_
+#define _COM_DIAG_OBELISK_OBELISK_PLL_H_
+
+/**
+ * @file
+ *
+ * Copyright 2018 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in LICENSE.txt<BR>
+ * Chip Overclock<BR>
+ * mailto:coverclock@diag.com<BR>
+ * http://github.com/coverclock/com-diag-obelisk<BR>
+ *
+ * The rising edge of each WWVB pulse is measured only as well as the
+ * receiver, the debouncer, and the sampling timer allow, which is to
+ * within tens of milliseconds. This loop tracks those edges against a
+ * local monotonic clock and maintains a smoothed estimate of when each
+ * second begins (its phase) and how long a second is on the local clock
+ * (its frequency). For its first time constant it locks frequency by
+ * averaging the interval since the first edge; after that it is a second
+ * order phase-locked loop whose time constant sets its bandwidth. Edges
+ * too far from where the loop expects them are rejected as outliers, and
+ * if too many are rejected in a row, the loop starts over.
+ *
+ * Times are in nanoseconds on whatever monotonic clock the caller uses,
+ * typically CLOCK_MONOTONIC_RAW so that the loop is not itself steered by
+ * the clock discipline.
+ */
+
+#include <stdint.h>
+
+/**
+ * These are the parameters of the loop.
+ */
+enum ObeliskPllConstants {
+    OBELISK_PLL_CONSTANT    = 16,           /* Default time constant in seconds. */
+    OBELISK_PLL_WARMUP      = 8,            /* Fewest edges used to lock frequency. */
+    OBELISK_PLL_CAPTURE     = 100000000,    /* Largest phase error ever accepted in ns. */
+    OBELISK_PLL_FLOOR       = 20000000,     /* Phase error always accepted in ns. */
+    OBELISK_PLL_OUTLIER     = 4,            /* Else reject beyond this many jitters. */
+    OBELISK_PLL_RESTART     = 8,            /* Start over after this many rejections. */
+    OBELISK_PLL_SECOND      = 1000000000,   /* Nominal second in ns. */
+    OBELISK_PLL_STABILITY   = 1000,         /* Assumed frequency wander in ns per second. */
+};
+
+/**
+ * This structure describes the state of the loop.
+ */
+typedef struct ObeliskPll {
+    int64_t phase;      /* Estimated most recent edge in ns. */
+    int64_t first;      /* First edge since the loop started in ns. */
+    double period;      /* Estimated local ns per second. */
+    double error;       /* Most recent phase error in ns. */
+    double jitter;      /* Smoothed magnitude of the phase error in ns. */
+    double kp;          /* Proportional gain. */
+    double ki;          /* Integral gain. */
+    int64_t seconds;    /* Seconds since the first edge. */
+    int count;          /* Edges accepted up to warmup. */
+    int warmup;         /* Edges used to lock frequency. */
+    int rejected;       /* Edges rejected in a row. */
+    int constant;       /* Time constant in seconds. */
+} obelisk_pll_t;
+
+/**
+ * Initialize the loop.
+ * @param pllp points to the loop.
+ * @param constant is the time constant in seconds (1 or more); larger
+ * is smoother but slower to follow changes.
+ */
+extern void obelisk_pll_init(obelisk_pll_t * pllp, int constant);
+
+/**
+ * Feed the time of a measured edge to the loop. Edges may be missing,
+ * but must be fed in order.
+ * @param pllp points to the loop.
+ * @param edge is the time of the edge in ns.
+ * @return 0 if the edge was accepted, >0 if it was rejected as an
+ * outlier, <0 if the loop started over from it.
+ */
+extern int obelisk_pll_update(obelisk_pll_t * pllp, int64_t edge);
+
+/**
+ * Return true if the loop has locked frequency and is tracking phase.
+ * @param pllp points to the loop.
+ * @return true if locked.
+ */
+extern int obelisk_pll_locked(const obelisk_pll_t * pllp);
+
+/**
+ * Return the estimated time of the most recent edge at or before a time.
+ * The estimate continues from the phase and frequency of the loop even
+ * if no edges are being fed to it.
+ * @param pllp points to the loop.
+ * @param now is a time in ns no earlier than the most recent edge.
+ * @return the time of the estimated edge in ns.
+ */
+extern int64_t obelisk_pll_edge(const obelisk_pll_t * pllp, int64_t now);
+
+/**
+ * Return an estimate of how far the edge returned by obelisk_pll_edge()
+ * may be from the true one. It starts at the jitter of the loop, and
+ * while no edges are accepted (for example, in holdover) it grows by the
+ * frequency wander assumed for an undisciplined local oscillator.
+ * @param pllp points to the loop.
+ * @param now is a time in ns no earlier than the most recent edge.
+ * @return the estimated error in ns.
+ */
+extern int64_t obelisk_pll_uncertainty(const obelisk_pll_t * pllp, int64_t now);
+
+#endif /*  _COM_DIAG_OBELISK_OBELISK_PLL_H_ */
@@ -0,0 +1,128 @@
+/* vim: set ts=4 expandtab shiftwidth=4: */
+#ifndef _COM_DIAG_OBELISK_OBELISK_PM_H_
+#define _COM_DIAG_OBELISK_OBELISK_PM_H_
+
+/**
+ * @file
+ *
+ * Copyright 2018 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in LICENSE.txt<BR>
+ * Chip Overclock<BR>
+ * mailto:coverclock@diag.com<BR>
+ * http://github.com/coverclock/com-diag-obelisk<BR>
+ *
+ * Besides the pulse width (AM) time code, WWVB binary phase shift keys
+ * its carrier with a second (PM) time code: one bit per second, a ZERO
+ * being the reference phase and a ONE being the inverted phase. This
+ * decoder accepts complex baseband I/Q samples, already mixed down from
+ * the 60KHz carrier and decimated, integrates them into one symbol per
+ * second, recovers the symbol timing and the carrier phase, finds the
+ * sync word at the start of each minute, and decodes the frame into the
+ * same obelisk_frame_t as the AM decoder, so obelisk_validate(),
+ * obelisk_decode(), and obelisk_revalidate() apply unchanged.
+ *
+ * The PM minute frame, as laid out in the NIST Enhanced WWVB Broadcast
+ * Format, is
+ *
+ *  :00 .. :12  sync_T, 0011101101000
+ *  :13 .. :17  time_par[4:0], Hamming (31,26) parity over time[25:0]
+ *  :18         time[25], minute of the century
+ *  :19         time[0]
+ *  :20 .. :28  time[24:16]
+ *  :29         reserved
+ *  :30 .. :38  time[15:7]
+ *  :39         reserved
+ *  :40 .. :45  time[6:1]
+ *  :46 .. :47  dst_ls[4:3], DST state and leap second warning
+ *  :48         notice (not decoded)
+ *  :49         reserved
+ *  :50 .. :52  dst_ls[2:0]
+ *  :53 .. :58  dst_next[5:0], DST schedule (not decoded)
+ *  :59         reserved
+ *
+ * using the same bit numbering as the AM buffer: the bit received at
+ * second N of the minute is bit 59 - N of an obelisk_buffer_t. The dst_ls
+ * code words are this decoder's own, not yet NIST's. Frames are found by
+ * sync_T alone; the 106-bit sync_M that starts the extended six minute
+ * frames every half hour is not used, since every minute carries sync_T
+ * and the time.
+ */
+
+#include <stdint.h>
+#include <complex.h>
+#include "com/diag/obelisk/obelisk.h"
+
+/**
+ * These are the parameters of the PM decoder.
+ */
+enum ObeliskPmConstants {
+    OBELISK_PM_SECONDS  = 60,   /* Symbols per frame. */
+    OBELISK_PM_SYNC     = 13,   /* Bits in the sync word. */
+    OBELISK_PM_ERRORS   = 1,    /* Sync word bit errors tolerated. */
+    OBELISK_PM_PHASES   = 10,   /* Symbol timing hypotheses per second. */
+    OBELISK_PM_WINDOW   = 4,    /* Symbols each side for carrier phase. */
+    OBELISK_PM_SMOOTHING = 16,  /* Symbols over which energy is smoothed. */
+};
+
+/**
+ * This structure describes the state of the PM demodulator. The caller
+ * does not need to know its contents except for the timing hypothesis
+ * currently believed to be aligned with the second, and the polarity of
+ * the carrier phase relative to the sync word.
+ */
+typedef struct ObeliskPm {
+    double complex symbol[OBELISK_PM_PHASES][OBELISK_PM_SECONDS];  /* Recent symbols. */
+    double complex sum[OBELISK_PM_PHASES];                          /* Integrating. */
+    double energy[OBELISK_PM_PHASES];                               /* Smoothed. */
+    int count[OBELISK_PM_PHASES];                                   /* Symbols held. */
+    int next[OBELISK_PM_PHASES];                                    /* Next slot. */
+    int samples;                                                    /* Per second. */
+    int sample;                                                     /* In second. */
+    int phase;                                                      /* Most energy. */
+    int polarity;                                                   /* +1 or -1. */
+} obelisk_pm_t;
+
+/**
+ * Initialize the PM demodulator.
+ * @param pmp points to the demodulator.
+ * @param samples_per_second is the sample rate of the I/Q input, which
+ * must be a multiple of OBELISK_PM_PHASES.
+ */
+extern void obelisk_pm_init(obelisk_pm_t * pmp, int samples_per_second);
+
+/**
+ * Feed one complex baseband sample to the PM demodulator. Every time a
+ * symbol completes on the timing hypothesis with the most energy, the
+ * most recent minute of symbols is checked for the sync word.
+ * @param pmp points to the demodulator.
+ * @param in_phase is the in-phase (I) component of the sample.
+ * @param quadrature is the quadrature (Q) component of the sample.
+ * @param bufferp points to the buffer into which the bits of a
+ * synchronized frame are stored.
+ * @return OBELISK_EVENT_FRAME if a frame was stored, OBELISK_EVENT_WAITING
+ * if not enough symbols have been received, OBELISK_EVENT_NOMINAL otherwise.
+ */
+extern obelisk_event_t obelisk_pm_sample(obelisk_pm_t * pmp, float in_phase, float quadrature, obelisk_buffer_t * bufferp);
+
+/**
+ * Decode a PM frame into the same frame structure the AM decoder produces.
+ * The time is corrected for up to one bit error. There is no dUT1 in the
+ * PM time code, so dUT1 is reported as +0.0.
+ * @param framep points to the output frame.
+ * @param buffer is the input buffer.
+ * @return the number of bits corrected (0 or 1) for success, <0 if the
+ * DST and leap second code is corrupt or the time is out of range.
+ */
+extern int obelisk_pm_decode(obelisk_frame_t * framep, obelisk_buffer_t buffer);
+
+/**
+ * Encode a PM frame. This is how the unit tests generate their synthetic
+ * I/Q test vectors.
+ * @param minutes is the minute of the century since 2000-01-01T00:00Z.
+ * @param dst is the DST state.
+ * @param lsw is true if a leap second is pending at the end of the month.
+ * @return the buffer.
+ */
+extern obelisk_buffer_t obelisk_pm_encode(int32_t minutes, obelisk_dst_t dst, int lsw);
+
+#endif /*  _COM_DIAG_OBELISK_OBELISK_PM_H_ */
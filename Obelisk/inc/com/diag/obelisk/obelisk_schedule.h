@@ -0,0 +1,86 @@
+/* vim: set ts=4 expandtab shiftwidth=4: */
+#ifndef _COM_DIAG_OBELISK_OBELISK_SCHEDULE_H_
+#define _COM_DIAG_OBELISK_OBELISK_SCHEDULE_H_
+
+/**
+ * @file
+ *
+ * Copyright 2018 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in LICENSE.txt<BR>
+ * Chip Overclock<BR>
+ * mailto:coverclock@diag.com<BR>
+ * http://github.com/coverclock/com-diag-obelisk<BR>
+ *
+ * These functions schedule an output for a predicted moment, typically
+ * the next second edge estimated by the software PLL. The wait is an
+ * absolute sleep armed early by a compensation for the latency of waking
+ * up and producing the output, which is learned from how far from the
+ * moment each output actually lands. The landings are also kept as
+ * statistics.
+ *
+ * Times are in nanoseconds on the caller's monotonic clock, typically
+ * CLOCK_MONOTONIC_RAW, which clock_nanosleep(2) can't sleep on; the sleep
+ * is done on CLOCK_MONOTONIC instead, offset to match.
+ */
+
+#include <stdint.h>
+
+/**
+ * These are the parameters of the schedule.
+ */
+enum ObeliskScheduleConstants {
+    OBELISK_SCHEDULE_GAIN       = 8,            /* Compensation learns 1/GAIN of each error. */
+    OBELISK_SCHEDULE_LIMIT      = 5000000,      /* Largest compensation in ns. */
+};
+
+/**
+ * This structure describes the state of the schedule.
+ */
+typedef struct ObeliskSchedule {
+    int64_t compensation;   /* How early to wake in ns. */
+    int64_t count;          /* Outputs landed. */
+    int64_t minimum;        /* Earliest landing in ns. */
+    int64_t maximum;        /* Latest landing in ns. */
+    double sum;             /* Sum of landings in ns. */
+    double squares;         /* Sum of squared landings in ns^2. */
+} obelisk_schedule_t;
+
+/**
+ * Initialize the schedule.
+ * @param sp points to the schedule.
+ */
+extern void obelisk_schedule_init(obelisk_schedule_t * sp);
+
+/**
+ * Sleep until shortly before a moment, early by the compensation.
+ * @param sp points to the schedule.
+ * @param moment is the moment in ns on the caller's monotonic clock.
+ * @param now is the current time in ns on the caller's monotonic clock.
+ * @return 0 for success, <0 with errno set if an error occurred.
+ */
+extern int obelisk_schedule_wait(const obelisk_schedule_t * sp, int64_t moment, int64_t now);
+
+/**
+ * Record when an output scheduled for a moment actually happened, and
+ * learn from it.
+ * @param sp points to the schedule.
+ * @param moment is the moment in ns.
+ * @param actual is when the output happened in ns.
+ */
+extern void obelisk_schedule_land(obelisk_schedule_t * sp, int64_t moment, int64_t actual);
+
+/**
+ * Return the mean landing relative to the moment.
+ * @param sp points to the schedule.
+ * @return the mean in ns (late is positive).
+ */
+extern double obelisk_schedule_mean(const obelisk_schedule_t * sp);
+
+/**
+ * Return the root mean square landing relative to the moment.
+ * @param sp points to the schedule.
+ * @return the RMS in ns.
+ */
+extern double obelisk_schedule_rms(const obelisk_schedule_t * sp);
+
+#endif /*  _COM_DIAG_OBELISK_OBELISK_SCHEDULE_H_ */
@@ -0,0 +1,115 @@
+/* vim: set ts=4 expandtab shiftwidth=4: */
+#ifndef _COM_DIAG_OBELISK_OBELISK_SHM_H_
+#define _COM_DIAG_OBELISK_OBELISK_SHM_H_
+
+/**
+ * @file
+ *
+ * Copyright 2018 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in LICENSE.txt<BR>
+ * Chip Overclock<BR>
+ * mailto:coverclock@diag.com<BR>
+ * http://github.com/coverclock/com-diag-obelisk<BR>
+ *
+ * These functions write samples to the System V shared memory segment
+ * read by the ntpd SHM reference clock driver (type 28), the same segment
+ * gpsd writes, so that wwvbtool can feed ntpd directly. Each unit has its
+ * own segment whose key is "NTP0" plus the unit number; by ntpd convention
+ * units 0 and 1 are accessible only by root. Samples are written using
+ * mode 1 of the driver: the count is bumped before and after the fields
+ * are written, so that a reader can tell if it raced the writer.
+ *
+ * REFERENCES
+ *
+ * ntpd, ntpd/refclock_shm.c
+ *
+ * gpsd, ntpshmwrite.c
+ */
+
+#include <stdint.h>
+#include <time.h>
+#include <sys/types.h>
+
+/**
+ * These are the constants of the driver.
+ */
+enum ObeliskShmConstants {
+    OBELISK_SHM_KEY             = 0x4e545030,   /* "NTP0" */
+    OBELISK_SHM_PRIVATE         = 2,            /* Units below this are for root only. */
+    OBELISK_SHM_MODE            = 1,            /* Use the count to detect races. */
+};
+
+/**
+ * These are the leap indicators of NTP.
+ */
+typedef enum ObeliskShmLeap {
+    OBELISK_SHM_LEAP_NOWARNING  = 0,
+    OBELISK_SHM_LEAP_ADDSECOND  = 1,
+    OBELISK_SHM_LEAP_DELSECOND  = 2,
+    OBELISK_SHM_LEAP_NOTINSYNC  = 3,
+} obelisk_shm_leap_t;
+
+/**
+ * This is the layout of the segment, which must match struct shmTime in
+ * the driver exactly.
+ */
+typedef struct ObeliskShm {
+    int mode;                           /* 0 or 1. */
+    volatile int count;                 /* Bumped before and after writing. */
+    time_t clockTimeStampSec;           /* Reference time. */
+    int clockTimeStampUSec;
+    time_t receiveTimeStampSec;         /* System time of the reference time. */
+    int receiveTimeStampUSec;
+    int leap;                           /* obelisk_shm_leap_t. */
+    int precision;                      /* Log2 of precision in seconds. */
+    int nsamples;                       /* Unused. */
+    volatile int valid;                 /* True when a new sample is ready. */
+    unsigned clockTimeStampNSec;        /* Nanoseconds of reference time. */
+    unsigned receiveTimeStampNSec;      /* Nanoseconds of system time. */
+    int dummy[8];                       /* Reserved. */
+} obelisk_shm_t;
+
+/**
+ * Attach to the segment of a unit, creating it if necessary.
+ * @param unit is the unit number of the reference clock in ntp.conf.
+ * @return a pointer to the segment, or NULL with errno set if an error
+ * occurred.
+ */
+extern obelisk_shm_t * obelisk_shm_attach(int unit);
+
+/**
+ * Detach from a segment.
+ * @param shmp points to the segment.
+ * @return 0 for success, <0 with errno set if an error occurred.
+ */
+extern int obelisk_shm_detach(obelisk_shm_t * shmp);
+
+/**
+ * Return the precision (log2 of seconds) that ntpd expects for an error.
+ * @param nanoseconds is the error in ns.
+ * @return the smallest power of two in seconds at least as large.
+ */
+extern int obelisk_shm_precision(int64_t nanoseconds);
+
+/**
+ * Post a sample to a segment.
+ * @param shmp points to the segment.
+ * @param clockp points to the reference time.
+ * @param receivep points to the system time at the reference time.
+ * @param leap is the leap indicator.
+ * @param precision is the precision.
+ */
+extern void obelisk_shm_post(obelisk_shm_t * shmp, const struct timespec * clockp, const struct timespec * receivep, obelisk_shm_leap_t leap, int precision);
+
+/**
+ * Fetch a sample from a segment as the driver does, consuming it.
+ * @param shmp points to the segment.
+ * @param clockp points to where the reference time is stored.
+ * @param receivep points to where the system time is stored.
+ * @param leapp points to where the leap indicator is stored.
+ * @return 0 if a sample was fetched, >0 if none was ready, <0 if the
+ * writer was caught in the middle of posting one.
+ */
+extern int obelisk_shm_fetch(obelisk_shm_t * shmp, struct timespec * clockp, struct timespec * receivep, obelisk_shm_leap_t * leapp);
+
+#endif /*  _COM_DIAG_OBELISK_OBELISK_SHM_H_ */
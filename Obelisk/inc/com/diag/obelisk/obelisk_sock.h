@@ -0,0 +1,91 @@
+/* vim: set ts=4 expandtab shiftwidth=4: */
+#ifndef _COM_DIAG_OBELISK_OBELISK_SOCK_H_
+#define _COM_DIAG_OBELISK_OBELISK_SOCK_H_
+
+/**
+ * @file
+ *
+ * Copyright 2018 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in LICENSE.txt<BR>
+ * Chip Overclock<BR>
+ * mailto:coverclock@diag.com<BR>
+ * http://github.com/coverclock/com-diag-obelisk<BR>
+ *
+ * These functions send samples to the chronyd SOCK reference clock driver,
+ * which binds a UNIX domain datagram socket and reads one struct
+ * sock_sample from each datagram. A sample is the offset of the true time
+ * from the system time at some moment. A pulse sample knows only where the
+ * second begins, not which second it is, so its offset is within half a
+ * second and chronyd needs another source to number the seconds.
+ *
+ * REFERENCES
+ *
+ * chrony, refclock_sock.c
+ */
+
+#include <sys/time.h>
+#include <time.h>
+
+/**
+ * These are the constants of the driver.
+ */
+enum ObeliskSockConstants {
+    OBELISK_SOCK_MAGIC          = 0x534f434b,   /* "SOCK" */
+};
+
+/**
+ * These are the leap indicators of the driver.
+ */
+typedef enum ObeliskSockLeap {
+    OBELISK_SOCK_LEAP_NORMAL    = 0,
+    OBELISK_SOCK_LEAP_INSERT    = 1,
+    OBELISK_SOCK_LEAP_DELETE    = 2,
+} obelisk_sock_leap_t;
+
+/**
+ * This is the layout of a sample, which must match struct sock_sample in
+ * the driver exactly.
+ */
+typedef struct ObeliskSockSample {
+    struct timeval tv;      /* System time of the sample. */
+    double offset;          /* True time minus system time in seconds. */
+    int pulse;              /* True if only the second edge is known. */
+    int leap;               /* obelisk_sock_leap_t. */
+    int _pad;
+    int magic;              /* OBELISK_SOCK_MAGIC. */
+} obelisk_sock_sample_t;
+
+/**
+ * Open a socket to the driver.
+ * @param path is the path of the socket bound by chronyd.
+ * @return a socket, or <0 with errno set if an error occurred.
+ */
+extern int obelisk_sock_open(const char * path);
+
+/**
+ * Close a socket to the driver.
+ * @param sock is the socket.
+ * @return 0 for success, <0 with errno set if an error occurred.
+ */
+extern int obelisk_sock_close(int sock);
+
+/**
+ * Prepare a sample.
+ * @param samplep points to the sample.
+ * @param systemp points to the system time of the sample.
+ * @param referencep points to the true time at that system time, or is
+ * NULL for a pulse sample, for which the system time is on a second edge.
+ * @param leap is the leap indicator.
+ */
+extern void obelisk_sock_prepare(obelisk_sock_sample_t * samplep, const struct timespec * systemp, const struct timespec * referencep, obelisk_sock_leap_t leap);
+
+/**
+ * Send a sample to the driver.
+ * @param sock is the socket.
+ * @param samplep points to the sample.
+ * @return the size of the sample, or <0 with errno set if an error
+ * occurred, for example if chronyd isn't running.
+ */
+extern int obelisk_sock_send(int sock, const obelisk_sock_sample_t * samplep);
+
+#endif /*  _COM_DIAG_OBELISK_OBELISK_SOCK_H_ */
@@ -0,0 +1,131 @@
+/* vim: set ts=4 expandtab shiftwidth=4: */
+#ifndef _COM_DIAG_OBELISK_OBELISK_STABILITY_H_
+#define _COM_DIAG_OBELISK_OBELISK_STABILITY_H_
+
+/**
+ * @file
+ *
+ * Copyright 2018 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in LICENSE.txt<BR>
+ * Chip Overclock<BR>
+ * mailto:coverclock@diag.com<BR>
+ * http://github.com/coverclock/com-diag-obelisk<BR>
+ *
+ * These functions characterize the stability of the second edges as
+ * measured against a local clock, online and in bounded memory, using the
+ * usual statistics: the overlapping Allan deviation (ADEV), the time
+ * deviation (TDEV), and the maximum time interval error (MTIE), each at
+ * taus of 1, 2, 4, and so on up to 2048 seconds. At short taus these are
+ * dominated by the jitter of the receiver and of the sampling, at long
+ * taus by the wander of the local oscillator, so where the curves turn
+ * over shows which of the two limits the timing.
+ *
+ * Each second, the edge is reduced to a phase sample: how far it is from
+ * where it would be if every second on the local clock were exactly one
+ * second long since the first edge. Adding a sample costs a constant
+ * amount of work for each tau.
+ */
+
+#include <stdint.h>
+
+/**
+ * These are the parameters of the analysis.
+ */
+enum ObeliskStabilityConstants {
+    OBELISK_STABILITY_TAUS      = 12,           /* Taus of 1, 2, 4, ... 2048 seconds. */
+    OBELISK_STABILITY_SAMPLES   = 8192,         /* Power of two more than three times the largest tau. */
+    OBELISK_STABILITY_DEQUES    = (1 << OBELISK_STABILITY_TAUS) - 1 + OBELISK_STABILITY_TAUS,
+    OBELISK_STABILITY_CAPTURE   = 100000000,    /* Largest edge error ever accepted in ns. */
+    OBELISK_STABILITY_GAP       = 60,           /* Longest gap filled in seconds. */
+    OBELISK_STABILITY_SECOND    = 1000000000,   /* Nominal second in ns. */
+};
+
+/**
+ * This structure accumulates the statistics for one tau. The deques hold
+ * the indices of the samples that may yet be the largest and smallest in
+ * the window of the tau.
+ */
+typedef struct ObeliskStabilityTau {
+    double adev;        /* Sum of squared second differences in ns^2. */
+    double tdev;        /* Sum of squared summed second differences in ns^2. */
+    int64_t mtie;       /* Largest peak to peak phase in any window in ns. */
+    int64_t adevs;      /* Terms in adev. */
+    int64_t tdevs;      /* Terms in tdev. */
+    int maxhead;        /* Front of the deque of maxima. */
+    int maxcount;       /* Length of the deque of maxima. */
+    int minhead;        /* Front of the deque of minima. */
+    int mincount;       /* Length of the deque of minima. */
+} obelisk_stability_tau_t;
+
+/**
+ * This structure describes the state of the analysis.
+ */
+typedef struct ObeliskStability {
+    int64_t phase[OBELISK_STABILITY_SAMPLES];   /* Ring of phase samples in ns. */
+    uint64_t sum[OBELISK_STABILITY_SAMPLES];    /* Ring of (wrapping) prefix sums of phase. */
+    int64_t maxima[OBELISK_STABILITY_DEQUES];   /* Deques of indices of maxima for all taus. */
+    int64_t minima[OBELISK_STABILITY_DEQUES];   /* Deques of indices of minima for all taus. */
+    obelisk_stability_tau_t tau[OBELISK_STABILITY_TAUS];
+    int64_t samples;    /* Phase samples so far. */
+    int64_t origin;     /* First edge in ns. */
+    int64_t last;       /* Most recent edge in ns. */
+    int64_t seconds;    /* Seconds from the first edge to the most recent. */
+} obelisk_stability_t;
+
+/**
+ * Initialize the analysis, discarding any samples.
+ * @param sp points to the analysis.
+ */
+extern void obelisk_stability_init(obelisk_stability_t * sp);
+
+/**
+ * Add the next phase sample, one second after the previous one.
+ * @param sp points to the analysis.
+ * @param phase is the phase in ns.
+ */
+extern void obelisk_stability_sample(obelisk_stability_t * sp, int64_t phase);
+
+/**
+ * Add a measured edge. Edges that are not about a whole number of seconds
+ * after the previous one are rejected as glitches. Short gaps are filled
+ * by interpolating the phase across them; after longer ones, the analysis
+ * starts over.
+ * @param sp points to the analysis.
+ * @param edge is the time of the edge in ns on the local clock.
+ * @return 0 if the edge was added, >0 if it was rejected, <0 if the
+ * analysis started over from it.
+ */
+extern int obelisk_stability_edge(obelisk_stability_t * sp, int64_t edge);
+
+/**
+ * Return the tau in seconds of an index.
+ * @param index is an index from 0 to OBELISK_STABILITY_TAUS - 1.
+ * @return the tau in seconds.
+ */
+extern int obelisk_stability_tau(int index);
+
+/**
+ * Return the overlapping Allan deviation at a tau.
+ * @param sp points to the analysis.
+ * @param index is an index from 0 to OBELISK_STABILITY_TAUS - 1.
+ * @return the deviation (dimensionless), or <0 if not enough samples.
+ */
+extern double obelisk_stability_adev(const obelisk_stability_t * sp, int index);
+
+/**
+ * Return the time deviation at a tau.
+ * @param sp points to the analysis.
+ * @param index is an index from 0 to OBELISK_STABILITY_TAUS - 1.
+ * @return the deviation in ns, or <0 if not enough samples.
+ */
+extern double obelisk_stability_tdev(const obelisk_stability_t * sp, int index);
+
+/**
+ * Return the maximum time interval error at a tau.
+ * @param sp points to the analysis.
+ * @param index is an index from 0 to OBELISK_STABILITY_TAUS - 1.
+ * @return the error in ns, or <0 if not enough samples.
+ */
+extern int64_t obelisk_stability_mtie(const obelisk_stability_t * sp, int index);
+
+#endif /*  _COM_DIAG_OBELISK_OBELISK_STABILITY_H_ */
@@ -0,0 +1,104 @@
+/* vim: set ts=4 expandtab shiftwidth=4: */
+#ifndef _COM_DIAG_OBELISK_OBELISK_TABLE_H_
+#define _COM_DIAG_OBELISK_OBELISK_TABLE_H_
+
+/**
+ * @file
+ *
+ * Copyright 2018 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in LICENSE.txt<BR>
+ * Chip Overclock<BR>
+ * mailto:coverclock@diag.com<BR>
+ * http://github.com/coverclock/com-diag-obelisk<BR>
+ *
+ * A frame table holds the buffer WWVB transmits during every minute of a
+ * year, 525,600 of them or 527,040 in a leap year, following a small
+ * header. It contains no pointers, so it can be written to a file and
+ * mapped back into memory as is. Looking up the frame for a time, or
+ * the time of a frame, is a matter of indexing it.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+#include "com/diag/obelisk/obelisk.h"
+
+/**
+ * These are the constants of the frame table header.
+ */
+enum ObeliskTableConstants {
+    OBELISK_TABLE_MAGIC     = 0x4f424c4b,   /* "OBLK" */
+    OBELISK_TABLE_VERSION   = 1,
+};
+
+/**
+ * This structure describes a frame table. The frames are in native byte
+ * order, which the magic number reveals.
+ */
+typedef struct ObeliskTable {
+    uint32_t magic;             /* OBELISK_TABLE_MAGIC */
+    uint16_t version;           /* OBELISK_TABLE_VERSION */
+    uint16_t year;              /* e.g. 2018 */
+    uint32_t minutes;           /* Frames that follow. */
+    int32_t dut1;               /* Tenths of a second. */
+    int64_t first;              /* Epoch of the first frame. */
+    obelisk_buffer_t frame[];   /* One per minute. */
+} obelisk_table_t;
+
+/**
+ * Return the DST status that WWVB transmits on a day of the year under
+ * the United States rules in effect since 2007: DST begins on the second
+ * Sunday in March and ends on the first Sunday in November.
+ * @param year is the fully qualified year.
+ * @param day is the Julian day of the year [1..365 or 366].
+ * @return the DST status.
+ */
+extern obelisk_dst_t obelisk_table_dst(int year, int day);
+
+/**
+ * Return the size of the frame table for a year.
+ * @param year is the fully qualified year.
+ * @return the size in bytes.
+ */
+extern size_t obelisk_table_size(int year);
+
+/**
+ * Generate the frame table for a year. The DST status follows
+ * obelisk_table_dst(), and dUT1 is the same throughout.
+ * @param tablep points to the table.
+ * @param size is the size of the table in bytes.
+ * @param year is the fully qualified year.
+ * @param dut1 is UT1 - UTC in tenths of a second [-9..+9].
+ * @param month is the month [1..12] at whose end a leap second is
+ * inserted, or zero if none.
+ * @return >=0 for success, <0 if the table is too small.
+ */
+extern int obelisk_table_generate(obelisk_table_t * tablep, size_t size, int year, int dut1, int month);
+
+/**
+ * Check that a table, perhaps one just mapped from a file, is intact.
+ * @param tablep points to the table.
+ * @param size is the size of the table in bytes.
+ * @return >=0 if the table is usable, <0 otherwise.
+ */
+extern int obelisk_table_check(const obelisk_table_t * tablep, size_t size);
+
+/**
+ * Look up the frame transmitted during the minute containing a time.
+ * @param tablep points to the table.
+ * @param epoch is the time in seconds since the POSIX epoch.
+ * @param bufferp points to where the buffer is stored.
+ * @return >=0 for success, <0 if the time is not in the table.
+ */
+extern int obelisk_table_frame(const obelisk_table_t * tablep, time_t epoch, obelisk_buffer_t * bufferp);
+
+/**
+ * Look up the time at which a frame was transmitted, which is the start
+ * of the minute, provided every field of the frame matches the table.
+ * @param tablep points to the table.
+ * @param buffer is the buffer.
+ * @return the seconds since the POSIX epoch, or -1 if it isn't in the table.
+ */
+extern time_t obelisk_table_epoch(const obelisk_table_t * tablep, obelisk_buffer_t buffer);
+
+#endif /*  _COM_DIAG_OBELISK_OBELISK_TABLE_H_ */
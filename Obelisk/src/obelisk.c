@@ -12,9 +12,11 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <time.h>
 #include <assert.h>
 #include "com/diag/obelisk/obelisk.h"
 #include "obelisk.h"
+#include "obelisk_calendar.h"
 
 #define countof(_ARRAY_) (sizeof(_ARRAY_) / sizeof(_ARRAY_[0]))
 
@@ -373,28 +375,18 @@ obelisk_event_t obelisk_parse(obelisk_state_t * statep, obelisk_token_t token, i
     return event;
 }
 
-static const int8_t DAYS[2][12] = {
-/*    JAN FEB MAR APR MAY JUN JUL AUG SEP OCT NOV DEC */
-    {  31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 },    /* !LYI */
-    {  31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 },    /* LYI */
-};
-
 /*
  * Exposed for unit testing.
  */
 int obelisk_julian2gregorian(int julian, int lyi, int * monthp, int * dayp) {
     int rc = -1;
 
-    if (julian > 0) {
-        for (int month = 0; month < countof(DAYS[0]); ++month) {
-            if (julian <= DAYS[lyi][month]) {
-                *monthp = month + 1;
-                *dayp = julian;
-                rc = 0;
-                break;
-            }
-            julian -= DAYS[lyi][month];
-        }
+    if (!((0 <= lyi) && (lyi < countof(OBELISK_CALENDAR_CUMULATIVE)))) {
+        /* Do nothing. */
+    } else if ((0 < julian) && (julian <= OBELISK_CALENDAR_CUMULATIVE[lyi][12])) {
+        *monthp = OBELISK_CALENDAR_MONTH[lyi][julian];
+        *dayp = OBELISK_CALENDAR_DAY[lyi][julian];
+        rc = 0;
     }
 
     return rc;
@@ -425,22 +417,36 @@ obelisk_zeller_t obelisk_zeller(int year, int month, int day)
     int m = -1;
     int d = -1;
 
-    /*
-     * Reference:   C. Overclock, Date::weekday, Date.cpp,
-     *              https://github.com/coverclock/com-diag-grandote,
-     *              2017-09-27
-     *
-     * Reference:   Wikipedia, "Zeller's congruence",
-     *              https://en.wikipedia.org/wiki/Zeller%27s_congruence,
-     *              2017-08-31
-     */
-    ye = ((year - 1) % 400) + 1;
-    a = (14 - month) / 12;
-    y = ye - a;
-    m = month + (12 * a) - 2;
-    d = day + y + (y / 4) - (y / 100) + (y / 400) + ((31 * m) / 12);
+    if ((2017 <= year) && (year <= 2116) && (1 <= month) && (month <= 12) && (1 <= day) && (day <= 31)) {
+
+        /*
+         * Within the century obelisk_decode() uses, this is just the day of
+         * the week of the first of January offset by the day of the year.
+         */
+
+        index = (OBELISK_CALENDAR_WEEKDAY[year % 100] + OBELISK_CALENDAR_CUMULATIVE[OBELISK_CALENDAR_LEAP(year)][month - 1] + day - 1) % 7;
+
+    } else {
+
+        /*
+         * Reference:   C. Overclock, Date::weekday, Date.cpp,
+         *              https://github.com/coverclock/com-diag-grandote,
+         *              2017-09-27
+         *
+         * Reference:   Wikipedia, "Zeller's congruence",
+         *              https://en.wikipedia.org/wiki/Zeller%27s_congruence,
+         *              2017-08-31
+         */
+        ye = ((year - 1) % 400) + 1;
+        a = (14 - month) / 12;
+        y = ye - a;
+        m = month + (12 * a) - 2;
+        d = day + y + (y / 4) - (y / 100) + (y / 400) + ((31 * m) / 12);
+
+        index = (((((d % 7) + 6) % 7) + 1) % 7);
+
+    }
 
-    index = (((((d % 7) + 6) % 7) + 1) % 7);
     assert((0 <= index) && (index < countof(ZELLER)));
 
     return ZELLER[index];
@@ -481,6 +487,33 @@ int obelisk_validate(const obelisk_frame_t * framep)
     return rc;
 }
 
+#define OBELISK_FAILED(_CARRIES_, _FIELD_) ((int)(((_CARRIES_) & OBELISK_CARRY(_FIELD_)) / OBELISK_CARRY(_FIELD_)) * OBELISK_FAILURE_ ## _FIELD_)
+
+int obelisk_verify(obelisk_buffer_t buffer)
+{
+    obelisk_buffer_t carries = 0;
+    obelisk_buffer_t sign = 0;
+
+    carries = ((buffer & OBELISK_DIGITS) + OBELISK_BIASES) & OBELISK_CARRIES;
+
+    /*
+     * The dUT1 sign is valid only as 0b010 or 0b101: the outer bits are
+     * the same and the middle bit is different. A mismatch is moved to
+     * where a carry out of the field would be.
+     */
+
+    sign = (buffer >> OBELISK_OFFSET_DUTONESIGN) & OBELISK_MASK_DUTONESIGN;
+    sign = ((sign ^ (sign >> 2)) | ~(sign ^ (sign >> 1))) & 1;
+    carries |= sign * OBELISK_CARRY(DUTONESIGN);
+
+    return
+        OBELISK_FAILED(carries, MINUTES10) | OBELISK_FAILED(carries, MINUTES1) |
+        OBELISK_FAILED(carries, HOURS10) | OBELISK_FAILED(carries, HOURS1) |
+        OBELISK_FAILED(carries, DAY100) | OBELISK_FAILED(carries, DAY10) | OBELISK_FAILED(carries, DAY1) |
+        OBELISK_FAILED(carries, DUTONESIGN) | OBELISK_FAILED(carries, DUTONE1) |
+        OBELISK_FAILED(carries, YEAR10) | OBELISK_FAILED(carries, YEAR1);
+}
+
 int obelisk_decode(struct tm * timep, const obelisk_frame_t * framep)
 {
     int rc = -1;
@@ -510,6 +543,132 @@ int obelisk_decode(struct tm * timep, const obelisk_frame_t * framep)
     return rc;
 }
 
+time_t obelisk_epoch(obelisk_buffer_t buffer)
+{
+    time_t epoch = -1;
+    int year = -1;
+    int leap = -1;
+    int day = -1;
+    int hour = -1;
+    int minute = -1;
+
+    year = (OBELISK_EXTRACT(buffer, YEAR10) * 10) + OBELISK_EXTRACT(buffer, YEAR1);
+    day = (OBELISK_EXTRACT(buffer, DAY100) * 100) + (OBELISK_EXTRACT(buffer, DAY10) * 10) + OBELISK_EXTRACT(buffer, DAY1);
+    hour = (OBELISK_EXTRACT(buffer, HOURS10) * 10) + OBELISK_EXTRACT(buffer, HOURS1);
+    minute = (OBELISK_EXTRACT(buffer, MINUTES10) * 10) + OBELISK_EXTRACT(buffer, MINUTES1);
+    leap = OBELISK_CALENDAR_LEAP(OBELISK_CALENDAR_YEAR(year));
+
+    if (!((0 <= year) && (year < countof(OBELISK_YEARDAYS)))) {
+        /* Do nothing. */
+    } else if (!((1 <= day) && (day <= OBELISK_CALENDAR_CUMULATIVE[leap][12]))) {
+        /* Do nothing. */
+    } else if (!((0 <= hour) && (hour <= 23))) {
+        /* Do nothing. */
+    } else if (!((0 <= minute) && (minute <= 59))) {
+        /* Do nothing. */
+    } else {
+        epoch = OBELISK_YEARDAYS[year];
+        epoch += day - 1;
+        epoch *= 24;
+        epoch += hour;
+        epoch *= 60;
+        epoch += minute;
+        epoch *= 60;
+    }
+
+    return epoch;
+}
+
+int obelisk_timespec(struct timespec * timep, int * leapp, obelisk_dst_t * dstp, obelisk_buffer_t buffer)
+{
+    int rc = -1;
+    time_t epoch = -1;
+    int year = -1;
+    int day = -1;
+    int leap = 0;
+
+    assert(timep != (struct timespec *)0);
+
+    epoch = obelisk_epoch(buffer);
+    if (epoch >= 0) {
+
+        timep->tv_sec = epoch;
+        timep->tv_nsec = 0;
+
+        /*
+         * A leap second is inserted after 23:59:59 on the last day of the
+         * month during which the warning is set.
+         */
+
+        if (!OBELISK_EXTRACT(buffer, LSW)) {
+            /* Do nothing. */
+        } else if ((epoch % (24 * 60 * 60)) != ((23 * 60 * 60) + (59 * 60))) {
+            /* Do nothing. */
+        } else {
+            year = (OBELISK_EXTRACT(buffer, YEAR10) * 10) + OBELISK_EXTRACT(buffer, YEAR1);
+            day = (OBELISK_EXTRACT(buffer, DAY100) * 100) + (OBELISK_EXTRACT(buffer, DAY10) * 10) + OBELISK_EXTRACT(buffer, DAY1);
+            for (int mm = 1; mm < countof(OBELISK_CALENDAR_CUMULATIVE[0]); ++mm) {
+                if (day == OBELISK_CALENDAR_CUMULATIVE[OBELISK_CALENDAR_LEAP(OBELISK_CALENDAR_YEAR(year))][mm]) {
+                    leap = !0;
+                    break;
+                }
+            }
+        }
+
+        if (leapp != (int *)0) {
+            *leapp = leap;
+        }
+
+        if (dstp != (obelisk_dst_t *)0) {
+            *dstp = OBELISK_EXTRACT(buffer, DST);
+        }
+
+        rc = 0;
+
+    }
+
+    return rc;
+}
+
+obelisk_buffer_t obelisk_compose(int year, int day, int hour, int minute, int dut1, int lyi, int lsw, obelisk_dst_t dst)
+{
+    obelisk_buffer_t buffer = 0;
+
+    assert((-9 <= dut1) && (dut1 <= 9));
+
+    buffer = OBELISK_INSERT(buffer, MINUTES10, minute / 10);
+    buffer = OBELISK_INSERT(buffer, MINUTES1, minute % 10);
+    buffer = OBELISK_INSERT(buffer, HOURS10, hour / 10);
+    buffer = OBELISK_INSERT(buffer, HOURS1, hour % 10);
+    buffer = OBELISK_INSERT(buffer, DAY100, day / 100);
+    buffer = OBELISK_INSERT(buffer, DAY10, (day % 100) / 10);
+    buffer = OBELISK_INSERT(buffer, DAY1, day % 10);
+    buffer = OBELISK_INSERT(buffer, DUTONESIGN, (dut1 < 0) ? OBELISK_SIGN_NEGATIVE : OBELISK_SIGN_POSITIVE);
+    buffer = OBELISK_INSERT(buffer, DUTONE1, (dut1 < 0) ? -dut1 : dut1);
+    buffer = OBELISK_INSERT(buffer, YEAR10, year / 10);
+    buffer = OBELISK_INSERT(buffer, YEAR1, year % 10);
+    buffer = OBELISK_INSERT(buffer, LYI, !!lyi);
+    buffer = OBELISK_INSERT(buffer, LSW, !!lsw);
+    buffer = OBELISK_INSERT(buffer, DST, dst);
+
+    return buffer;
+}
+
+obelisk_buffer_t obelisk_encode(time_t epoch, int dut1, int lyi, int lsw, obelisk_dst_t dst)
+{
+    struct tm time = { 0 };
+    int year = -1;
+
+    gmtime_r(&epoch, &time);
+
+    year = (time.tm_year + 1900) % 100;
+    if (lyi < 0) {
+        lyi = OBELISK_CALENDAR_LEAP(OBELISK_CALENDAR_YEAR(year));
+    }
+
+    return obelisk_compose(year, time.tm_yday + 1, time.tm_hour, time.tm_min, dut1, lyi, lsw, dst);
+}
+
 int obelisk_revalidate(const struct tm * timep)
 {
     int rc = 0;
@@ -517,8 +676,8 @@ int obelisk_revalidate(const struct tm * timep)
     int leap = -1;
     int days = -1;
 
-    year = timep->tm_year + 1900;
-    leap = ((year % 4) == 0) && ((year % 400) != 0);
+    year = (timep->tm_year + 1900) % 100;
+    leap = OBELISK_CALENDAR_LEAP(OBELISK_CALENDAR_YEAR(year));
     days = leap ? 366 : 365;
 
     /*
@@ -534,7 +693,7 @@ int obelisk_revalidate(const struct tm * timep)
         rc = -16;
     } else if (!((0 <= timep->tm_mon) && (timep->tm_mon <= 11))) {
         rc = -17;
-    } else if (!((1 <= timep->tm_mday) && (timep->tm_mday <= DAYS[leap][timep->tm_mon]))) {
+    } else if (!((1 <= timep->tm_mday) && (timep->tm_mday <= (OBELISK_CALENDAR_CUMULATIVE[leap][timep->tm_mon + 1] - OBELISK_CALENDAR_CUMULATIVE[leap][timep->tm_mon])))) {
         rc = -18;
     } else if (!((117 <= timep->tm_year) && (timep->tm_year <= 216))) {
         rc = -19;
@@ -550,3 +709,779 @@ int obelisk_revalidate(const struct tm * timep)
 
     return 0;
 }
+
+/**
+ * Reference:   NIST, "WWVB Time Code Format", 2010-03
+ */
+static const struct {
+    obelisk_group_t group;
+    int8_t second;              /* Second at which the group is complete. */
+    obelisk_buffer_t unused;    /* Unused bits that must be zero. */
+} GROUP[] = {
+    { OBELISK_GROUP_MINUTES,    9, OBELISK_BIT(4), },
+    { OBELISK_GROUP_HOURS,     19, OBELISK_BIT(10) | OBELISK_BIT(11) | OBELISK_BIT(14), },
+    { OBELISK_GROUP_DAY,       34, OBELISK_BIT(20) | OBELISK_BIT(21) | OBELISK_BIT(24) | OBELISK_BIT(34), },
+    { OBELISK_GROUP_YEAR,      54, OBELISK_BIT(44) | OBELISK_BIT(54), },
+};
+
+obelisk_group_t obelisk_partial(obelisk_partial_t * partialp, obelisk_state_t state, int field, int length, obelisk_buffer_t buffer)
+{
+    obelisk_group_t group = OBELISK_GROUP_NONE;
+    int second = -1;
+    int valid = 0;
+
+    assert(partialp != (obelisk_partial_t *)0);
+
+    /*
+     * The second of the minute follows from how far the finite state
+     * machine has gotten through the fields and their separator MARKERs.
+     * The buffer then only needs to be shifted to line up with the
+     * offsets of a complete frame.
+     */
+
+    switch (state) {
+
+    case OBELISK_STATE_SYNC:
+    case OBELISK_STATE_DATA:
+    case OBELISK_STATE_MARK:
+    case OBELISK_STATE_END:
+    case OBELISK_STATE_LEAP:
+        if ((0 <= field) && (field < countof(LENGTH)) && (0 <= length) && (length <= LENGTH[field])) {
+            second = 0;
+            for (int ii = 0; ii < field; ++ii) {
+                second += LENGTH[ii] + 1;
+            }
+            second += LENGTH[field] - length;
+        }
+        break;
+
+    case OBELISK_STATE_BEGIN:
+        second = 59;
+        break;
+
+    default:
+        /* Do nothing. */
+        break;
+
+    }
+
+    partialp->second = second;
+    partialp->complete = OBELISK_GROUP_NONE;
+    partialp->confident = OBELISK_GROUP_NONE;
+
+    if (second < 0) {
+        return group;
+    }
+
+    buffer <<= (59 - second);
+
+    partialp->minutes = (OBELISK_EXTRACT(buffer, MINUTES10) * 10) + OBELISK_EXTRACT(buffer, MINUTES1);
+    partialp->hours = (OBELISK_EXTRACT(buffer, HOURS10) * 10) + OBELISK_EXTRACT(buffer, HOURS1);
+    partialp->day = (OBELISK_EXTRACT(buffer, DAY100) * 100) + (OBELISK_EXTRACT(buffer, DAY10) * 10) + OBELISK_EXTRACT(buffer, DAY1);
+    partialp->year = (OBELISK_EXTRACT(buffer, YEAR10) * 10) + OBELISK_EXTRACT(buffer, YEAR1);
+
+    for (int ii = 0; ii < countof(GROUP); ++ii) {
+
+        if (second < GROUP[ii].second) {
+            break;
+        }
+
+        if (second == GROUP[ii].second) {
+            group = GROUP[ii].group;
+        }
+
+        partialp->complete |= GROUP[ii].group;
+
+        switch (GROUP[ii].group) {
+
+        case OBELISK_GROUP_MINUTES:
+            valid = (OBELISK_EXTRACT(buffer, MINUTES10) <= 5) && (OBELISK_EXTRACT(buffer, MINUTES1) <= 9);
+            break;
+
+        case OBELISK_GROUP_HOURS:
+            valid = (OBELISK_EXTRACT(buffer, HOURS1) <= 9) && (partialp->hours <= 23);
+            break;
+
+        case OBELISK_GROUP_DAY:
+            valid = (OBELISK_EXTRACT(buffer, DAY10) <= 9) && (OBELISK_EXTRACT(buffer, DAY1) <= 9) && (1 <= partialp->day) && (partialp->day <= 366);
+            break;
+
+        case OBELISK_GROUP_YEAR:
+            valid = (OBELISK_EXTRACT(buffer, YEAR10) <= 9) && (OBELISK_EXTRACT(buffer, YEAR1) <= 9);
+            break;
+
+        default:
+            valid = 0;
+            break;
+
+        }
+
+        if (!valid) {
+            /* Do nothing. */
+        } else if ((buffer & GROUP[ii].unused) != 0) {
+            /* Do nothing. */
+        } else {
+            partialp->confident |= GROUP[ii].group;
+        }
+
+    }
+
+    return group;
+}
+
+obelisk_buffer_t obelisk_advance(obelisk_buffer_t buffer, int minutes)
+{
+    int minute = -1;
+    int hour = -1;
+    int day = -1;
+    int year = -1;
+    int lyi = -1;
+    int changed = 0;
+
+    assert(minutes >= 0);
+
+    minute = (OBELISK_EXTRACT(buffer, MINUTES10) * 10) + OBELISK_EXTRACT(buffer, MINUTES1);
+    hour = (OBELISK_EXTRACT(buffer, HOURS10) * 10) + OBELISK_EXTRACT(buffer, HOURS1);
+    day = (OBELISK_EXTRACT(buffer, DAY100) * 100) + (OBELISK_EXTRACT(buffer, DAY10) * 10) + OBELISK_EXTRACT(buffer, DAY1);
+    year = (OBELISK_EXTRACT(buffer, YEAR10) * 10) + OBELISK_EXTRACT(buffer, YEAR1);
+    lyi = OBELISK_EXTRACT(buffer, LYI);
+
+    minute += minutes;
+    hour += minute / 60;
+    minute %= 60;
+    day += hour / 24;
+    hour %= 24;
+
+    /*
+     * The frame tells us whether the current year is a leap year; we figure
+     * it out for subsequent years, mapping the two digit WWVB year to the
+     * same century obelisk_decode() does, so that 00 is 2100, which is not.
+     */
+
+    while (day > (lyi ? 366 : 365)) {
+        day -= (lyi ? 366 : 365);
+        year = (year + 1) % 100;
+        lyi = OBELISK_CALENDAR_LEAP(OBELISK_CALENDAR_YEAR(year));
+        changed = !0;
+    }
+
+    buffer = OBELISK_INSERT(buffer, MINUTES10, minute / 10);
+    buffer = OBELISK_INSERT(buffer, MINUTES1, minute % 10);
+    buffer = OBELISK_INSERT(buffer, HOURS10, hour / 10);
+    buffer = OBELISK_INSERT(buffer, HOURS1, hour % 10);
+    buffer = OBELISK_INSERT(buffer, DAY100, day / 100);
+    buffer = OBELISK_INSERT(buffer, DAY10, (day % 100) / 10);
+    buffer = OBELISK_INSERT(buffer, DAY1, day % 10);
+
+    if (changed) {
+        buffer = OBELISK_INSERT(buffer, YEAR10, year / 10);
+        buffer = OBELISK_INSERT(buffer, YEAR1, year % 10);
+        buffer = OBELISK_INSERT(buffer, LYI, lyi);
+    }
+
+    return buffer;
+}
+
+void obelisk_accumulator_init(obelisk_accumulator_t * accumulatorp)
+{
+    memset(accumulatorp, 0, sizeof(*accumulatorp));
+}
+
+void obelisk_accumulator_add(obelisk_accumulator_t * accumulatorp, int minute, obelisk_buffer_t buffer, int second)
+{
+    assert((0 <= accumulatorp->next) && (accumulatorp->next < countof(accumulatorp->value)));
+    assert((0 <= second) && (second <= 59));
+
+    /*
+     * Only the bits from :01 through the specified second have been
+     * received. The :00 MARKER is never in the buffer but it is always
+     * zero anyway.
+     */
+
+    accumulatorp->value[accumulatorp->next] = (buffer << (59 - second)) & OBELISK_FRAME;
+    accumulatorp->known[accumulatorp->next] = OBELISK_FRAME & ~(OBELISK_BIT(second) - 1);
+    accumulatorp->minute[accumulatorp->next] = minute;
+
+    accumulatorp->next = (accumulatorp->next + 1) % countof(accumulatorp->value);
+    if (accumulatorp->count < countof(accumulatorp->value)) {
+        accumulatorp->count += 1;
+    }
+}
+
+/**
+ * These are the groups of time fields in the order in which a carry
+ * propagates through them when a buffer is advanced.
+ */
+static const obelisk_buffer_t CARRY[] = {
+    OBELISK_FIELD(MINUTES10) | OBELISK_FIELD(MINUTES1),
+    OBELISK_FIELD(HOURS10) | OBELISK_FIELD(HOURS1),
+    OBELISK_FIELD(DAY100) | OBELISK_FIELD(DAY10) | OBELISK_FIELD(DAY1),
+    OBELISK_FIELD(YEAR10) | OBELISK_FIELD(YEAR1) | OBELISK_FIELD(LYI),
+};
+
+static const obelisk_buffer_t DAY = OBELISK_FIELD(DAY100) | OBELISK_FIELD(DAY10) | OBELISK_FIELD(DAY1);
+
+/*
+ * The tallies are kept bit-sliced: plane [i] holds bit i of the sixty
+ * per-bit counts, so a single sixty-four bit operation adds or compares
+ * all sixty counts at once. Four planes hold any sum of two tallies.
+ */
+
+enum {
+    PLANES = 4,
+};
+
+static void increment(obelisk_buffer_t tally[PLANES], obelisk_buffer_t bits)
+{
+    obelisk_buffer_t carry = 0;
+
+    for (int ii = 0; ii < PLANES; ++ii) {
+        carry = tally[ii] & bits;
+        tally[ii] ^= bits;
+        bits = carry;
+    }
+}
+
+static void add(obelisk_buffer_t sum[PLANES], const obelisk_buffer_t tally[PLANES], int constant)
+{
+    obelisk_buffer_t carry = 0;
+    obelisk_buffer_t bits = 0;
+
+    for (int ii = 0; ii < PLANES; ++ii) {
+        bits = ((constant >> ii) & 1) ? ~(obelisk_buffer_t)0 : 0;
+        sum[ii] = tally[ii] ^ bits ^ carry;
+        carry = (tally[ii] & bits) | (carry & (tally[ii] ^ bits));
+    }
+}
+
+static obelisk_buffer_t atleast(const obelisk_buffer_t aa[PLANES], const obelisk_buffer_t bb[PLANES])
+{
+    obelisk_buffer_t greater = 0;
+    obelisk_buffer_t equal = ~(obelisk_buffer_t)0;
+
+    for (int ii = PLANES - 1; ii >= 0; --ii) {
+        greater |= equal & aa[ii] & ~bb[ii];
+        equal &= ~(aa[ii] ^ bb[ii]);
+    }
+
+    return greater | equal;
+}
+
+/*
+ * Count the bits that are set, one iteration per set bit.
+ */
+static int population(obelisk_buffer_t bits)
+{
+    int count = 0;
+
+    for (; bits != 0; bits &= bits - 1) {
+        ++count;
+    }
+
+    return count;
+}
+
+int obelisk_accumulator_vote(const obelisk_accumulator_t * accumulatorp, int margin, obelisk_buffer_t * bufferp, obelisk_frame_t * framep)
+{
+    int undecided = 0;
+    int latest = 0;
+    int uncertain = 0;
+    obelisk_buffer_t value = 0;
+    obelisk_buffer_t known = 0;
+    obelisk_buffer_t ones[PLANES] = { 0 };
+    obelisk_buffer_t zeros[PLANES] = { 0 };
+    obelisk_buffer_t threshold[PLANES] = { 0 };
+    obelisk_buffer_t decided1 = 0;
+    obelisk_buffer_t decided0 = 0;
+    obelisk_buffer_t undecided_bits = 0;
+
+    assert((1 <= margin) && (margin <= countof(accumulatorp->value)));
+    assert((0 <= accumulatorp->count) && (accumulatorp->count <= countof(accumulatorp->value)));
+
+    for (int ii = 0; ii < accumulatorp->count; ++ii) {
+        if ((ii == 0) || (accumulatorp->minute[ii] > latest)) {
+            latest = accumulatorp->minute[ii];
+        }
+    }
+
+    for (int ii = 0; ii < accumulatorp->count; ++ii) {
+
+        value = accumulatorp->value[ii];
+        known = accumulatorp->known[ii];
+
+        /*
+         * Advance each older frame to the most recent minute. A time field
+         * that was not completely received can't be trusted once it has
+         * been advanced, and neither can any of the fields into which its
+         * carry might propagate. Crossing into a new day can change the DST
+         * field.
+         */
+
+        if (accumulatorp->minute[ii] < latest) {
+            value = obelisk_advance(value, latest - accumulatorp->minute[ii]);
+            uncertain = 0;
+            for (int jj = 0; jj < countof(CARRY); ++jj) {
+                if ((known & CARRY[jj]) != CARRY[jj]) {
+                    uncertain = !0;
+                }
+                if (uncertain) {
+                    known &= ~CARRY[jj];
+                }
+            }
+            if ((value & DAY) != (accumulatorp->value[ii] & DAY)) {
+                known &= ~OBELISK_FIELD(DST);
+            }
+        }
+
+        increment(ones, value & known);
+        increment(zeros, ~value & known & OBELISK_FRAME);
+
+    }
+
+    /*
+     * A bit is decided as a one if its ones are at least its zeros plus
+     * the margin, and as a zero if the reverse is true.
+     */
+
+    add(threshold, zeros, margin);
+    decided1 = atleast(ones, threshold);
+    add(threshold, ones, margin);
+    decided0 = atleast(zeros, threshold);
+
+    undecided_bits = OBELISK_FRAME & ~(decided1 | decided0);
+
+    undecided = population(undecided_bits);
+
+    if (undecided == 0) {
+        *bufferp = decided1 & OBELISK_FRAME;
+        obelisk_extract(framep, *bufferp);
+    }
+
+    return -undecided;
+}
+
+obelisk_buffer_t obelisk_predict(obelisk_buffer_t buffer)
+{
+    obelisk_buffer_t next = 0;
+    int dst = -1;
+    int month = -1;
+    int month_next = -1;
+    int day = -1;
+    int rc = -1;
+
+    next = obelisk_advance(buffer, 1);
+
+    if ((next & DAY) == (buffer & DAY)) {
+        /* Do nothing. */
+    } else {
+
+        /*
+         * The DST bit at :57 tells us whether DST is in effect at the end
+         * of the current UTC day, and the one at :58 whether it was in
+         * effect at the start of it. Absent an announced change, the new
+         * day starts and ends the way the old one ended.
+         */
+
+        dst = OBELISK_EXTRACT(buffer, DST);
+        next = OBELISK_INSERT(next, DST, (dst & OBELISK_DST_BEGINS) ? OBELISK_DST_ON : OBELISK_DST_OFF);
+
+        /*
+         * The leap second warning is set during the month at whose end
+         * the leap second is inserted, so it is cleared when the month
+         * changes.
+         */
+
+        rc = obelisk_julian2gregorian((OBELISK_EXTRACT(buffer, DAY100) * 100) + (OBELISK_EXTRACT(buffer, DAY10) * 10) + OBELISK_EXTRACT(buffer, DAY1), OBELISK_EXTRACT(buffer, LYI), &month, &day);
+        if (rc >= 0) {
+            rc = obelisk_julian2gregorian((OBELISK_EXTRACT(next, DAY100) * 100) + (OBELISK_EXTRACT(next, DAY10) * 10) + OBELISK_EXTRACT(next, DAY1), OBELISK_EXTRACT(next, LYI), &month_next, &day);
+        }
+        if (rc < 0) {
+            /* Do nothing. */
+        } else if (month == month_next) {
+            /* Do nothing. */
+        } else {
+            next = OBELISK_INSERT(next, LSW, 0);
+        }
+
+    }
+
+    return next;
+}
+
+int obelisk_mismatch(obelisk_buffer_t expected, obelisk_buffer_t buffer, int second)
+{
+    assert((0 <= second) && (second <= 59));
+
+    return population(((buffer << (59 - second)) ^ expected) & OBELISK_FRAME & ~(OBELISK_BIT(second) - 1));
+}
+
+/*
+ * This is the spread in milliseconds of a pulse around its nominal duration
+ * that costs one unit.
+ */
+static const int MILLISECONDS_SCALE = 25;
+
+void obelisk_likelihood(int cost[OBELISK_VITERBI_TOKENS], int milliseconds_pulse)
+{
+    int nominal = -1;
+    int distance = -1;
+
+    for (obelisk_token_t tt = OBELISK_TOKEN_ZERO; tt <= OBELISK_TOKEN_MARKER; ++tt) {
+        assert((0 <= tt) && (tt < countof(MILLISECONDS)));
+        nominal = (MILLISECONDS[tt].minimum + MILLISECONDS[tt].maximum) / 2;
+        distance = (milliseconds_pulse > nominal) ? (milliseconds_pulse - nominal) : (nominal - milliseconds_pulse);
+        if (distance >= (MILLISECONDS_SCALE * 8)) {
+            cost[tt] = OBELISK_VITERBI_COST;
+        } else {
+            cost[tt] = (distance * distance) / (MILLISECONDS_SCALE * MILLISECONDS_SCALE);
+        }
+    }
+}
+
+/**
+ * These are the seconds of the minute at which a MARKER is transmitted,
+ * not counting the leap second.
+ */
+static const obelisk_buffer_t MARKERS =
+    OBELISK_BIT(0) | OBELISK_BIT(9) | OBELISK_BIT(19) | OBELISK_BIT(29) |
+    OBELISK_BIT(39) | OBELISK_BIT(49) | OBELISK_BIT(59);
+
+/**
+ * These are the seconds of the minute at which an unused bit, which is
+ * always a ZERO, is transmitted.
+ */
+static const obelisk_buffer_t UNUSED =
+    OBELISK_BIT(4) | OBELISK_BIT(10) | OBELISK_BIT(11) | OBELISK_BIT(14) |
+    OBELISK_BIT(20) | OBELISK_BIT(21) | OBELISK_BIT(24) | OBELISK_BIT(34) |
+    OBELISK_BIT(35) | OBELISK_BIT(44) | OBELISK_BIT(54);
+
+enum {
+    LEAP = OBELISK_VITERBI_STATES - 1,
+    END = LEAP - 1,
+};
+
+/*
+ * Set the parser variables to what obelisk_parse() would have after the
+ * pulse at the specified second, from :01 through :58, of a frame.
+ */
+static void locate(int second, obelisk_state_t * statep, int * fieldp, int * lengthp)
+{
+    int field = -1;
+    int start = -1;
+
+    start = 0;
+    for (field = 0; field < (countof(LENGTH) - 1); ++field) {
+        if (second < (start + LENGTH[field] + 1)) {
+            break;
+        }
+        start += LENGTH[field] + 1;
+    }
+    *fieldp = field;
+    *lengthp = start + LENGTH[field] - second;
+    if (*lengthp > 0) {
+        *statep = OBELISK_STATE_DATA;
+    } else if (field < (countof(LENGTH) - 1)) {
+        *statep = OBELISK_STATE_MARK;
+    } else {
+        *statep = OBELISK_STATE_END;
+    }
+}
+
+void obelisk_viterbi_init(obelisk_viterbi_t * viterbip)
+{
+    memset(viterbip, 0, sizeof(*viterbip));
+    viterbip->second = -1;
+}
+
+obelisk_event_t obelisk_viterbi(obelisk_viterbi_t * viterbip, const int cost[OBELISK_VITERBI_TOKENS], obelisk_state_t * statep, int * fieldp, int * lengthp, obelisk_buffer_t * bufferp, obelisk_frame_t * framep)
+{
+    obelisk_event_t event = OBELISK_EVENT_NOMINAL;
+    int metric[OBELISK_VITERBI_STATES];
+    obelisk_buffer_t survivor[OBELISK_VITERBI_STATES];
+    int observed = -1;
+    int bit = -1;
+    int best = -1;
+    int runnerup = -1;
+    int previous = -1;
+    int predecessor = -1;
+
+    assert(viterbip != (obelisk_viterbi_t *)0);
+    assert(statep != (obelisk_state_t *)0);
+    assert(fieldp != (int *)0);
+    assert(lengthp != (int *)0);
+    assert(bufferp != (obelisk_buffer_t *)0);
+    assert(framep != (obelisk_frame_t *)0);
+
+    /*
+     * Every state has exactly one predecessor except for :00, which may
+     * follow either :59 or the leap second at :60. Markers and unused bits
+     * have only one possible value; the data bits take whichever value is
+     * more likely, and that decision is carried along in the survivor
+     * buffer of the path, shifted in just as obelisk_parse() would.
+     */
+
+    for (int ss = 0; ss < OBELISK_VITERBI_STATES; ++ss) {
+
+        if (ss == LEAP) {
+            observed = cost[OBELISK_TOKEN_MARKER];
+            metric[ss] = viterbip->metric[END] + OBELISK_VITERBI_LEAP + observed;
+            survivor[ss] = 0;
+        } else if (ss == 0) {
+            observed = cost[OBELISK_TOKEN_MARKER];
+            viterbip->leap = (viterbip->metric[LEAP] < viterbip->metric[END]);
+            metric[ss] = (viterbip->leap ? viterbip->metric[LEAP] : viterbip->metric[END]) + observed;
+            survivor[ss] = 0;
+        } else {
+            if ((MARKERS & OBELISK_BIT(ss)) != 0) {
+                observed = cost[OBELISK_TOKEN_MARKER];
+                bit = 0;
+            } else if ((UNUSED & OBELISK_BIT(ss)) != 0) {
+                observed = cost[OBELISK_TOKEN_ZERO];
+                bit = 0;
+            } else if (cost[OBELISK_TOKEN_ONE] < cost[OBELISK_TOKEN_ZERO]) {
+                observed = cost[OBELISK_TOKEN_ONE];
+                bit = 1;
+            } else {
+                observed = cost[OBELISK_TOKEN_ZERO];
+                bit = 0;
+            }
+            metric[ss] = viterbip->metric[ss - 1] + observed;
+            survivor[ss] = (viterbip->survivor[ss - 1] << 1) | bit;
+        }
+
+        if ((best < 0) || (metric[ss] < metric[best])) {
+            best = ss;
+        }
+
+    }
+
+    /*
+     * Normalize the metrics so that the best is zero, and saturate them so
+     * that a long history can't keep the synchronizer from following a
+     * change in alignment. The :00 and :60 states are the same alignment
+     * right after a MARKER at :59, so one isn't the runner up to the other.
+     */
+
+    for (int ss = 0; ss < OBELISK_VITERBI_STATES; ++ss) {
+        metric[ss] -= metric[best];
+        if (metric[ss] > OBELISK_VITERBI_METRIC) {
+            metric[ss] = OBELISK_VITERBI_METRIC;
+        }
+        viterbip->metric[ss] = metric[ss];
+        viterbip->survivor[ss] = survivor[ss];
+        if (ss == best) {
+            /* Do nothing. */
+        } else if ((best == 0) && (ss == LEAP)) {
+            /* Do nothing. */
+        } else if ((best == LEAP) && (ss == 0)) {
+            /* Do nothing. */
+        } else if ((runnerup < 0) || (metric[ss] < metric[runnerup])) {
+            runnerup = ss;
+        }
+    }
+
+    previous = viterbip->second;
+    viterbip->second = best;
+    viterbip->confidence = metric[runnerup];
+
+    /*
+     * We lock onto the most likely alignment once it is sufficiently more
+     * likely than any other. The margin shrinks every minute right after
+     * :00, when a path that hypothesizes a leap second is briefly almost as
+     * likely, so once locked we stay locked as long as the most likely path
+     * continues the one we locked onto. A leap second is recognized a
+     * second late, when the MARKER at :00 follows it; until then the MARKER
+     * at :60 looks like the one at :00.
+     */
+
+    if (best == LEAP) {
+        predecessor = END;
+    } else if (best != 0) {
+        predecessor = best - 1;
+    } else if (viterbip->leap) {
+        predecessor = LEAP;
+    } else {
+        predecessor = END;
+    }
+
+    if (!viterbip->locked) {
+        if (viterbip->confidence < OBELISK_VITERBI_CONFIDENCE) {
+            event = OBELISK_EVENT_WAITING;
+        } else {
+            viterbip->locked = !0;
+        }
+    } else if (previous == predecessor) {
+        /* Do nothing. */
+    } else if ((best == 0) && viterbip->leap && (previous == 0)) {
+        /* Do nothing. */
+    } else {
+        event = OBELISK_EVENT_INVALID;
+        viterbip->locked = 0;
+    }
+
+    /*
+     * Translate the most likely second into what the parser would have
+     * done at the same point in the frame.
+     */
+
+    if (!viterbip->locked) {
+        *statep = OBELISK_STATE_START;
+    } else if (best == LEAP) {
+        event = OBELISK_EVENT_TIME;
+        *statep = OBELISK_STATE_LEAP;
+        *fieldp = 0;
+        *lengthp = LENGTH[0];
+    } else if (best == 0) {
+        event = viterbip->leap ? OBELISK_EVENT_LEAP : OBELISK_EVENT_TIME;
+        *statep = viterbip->leap ? OBELISK_STATE_DATA : OBELISK_STATE_LEAP;
+        *fieldp = 0;
+        *lengthp = LENGTH[0];
+    } else if (best == END) {
+        event = OBELISK_EVENT_FRAME;
+        *statep = OBELISK_STATE_BEGIN;
+        *fieldp = countof(LENGTH) - 1;
+        *lengthp = 0;
+        obelisk_extract(framep, survivor[best]);
+    } else {
+        locate(best, statep, fieldp, lengthp);
+    }
+
+    *bufferp = survivor[best];
+
+    return event;
+}
+
+/**
+ * These are the bits of a frame that can be computed from the time alone.
+ */
+static const obelisk_buffer_t KNOWN = OBELISK_FRAME & ~(
+    OBELISK_FIELD(DUTONESIGN) | OBELISK_FIELD(DUTONE1) |
+    OBELISK_FIELD(LSW) | OBELISK_FIELD(DST));
+
+void obelisk_acquire_init(obelisk_acquire_t * acquirep, time_t prior)
+{
+    assert(acquirep != (obelisk_acquire_t *)0);
+
+    memset(acquirep, 0, sizeof(*acquirep));
+
+    acquirep->first = prior - OBELISK_ACQUIRE_SECONDS;
+    acquirep->base = acquirep->first - (acquirep->first % 60);
+    acquirep->best = -1;
+
+    for (int mm = 0; mm < countof(acquirep->candidate); ++mm) {
+        acquirep->candidate[mm] = obelisk_encode(acquirep->base + (mm * 60), 0, -1, 0, OBELISK_DST_OFF) & KNOWN;
+    }
+}
+
+int obelisk_acquire(obelisk_acquire_t * acquirep, obelisk_token_t token, time_t * epochp, obelisk_state_t * statep, int * fieldp, int * lengthp, obelisk_buffer_t * bufferp)
+{
+    int rc = 0;
+    time_t now = -1;
+    obelisk_buffer_t bit = 0;
+    obelisk_buffer_t candidate = 0;
+    obelisk_buffer_t mask = 0;
+    int offset = -1;
+    int minute = -1;
+    int second = -1;
+    int mismatch = -1;
+    int runnerup = -1;
+
+    assert(acquirep != (obelisk_acquire_t *)0);
+    assert(epochp != (time_t *)0);
+    assert(statep != (obelisk_state_t *)0);
+    assert(fieldp != (int *)0);
+    assert(lengthp != (int *)0);
+    assert(bufferp != (obelisk_buffer_t *)0);
+
+    /*
+     * The received bits are shifted in just as obelisk_parse() would,
+     * but are only used for the fields that can't be predicted.
+     */
+
+    acquirep->received = (acquirep->received << 1) | ((token == OBELISK_TOKEN_ONE) ? 1 : 0);
+
+    for (int hh = 0; (token != OBELISK_TOKEN_INVALID) && (hh < countof(acquirep->mismatches)); ++hh) {
+
+        offset = (acquirep->first + hh + acquirep->tokens) - acquirep->base;
+        minute = offset / 60;
+        second = offset % 60;
+        assert((0 <= minute) && (minute < countof(acquirep->candidate)));
+        bit = OBELISK_BIT(second);
+
+        if ((MARKERS & bit) != 0) {
+            mismatch = (token != OBELISK_TOKEN_MARKER);
+        } else if (token == OBELISK_TOKEN_MARKER) {
+            mismatch = !0;
+        } else if ((KNOWN & bit) == 0) {
+            mismatch = 0;
+        } else {
+            mismatch = ((acquirep->candidate[minute] & bit) != 0) != (token == OBELISK_TOKEN_ONE);
+        }
+
+        if (mismatch) {
+            acquirep->mismatches[hh] += 1;
+        }
+
+    }
+
+    acquirep->tokens += 1;
+
+    acquirep->best = 0;
+    runnerup = -1;
+    for (int hh = 1; hh < countof(acquirep->mismatches); ++hh) {
+        if (acquirep->mismatches[hh] < acquirep->mismatches[acquirep->best]) {
+            runnerup = acquirep->best;
+            acquirep->best = hh;
+        } else if ((runnerup < 0) || (acquirep->mismatches[hh] < acquirep->mismatches[runnerup])) {
+            runnerup = hh;
+        } else {
+            /* Do nothing. */
+        }
+    }
+    acquirep->margin = acquirep->mismatches[runnerup] - acquirep->mismatches[acquirep->best];
+
+    if (acquirep->mismatches[acquirep->best] > OBELISK_ACQUIRE_ERRORS) {
+        rc = -1;
+    } else if (acquirep->margin >= OBELISK_ACQUIRE_MARGIN) {
+        rc = 1;
+    } else if (acquirep->tokens >= OBELISK_ACQUIRE_TOKENS) {
+        rc = -1;
+    } else {
+        /* Do nothing. */
+    }
+
+    if (rc > 0) {
+
+        now = acquirep->first + acquirep->best + acquirep->tokens - 1;
+        *epochp = now;
+
+        offset = now - acquirep->base;
+        minute = offset / 60;
+        second = offset % 60;
+        candidate = acquirep->candidate[minute];
+
+        /*
+         * The buffer holds the bits from :01 through the current second,
+         * taken from the candidate where they are known and from what was
+         * received where they are not.
+         */
+
+        mask = (((obelisk_buffer_t)1) << second) - 1;
+        *bufferp = (((candidate & KNOWN) >> (59 - second)) | (acquirep->received & ~(KNOWN >> (59 - second)))) & mask;
+
+        if (second == 0) {
+            *statep = OBELISK_STATE_LEAP;
+            *fieldp = 0;
+            *lengthp = LENGTH[0];
+        } else if (second == END) {
+            *statep = OBELISK_STATE_BEGIN;
+            *fieldp = countof(LENGTH) - 1;
+            *lengthp = 0;
+        } else {
+            locate(second, statep, fieldp, lengthp);
+        }
+
+    }
+
+    return rc;
+}
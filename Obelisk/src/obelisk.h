@@ -73,6 +73,85 @@ typedef enum ObeliskMask {
  */
 #define OBELISK_EXTRACT(_BUFFER_, _FIELD_) ((_BUFFER_ >> OBELISK_OFFSET_ ## _FIELD_) & OBELISK_MASK_ ## _FIELD_)
 
+/**
+ * @def OBELISK_BIT
+ * This generates the bit in the buffer that is received at the specified
+ * second of the minute.
+ */
+#define OBELISK_BIT(_SECOND_) ((obelisk_buffer_t)1 << (59 - (_SECOND_)))
+
+/**
+ * @def OBELISK_INSERT
+ * This generates code to replace a single field in the buffer with a value.
+ * The field name is turned into an bit offset and a bit mask.
+ */
+#define OBELISK_INSERT(_BUFFER_, _FIELD_, _VALUE_) (((_BUFFER_) & ~((obelisk_buffer_t)OBELISK_MASK_ ## _FIELD_ << OBELISK_OFFSET_ ## _FIELD_)) | (((obelisk_buffer_t)(_VALUE_) & OBELISK_MASK_ ## _FIELD_) << OBELISK_OFFSET_ ## _FIELD_))
+
+/**
+ * @def OBELISK_FIELD
+ * This generates the bits in the buffer that a single field occupies.
+ */
+#define OBELISK_FIELD(_FIELD_) ((obelisk_buffer_t)OBELISK_MASK_ ## _FIELD_ << OBELISK_OFFSET_ ## _FIELD_)
+
+/**
+ * @def OBELISK_FRAME
+ * This generates the bits in the buffer that a complete frame occupies.
+ */
+#define OBELISK_FRAME ((((obelisk_buffer_t)1) << 60) - 1)
+
+/*
+ * Each BCD field is followed in the buffer by a MARKER or an unused bit,
+ * and that bit is where a field that is greater than its maximum carries
+ * into when the field is added to its bias: the all-ones value of the
+ * field less its maximum. Since the carry bits are cleared first, a carry
+ * can't propagate any further, so all fields are checked in one addition.
+ */
+
+/**
+ * @def OBELISK_CARRY
+ * This generates the bit in the buffer just past the end of a field.
+ */
+#define OBELISK_CARRY(_FIELD_) (((obelisk_buffer_t)OBELISK_MASK_ ## _FIELD_ + 1) << OBELISK_OFFSET_ ## _FIELD_)
+
+/**
+ * @def OBELISK_BIAS
+ * This generates the bias that carries out of a field above its maximum.
+ */
+#define OBELISK_BIAS(_FIELD_, _MAXIMUM_) ((obelisk_buffer_t)(OBELISK_MASK_ ## _FIELD_ - (_MAXIMUM_)) << OBELISK_OFFSET_ ## _FIELD_)
+
+/**
+ * @def OBELISK_DIGITS
+ * These are the bits of all of the BCD fields in the buffer.
+ */
+#define OBELISK_DIGITS \
+    (OBELISK_FIELD(MINUTES10) | OBELISK_FIELD(MINUTES1) | \
+     OBELISK_FIELD(HOURS10) | OBELISK_FIELD(HOURS1) | \
+     OBELISK_FIELD(DAY100) | OBELISK_FIELD(DAY10) | OBELISK_FIELD(DAY1) | \
+     OBELISK_FIELD(DUTONE1) | \
+     OBELISK_FIELD(YEAR10) | OBELISK_FIELD(YEAR1))
+
+/**
+ * @def OBELISK_BIASES
+ * These are the biases of all of the BCD fields in the buffer.
+ */
+#define OBELISK_BIASES \
+    (OBELISK_BIAS(MINUTES10, 5) | OBELISK_BIAS(MINUTES1, 9) | \
+     OBELISK_BIAS(HOURS10, 2) | OBELISK_BIAS(HOURS1, 9) | \
+     OBELISK_BIAS(DAY100, 3) | OBELISK_BIAS(DAY10, 9) | OBELISK_BIAS(DAY1, 9) | \
+     OBELISK_BIAS(DUTONE1, 9) | \
+     OBELISK_BIAS(YEAR10, 9) | OBELISK_BIAS(YEAR1, 9))
+
+/**
+ * @def OBELISK_CARRIES
+ * These are the carry bits of all of the BCD fields in the buffer.
+ */
+#define OBELISK_CARRIES \
+    (OBELISK_CARRY(MINUTES10) | OBELISK_CARRY(MINUTES1) | \
+     OBELISK_CARRY(HOURS10) | OBELISK_CARRY(HOURS1) | \
+     OBELISK_CARRY(DAY100) | OBELISK_CARRY(DAY10) | OBELISK_CARRY(DAY1) | \
+     OBELISK_CARRY(DUTONE1) | \
+     OBELISK_CARRY(YEAR10) | OBELISK_CARRY(YEAR1))
+
 /**
  * Extract the individual IRIQ timecode fields from the buffer and store
  * them in a frame.
@@ -0,0 +1,280 @@
+/* vim: set ts=4 expandtab shiftwidth=4: */
+
+/**
+ * @file
+ *
+ * Copyright 2018 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in LICENSE.txt<BR>
+ * Chip Overclock<BR>
+ * mailto:coverclock@diag.com<BR>
+ * http://github.com/coverclock/com-diag-obelisk<BR>
+ */
+
+#include <assert.h>
+#include <pthread.h>
+#include "com/diag/obelisk/obelisk.h"
+#include "com/diag/obelisk/obelisk_batch.h"
+#include "obelisk.h"
+#include "obelisk_calendar.h"
+
+#if defined(__x86_64__)
+#   include <immintrin.h>
+#   define OBELISK_BATCH_AVX2
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#   include <arm_neon.h>
+#   define OBELISK_BATCH_NEON
+#endif
+
+typedef size_t (obelisk_batch_t)(time_t epochs[], uint8_t valid[], const obelisk_buffer_t buffers[], size_t count);
+
+static const int32_t SECONDS_PER_DAY = 24 * 60 * 60;
+
+size_t obelisk_batch_scalar(time_t epochs[], uint8_t valid[], const obelisk_buffer_t buffers[], size_t count)
+{
+    size_t total = 0;
+
+    for (size_t ii = 0; ii < count; ++ii) {
+        epochs[ii] = (obelisk_verify(buffers[ii]) == 0) ? obelisk_epoch(buffers[ii]) : -1;
+        valid[ii] = (epochs[ii] >= 0);
+        total += valid[ii];
+    }
+
+    return total;
+}
+
+#if defined(OBELISK_BATCH_AVX2)
+
+/*
+ * Each of the four 64-bit lanes holds one buffer, and each step is
+ * exactly what obelisk_verify() and obelisk_epoch() do to one of them.
+ * The only products are of values that fit in 32 bits, which is what
+ * _mm256_mul_epu32() multiplies.
+ */
+
+#define OBELISK_BATCH_FIELD(_BUFFER_, _FIELD_) _mm256_and_si256(_mm256_srli_epi64(_BUFFER_, OBELISK_OFFSET_ ## _FIELD_), _mm256_set1_epi64x(OBELISK_MASK_ ## _FIELD_))
+
+__attribute__((target("avx2")))
+static size_t batch_avx2(time_t epochs[], uint8_t valid[], const obelisk_buffer_t buffers[], size_t count)
+{
+    size_t total = 0;
+    size_t ii = 0;
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi64x(1);
+    const __m256i three = _mm256_set1_epi64x(3);
+    const __m256i ten = _mm256_set1_epi64x(10);
+    const __m256i hundred = _mm256_set1_epi64x(100);
+    const __m256i hours = _mm256_set1_epi64x(23);
+    const __m256i days = _mm256_set1_epi64x(365);
+    __m256i buffer;
+    __m256i bad;
+    __m256i sign;
+    __m256i year;
+    __m256i day;
+    __m256i hour;
+    __m256i minute;
+    __m256i leap;
+    __m256i base;
+    __m256i epoch;
+    int mask;
+
+    assert(sizeof(time_t) == sizeof(int64_t));
+
+    for (ii = 0; (ii + 4) <= count; ii += 4) {
+
+        buffer = _mm256_loadu_si256((const __m256i *)&buffers[ii]);
+
+        bad = _mm256_and_si256(_mm256_add_epi64(_mm256_and_si256(buffer, _mm256_set1_epi64x(OBELISK_DIGITS)), _mm256_set1_epi64x(OBELISK_BIASES)), _mm256_set1_epi64x(OBELISK_CARRIES));
+
+        /*
+         * The dUT1 sign is valid only as 0b010 or 0b101, in which each bit
+         * differs from the next.
+         */
+
+        sign = OBELISK_BATCH_FIELD(buffer, DUTONESIGN);
+        sign = _mm256_xor_si256(sign, _mm256_srli_epi64(sign, 1));
+        sign = _mm256_xor_si256(_mm256_and_si256(_mm256_srli_epi64(sign, 1), sign), one);
+        bad = _mm256_or_si256(bad, _mm256_and_si256(sign, one));
+
+        bad = _mm256_xor_si256(_mm256_cmpeq_epi64(bad, zero), _mm256_cmpeq_epi64(zero, zero));
+
+        year = _mm256_add_epi64(_mm256_mul_epu32(OBELISK_BATCH_FIELD(buffer, YEAR10), ten), OBELISK_BATCH_FIELD(buffer, YEAR1));
+        day = _mm256_add_epi64(_mm256_add_epi64(_mm256_mul_epu32(OBELISK_BATCH_FIELD(buffer, DAY100), hundred), _mm256_mul_epu32(OBELISK_BATCH_FIELD(buffer, DAY10), ten)), OBELISK_BATCH_FIELD(buffer, DAY1));
+        hour = _mm256_add_epi64(_mm256_mul_epu32(OBELISK_BATCH_FIELD(buffer, HOURS10), ten), OBELISK_BATCH_FIELD(buffer, HOURS1));
+        minute = _mm256_add_epi64(_mm256_mul_epu32(OBELISK_BATCH_FIELD(buffer, MINUTES10), ten), OBELISK_BATCH_FIELD(buffer, MINUTES1));
+
+        /*
+         * Two digit year 00 is 2100, which is not a leap year.
+         */
+
+        leap = _mm256_andnot_si256(_mm256_cmpeq_epi64(year, zero), _mm256_cmpeq_epi64(_mm256_and_si256(year, three), zero));
+        leap = _mm256_and_si256(leap, one);
+
+        bad = _mm256_or_si256(bad, _mm256_cmpgt_epi64(hour, hours));
+        bad = _mm256_or_si256(bad, _mm256_cmpeq_epi64(day, zero));
+        bad = _mm256_or_si256(bad, _mm256_cmpgt_epi64(day, _mm256_add_epi64(days, leap)));
+
+        /*
+         * A valid year is less than one hundred, and an invalid one is
+         * replaced by zero, so the gather always stays within the table.
+         */
+
+        base = _mm256_cvtepi32_epi64(_mm256_i64gather_epi32((const int *)OBELISK_YEARDAYS, _mm256_andnot_si256(bad, year), sizeof(OBELISK_YEARDAYS[0])));
+
+        epoch = _mm256_mul_epu32(_mm256_sub_epi64(_mm256_add_epi64(base, day), one), _mm256_set1_epi64x(SECONDS_PER_DAY));
+        epoch = _mm256_add_epi64(epoch, _mm256_mul_epu32(hour, _mm256_set1_epi64x(60 * 60)));
+        epoch = _mm256_add_epi64(epoch, _mm256_mul_epu32(minute, _mm256_set1_epi64x(60)));
+        epoch = _mm256_or_si256(epoch, bad);
+
+        _mm256_storeu_si256((__m256i *)&epochs[ii], epoch);
+
+        mask = _mm256_movemask_pd(_mm256_castsi256_pd(bad));
+        valid[ii + 0] = !(mask & 0x1);
+        valid[ii + 1] = !(mask & 0x2);
+        valid[ii + 2] = !(mask & 0x4);
+        valid[ii + 3] = !(mask & 0x8);
+        total += 4 - __builtin_popcount(mask);
+
+    }
+
+    total += obelisk_batch_scalar(&epochs[ii], &valid[ii], &buffers[ii], count - ii);
+
+    return total;
+}
+
+#endif
+
+#if defined(OBELISK_BATCH_NEON)
+
+/*
+ * Each of the two 64-bit lanes holds one buffer. NEON has no 64-bit
+ * multiply, so the values, all of which fit in 32 bits, are narrowed and
+ * multiplied with a widening multiply. Nor does it have a gather, so the
+ * table is indexed one lane at a time.
+ */
+
+#define OBELISK_BATCH_FIELD(_BUFFER_, _FIELD_) vandq_u64(vshrq_n_u64(_BUFFER_, OBELISK_OFFSET_ ## _FIELD_), vdupq_n_u64(OBELISK_MASK_ ## _FIELD_))
+
+#define OBELISK_BATCH_MULTIPLY(_VALUE_, _CONSTANT_) vmull_u32(vmovn_u64(_VALUE_), vdup_n_u32(_CONSTANT_))
+
+static size_t batch_neon(time_t epochs[], uint8_t valid[], const obelisk_buffer_t buffers[], size_t count)
+{
+    size_t total = 0;
+    size_t ii = 0;
+    const uint64x2_t zero = vdupq_n_u64(0);
+    const uint64x2_t one = vdupq_n_u64(1);
+    uint64x2_t buffer;
+    uint64x2_t bad;
+    uint64x2_t sign;
+    uint64x2_t year;
+    uint64x2_t day;
+    uint64x2_t hour;
+    uint64x2_t minute;
+    uint64x2_t leap;
+    uint64x2_t base;
+    uint64x2_t epoch;
+    int64_t results[2];
+
+    for (ii = 0; (ii + 2) <= count; ii += 2) {
+
+        buffer = vld1q_u64((const uint64_t *)&buffers[ii]);
+
+        bad = vandq_u64(vaddq_u64(vandq_u64(buffer, vdupq_n_u64(OBELISK_DIGITS)), vdupq_n_u64(OBELISK_BIASES)), vdupq_n_u64(OBELISK_CARRIES));
+
+        /*
+         * The dUT1 sign is valid only as 0b010 or 0b101, in which each bit
+         * differs from the next.
+         */
+
+        sign = OBELISK_BATCH_FIELD(buffer, DUTONESIGN);
+        sign = veorq_u64(sign, vshrq_n_u64(sign, 1));
+        sign = veorq_u64(vandq_u64(vshrq_n_u64(sign, 1), sign), one);
+        bad = vorrq_u64(bad, vandq_u64(sign, one));
+
+        bad = vtstq_u64(bad, bad);
+
+        year = vaddq_u64(OBELISK_BATCH_MULTIPLY(OBELISK_BATCH_FIELD(buffer, YEAR10), 10), OBELISK_BATCH_FIELD(buffer, YEAR1));
+        day = vaddq_u64(vaddq_u64(OBELISK_BATCH_MULTIPLY(OBELISK_BATCH_FIELD(buffer, DAY100), 100), OBELISK_BATCH_MULTIPLY(OBELISK_BATCH_FIELD(buffer, DAY10), 10)), OBELISK_BATCH_FIELD(buffer, DAY1));
+        hour = vaddq_u64(OBELISK_BATCH_MULTIPLY(OBELISK_BATCH_FIELD(buffer, HOURS10), 10), OBELISK_BATCH_FIELD(buffer, HOURS1));
+        minute = vaddq_u64(OBELISK_BATCH_MULTIPLY(OBELISK_BATCH_FIELD(buffer, MINUTES10), 10), OBELISK_BATCH_FIELD(buffer, MINUTES1));
+
+        /*
+         * Two digit year 00 is 2100, which is not a leap year.
+         */
+
+        leap = vbicq_u64(vceqq_u64(vandq_u64(year, vdupq_n_u64(3)), zero), vceqq_u64(year, zero));
+        leap = vandq_u64(leap, one);
+
+        bad = vorrq_u64(bad, vcgtq_u64(hour, vdupq_n_u64(23)));
+        bad = vorrq_u64(bad, vceqq_u64(day, zero));
+        bad = vorrq_u64(bad, vcgtq_u64(day, vaddq_u64(vdupq_n_u64(365), leap)));
+
+        year = vbicq_u64(year, bad);
+        base = vcombine_u64(vcreate_u64(OBELISK_YEARDAYS[vgetq_lane_u64(year, 0)]), vcreate_u64(OBELISK_YEARDAYS[vgetq_lane_u64(year, 1)]));
+
+        epoch = OBELISK_BATCH_MULTIPLY(vsubq_u64(vaddq_u64(base, day), one), SECONDS_PER_DAY);
+        epoch = vaddq_u64(epoch, OBELISK_BATCH_MULTIPLY(hour, 60 * 60));
+        epoch = vaddq_u64(epoch, OBELISK_BATCH_MULTIPLY(minute, 60));
+        epoch = vorrq_u64(epoch, bad);
+
+        vst1q_s64(results, vreinterpretq_s64_u64(epoch));
+        epochs[ii + 0] = results[0];
+        epochs[ii + 1] = results[1];
+
+        valid[ii + 0] = (vgetq_lane_u64(bad, 0) == 0);
+        valid[ii + 1] = (vgetq_lane_u64(bad, 1) == 0);
+        total += valid[ii + 0] + valid[ii + 1];
+
+    }
+
+    total += obelisk_batch_scalar(&epochs[ii], &valid[ii], &buffers[ii], count - ii);
+
+    return total;
+}
+
+#endif
+
+/*
+ * The implementation is chosen once, the first time through, by whichever
+ * thread gets there first; the others wait until it has been chosen.
+ */
+
+static obelisk_batch_t * implementation = (obelisk_batch_t *)0;
+
+static const char * name = (const char *)0;
+
+static pthread_once_t once = PTHREAD_ONCE_INIT;
+
+static void choose(void)
+{
+#if defined(OBELISK_BATCH_AVX2)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        name = "avx2";
+        implementation = batch_avx2;
+    } else {
+        name = "scalar";
+        implementation = obelisk_batch_scalar;
+    }
+#elif defined(OBELISK_BATCH_NEON)
+    /* Advanced SIMD is a mandatory part of ARMv8-A. */
+    name = "neon";
+    implementation = batch_neon;
+#else
+    name = "scalar";
+    implementation = obelisk_batch_scalar;
+#endif
+}
+
+size_t obelisk_batch(time_t epochs[], uint8_t valid[], const obelisk_buffer_t buffers[], size_t count)
+{
+    pthread_once(&once, choose);
+
+    return (*implementation)(epochs, valid, buffers, count);
+}
+
+const char * obelisk_batch_implementation(void)
+{
+    pthread_once(&once, choose);
+
+    return name;
+}
@@ -0,0 +1,140 @@
+/* vim: set ts=4 expandtab shiftwidth=4: */
+
+/**
+ * @file
+ *
+ * Copyright 2018 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in LICENSE.txt<BR>
+ * Chip Overclock<BR>
+ * mailto:coverclock@diag.com<BR>
+ * http://github.com/coverclock/com-diag-obelisk<BR>
+ */
+
+#include <assert.h>
+#include "obelisk_calendar.h"
+
+/*******************************************************************************
+ * CHECKS
+ ******************************************************************************/
+
+/*
+ * The days before each month are checked against the familiar table.
+ */
+
+#define CHECKBEFORE(_MONTH_, _COMMON_, _LEAP_) \
+    static_assert(OBELISK_CALENDAR_BEFORE(0, _MONTH_) == (_COMMON_), "common year days before month"); \
+    static_assert(OBELISK_CALENDAR_BEFORE(1, _MONTH_) == (_LEAP_), "leap year days before month")
+
+CHECKBEFORE( 1,   0,   0);
+CHECKBEFORE( 2,  31,  31);
+CHECKBEFORE( 3,  59,  60);
+CHECKBEFORE( 4,  90,  91);
+CHECKBEFORE( 5, 120, 121);
+CHECKBEFORE( 6, 151, 152);
+CHECKBEFORE( 7, 181, 182);
+CHECKBEFORE( 8, 212, 213);
+CHECKBEFORE( 9, 243, 244);
+CHECKBEFORE(10, 273, 274);
+CHECKBEFORE(11, 304, 305);
+CHECKBEFORE(12, 334, 335);
+CHECKBEFORE(13, 365, 366);
+
+/*
+ * Every day of the year falls after the first of the month it is said to
+ * be in and no later than the last day of that month.
+ */
+
+#define CHECKJULIAN(_LEAP_, _JULIAN_) \
+    static_assert(!OBELISK_CALENDAR_VALID(_LEAP_, _JULIAN_) || \
+        ((OBELISK_CALENDAR_BEFORE(_LEAP_, OBELISK_CALENDAR_MONTHOF(_LEAP_, _JULIAN_)) < (_JULIAN_)) && \
+         ((_JULIAN_) <= OBELISK_CALENDAR_BEFORE(_LEAP_, OBELISK_CALENDAR_MONTHOF(_LEAP_, _JULIAN_) + 1))), "day of the year to month");
+
+OBELISK_CALENDAR_JULIANS(CHECKJULIAN, 0)
+OBELISK_CALENDAR_JULIANS(CHECKJULIAN, 1)
+
+static_assert((OBELISK_CALENDAR_MONTHOF(0, 365) == 12) && (OBELISK_CALENDAR_DAYOF(0, 365) == 31), "common year ends December 31st");
+static_assert((OBELISK_CALENDAR_MONTHOF(1, 366) == 12) && (OBELISK_CALENDAR_DAYOF(1, 366) == 31), "leap year ends December 31st");
+static_assert((OBELISK_CALENDAR_MONTHOF(1, 60) == 2) && (OBELISK_CALENDAR_DAYOF(1, 60) == 29), "leap day");
+
+/*
+ * The days from the epoch and the day of the week of the first of January
+ * are checked at dates that are well known, and from year to year using
+ * the Gregorian leap year rule.
+ */
+
+static_assert(OBELISK_CALENDAR_EPOCHDAYS(1970) == 0, "1970-01-01");
+static_assert(OBELISK_CALENDAR_EPOCHDAYS(2000) == 10957, "2000-01-01");
+static_assert(OBELISK_CALENDAR_EPOCHDAYS(2017) == 17167, "2017-01-01");
+static_assert(OBELISK_CALENDAR_EPOCHDAYS(2100) == 47482, "2100-01-01");
+static_assert(OBELISK_CALENDAR_WEEKDAYOF(2000) == 6, "2000-01-01 was a Saturday");
+static_assert(OBELISK_CALENDAR_WEEKDAYOF(2017) == 0, "2017-01-01 was a Sunday");
+static_assert(OBELISK_CALENDAR_WEEKDAYOF(2100) == 5, "2100-01-01 will be a Friday");
+static_assert(!OBELISK_CALENDAR_LEAP(2100) && OBELISK_CALENDAR_LEAP(2000) && OBELISK_CALENDAR_LEAP(2116), "leap years");
+
+#define YEARLENGTH(_YEAR_) (365 + OBELISK_CALENDAR_LEAP(_YEAR_))
+
+#define CHECKYEAR(_UNUSED_, _YY_) \
+    static_assert((OBELISK_CALENDAR_EPOCHDAYS(OBELISK_CALENDAR_YEAR(_YY_) + 1) - OBELISK_CALENDAR_EPOCHDAYS(OBELISK_CALENDAR_YEAR(_YY_))) == YEARLENGTH(OBELISK_CALENDAR_YEAR(_YY_)), "days from the epoch"); \
+    static_assert(OBELISK_CALENDAR_WEEKDAYOF(OBELISK_CALENDAR_YEAR(_YY_) + 1) == ((OBELISK_CALENDAR_WEEKDAYOF(OBELISK_CALENDAR_YEAR(_YY_)) + YEARLENGTH(OBELISK_CALENDAR_YEAR(_YY_))) % 7), "day of the week"); \
+    static_assert(OBELISK_CALENDAR_LEAP(OBELISK_CALENDAR_YEAR(_YY_)) == ((((_YY_) % 4) == 0) && ((_YY_) != 0)), "two digit leap year");
+
+OBELISK_CALENDAR_YEARS(CHECKYEAR, 0)
+
+/*
+ * The PM decoder finds the year of the century from the day of the century
+ * with no search at all: every fourth year from 2000 through 2099 is a leap
+ * year, so the year is the day times four divided by the days in four
+ * years. This checks that for the first and last day of every year.
+ */
+
+#define CENTURYDAYS(_YY_) \
+    (OBELISK_CALENDAR_EPOCHDAYS(2000 + (_YY_)) - OBELISK_CALENDAR_EPOCHDAYS(2000))
+
+#define CHECKCENTURY(_UNUSED_, _YY_) \
+    static_assert(((4 * CENTURYDAYS(_YY_)) / 1461) == (_YY_), "first day of the year of the century"); \
+    static_assert(((4 * (CENTURYDAYS((_YY_) + 1) - 1)) / 1461) == (_YY_), "last day of the year of the century");
+
+OBELISK_CALENDAR_YEARS(CHECKCENTURY, 0)
+
+/*******************************************************************************
+ * TABLES
+ ******************************************************************************/
+
+#define CUMULATIVE(_LEAP_, _MONTH_) OBELISK_CALENDAR_BEFORE(_LEAP_, (_MONTH_) + 1),
+
+const int16_t OBELISK_CALENDAR_CUMULATIVE[2][13] = {
+    { OBELISK_CALENDAR_R10(CUMULATIVE, 0, 0) CUMULATIVE(0, 10) CUMULATIVE(0, 11) CUMULATIVE(0, 12) },
+    { OBELISK_CALENDAR_R10(CUMULATIVE, 1, 0) CUMULATIVE(1, 10) CUMULATIVE(1, 11) CUMULATIVE(1, 12) },
+};
+
+#define MONTH(_LEAP_, _JULIAN_) (OBELISK_CALENDAR_VALID(_LEAP_, _JULIAN_) ? OBELISK_CALENDAR_MONTHOF(_LEAP_, _JULIAN_) : 0),
+
+const uint8_t OBELISK_CALENDAR_MONTH[2][367] = {
+    { OBELISK_CALENDAR_JULIANS(MONTH, 0) },
+    { OBELISK_CALENDAR_JULIANS(MONTH, 1) },
+};
+
+#define DAY(_LEAP_, _JULIAN_) (OBELISK_CALENDAR_VALID(_LEAP_, _JULIAN_) ? OBELISK_CALENDAR_DAYOF(_LEAP_, _JULIAN_) : 0),
+
+const uint8_t OBELISK_CALENDAR_DAY[2][367] = {
+    { OBELISK_CALENDAR_JULIANS(DAY, 0) },
+    { OBELISK_CALENDAR_JULIANS(DAY, 1) },
+};
+
+#define WEEKDAY(_UNUSED_, _YY_) OBELISK_CALENDAR_WEEKDAYOF(OBELISK_CALENDAR_YEAR(_YY_)),
+
+const uint8_t OBELISK_CALENDAR_WEEKDAY[100] = {
+    OBELISK_CALENDAR_YEARS(WEEKDAY, 0)
+};
+
+#define CENTURY(_UNUSED_, _YY_) CENTURYDAYS(_YY_),
+
+const int32_t OBELISK_CALENDAR_CENTURY[100] = {
+    OBELISK_CALENDAR_YEARS(CENTURY, 0)
+};
+
+#define YEARDAYS(_UNUSED_, _YY_) OBELISK_CALENDAR_EPOCHDAYS(OBELISK_CALENDAR_YEAR(_YY_)),
+
+const int32_t OBELISK_YEARDAYS[100] = {
+    OBELISK_CALENDAR_YEARS(YEARDAYS, 0)
+};
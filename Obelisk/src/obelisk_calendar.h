@@ -0,0 +1,179 @@
+/* vim: set ts=4 expandtab shiftwidth=4: */
+#ifndef _COM_DIAG_OBELISK_OBELISK_CALENDAR_PRIVATE_H_
+#define _COM_DIAG_OBELISK_OBELISK_CALENDAR_PRIVATE_H_
+
+/**
+ * @file
+ *
+ * Copyright 2018 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in LICENSE.txt<BR>
+ * Chip Overclock<BR>
+ * mailto:coverclock@diag.com<BR>
+ * http://github.com/coverclock/com-diag-obelisk<BR>
+ *
+ * These are the calendar lookup tables used by the decoders. Every entry
+ * is a constant expression generated by the preprocessor from the macros
+ * below, and obelisk_calendar.c checks every one of those expressions
+ * with static_assert, so the tables are computed and verified entirely
+ * at compile time and the decoders do nothing at run time but index them.
+ *
+ * Tables indexed by a two digit year place it in the same century that
+ * obelisk_decode() does: 2017 through 2099 and then 2100 through 2116.
+ * OBELISK_CALENDAR_CENTURY instead covers 2000 through 2099, which is the
+ * century the PM time code counts minutes in.
+ */
+
+#include <stdint.h>
+
+/*******************************************************************************
+ * GENERATORS
+ ******************************************************************************/
+
+/**
+ * @def OBELISK_CALENDAR_LEAP
+ * This is true if the Gregorian year @a _YEAR_ is a leap year.
+ */
+#define OBELISK_CALENDAR_LEAP(_YEAR_) \
+    ((((_YEAR_) % 4) == 0) && ((((_YEAR_) % 100) != 0) || (((_YEAR_) % 400) == 0)))
+
+/**
+ * @def OBELISK_CALENDAR_YEAR
+ * This is the Gregorian year that obelisk_decode() assigns to the two
+ * digit year @a _YY_.
+ */
+#define OBELISK_CALENDAR_YEAR(_YY_) \
+    (((_YY_) < 17) ? (2100 + (_YY_)) : (2000 + (_YY_)))
+
+/**
+ * @def OBELISK_CALENDAR_BEFORE
+ * This is the number of days in the year before the first of the month
+ * @a _MONTH_ [1..12], or in the entire year if @a _MONTH_ is 13. From
+ * March on the month lengths repeat 31, 30, 31, 30, 31 every five months.
+ */
+#define OBELISK_CALENDAR_BEFORE(_LEAP_, _MONTH_) \
+    (((_MONTH_) <= 1) ? 0 : \
+     ((_MONTH_) == 2) ? 31 : \
+     ((((153 * ((_MONTH_) - 3)) + 2) / 5) + 59 + (_LEAP_)))
+
+/**
+ * @def OBELISK_CALENDAR_MONTHOF
+ * This is the month [1..12] of the day of the year @a _JULIAN_, using the
+ * same five month cycle from March on.
+ */
+#define OBELISK_CALENDAR_MONTHOF(_LEAP_, _JULIAN_) \
+    (((_JULIAN_) <= 31) ? 1 : \
+     ((_JULIAN_) <= (59 + (_LEAP_))) ? 2 : \
+     ((((5 * ((_JULIAN_) - 60 - (_LEAP_))) + 2) / 153) + 3))
+
+/**
+ * @def OBELISK_CALENDAR_DAYOF
+ * This is the day of the month [1..31] of the day of the year @a _JULIAN_.
+ */
+#define OBELISK_CALENDAR_DAYOF(_LEAP_, _JULIAN_) \
+    ((_JULIAN_) - OBELISK_CALENDAR_BEFORE(_LEAP_, OBELISK_CALENDAR_MONTHOF(_LEAP_, _JULIAN_)))
+
+/**
+ * @def OBELISK_CALENDAR_VALID
+ * This is true if @a _JULIAN_ is a day [1..365 or 366] of the year.
+ */
+#define OBELISK_CALENDAR_VALID(_LEAP_, _JULIAN_) \
+    ((1 <= (_JULIAN_)) && ((_JULIAN_) <= OBELISK_CALENDAR_BEFORE(_LEAP_, 13)))
+
+/**
+ * @def OBELISK_CALENDAR_EPOCHDAYS
+ * This is the number of days from the POSIX epoch to the first of January
+ * of the Gregorian year @a _YEAR_ (1970 or later).
+ */
+#define OBELISK_CALENDAR_EPOCHDAYS(_YEAR_) \
+    ((365 * ((_YEAR_) - 1970)) + (((_YEAR_) - 1969) / 4) - (((_YEAR_) - 1901) / 100) + (((_YEAR_) - 1601) / 400))
+
+/**
+ * @def OBELISK_CALENDAR_WEEKDAYOF
+ * This is the day of the week [0=Sunday..6=Saturday] of the first of
+ * January of the Gregorian year @a _YEAR_. The POSIX epoch was a Thursday.
+ */
+#define OBELISK_CALENDAR_WEEKDAYOF(_YEAR_) \
+    ((OBELISK_CALENDAR_EPOCHDAYS(_YEAR_) + 4) % 7)
+
+/*******************************************************************************
+ * REPETITION
+ ******************************************************************************/
+
+/*
+ * These apply the generator _F_ to the argument _A_ and each of a run of
+ * consecutive integers starting at _N_.
+ */
+
+#define OBELISK_CALENDAR_R1(_F_, _A_, _N_) _F_(_A_, _N_)
+
+#define OBELISK_CALENDAR_R10(_F_, _A_, _N_) \
+    _F_(_A_, (_N_) + 0) _F_(_A_, (_N_) + 1) _F_(_A_, (_N_) + 2) _F_(_A_, (_N_) + 3) _F_(_A_, (_N_) + 4) \
+    _F_(_A_, (_N_) + 5) _F_(_A_, (_N_) + 6) _F_(_A_, (_N_) + 7) _F_(_A_, (_N_) + 8) _F_(_A_, (_N_) + 9)
+
+#define OBELISK_CALENDAR_R100(_F_, _A_, _N_) \
+    OBELISK_CALENDAR_R10(_F_, _A_, (_N_) + 0) OBELISK_CALENDAR_R10(_F_, _A_, (_N_) + 10) \
+    OBELISK_CALENDAR_R10(_F_, _A_, (_N_) + 20) OBELISK_CALENDAR_R10(_F_, _A_, (_N_) + 30) \
+    OBELISK_CALENDAR_R10(_F_, _A_, (_N_) + 40) OBELISK_CALENDAR_R10(_F_, _A_, (_N_) + 50) \
+    OBELISK_CALENDAR_R10(_F_, _A_, (_N_) + 60) OBELISK_CALENDAR_R10(_F_, _A_, (_N_) + 70) \
+    OBELISK_CALENDAR_R10(_F_, _A_, (_N_) + 80) OBELISK_CALENDAR_R10(_F_, _A_, (_N_) + 90)
+
+/**
+ * @def OBELISK_CALENDAR_YEARS
+ * This applies _F_ to each two digit year [0..99].
+ */
+#define OBELISK_CALENDAR_YEARS(_F_, _A_) \
+    OBELISK_CALENDAR_R100(_F_, _A_, 0)
+
+/**
+ * @def OBELISK_CALENDAR_JULIANS
+ * This applies _F_ to each index [0..366] of a table by day of the year.
+ */
+#define OBELISK_CALENDAR_JULIANS(_F_, _A_) \
+    OBELISK_CALENDAR_R100(_F_, _A_, 0) OBELISK_CALENDAR_R100(_F_, _A_, 100) OBELISK_CALENDAR_R100(_F_, _A_, 200) \
+    OBELISK_CALENDAR_R10(_F_, _A_, 300) OBELISK_CALENDAR_R10(_F_, _A_, 310) OBELISK_CALENDAR_R10(_F_, _A_, 320) \
+    OBELISK_CALENDAR_R10(_F_, _A_, 330) OBELISK_CALENDAR_R10(_F_, _A_, 340) OBELISK_CALENDAR_R10(_F_, _A_, 350) \
+    OBELISK_CALENDAR_R1(_F_, _A_, 360) OBELISK_CALENDAR_R1(_F_, _A_, 361) OBELISK_CALENDAR_R1(_F_, _A_, 362) \
+    OBELISK_CALENDAR_R1(_F_, _A_, 363) OBELISK_CALENDAR_R1(_F_, _A_, 364) OBELISK_CALENDAR_R1(_F_, _A_, 365) \
+    OBELISK_CALENDAR_R1(_F_, _A_, 366)
+
+/*******************************************************************************
+ * TABLES
+ ******************************************************************************/
+
+/**
+ * These are the days in the year before the first of each month [0..11],
+ * and at the end of the year [12], for common [0] and leap [1] years.
+ */
+extern const int16_t OBELISK_CALENDAR_CUMULATIVE[2][13];
+
+/**
+ * These are the month [1..12] of each day of the year [1..365 or 366] for
+ * common [0] and leap [1] years, or zero if there is no such day.
+ */
+extern const uint8_t OBELISK_CALENDAR_MONTH[2][367];
+
+/**
+ * These are the day of the month [1..31] of each day of the year [1..365
+ * or 366] for common [0] and leap [1] years, or zero if there is no such day.
+ */
+extern const uint8_t OBELISK_CALENDAR_DAY[2][367];
+
+/**
+ * These are the day of the week [0=Sunday..6=Saturday] of the first of
+ * January of each two digit year.
+ */
+extern const uint8_t OBELISK_CALENDAR_WEEKDAY[100];
+
+/**
+ * These are the days from the first of January 2000 to the first of
+ * January of each year 2000 through 2099.
+ */
+extern const int32_t OBELISK_CALENDAR_CENTURY[100];
+
+/**
+ * These are the days from the POSIX epoch to the first of January of each
+ * two digit year. The batch decoders gather from this table.
+ */
+extern const int32_t OBELISK_YEARDAYS[100];
+
+#endif /*  _COM_DIAG_OBELISK_OBELISK_CALENDAR_PRIVATE_H_ */
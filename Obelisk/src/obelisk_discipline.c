@@ -0,0 +1,116 @@
+/* vim: set ts=4 expandtab shiftwidth=4: */
+
+/**
+ * @file
+ *
+ * Copyright 2018 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in LICENSE.txt<BR>
+ * Chip Overclock<BR>
+ * mailto:coverclock@diag.com<BR>
+ * http://github.com/coverclock/com-diag-obelisk<BR>
+ */
+
+#include <assert.h>
+#include <string.h>
+#include "com/diag/obelisk/obelisk_discipline.h"
+
+static const int64_t NANOSECONDS = 1000000000LL;
+
+void obelisk_discipline_init(obelisk_discipline_t * disciplinep, int milliseconds, int constant)
+{
+    assert(milliseconds >= 0);
+    assert((0 <= constant) && (constant <= 10));
+
+    memset(disciplinep, 0, sizeof(*disciplinep));
+
+    disciplinep->threshold = (int64_t)milliseconds * 1000000LL;
+    disciplinep->constant = constant;
+    disciplinep->state = -1;
+}
+
+int64_t obelisk_discipline_offset(const struct timespec * systemp, const struct timespec * referencep)
+{
+    return (((int64_t)systemp->tv_sec - (int64_t)referencep->tv_sec) * NANOSECONDS) + ((int64_t)systemp->tv_nsec - (int64_t)referencep->tv_nsec);
+}
+
+int obelisk_discipline_prepare(obelisk_discipline_t * disciplinep, struct timex * timexp, int64_t offset)
+{
+    int rc = -1;
+    int64_t correction = 0;
+    int64_t magnitude = 0;
+
+    memset(timexp, 0, sizeof(*timexp));
+
+    correction = -offset;
+    magnitude = (offset < 0) ? -offset : offset;
+
+    if (magnitude > disciplinep->threshold) {
+
+        /*
+         * The kernel adds the time to the clock atomically; with ADJ_NANO
+         * the microseconds are nanoseconds and must not be negative.
+         */
+
+        timexp->modes = ADJ_SETOFFSET | ADJ_NANO;
+        timexp->time.tv_sec = correction / NANOSECONDS;
+        timexp->time.tv_usec = correction % NANOSECONDS;
+        if (timexp->time.tv_usec < 0) {
+            timexp->time.tv_sec -= 1;
+            timexp->time.tv_usec += NANOSECONDS;
+        }
+
+        rc = 1;
+
+    } else {
+
+        /*
+         * The kernel PLL slews out the offset, estimating the frequency
+         * error as it does so. Not setting STA_UNSYNC tells the kernel
+         * the clock is synchronized, so it also keeps the RTC updated.
+         */
+
+        if (correction > ((int64_t)OBELISK_DISCIPLINE_MAXPHASE * 1000000LL)) {
+            correction = (int64_t)OBELISK_DISCIPLINE_MAXPHASE * 1000000LL;
+        } else if (correction < -((int64_t)OBELISK_DISCIPLINE_MAXPHASE * 1000000LL)) {
+            correction = -((int64_t)OBELISK_DISCIPLINE_MAXPHASE * 1000000LL);
+        } else {
+            /* Do nothing. */
+        }
+
+        timexp->modes = ADJ_OFFSET | ADJ_STATUS | ADJ_NANO | ADJ_TIMECONST | ADJ_MAXERROR | ADJ_ESTERROR;
+        timexp->offset = correction;
+        timexp->status = STA_PLL | (disciplinep->leap ? STA_INS : 0);
+        timexp->constant = disciplinep->constant;
+        timexp->maxerror = magnitude / 1000;
+        timexp->esterror = magnitude / 1000;
+
+        rc = 0;
+
+    }
+
+    return rc;
+}
+
+int obelisk_discipline_adjust(obelisk_discipline_t * disciplinep, int64_t offset)
+{
+    int rc = -1;
+    int state = -1;
+    struct timex timex;
+
+    rc = obelisk_discipline_prepare(disciplinep, &timex, offset);
+    disciplinep->offset = offset;
+
+    if ((state = adjtimex(&timex)) < 0) {
+        rc = -1;
+    } else {
+        disciplinep->state = state;
+        disciplinep->frequency = timex.freq;
+        if (rc > 0) {
+            disciplinep->steps += 1;
+        } else {
+            disciplinep->slews += 1;
+        }
+    }
+
+    return rc;
+}
@@ -0,0 +1,301 @@
+/* vim: set ts=4 expandtab shiftwidth=4: */
+
+/**
+ * @file
+ *
+ * Copyright 2018 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in LICENSE.txt<BR>
+ * Chip Overclock<BR>
+ * mailto:coverclock@diag.com<BR>
+ * http://github.com/coverclock/com-diag-obelisk<BR>
+ */
+
+#include <assert.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include "com/diag/obelisk/obelisk_fanout.h"
+
+static void wake(obelisk_fanout_t * fp)
+{
+    static const char BYTE = '\0';
+
+    /*
+     * If the pipe is full the thread is already awake.
+     */
+
+    if (write(fp->wake[1], &BYTE, sizeof(BYTE)) < 0) {
+        /* Do nothing. */
+    }
+}
+
+/*
+ * Write (some of) the message at the tail of a sink's queue. Only the thread
+ * touches the tail, so the message can be written without holding the
+ * mutex; the caller only ever touches the head.
+ */
+static void flush(obelisk_fanout_t * fp, obelisk_fanout_sink_t * sp)
+{
+    unsigned int slot = 0;
+    const char * buffer = (const char *)0;
+    size_t length = 0;
+    ssize_t rc = -1;
+    int error = 0;
+
+    pthread_mutex_lock(&fp->mutex);
+    if (sp->head != sp->tail) {
+        slot = sp->tail % OBELISK_FANOUT_DEPTH;
+        buffer = &sp->messages[slot][sp->offset];
+        length = sp->lengths[slot] - sp->offset;
+    }
+    pthread_mutex_unlock(&fp->mutex);
+
+    if (length > 0) {
+
+        if (sp->functionp != (obelisk_fanout_function_t *)0) {
+            rc = (*sp->functionp)(sp->context, sp->fd, buffer, length);
+        } else {
+            rc = write(sp->fd, buffer, length);
+        }
+        error = errno;
+
+        pthread_mutex_lock(&fp->mutex);
+        if (rc < 0) {
+            if ((error == EINTR) || (error == EAGAIN) || (error == EWOULDBLOCK)) {
+                /* Do nothing. */
+            } else {
+                sp->statistics.failed += 1;
+                sp->offset = 0;
+                sp->tail += 1;
+            }
+        } else if (rc < length) {
+            sp->offset += rc;
+        } else {
+            sp->statistics.written += 1;
+            sp->offset = 0;
+            sp->tail += 1;
+        }
+        pthread_mutex_unlock(&fp->mutex);
+
+    }
+}
+
+static void * drain(void * arg)
+{
+    obelisk_fanout_t * fp = (obelisk_fanout_t *)arg;
+    struct pollfd fds[1 + OBELISK_FANOUT_SINKS];
+    obelisk_fanout_sink_t * sinks[1 + OBELISK_FANOUT_SINKS];
+    char scratch[64];
+    nfds_t nfds = 0;
+    nfds_t ii = 0;
+    int stopping = 0;
+    int rc = -1;
+
+    while (!0) {
+
+        /*
+         * Wait for the pipe to say there is more to write, or for a sink
+         * with something queued to be able to take (some of) it.
+         */
+
+        nfds = 0;
+        fds[nfds].fd = fp->wake[0];
+        fds[nfds].events = POLLIN;
+        sinks[nfds] = (obelisk_fanout_sink_t *)0;
+        ++nfds;
+
+        pthread_mutex_lock(&fp->mutex);
+        stopping = fp->stopping;
+        for (ii = 0; ii < fp->count; ++ii) {
+            if (fp->sinks[ii].head != fp->sinks[ii].tail) {
+                fds[nfds].fd = fp->sinks[ii].fd;
+                fds[nfds].events = POLLOUT;
+                sinks[nfds] = &fp->sinks[ii];
+                ++nfds;
+            }
+        }
+        pthread_mutex_unlock(&fp->mutex);
+
+        if (stopping) {
+            break;
+        }
+
+        rc = poll(fds, nfds, -1);
+        if (rc > 0) {
+            /* Do nothing. */
+        } else if ((rc < 0) && (errno == EINTR)) {
+            continue;
+        } else {
+            break;
+        }
+
+        if (fds[0].revents != 0) {
+            while (read(fp->wake[0], scratch, sizeof(scratch)) > 0) {
+                /* Do nothing. */
+            }
+        }
+
+        for (ii = 1; ii < nfds; ++ii) {
+            if (fds[ii].revents != 0) {
+                flush(fp, sinks[ii]);
+            }
+        }
+
+    }
+
+    return (void *)0;
+}
+
+int obelisk_fanout_init(obelisk_fanout_t * fp)
+{
+    int rc = -1;
+
+    memset(fp, 0, sizeof(*fp));
+    fp->wake[0] = -1;
+    fp->wake[1] = -1;
+
+    if ((rc = pthread_mutex_init(&fp->mutex, (pthread_mutexattr_t *)0)) != 0) {
+        errno = rc;
+        rc = -1;
+    } else if ((rc = pipe(fp->wake)) < 0) {
+        pthread_mutex_destroy(&fp->mutex);
+    } else if (((rc = fcntl(fp->wake[0], F_SETFL, O_NONBLOCK)) < 0) || ((rc = fcntl(fp->wake[1], F_SETFL, O_NONBLOCK)) < 0)) {
+        (void)close(fp->wake[0]);
+        (void)close(fp->wake[1]);
+        pthread_mutex_destroy(&fp->mutex);
+    } else {
+        /* Do nothing. */
+    }
+
+    return rc;
+}
+
+int obelisk_fanout_add(obelisk_fanout_t * fp, int fd, obelisk_fanout_function_t * functionp, void * context)
+{
+    int index = -1;
+    int flags = -1;
+
+    if (fp->running) {
+        errno = EBUSY;
+    } else if (fp->count >= OBELISK_FANOUT_SINKS) {
+        errno = ENOSPC;
+    } else if ((flags = fcntl(fd, F_GETFL)) < 0) {
+        /* Do nothing. */
+    } else if (fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+        /* Do nothing. */
+    } else {
+        index = fp->count++;
+        fp->sinks[index].fd = fd;
+        fp->sinks[index].functionp = functionp;
+        fp->sinks[index].context = context;
+    }
+
+    return index;
+}
+
+int obelisk_fanout_start(obelisk_fanout_t * fp)
+{
+    int rc = -1;
+    sigset_t all;
+    sigset_t old;
+
+    sigfillset(&all);
+
+    if (fp->running) {
+        errno = EBUSY;
+    } else if ((rc = pthread_sigmask(SIG_SETMASK, &all, &old)) != 0) {
+        errno = rc;
+        rc = -1;
+    } else {
+        rc = pthread_create(&fp->thread, (pthread_attr_t *)0, drain, fp);
+        pthread_sigmask(SIG_SETMASK, &old, (sigset_t *)0);
+        if (rc != 0) {
+            errno = rc;
+            rc = -1;
+        } else {
+            fp->running = !0;
+        }
+    }
+
+    return rc;
+}
+
+int obelisk_fanout_post(obelisk_fanout_t * fp, const void * buffer, size_t length)
+{
+    int queued = -1;
+    int ii = 0;
+    obelisk_fanout_sink_t * sp = (obelisk_fanout_sink_t *)0;
+    unsigned int slot = 0;
+
+    if (length > OBELISK_FANOUT_SIZE) {
+        errno = EMSGSIZE;
+    } else {
+
+        queued = 0;
+
+        pthread_mutex_lock(&fp->mutex);
+        for (ii = 0; ii < fp->count; ++ii) {
+            sp = &fp->sinks[ii];
+            if ((sp->head - sp->tail) >= OBELISK_FANOUT_DEPTH) {
+                sp->statistics.dropped += 1;
+            } else {
+                slot = sp->head % OBELISK_FANOUT_DEPTH;
+                memcpy(sp->messages[slot], buffer, length);
+                sp->lengths[slot] = length;
+                sp->head += 1;
+                sp->statistics.queued += 1;
+                queued += 1;
+            }
+        }
+        pthread_mutex_unlock(&fp->mutex);
+
+        if (queued > 0) {
+            wake(fp);
+        }
+
+    }
+
+    return queued;
+}
+
+void obelisk_fanout_statistics(obelisk_fanout_t * fp, int index, obelisk_fanout_statistics_t * statisticsp)
+{
+    assert((0 <= index) && (index < fp->count));
+
+    pthread_mutex_lock(&fp->mutex);
+    *statisticsp = fp->sinks[index].statistics;
+    pthread_mutex_unlock(&fp->mutex);
+}
+
+int obelisk_fanout_stop(obelisk_fanout_t * fp)
+{
+    int rc = 0;
+
+    if (fp->running) {
+        pthread_mutex_lock(&fp->mutex);
+        fp->stopping = !0;
+        pthread_mutex_unlock(&fp->mutex);
+        wake(fp);
+        if ((rc = pthread_join(fp->thread, (void **)0)) != 0) {
+            errno = rc;
+            rc = -1;
+        }
+        fp->running = 0;
+    }
+
+    return rc;
+}
+
+void obelisk_fanout_fini(obelisk_fanout_t * fp)
+{
+    assert(!fp->running);
+
+    (void)close(fp->wake[0]);
+    (void)close(fp->wake[1]);
+    fp->wake[0] = -1;
+    fp->wake[1] = -1;
+    pthread_mutex_destroy(&fp->mutex);
+}
@@ -0,0 +1,144 @@
+/* vim: set ts=4 expandtab shiftwidth=4: */
+
+/**
+ * @file
+ *
+ * Copyright 2018 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in LICENSE.txt<BR>
+ * Chip Overclock<BR>
+ * mailto:coverclock@diag.com<BR>
+ * http://github.com/coverclock/com-diag-obelisk<BR>
+ */
+
+#define _GNU_SOURCE /* recvmmsg(2) */
+
+#include <assert.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "com/diag/obelisk/obelisk_message.h"
+
+void obelisk_message_init(obelisk_message_t * mp)
+{
+    memset(mp, 0, sizeof(*mp));
+    mp->magic = OBELISK_MESSAGE_MAGIC;
+    mp->version = OBELISK_MESSAGE_VERSION;
+    mp->lock = OBELISK_MESSAGE_LOCK_NONE;
+    mp->uncertainty = -1;
+}
+
+void obelisk_message_status(obelisk_message_t * mp, int dut1, int leap, obelisk_dst_t dst)
+{
+    mp->dut1 = dut1 * 100;
+    mp->leap = !!leap;
+    mp->dst = dst;
+}
+
+void obelisk_message_prepare(obelisk_message_t * mp, obelisk_message_lock_t lock, time_t seconds, int32_t nanoseconds, int64_t uncertainty)
+{
+    mp->lock = lock;
+    mp->seconds = seconds;
+    mp->nanoseconds = nanoseconds;
+    if (uncertainty < 0) {
+        mp->uncertainty = -1;
+    } else if (uncertainty > INT32_MAX) {
+        mp->uncertainty = INT32_MAX;
+    } else {
+        mp->uncertainty = uncertainty;
+    }
+    mp->sequence += 1;
+}
+
+int obelisk_message_valid(const obelisk_message_t * mp, size_t length)
+{
+    return (length == sizeof(*mp)) && (mp->magic == OBELISK_MESSAGE_MAGIC) && (mp->version == OBELISK_MESSAGE_VERSION);
+}
+
+/*
+ * Connect or bind a UNIX domain datagram socket to a path.
+ */
+static int plumb(const char * path, int (*functionp)(int, const struct sockaddr *, socklen_t))
+{
+    int sock = -1;
+    struct sockaddr_un address = { 0 };
+
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, path, sizeof(address.sun_path) - 1);
+
+    if (strlen(path) >= sizeof(address.sun_path)) {
+        errno = ENAMETOOLONG;
+    } else if ((sock = socket(AF_UNIX, SOCK_DGRAM, 0)) < 0) {
+        /* Do nothing. */
+    } else if ((*functionp)(sock, (struct sockaddr *)&address, sizeof(address)) < 0) {
+        (void)close(sock);
+        sock = -1;
+    } else {
+        /* Do nothing. */
+    }
+
+    return sock;
+}
+
+int obelisk_message_open(const char * path)
+{
+    return plumb(path, connect);
+}
+
+int obelisk_message_bind(const char * path)
+{
+    return plumb(path, bind);
+}
+
+int obelisk_message_close(int sock)
+{
+    return close(sock);
+}
+
+int obelisk_message_send(int sock, const obelisk_message_t * mp)
+{
+    return send(sock, mp, sizeof(*mp), 0);
+}
+
+int obelisk_message_receive(int sock, obelisk_message_t * messages, int count)
+{
+    struct mmsghdr headers[OBELISK_MESSAGE_BATCH];
+    struct iovec vectors[OBELISK_MESSAGE_BATCH];
+    int received = -1;
+    int valid = 0;
+    int ii = 0;
+
+    assert((0 < count) && (count <= OBELISK_MESSAGE_BATCH));
+
+    /*
+     * Each datagram lands directly in its own message; a datagram longer
+     * than a message is truncated, and flagged, and so discarded.
+     */
+
+    memset(headers, 0, sizeof(headers));
+    for (ii = 0; ii < count; ++ii) {
+        vectors[ii].iov_base = &messages[ii];
+        vectors[ii].iov_len = sizeof(messages[ii]);
+        headers[ii].msg_hdr.msg_iov = &vectors[ii];
+        headers[ii].msg_hdr.msg_iovlen = 1;
+    }
+
+    if ((received = recvmmsg(sock, headers, count, MSG_WAITFORONE, (struct timespec *)0)) < 0) {
+        valid = -1;
+    } else {
+        for (ii = 0; ii < received; ++ii) {
+            if ((headers[ii].msg_hdr.msg_flags & MSG_TRUNC) != 0) {
+                /* Do nothing. */
+            } else if (!obelisk_message_valid(&messages[ii], headers[ii].msg_len)) {
+                /* Do nothing. */
+            } else if (valid == ii) {
+                ++valid;
+            } else {
+                messages[valid++] = messages[ii];
+            }
+        }
+    }
+
+    return valid;
+}
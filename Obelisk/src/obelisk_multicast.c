@@ -0,0 +1,323 @@
+/* vim: set ts=4 expandtab shiftwidth=4: */
+
+/**
+ * @file
+ *
+ * Copyright 2018 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in LICENSE.txt<BR>
+ * Chip Overclock<BR>
+ * mailto:coverclock@diag.com<BR>
+ * http://github.com/coverclock/com-diag-obelisk<BR>
+ */
+
+#define _GNU_SOURCE /* sendmmsg(2) */
+
+#include <assert.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <linux/errqueue.h>
+#include <linux/net_tstamp.h>
+#include "com/diag/obelisk/obelisk_multicast.h"
+
+static const int64_t NANOSECONDS = 1000000000LL;
+
+static void put(uint8_t * buffer, uint64_t value, size_t length)
+{
+    while (length > 0) {
+        length -= 1;
+        buffer[length] = value & 0xff;
+        value >>= 8;
+    }
+}
+
+static uint64_t get(const uint8_t * buffer, size_t length)
+{
+    uint64_t value = 0;
+    size_t ii = 0;
+
+    for (ii = 0; ii < length; ++ii) {
+        value = (value << 8) | buffer[ii];
+    }
+
+    return value;
+}
+
+void obelisk_multicast_encode(uint8_t * buffer, const obelisk_multicast_announcement_t * ap)
+{
+    put(&buffer[0], OBELISK_MULTICAST_MAGIC, 4);
+    put(&buffer[4], ap->version, 1);
+    put(&buffer[5], ap->flags, 1);
+    put(&buffer[6], ap->sequence, 2);
+    put(&buffer[8], (uint64_t)ap->seconds, 8);
+    put(&buffer[16], (uint32_t)ap->previous, 4);
+}
+
+int obelisk_multicast_decode(obelisk_multicast_announcement_t * ap, const uint8_t * buffer, size_t length)
+{
+    int rc = -1;
+
+    if (length < OBELISK_MULTICAST_LENGTH) {
+        /* Do nothing. */
+    } else if (get(&buffer[0], 4) != OBELISK_MULTICAST_MAGIC) {
+        /* Do nothing. */
+    } else if (get(&buffer[4], 1) != OBELISK_MULTICAST_VERSION) {
+        /* Do nothing. */
+    } else {
+        ap->version = get(&buffer[4], 1);
+        ap->flags = get(&buffer[5], 1);
+        ap->sequence = get(&buffer[6], 2);
+        ap->seconds = (int64_t)get(&buffer[8], 8);
+        ap->previous = (int32_t)(uint32_t)get(&buffer[16], 4);
+        rc = 0;
+    }
+
+    return rc;
+}
+
+/*
+ * Open the socket for an address family, with the TTL or hop limit, the
+ * interface, and transmit timestamps.
+ */
+static int plumb(obelisk_multicast_t * mp, int family)
+{
+    int sock = -1;
+    int ttl = 0;
+    int timestamping = 0;
+    struct ip_mreqn mreqn = { 0 };
+
+    ttl = mp->ttl;
+    timestamping = SOF_TIMESTAMPING_TX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE | SOF_TIMESTAMPING_OPT_TSONLY;
+    mreqn.imr_ifindex = mp->interface;
+
+    if ((sock = socket(family, SOCK_DGRAM, 0)) < 0) {
+        /* Do nothing. */
+    } else if ((family == AF_INET) && (setsockopt(sock, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl)) < 0)) {
+        (void)close(sock);
+        sock = -1;
+    } else if ((family == AF_INET) && (mp->interface != 0) && (setsockopt(sock, IPPROTO_IP, IP_MULTICAST_IF, &mreqn, sizeof(mreqn)) < 0)) {
+        (void)close(sock);
+        sock = -1;
+    } else if ((family == AF_INET6) && (setsockopt(sock, IPPROTO_IPV6, IPV6_MULTICAST_HOPS, &ttl, sizeof(ttl)) < 0)) {
+        (void)close(sock);
+        sock = -1;
+    } else if ((family == AF_INET6) && (mp->interface != 0) && (setsockopt(sock, IPPROTO_IPV6, IPV6_MULTICAST_IF, &mp->interface, sizeof(mp->interface)) < 0)) {
+        (void)close(sock);
+        sock = -1;
+    } else if (setsockopt(sock, SOL_SOCKET, SO_TIMESTAMPING, &timestamping, sizeof(timestamping)) < 0) {
+        (void)close(sock);
+        sock = -1;
+    } else {
+        /* Do nothing. */
+    }
+
+    return sock;
+}
+
+/*
+ * Collect the transmit timestamps of the last announcement from the error
+ * queue of a socket, keeping how long after its edge the earliest one was.
+ */
+static void collect(obelisk_multicast_t * mp, int sock)
+{
+    char control[256];
+    struct msghdr message = { 0 };
+    struct cmsghdr * cp = (struct cmsghdr *)0;
+    const struct scm_timestamping * tsp = (const struct scm_timestamping *)0;
+    int64_t delay = 0;
+
+    while (!0) {
+
+        memset(&message, 0, sizeof(message));
+        message.msg_control = control;
+        message.msg_controllen = sizeof(control);
+
+        if (recvmsg(sock, &message, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) {
+            break;
+        }
+
+        for (cp = CMSG_FIRSTHDR(&message); cp != (struct cmsghdr *)0; cp = CMSG_NXTHDR(&message, cp)) {
+            if ((cp->cmsg_level != SOL_SOCKET) || (cp->cmsg_type != SCM_TIMESTAMPING)) {
+                continue;
+            }
+            tsp = (const struct scm_timestamping *)CMSG_DATA(cp);
+            delay = ((tsp->ts[0].tv_sec - mp->edge.tv_sec) * NANOSECONDS) + (tsp->ts[0].tv_nsec - mp->edge.tv_nsec);
+            if ((delay < 0) || (delay >= NANOSECONDS)) {
+                /* Do nothing. */
+            } else if ((mp->previous < 0) || (delay < mp->previous)) {
+                mp->previous = delay;
+            } else {
+                /* Do nothing. */
+            }
+        }
+
+    }
+}
+
+/*
+ * Send the announcement to every destination of an address family at
+ * once.
+ */
+static int batch(obelisk_multicast_t * mp, int sock, int family, uint8_t * buffer)
+{
+    struct mmsghdr messages[OBELISK_MULTICAST_DESTINATIONS];
+    struct iovec vector = { 0 };
+    int count = 0;
+    int ii = 0;
+
+    vector.iov_base = buffer;
+    vector.iov_len = OBELISK_MULTICAST_LENGTH;
+
+    memset(messages, 0, sizeof(messages));
+    for (ii = 0; ii < mp->count; ++ii) {
+        if (mp->destinations[ii].ss_family == family) {
+            messages[count].msg_hdr.msg_name = &mp->destinations[ii];
+            messages[count].msg_hdr.msg_namelen = mp->lengths[ii];
+            messages[count].msg_hdr.msg_iov = &vector;
+            messages[count].msg_hdr.msg_iovlen = 1;
+            ++count;
+        }
+    }
+
+    return (count > 0) ? sendmmsg(sock, messages, count, 0) : 0;
+}
+
+int obelisk_multicast_init(obelisk_multicast_t * mp, const char * interface, int ttl)
+{
+    int rc = -1;
+
+    memset(mp, 0, sizeof(*mp));
+    mp->sock4 = -1;
+    mp->sock6 = -1;
+    mp->ttl = ttl;
+    mp->previous = -1;
+
+    if (interface == (const char *)0) {
+        rc = 0;
+    } else if ((mp->interface = if_nametoindex(interface)) == 0) {
+        /* Do nothing. */
+    } else {
+        rc = 0;
+    }
+
+    return rc;
+}
+
+int obelisk_multicast_add(obelisk_multicast_t * mp, const char * group, int port)
+{
+    int rc = -1;
+    struct sockaddr_in * in4p = (struct sockaddr_in *)0;
+    struct sockaddr_in6 * in6p = (struct sockaddr_in6 *)0;
+
+    /*
+     * At capacity these point one past the end and are never dereferenced.
+     */
+    in4p = (struct sockaddr_in *)&mp->destinations[mp->count];
+    in6p = (struct sockaddr_in6 *)&mp->destinations[mp->count];
+
+    if (mp->count >= OBELISK_MULTICAST_DESTINATIONS) {
+        errno = ENOSPC;
+    } else if ((port <= 0) || (port > 65535)) {
+        errno = EINVAL;
+    } else if (inet_pton(AF_INET, group, &in4p->sin_addr) == 1) {
+        if (!IN_MULTICAST(ntohl(in4p->sin_addr.s_addr))) {
+            errno = EINVAL;
+        } else if ((mp->sock4 < 0) && ((mp->sock4 = plumb(mp, AF_INET)) < 0)) {
+            /* Do nothing. */
+        } else {
+            in4p->sin_family = AF_INET;
+            in4p->sin_port = htons(port);
+            mp->lengths[mp->count++] = sizeof(*in4p);
+            rc = 0;
+        }
+    } else if (inet_pton(AF_INET6, group, &in6p->sin6_addr) == 1) {
+        if (!IN6_IS_ADDR_MULTICAST(&in6p->sin6_addr)) {
+            errno = EINVAL;
+        } else if ((mp->sock6 < 0) && ((mp->sock6 = plumb(mp, AF_INET6)) < 0)) {
+            /* Do nothing. */
+        } else {
+            in6p->sin6_family = AF_INET6;
+            in6p->sin6_port = htons(port);
+            in6p->sin6_scope_id = mp->interface;
+            mp->lengths[mp->count++] = sizeof(*in6p);
+            rc = 0;
+        }
+    } else {
+        errno = EINVAL;
+    }
+
+    if ((rc < 0) && (mp->count < OBELISK_MULTICAST_DESTINATIONS)) {
+        memset(&mp->destinations[mp->count], 0, sizeof(mp->destinations[mp->count]));
+    }
+
+    return rc;
+}
+
+int obelisk_multicast_send(obelisk_multicast_t * mp, time_t seconds, const struct timespec * edgep, int flags)
+{
+    uint8_t buffer[OBELISK_MULTICAST_LENGTH];
+    obelisk_multicast_announcement_t announcement = { 0 };
+    int sent = 0;
+    int rc = 0;
+    int error = 0;
+
+    /*
+     * By now the kernel has long since timestamped the last announcement.
+     */
+
+    mp->previous = -1;
+    if (mp->sock4 >= 0) {
+        collect(mp, mp->sock4);
+    }
+    if (mp->sock6 >= 0) {
+        collect(mp, mp->sock6);
+    }
+
+    announcement.version = OBELISK_MULTICAST_VERSION;
+    announcement.flags = flags;
+    announcement.sequence = mp->sequence++;
+    announcement.seconds = seconds;
+    announcement.previous = mp->previous;
+    obelisk_multicast_encode(buffer, &announcement);
+
+    mp->edge = *edgep;
+
+    if (mp->sock4 < 0) {
+        /* Do nothing. */
+    } else if ((rc = batch(mp, mp->sock4, AF_INET, buffer)) < 0) {
+        error = errno;
+    } else {
+        sent += rc;
+    }
+
+    if (mp->sock6 < 0) {
+        /* Do nothing. */
+    } else if ((rc = batch(mp, mp->sock6, AF_INET6, buffer)) < 0) {
+        error = errno;
+    } else {
+        sent += rc;
+    }
+
+    if ((sent == 0) && (error != 0)) {
+        errno = error;
+        sent = -1;
+    }
+
+    return sent;
+}
+
+void obelisk_multicast_fini(obelisk_multicast_t * mp)
+{
+    if (mp->sock4 >= 0) {
+        (void)close(mp->sock4);
+        mp->sock4 = -1;
+    }
+    if (mp->sock6 >= 0) {
+        (void)close(mp->sock6);
+        mp->sock6 = -1;
+    }
+}
@@ -0,0 +1,204 @@
+/* vim: set ts=4 expandtab shiftwidth=4: */
+
+/**
+ * @file
+ *
+ * Copyright 2018 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in LICENSE.txt<BR>
+ * Chip Overclock<BR>
+ * mailto:coverclock@diag.com<BR>
+ * http://github.com/coverclock/com-diag-obelisk<BR>
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include "com/diag/obelisk/obelisk_nmea.h"
+
+/*
+ * Offsets of the fields within each sentence, which follow from the
+ * formats below.
+ */
+
+enum Offsets {
+    RMC_HOURS       = 7,
+    RMC_MINUTES     = 9,
+    RMC_SECONDS     = 11,
+    RMC_HUNDREDTHS  = 14,
+    RMC_DAY         = 25,
+    RMC_MONTH       = 27,
+    RMC_YEAR        = 29,
+    RMC_MODE        = 34,
+    RMC_STAR        = 35,
+    ZDA_HOURS       = 7,
+    ZDA_MINUTES     = 9,
+    ZDA_SECONDS     = 11,
+    ZDA_HUNDREDTHS  = 14,
+    ZDA_DAY         = 17,
+    ZDA_MONTH       = 20,
+    ZDA_CENTURY     = 23,
+    ZDA_YEAR        = 25,
+    ZDA_STAR        = 33,
+    STATUS_SIGN     = 7,
+    STATUS_TENTHS   = 10,
+    STATUS_LSW      = 12,
+    STATUS_DST      = 14,
+    STATUS_QUALITY  = 16,
+    STATUS_STAR     = 18,
+    RMC_LENGTH      = 40,
+    ZDA_LENGTH      = 38,
+    STATUS_LENGTH   = 23,
+};
+
+static const char RMC[] = "$%2.2sRMC,000000.00,A,,,,,,,010170,,,D*00\r\n";
+static const char ZDA[] = "$%2.2sZDA,000000.00,01,01,1970,00,00*00\r\n";
+static const char STATUS[] = "$PWWVB,+0.0,0,0,00*00\r\n";
+
+static const size_t STAR[OBELISK_NMEA_COUNT] = { RMC_STAR, ZDA_STAR, STATUS_STAR, };
+
+static const char HEX[] = "0123456789ABCDEF";
+
+/*
+ * Where each sentence begins in the buffer. They are all fixed length.
+ */
+
+static const size_t BEGIN[OBELISK_NMEA_COUNT] = { 0, RMC_LENGTH, RMC_LENGTH + ZDA_LENGTH, };
+
+static void seal(obelisk_nmea_t * np, obelisk_nmea_sentence_t sentence)
+{
+    char * here = (char *)0;
+
+    here = &np->buffer[BEGIN[sentence] + STAR[sentence] + 1];
+    here[0] = HEX[(np->checksum[sentence] >> 4) & 0xf];
+    here[1] = HEX[np->checksum[sentence] & 0xf];
+}
+
+static void patch(obelisk_nmea_t * np, obelisk_nmea_sentence_t sentence, size_t offset, char character)
+{
+    char * here = (char *)0;
+
+    here = &np->buffer[BEGIN[sentence] + offset];
+    if (*here != character) {
+        np->checksum[sentence] ^= (unsigned char)*here ^ (unsigned char)character;
+        *here = character;
+    }
+}
+
+static void digits(obelisk_nmea_t * np, obelisk_nmea_sentence_t sentence, size_t offset, int value)
+{
+    patch(np, sentence, offset, '0' + ((value / 10) % 10));
+    patch(np, sentence, offset + 1, '0' + (value % 10));
+}
+
+void obelisk_nmea_init(obelisk_nmea_t * np, const char * talker, int extra)
+{
+    obelisk_nmea_sentence_t sentence = (obelisk_nmea_sentence_t)-1;
+    int rc = -1;
+    const char * here = (const char *)0;
+    time_t zero = 0;
+    struct tm * timep = (struct tm *)0;
+
+    memset(np, 0, sizeof(*np));
+
+    /*
+     * Each sentence overwrites the terminating NUL of the one before it.
+     */
+
+    rc = snprintf(&np->buffer[BEGIN[OBELISK_NMEA_RMC]], RMC_LENGTH + 1, RMC, talker);
+    assert(rc == RMC_LENGTH);
+    rc = snprintf(&np->buffer[BEGIN[OBELISK_NMEA_ZDA]], ZDA_LENGTH + 1, ZDA, talker);
+    assert(rc == ZDA_LENGTH);
+    assert(strlen(STATUS) == STATUS_LENGTH);
+    strcpy(&np->buffer[BEGIN[OBELISK_NMEA_STATUS]], STATUS);
+
+    /*
+     * The checksum covers everything between the '$' and the '*'.
+     */
+
+    for (sentence = OBELISK_NMEA_RMC; sentence < OBELISK_NMEA_COUNT; ++sentence) {
+        assert(np->buffer[BEGIN[sentence] + STAR[sentence]] == '*');
+        for (here = &np->buffer[BEGIN[sentence] + 1]; *here != '*'; ++here) {
+            np->checksum[sentence] ^= (unsigned char)*here;
+        }
+        seal(np, sentence);
+    }
+
+    assert(strlen(np->buffer) == (RMC_LENGTH + ZDA_LENGTH + STATUS_LENGTH));
+    np->length = extra ? (RMC_LENGTH + ZDA_LENGTH + STATUS_LENGTH) : RMC_LENGTH;
+
+    np->seconds = zero;
+    timep = gmtime_r(&zero, &np->time);
+    assert(timep == &np->time);
+}
+
+void obelisk_nmea_time(obelisk_nmea_t * np, time_t seconds)
+{
+    struct tm * timep = (struct tm *)0;
+
+    if (seconds == np->seconds) {
+        /* Do nothing. */
+    } else if ((seconds == (np->seconds + 1)) && (np->time.tm_sec < 59)) {
+        np->time.tm_sec += 1;
+    } else {
+        timep = gmtime_r(&seconds, &np->time);
+        assert(timep == &np->time);
+    }
+
+    np->seconds = seconds;
+
+    /*
+     * Digits that haven't changed are left alone, as is the checksum.
+     */
+
+    digits(np, OBELISK_NMEA_RMC, RMC_HOURS, np->time.tm_hour);
+    digits(np, OBELISK_NMEA_RMC, RMC_MINUTES, np->time.tm_min);
+    digits(np, OBELISK_NMEA_RMC, RMC_SECONDS, np->time.tm_sec);
+    digits(np, OBELISK_NMEA_RMC, RMC_DAY, np->time.tm_mday);
+    digits(np, OBELISK_NMEA_RMC, RMC_MONTH, np->time.tm_mon + 1);
+    digits(np, OBELISK_NMEA_RMC, RMC_YEAR, (np->time.tm_year + 1900) % 100);
+    seal(np, OBELISK_NMEA_RMC);
+
+    digits(np, OBELISK_NMEA_ZDA, ZDA_HOURS, np->time.tm_hour);
+    digits(np, OBELISK_NMEA_ZDA, ZDA_MINUTES, np->time.tm_min);
+    digits(np, OBELISK_NMEA_ZDA, ZDA_SECONDS, np->time.tm_sec);
+    digits(np, OBELISK_NMEA_ZDA, ZDA_DAY, np->time.tm_mday);
+    digits(np, OBELISK_NMEA_ZDA, ZDA_MONTH, np->time.tm_mon + 1);
+    digits(np, OBELISK_NMEA_ZDA, ZDA_CENTURY, (np->time.tm_year + 1900) / 100);
+    digits(np, OBELISK_NMEA_ZDA, ZDA_YEAR, (np->time.tm_year + 1900) % 100);
+    seal(np, OBELISK_NMEA_ZDA);
+}
+
+void obelisk_nmea_hundredths(obelisk_nmea_t * np, int hundredths)
+{
+    digits(np, OBELISK_NMEA_RMC, RMC_HUNDREDTHS, hundredths);
+    seal(np, OBELISK_NMEA_RMC);
+
+    digits(np, OBELISK_NMEA_ZDA, ZDA_HUNDREDTHS, hundredths);
+    seal(np, OBELISK_NMEA_ZDA);
+}
+
+void obelisk_nmea_mode(obelisk_nmea_t * np, char mode)
+{
+    patch(np, OBELISK_NMEA_RMC, RMC_MODE, mode);
+    seal(np, OBELISK_NMEA_RMC);
+}
+
+void obelisk_nmea_status(obelisk_nmea_t * np, int dut1, int lsw, obelisk_dst_t dst, int quality)
+{
+    patch(np, OBELISK_NMEA_STATUS, STATUS_SIGN, (dut1 < 0) ? '-' : '+');
+    patch(np, OBELISK_NMEA_STATUS, STATUS_TENTHS, '0' + (((dut1 < 0) ? -dut1 : dut1) % 10));
+    patch(np, OBELISK_NMEA_STATUS, STATUS_LSW, lsw ? '1' : '0');
+    patch(np, OBELISK_NMEA_STATUS, STATUS_DST, '0' + (dst & 0x3));
+    digits(np, OBELISK_NMEA_STATUS, STATUS_QUALITY, quality);
+    seal(np, OBELISK_NMEA_STATUS);
+}
+
+void obelisk_nmea_precompute(const obelisk_nmea_t * np, obelisk_nmea_t table[], size_t count)
+{
+    size_t ii = 0;
+
+    for (ii = 0; ii < count; ++ii) {
+        table[ii] = (ii == 0) ? *np : table[ii - 1];
+        obelisk_nmea_time(&table[ii], table[ii].seconds + 1);
+    }
+}
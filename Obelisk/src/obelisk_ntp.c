@@ -0,0 +1,422 @@
+/* vim: set ts=4 expandtab shiftwidth=4: */
+
+/**
+ * @file
+ *
+ * Copyright 2018 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in LICENSE.txt<BR>
+ * Chip Overclock<BR>
+ * mailto:coverclock@diag.com<BR>
+ * http://github.com/coverclock/com-diag-obelisk<BR>
+ */
+
+#define _GNU_SOURCE /* recvmmsg(2), sendmmsg(2) */
+
+#include <assert.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include "com/diag/obelisk/obelisk_ntp.h"
+
+static const int64_t NANOSECONDS = 1000000000LL;
+
+/*
+ * Seconds from the NTP era 0 epoch (1900) to the POSIX epoch (1970).
+ */
+static const uint64_t NTP_EPOCH = 2208988800ULL;
+
+static void put(uint8_t * buffer, uint64_t value, size_t length)
+{
+    while (length > 0) {
+        length -= 1;
+        buffer[length] = value & 0xff;
+        value >>= 8;
+    }
+}
+
+static int64_t monotonic(void)
+{
+    struct timespec now = { 0 };
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (now.tv_sec * NANOSECONDS) + now.tv_nsec;
+}
+
+void obelisk_ntp_timestamp(uint8_t * buffer, const struct timespec * timep)
+{
+    put(&buffer[0], (uint32_t)(timep->tv_sec + NTP_EPOCH), 4);
+    put(&buffer[4], ((uint64_t)timep->tv_nsec << 32) / NANOSECONDS, 4);
+}
+
+int obelisk_ntp_respond(uint8_t * response, const uint8_t * request, size_t length, const obelisk_ntp_status_t * statusp, const struct timespec * receivep, const struct timespec * transmitp)
+{
+    int rc = -1;
+    int version = 0;
+    int64_t dispersion = 0;
+
+    if (length > 0) {
+        version = (request[0] >> 3) & 0x7;
+    }
+
+    if (length < OBELISK_NTP_LENGTH) {
+        /* Do nothing. */
+    } else if ((request[0] & 0x7) != OBELISK_NTP_MODE_CLIENT) {
+        /* Do nothing. */
+    } else if ((version < 1) || (version > OBELISK_NTP_VERSION)) {
+        /* Do nothing. */
+    } else if ((statusp->stratum < 1) || (statusp->stratum >= OBELISK_NTP_UNSYNCHRONIZED)) {
+        /*
+         * A client takes stratum 0 to be a Kiss-o'-Death, so until it is
+         * synchronized the server says nothing at all.
+         */
+    } else if (statusp->leap == OBELISK_NTP_LEAP_NOTINSYNC) {
+        /* Do nothing. */
+    } else {
+
+        memset(response, 0, OBELISK_NTP_LENGTH);
+
+        /*
+         * The version is the client's, and the poll interval is echoed
+         * back as the client asked for it. The root delay is zero, since
+         * the reference clock is attached to this host.
+         */
+
+        response[0] = (statusp->leap << 6) | (version << 3) | OBELISK_NTP_MODE_SERVER;
+        response[1] = statusp->stratum;
+        response[2] = request[2];
+        response[3] = (uint8_t)(int8_t)OBELISK_NTP_PRECISION;
+
+        dispersion = (statusp->dispersion < 0) ? 0 : ((statusp->dispersion << 16) / NANOSECONDS);
+        put(&response[8], (dispersion > 0xffffffffLL) ? 0xffffffffLL : dispersion, 4);
+
+        memcpy(&response[12], "WWVB", 4);
+
+        obelisk_ntp_timestamp(&response[16], &statusp->reference);
+        memcpy(&response[24], &request[40], 8);
+        obelisk_ntp_timestamp(&response[32], receivep);
+        obelisk_ntp_timestamp(&response[40], transmitp);
+
+        rc = OBELISK_NTP_LENGTH;
+
+    }
+
+    return rc;
+}
+
+int obelisk_ntp_init(obelisk_ntp_t * np, int port)
+{
+    int rc = -1;
+    int sock = -1;
+    int zero = 0;
+    int one = 1;
+    struct sockaddr_in6 address6 = { 0 };
+    struct sockaddr_in address4 = { 0 };
+    struct sockaddr_storage address = { 0 };
+    socklen_t length = sizeof(address);
+
+    memset(np, 0, sizeof(*np));
+    np->sock = -1;
+    np->wake[0] = -1;
+    np->wake[1] = -1;
+    np->status.leap = OBELISK_NTP_LEAP_NOTINSYNC;
+    np->status.stratum = OBELISK_NTP_UNSYNCHRONIZED;
+    np->status.dispersion = -1;
+
+    address6.sin6_family = AF_INET6;
+    address6.sin6_addr = in6addr_any;
+    address6.sin6_port = htons(port);
+
+    address4.sin_family = AF_INET;
+    address4.sin_addr.s_addr = htonl(INADDR_ANY);
+    address4.sin_port = htons(port);
+
+    /*
+     * A dual stack socket answers IPv4 clients as mapped IPv6 addresses.
+     */
+
+    if ((sock = socket(AF_INET6, SOCK_DGRAM, 0)) < 0) {
+        /* Do nothing. */
+    } else if ((setsockopt(sock, IPPROTO_IPV6, IPV6_V6ONLY, &zero, sizeof(zero)) < 0) || (bind(sock, (struct sockaddr *)&address6, sizeof(address6)) < 0)) {
+        (void)close(sock);
+        sock = -1;
+    } else {
+        /* Do nothing. */
+    }
+
+    if (sock >= 0) {
+        /* Do nothing. */
+    } else if ((sock = socket(AF_INET, SOCK_DGRAM, 0)) < 0) {
+        /* Do nothing. */
+    } else if (bind(sock, (struct sockaddr *)&address4, sizeof(address4)) < 0) {
+        (void)close(sock);
+        sock = -1;
+    } else {
+        /* Do nothing. */
+    }
+
+    if (sock < 0) {
+        /* Do nothing. */
+    } else if (setsockopt(sock, SOL_SOCKET, SO_TIMESTAMPNS, &one, sizeof(one)) < 0) {
+        (void)close(sock);
+    } else if (getsockname(sock, (struct sockaddr *)&address, &length) < 0) {
+        (void)close(sock);
+    } else if ((rc = pthread_mutex_init(&np->mutex, (pthread_mutexattr_t *)0)) != 0) {
+        errno = rc;
+        rc = -1;
+        (void)close(sock);
+    } else if ((rc = pipe(np->wake)) < 0) {
+        pthread_mutex_destroy(&np->mutex);
+        (void)close(sock);
+    } else if (((rc = fcntl(np->wake[0], F_SETFL, O_NONBLOCK)) < 0) || ((rc = fcntl(np->wake[1], F_SETFL, O_NONBLOCK)) < 0)) {
+        (void)close(np->wake[0]);
+        (void)close(np->wake[1]);
+        pthread_mutex_destroy(&np->mutex);
+        (void)close(sock);
+    } else {
+        np->sock = sock;
+        np->port = ntohs((address.ss_family == AF_INET6) ? ((struct sockaddr_in6 *)&address)->sin6_port : ((struct sockaddr_in *)&address)->sin_port);
+    }
+
+    return rc;
+}
+
+void obelisk_ntp_update(obelisk_ntp_t * np, const struct timespec * referencep, obelisk_ntp_leap_t leap, int64_t dispersion)
+{
+    pthread_mutex_lock(&np->mutex);
+    np->status.reference = *referencep;
+    np->status.updated = monotonic();
+    np->status.dispersion = dispersion;
+    np->status.leap = leap;
+    np->status.stratum = OBELISK_NTP_STRATUM;
+    pthread_mutex_unlock(&np->mutex);
+}
+
+void obelisk_ntp_status(obelisk_ntp_t * np, obelisk_ntp_status_t * statusp)
+{
+    pthread_mutex_lock(&np->mutex);
+    *statusp = np->status;
+    pthread_mutex_unlock(&np->mutex);
+
+    if (statusp->stratum == OBELISK_NTP_UNSYNCHRONIZED) {
+        /* Do nothing. */
+    } else if ((monotonic() - statusp->updated) <= (OBELISK_NTP_STALE * NANOSECONDS)) {
+        /* Do nothing. */
+    } else {
+        statusp->leap = OBELISK_NTP_LEAP_NOTINSYNC;
+        statusp->stratum = OBELISK_NTP_UNSYNCHRONIZED;
+    }
+}
+
+int obelisk_ntp_serve(obelisk_ntp_t * np)
+{
+    uint8_t requests[OBELISK_NTP_BATCH][OBELISK_NTP_LENGTH];
+    uint8_t responses[OBELISK_NTP_BATCH][OBELISK_NTP_LENGTH];
+    struct sockaddr_storage addresses[OBELISK_NTP_BATCH];
+    char controls[OBELISK_NTP_BATCH][CMSG_SPACE(sizeof(struct timespec))];
+    struct iovec vectors[OBELISK_NTP_BATCH];
+    struct iovec replies[OBELISK_NTP_BATCH];
+    struct mmsghdr headers[OBELISK_NTP_BATCH];
+    struct mmsghdr answers[OBELISK_NTP_BATCH];
+    struct cmsghdr * cp = (struct cmsghdr *)0;
+    obelisk_ntp_status_t status = { 0 };
+    obelisk_ntp_statistics_t statistics = { 0 };
+    struct timespec receive = { 0 };
+    struct timespec transmit = { 0 };
+    int received = 0;
+    int count = 0;
+    int sent = 0;
+    int total = 0;
+    int ii = 0;
+
+    while (!0) {
+
+        memset(headers, 0, sizeof(headers));
+        for (ii = 0; ii < OBELISK_NTP_BATCH; ++ii) {
+            vectors[ii].iov_base = requests[ii];
+            vectors[ii].iov_len = sizeof(requests[ii]);
+            headers[ii].msg_hdr.msg_name = &addresses[ii];
+            headers[ii].msg_hdr.msg_namelen = sizeof(addresses[ii]);
+            headers[ii].msg_hdr.msg_iov = &vectors[ii];
+            headers[ii].msg_hdr.msg_iovlen = 1;
+            headers[ii].msg_hdr.msg_control = controls[ii];
+            headers[ii].msg_hdr.msg_controllen = sizeof(controls[ii]);
+        }
+
+        if ((received = recvmmsg(np->sock, headers, OBELISK_NTP_BATCH, MSG_DONTWAIT, (struct timespec *)0)) > 0) {
+            /* Do nothing. */
+        } else if ((received < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK))) {
+            break;
+        } else if (received == 0) {
+            break;
+        } else {
+            total = -1;
+            break;
+        }
+
+        /*
+         * Every response in a batch shares the status and the transmit
+         * timestamp, which is taken as late as possible.
+         */
+
+        obelisk_ntp_status(np, &status);
+        (void)clock_gettime(CLOCK_REALTIME, &transmit);
+
+        memset(&statistics, 0, sizeof(statistics));
+        statistics.received = received;
+
+        memset(answers, 0, sizeof(answers));
+        for (ii = 0, count = 0; ii < received; ++ii) {
+
+            receive = transmit;
+            for (cp = CMSG_FIRSTHDR(&headers[ii].msg_hdr); cp != (struct cmsghdr *)0; cp = CMSG_NXTHDR(&headers[ii].msg_hdr, cp)) {
+                if ((cp->cmsg_level == SOL_SOCKET) && (cp->cmsg_type == SCM_TIMESTAMPNS)) {
+                    memcpy(&receive, CMSG_DATA(cp), sizeof(receive));
+                }
+            }
+
+            if (obelisk_ntp_respond(responses[count], requests[ii], headers[ii].msg_len, &status, &receive, &transmit) < 0) {
+                statistics.ignored += 1;
+            } else {
+                replies[count].iov_base = responses[count];
+                replies[count].iov_len = OBELISK_NTP_LENGTH;
+                answers[count].msg_hdr.msg_name = &addresses[ii];
+                answers[count].msg_hdr.msg_namelen = headers[ii].msg_hdr.msg_namelen;
+                answers[count].msg_hdr.msg_iov = &replies[count];
+                answers[count].msg_hdr.msg_iovlen = 1;
+                ++count;
+            }
+
+        }
+
+        /*
+         * A response that can't be sent is dropped; the client will ask
+         * again.
+         */
+
+        for (ii = 0; ii < count; ii += sent) {
+            if ((sent = sendmmsg(np->sock, &answers[ii], count - ii, 0)) > 0) {
+                statistics.answered += sent;
+            } else {
+                statistics.failed += 1;
+                sent = 1;
+            }
+        }
+
+        total += statistics.answered;
+
+        pthread_mutex_lock(&np->mutex);
+        np->statistics.received += statistics.received;
+        np->statistics.answered += statistics.answered;
+        np->statistics.ignored += statistics.ignored;
+        np->statistics.failed += statistics.failed;
+        pthread_mutex_unlock(&np->mutex);
+
+    }
+
+    return total;
+}
+
+static void * answer(void * arg)
+{
+    obelisk_ntp_t * np = (obelisk_ntp_t *)arg;
+    struct pollfd fds[2];
+    int rc = -1;
+
+    while (!0) {
+
+        fds[0].fd = np->wake[0];
+        fds[0].events = POLLIN;
+        fds[1].fd = np->sock;
+        fds[1].events = POLLIN;
+
+        rc = poll(fds, 2, -1);
+        if (rc > 0) {
+            /* Do nothing. */
+        } else if ((rc < 0) && (errno == EINTR)) {
+            continue;
+        } else {
+            break;
+        }
+
+        if (fds[0].revents != 0) {
+            break;
+        }
+
+        (void)obelisk_ntp_serve(np);
+
+    }
+
+    return (void *)0;
+}
+
+int obelisk_ntp_start(obelisk_ntp_t * np)
+{
+    int rc = -1;
+    sigset_t all;
+    sigset_t old;
+
+    sigfillset(&all);
+
+    if (np->running) {
+        errno = EBUSY;
+    } else if ((rc = pthread_sigmask(SIG_SETMASK, &all, &old)) != 0) {
+        errno = rc;
+        rc = -1;
+    } else {
+        rc = pthread_create(&np->thread, (pthread_attr_t *)0, answer, np);
+        pthread_sigmask(SIG_SETMASK, &old, (sigset_t *)0);
+        if (rc != 0) {
+            errno = rc;
+            rc = -1;
+        } else {
+            np->running = !0;
+        }
+    }
+
+    return rc;
+}
+
+void obelisk_ntp_statistics(obelisk_ntp_t * np, obelisk_ntp_statistics_t * statisticsp)
+{
+    pthread_mutex_lock(&np->mutex);
+    *statisticsp = np->statistics;
+    pthread_mutex_unlock(&np->mutex);
+}
+
+int obelisk_ntp_stop(obelisk_ntp_t * np)
+{
+    static const char BYTE = '\0';
+    int rc = 0;
+
+    if (np->running) {
+        if (write(np->wake[1], &BYTE, sizeof(BYTE)) < 0) {
+            /* Do nothing. */
+        }
+        if ((rc = pthread_join(np->thread, (void **)0)) != 0) {
+            errno = rc;
+            rc = -1;
+        }
+        np->running = 0;
+    }
+
+    return rc;
+}
+
+void obelisk_ntp_fini(obelisk_ntp_t * np)
+{
+    assert(!np->running);
+
+    (void)close(np->sock);
+    (void)close(np->wake[0]);
+    (void)close(np->wake[1]);
+    np->sock = -1;
+    np->wake[0] = -1;
+    np->wake[1] = -1;
+    pthread_mutex_destroy(&np->mutex);
+}
@@ -0,0 +1,74 @@
+/* vim: set ts=4 expandtab shiftwidth=4: */
+
+/**
+ * @file
+ *
+ * Copyright 2018 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in LICENSE.txt<BR>
+ * Chip Overclock<BR>
+ * mailto:coverclock@diag.com<BR>
+ * http://github.com/coverclock/com-diag-obelisk<BR>
+ */
+
+#include <assert.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "com/diag/obelisk/obelisk_page.h"
+
+obelisk_page_t * obelisk_page_create(const char * name)
+{
+    obelisk_page_t * pp = (obelisk_page_t *)0;
+    void * address = MAP_FAILED;
+    int fd = -1;
+
+    if ((fd = shm_open(name, O_RDWR | O_CREAT, 0644)) < 0) {
+        /* Do nothing. */
+    } else if (ftruncate(fd, sizeof(obelisk_page_t)) < 0) {
+        (void)close(fd);
+    } else if ((address = mmap((void *)0, sizeof(obelisk_page_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)) == MAP_FAILED) {
+        (void)close(fd);
+    } else {
+        (void)close(fd);
+        pp = (obelisk_page_t *)address;
+        __atomic_store_n(&pp->sequence, pp->sequence | 1, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+        memset(&pp->data, 0, sizeof(pp->data));
+        pp->data.uncertainty = -1;
+        pp->magic = OBELISK_PAGE_MAGIC;
+        pp->version = OBELISK_PAGE_VERSION;
+        __atomic_store_n(&pp->sequence, pp->sequence + 1, __ATOMIC_RELEASE);
+    }
+
+    return pp;
+}
+
+void obelisk_page_publish(obelisk_page_t * pp, const obelisk_page_data_t * dp)
+{
+    /*
+     * There is only one writer, so the sequence needs no read-modify-write;
+     * the fences keep the data from being written outside the two bumps.
+     */
+
+    __atomic_store_n(&pp->sequence, pp->sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    pp->data = *dp;
+
+    __atomic_store_n(&pp->sequence, pp->sequence + 1, __ATOMIC_RELEASE);
+}
+
+int obelisk_page_destroy(obelisk_page_t * pp, const char * name)
+{
+    int rc = -1;
+
+    if ((rc = munmap(pp, sizeof(*pp))) < 0) {
+        /* Do nothing. */
+    } else {
+        rc = shm_unlink(name);
+    }
+
+    return rc;
+}
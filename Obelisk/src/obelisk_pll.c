@@ -0,0 +1,154 @@
+/* vim: set ts=4 expandtab shiftwidth=4: */
+
+/**
+ * @file
+ *
+ * Copyright 2018 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in LICENSE.txt<BR>
+ * Chip Overclock<BR>
+ * mailto:coverclock@diag.com<BR>
+ * http://github.com/coverclock/com-diag-obelisk<BR>
+ */
+
+#include <assert.h>
+#include <string.h>
+#include <math.h>
+#include "com/diag/obelisk/obelisk_pll.h"
+
+static void restart(obelisk_pll_t * pllp, int64_t edge)
+{
+    pllp->phase = edge;
+    pllp->first = edge;
+    pllp->period = OBELISK_PLL_SECOND;
+    pllp->error = 0.0;
+    pllp->jitter = 0.0;
+    pllp->seconds = 0;
+    pllp->count = 1;
+    pllp->rejected = 0;
+}
+
+void obelisk_pll_init(obelisk_pll_t * pllp, int constant)
+{
+    assert(constant >= 1);
+
+    memset(pllp, 0, sizeof(*pllp));
+
+    pllp->period = OBELISK_PLL_SECOND;
+    pllp->constant = constant;
+    pllp->warmup = (constant > OBELISK_PLL_WARMUP) ? constant : OBELISK_PLL_WARMUP;
+
+    /*
+     * These gains make the loop critically damped.
+     */
+
+    pllp->kp = 1.0 / constant;
+    pllp->ki = (pllp->kp * pllp->kp) / 4.0;
+}
+
+int obelisk_pll_update(obelisk_pll_t * pllp, int64_t edge)
+{
+    int rc = 0;
+    int64_t seconds = 0;
+    double elapsed = 0.0;
+    double error = 0.0;
+    double magnitude = 0.0;
+
+    if (pllp->count == 0) {
+
+        restart(pllp, edge);
+
+    } else {
+
+        /*
+         * Edges may be missing, so figure out how many seconds have gone
+         * by since the last one, and how far this one is from where the
+         * loop expected it.
+         */
+
+        elapsed = edge - pllp->phase;
+        seconds = llround(elapsed / pllp->period);
+        error = elapsed - (seconds * pllp->period);
+        magnitude = fabs(error);
+
+        if (seconds < 1) {
+            rc = 1;
+        } else if (magnitude > OBELISK_PLL_CAPTURE) {
+            rc = 1;
+        } else if (!obelisk_pll_locked(pllp)) {
+            rc = 0;
+        } else if (magnitude <= OBELISK_PLL_FLOOR) {
+            rc = 0;
+        } else if (magnitude > (OBELISK_PLL_OUTLIER * pllp->jitter)) {
+            rc = 1;
+        } else {
+            rc = 0;
+        }
+
+        if (rc == 0) {
+
+            pllp->seconds += seconds;
+            pllp->error = error;
+            pllp->jitter += (magnitude - pllp->jitter) / OBELISK_PLL_WARMUP;
+            pllp->rejected = 0;
+
+            if (!obelisk_pll_locked(pllp)) {
+
+                /*
+                 * Frequency lock: the period is the average over every
+                 * second since the first edge.
+                 */
+
+                pllp->period = (double)(edge - pllp->first) / pllp->seconds;
+                pllp->phase = edge;
+                pllp->count += 1;
+
+            } else {
+
+                /*
+                 * Phase lock: move the phase part of the way toward the
+                 * edge, and the frequency a smaller part.
+                 */
+
+                pllp->phase += llround((seconds * pllp->period) + (pllp->kp * error));
+                pllp->period += (pllp->ki * error) / seconds;
+
+            }
+
+        } else if ((++pllp->rejected) < OBELISK_PLL_RESTART) {
+
+            rc = pllp->rejected;
+
+        } else {
+
+            restart(pllp, edge);
+            rc = -1;
+
+        }
+
+    }
+
+    return rc;
+}
+
+int obelisk_pll_locked(const obelisk_pll_t * pllp)
+{
+    return (pllp->count >= pllp->warmup);
+}
+
+int64_t obelisk_pll_edge(const obelisk_pll_t * pllp, int64_t now)
+{
+    int64_t seconds = 0;
+
+    seconds = (int64_t)floor((now - pllp->phase) / pllp->period);
+
+    return pllp->phase + llround(seconds * pllp->period);
+}
+
+int64_t obelisk_pll_uncertainty(const obelisk_pll_t * pllp, int64_t now)
+{
+    double seconds = 0.0;
+
+    seconds = (now - pllp->phase) / pllp->period;
+
+    return llround(pllp->jitter + (seconds * OBELISK_PLL_STABILITY));
+}
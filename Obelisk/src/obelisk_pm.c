@@ -0,0 +1,377 @@
+/* vim: set ts=4 expandtab shiftwidth=4: */
+
+/**
+ * @file
+ *
+ * Copyright 2018 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in LICENSE.txt<BR>
+ * Chip Overclock<BR>
+ * mailto:coverclock@diag.com<BR>
+ * http://github.com/coverclock/com-diag-obelisk<BR>
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <complex.h>
+#include "com/diag/obelisk/obelisk.h"
+#include "com/diag/obelisk/obelisk_pm.h"
+#include "obelisk.h"
+#include "obelisk_calendar.h"
+
+#define countof(_ARRAY_) (sizeof(_ARRAY_) / sizeof(_ARRAY_[0]))
+
+/**
+ * This is the sync word at :00 through :12.
+ */
+static const uint8_t SYNC[OBELISK_PM_SYNC] = {
+    0, 0, 1, 1, 1, 0, 1, 1, 0, 1, 0, 0, 0,
+};
+
+/**
+ * These are the seconds at which time_par[4] through time_par[0] are sent.
+ */
+static const int8_t PARITY[] = {
+    13, 14, 15, 16, 17,
+};
+
+/**
+ * These are the seconds at which time[25] through time[0] are sent. The
+ * least significant bit goes out out of order, at :19.
+ */
+static const int8_t TIME[] = {
+    18,
+    20, 21, 22, 23, 24, 25, 26, 27, 28,
+    30, 31, 32, 33, 34, 35, 36, 37, 38,
+    40, 41, 42, 43, 44, 45,
+    19,
+};
+
+/**
+ * These are the seconds at which dst_ls[4] through dst_ls[0] are sent,
+ * around the notice bit at :48 and the reserved bit at :49.
+ */
+static const int8_t DSTLS[] = {
+    46, 47, 50, 51, 52,
+};
+
+/**
+ * These are the bits of time[25:0] whose sum modulo two is time_par[0]
+ * through time_par[4], as NIST specifies them.
+ */
+static const uint32_t HAMMING[] = {
+    0x0b3e375,  /* time[23,21,20,17,16,15,14,13,9,8,6,5,4,2,0] */
+    0x167c6ea,  /* time[24,22,21,18,17,16,15,14,10,9,7,6,5,3,1] */
+    0x2cf8dd4,  /* time[25,23,22,19,18,17,16,15,11,10,8,7,6,4,2] */
+    0x12cf8dd,  /* time[24,21,19,18,15,14,13,12,11,7,6,4,3,2,0] */
+    0x259f1ba,  /* time[25,22,20,19,16,15,14,13,12,8,7,5,4,3,1] */
+};
+
+/**
+ * These are the dst_ls codes indexed by (DST state * 2) + leap second
+ * warning. Every pair differs in at least two bits so that any single bit
+ * error is detected.
+ */
+static const uint8_t CODE[] = {
+    0x03, 0x05, 0x06, 0x09, 0x0a, 0x0c, 0x11, 0x12,
+};
+
+/*
+ * In the Hamming (31,26) code every bit of the time is covered by a
+ * different combination of at least two of the parity bits, so the
+ * syndrome (the parity received XOR the parity recomputed) is zero if there
+ * is no error, names that combination if a bit of the time is in error, or
+ * has a single bit set if a parity bit is.
+ */
+
+static int column(int bit)
+{
+    int cc = 0;
+
+    for (int kk = 0; kk < countof(HAMMING); ++kk) {
+        if ((HAMMING[kk] & (1UL << bit)) != 0) {
+            cc |= (1 << kk);
+        }
+    }
+
+    return cc;
+}
+
+static int syndrome(uint32_t time, int parity)
+{
+    int ss = 0;
+
+    for (int kk = 0; kk < countof(HAMMING); ++kk) {
+        if ((__builtin_popcount(time & HAMMING[kk]) & 1) != 0) {
+            ss |= (1 << kk);
+        }
+    }
+
+    return ss ^ parity;
+}
+
+static uint32_t get(obelisk_buffer_t buffer, const int8_t seconds[], int count)
+{
+    uint32_t value = 0;
+
+    for (int ii = 0; ii < count; ++ii) {
+        value = (value << 1) | (((buffer & OBELISK_BIT(seconds[ii])) != 0) ? 1 : 0);
+    }
+
+    return value;
+}
+
+static obelisk_buffer_t put(obelisk_buffer_t buffer, const int8_t seconds[], int count, uint32_t value)
+{
+    for (int ii = count - 1; ii >= 0; --ii) {
+        if ((value & 1) != 0) {
+            buffer |= OBELISK_BIT(seconds[ii]);
+        }
+        value >>= 1;
+    }
+
+    return buffer;
+}
+
+obelisk_buffer_t obelisk_pm_encode(int32_t minutes, obelisk_dst_t dst, int lsw)
+{
+    obelisk_buffer_t buffer = 0;
+
+    assert((0 <= dst) && (dst <= OBELISK_DST_ON));
+
+    for (int ii = 0; ii < countof(SYNC); ++ii) {
+        if (SYNC[ii]) {
+            buffer |= OBELISK_BIT(ii);
+        }
+    }
+
+    buffer = put(buffer, TIME, countof(TIME), minutes);
+    buffer = put(buffer, PARITY, countof(PARITY), syndrome(minutes, 0));
+    buffer = put(buffer, DSTLS, countof(DSTLS), CODE[(dst * 2) + !!lsw]);
+
+    return buffer;
+}
+
+int obelisk_pm_decode(obelisk_frame_t * framep, obelisk_buffer_t buffer)
+{
+    int rc = 0;
+    uint32_t time = 0;
+    uint32_t code = 0;
+    int ss = -1;
+    int code_index = -1;
+    int year = -1;
+    int days = -1;
+    int lyi = -1;
+    int minute = -1;
+    int hour = -1;
+
+    time = get(buffer, TIME, countof(TIME));
+
+    /*
+     * Correct a single bit error in the time. If the error is in one of
+     * the parity bits, the time is fine as is.
+     */
+
+    ss = syndrome(time, get(buffer, PARITY, countof(PARITY)));
+    if (ss == 0) {
+        /* Do nothing. */
+    } else {
+        for (int ii = 0; ii < countof(TIME); ++ii) {
+            if (column(ii) == ss) {
+                time ^= (1UL << ii);
+                break;
+            }
+        }
+        rc = 1;
+    }
+
+    code = get(buffer, DSTLS, countof(DSTLS));
+    for (int ii = 0; ii < countof(CODE); ++ii) {
+        if (CODE[ii] == code) {
+            code_index = ii;
+            break;
+        }
+    }
+
+    /*
+     * Convert the minute of the century into the fields of the AM frame.
+     * Every fourth year of the century, including 2000, is a leap year, so
+     * the year is the day of the century times four divided by the days in
+     * four years.
+     */
+
+    minute = time % 60;
+    hour = (time / 60) % 24;
+    days = time / (60 * 24);
+    year = (days * 4) / ((365 * 4) + 1);
+    if (year < 100) {
+        lyi = ((year % 4) == 0);
+        days -= OBELISK_CALENDAR_CENTURY[year];
+    }
+    days += 1;
+
+    if (code_index < 0) {
+        rc = -1;
+    } else if (year >= 100) {
+        rc = -2;
+    } else {
+        memset(framep, 0, sizeof(*framep));
+        framep->minutes10       = minute / 10;
+        framep->minutes1        = minute % 10;
+        framep->hours10         = hour / 10;
+        framep->hours1          = hour % 10;
+        framep->day100          = days / 100;
+        framep->day10           = (days % 100) / 10;
+        framep->day1            = days % 10;
+        framep->dut1sign        = OBELISK_SIGN_POSITIVE;
+        framep->dut1magnitude   = 0;
+        framep->year10          = year / 10;
+        framep->year1           = year % 10;
+        framep->lyi             = lyi;
+        framep->lsw             = code_index % 2;
+        framep->dst             = code_index / 2;
+    }
+
+    return rc;
+}
+
+void obelisk_pm_init(obelisk_pm_t * pmp, int samples_per_second)
+{
+    assert(samples_per_second > 0);
+    assert((samples_per_second % OBELISK_PM_PHASES) == 0);
+
+    memset(pmp, 0, sizeof(*pmp));
+    pmp->samples = samples_per_second;
+    pmp->polarity = 1;
+}
+
+/*
+ * Recover the carrier phase and look for the sync word at the start of the
+ * most recent minute of symbols from a timing hypothesis. BPSK modulation
+ * is removed by squaring the symbols; the square root of their sum over a
+ * few neighboring seconds is the carrier phase to within 180 degrees, which
+ * follows slow drift between the transmitter and the receiver. Successive
+ * estimates are kept continuous, and the sync word resolves the remaining
+ * ambiguity.
+ */
+static int synchronize(obelisk_pm_t * pmp, int phase, obelisk_buffer_t * bufferp)
+{
+    int found = 0;
+    double complex symbol[OBELISK_PM_SECONDS];
+    double complex reference = 0;
+    double complex reference_old = 0;
+    double complex square = 0;
+    double soft[OBELISK_PM_SECONDS];
+    int agree = 0;
+    obelisk_buffer_t buffer = 0;
+
+    for (int ii = 0; ii < OBELISK_PM_SECONDS; ++ii) {
+        symbol[ii] = pmp->symbol[phase][(pmp->next[phase] + ii) % OBELISK_PM_SECONDS];
+    }
+
+    for (int ii = 0; ii < OBELISK_PM_SECONDS; ++ii) {
+        square = 0;
+        for (int jj = ii - OBELISK_PM_WINDOW; jj <= (ii + OBELISK_PM_WINDOW); ++jj) {
+            if ((0 <= jj) && (jj < OBELISK_PM_SECONDS)) {
+                square += symbol[jj] * symbol[jj];
+            }
+        }
+        reference = csqrt(square);
+        if ((ii > 0) && (creal(reference * conj(reference_old)) < 0)) {
+            reference = -reference;
+        }
+        soft[ii] = creal(symbol[ii] * conj(reference));
+        reference_old = reference;
+    }
+
+    for (int ii = 0; ii < countof(SYNC); ++ii) {
+        if ((soft[ii] < 0) == (SYNC[ii] != 0)) {
+            ++agree;
+        }
+    }
+
+    if (agree >= (OBELISK_PM_SYNC - OBELISK_PM_ERRORS)) {
+        pmp->polarity = 1;
+        found = !0;
+    } else if (agree <= OBELISK_PM_ERRORS) {
+        pmp->polarity = -1;
+        found = !0;
+    } else {
+        /* Do nothing. */
+    }
+
+    if (found) {
+        for (int ii = 0; ii < OBELISK_PM_SECONDS; ++ii) {
+            if ((soft[ii] * pmp->polarity) < 0) {
+                buffer |= OBELISK_BIT(ii);
+            }
+        }
+        *bufferp = buffer;
+    }
+
+    return found;
+}
+
+obelisk_event_t obelisk_pm_sample(obelisk_pm_t * pmp, float in_phase, float quadrature, obelisk_buffer_t * bufferp)
+{
+    obelisk_event_t event = OBELISK_EVENT_NOMINAL;
+    double complex sample = 0;
+    int step = -1;
+    int phase = -1;
+    double magnitude = 0;
+
+    sample = in_phase + (quadrature * I);
+
+    for (int pp = 0; pp < OBELISK_PM_PHASES; ++pp) {
+        pmp->sum[pp] += sample;
+    }
+
+    pmp->sample = (pmp->sample + 1) % pmp->samples;
+
+    /*
+     * Each timing hypothesis completes a symbol one tenth of a second after
+     * the one before it. The hypothesis aligned with the second integrates
+     * a whole bit without straddling a phase reversal, and so accumulates
+     * the most energy.
+     */
+
+    step = pmp->samples / OBELISK_PM_PHASES;
+
+    if ((pmp->sample % step) == 0) {
+
+        phase = pmp->sample / step;
+        assert((0 <= phase) && (phase < OBELISK_PM_PHASES));
+
+        magnitude = creal(pmp->sum[phase] * conj(pmp->sum[phase]));
+        pmp->energy[phase] += (magnitude - pmp->energy[phase]) / OBELISK_PM_SMOOTHING;
+        pmp->symbol[phase][pmp->next[phase]] = pmp->sum[phase];
+        pmp->next[phase] = (pmp->next[phase] + 1) % OBELISK_PM_SECONDS;
+        if (pmp->count[phase] < OBELISK_PM_SECONDS) {
+            pmp->count[phase] += 1;
+        }
+        pmp->sum[phase] = 0;
+
+        for (int pp = 0; pp < OBELISK_PM_PHASES; ++pp) {
+            if (pmp->energy[pp] > pmp->energy[pmp->phase]) {
+                pmp->phase = pp;
+            }
+        }
+
+        if (pmp->count[phase] < OBELISK_PM_SECONDS) {
+            event = OBELISK_EVENT_WAITING;
+        } else if (phase != pmp->phase) {
+            /* Do nothing. */
+        } else if (!synchronize(pmp, phase, bufferp)) {
+            /* Do nothing. */
+        } else {
+            event = OBELISK_EVENT_FRAME;
+        }
+
+    } else if (pmp->count[0] < OBELISK_PM_SECONDS) {
+        event = OBELISK_EVENT_WAITING;
+    } else {
+        /* Do nothing. */
+    }
+
+    return event;
+}
@@ -0,0 +1,101 @@
+/* vim: set ts=4 expandtab shiftwidth=4: */
+
+/**
+ * @file
+ *
+ * Copyright 2018 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in LICENSE.txt<BR>
+ * Chip Overclock<BR>
+ * mailto:coverclock@diag.com<BR>
+ * http://github.com/coverclock/com-diag-obelisk<BR>
+ */
+
+#include <assert.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include <time.h>
+#include "com/diag/obelisk/obelisk_schedule.h"
+
+static const int64_t NANOSECONDS = 1000000000LL;
+
+void obelisk_schedule_init(obelisk_schedule_t * sp)
+{
+    memset(sp, 0, sizeof(*sp));
+}
+
+int obelisk_schedule_wait(const obelisk_schedule_t * sp, int64_t moment, int64_t now)
+{
+    int rc = -1;
+    struct timespec then = { 0 };
+    int64_t wake = 0;
+
+    /*
+     * The two monotonic clocks differ only by the slewing of the one we
+     * sleep on, which over the less than a second we look ahead is too
+     * small to matter.
+     */
+
+    if ((rc = clock_gettime(CLOCK_MONOTONIC, &then)) < 0) {
+        /* Do nothing. */
+    } else {
+        wake = ((int64_t)then.tv_sec * NANOSECONDS) + then.tv_nsec + (moment - sp->compensation - now);
+        then.tv_sec = wake / NANOSECONDS;
+        then.tv_nsec = wake % NANOSECONDS;
+        do {
+            rc = clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &then, (struct timespec *)0);
+        } while (rc == EINTR);
+        if (rc != 0) {
+            errno = rc;
+            rc = -1;
+        }
+    }
+
+    return rc;
+}
+
+void obelisk_schedule_land(obelisk_schedule_t * sp, int64_t moment, int64_t actual)
+{
+    int64_t error = 0;
+
+    error = actual - moment;
+
+    if (sp->count == 0) {
+        sp->minimum = error;
+        sp->maximum = error;
+    } else if (error < sp->minimum) {
+        sp->minimum = error;
+    } else if (error > sp->maximum) {
+        sp->maximum = error;
+    } else {
+        /* Do nothing. */
+    }
+
+    sp->count += 1;
+    sp->sum += error;
+    sp->squares += (double)error * (double)error;
+
+    /*
+     * Landing late means waking earlier next time, and vice versa, but
+     * never so early that a bad landing throws off the next one by much.
+     */
+
+    sp->compensation += error / OBELISK_SCHEDULE_GAIN;
+    if (sp->compensation < 0) {
+        sp->compensation = 0;
+    } else if (sp->compensation > OBELISK_SCHEDULE_LIMIT) {
+        sp->compensation = OBELISK_SCHEDULE_LIMIT;
+    } else {
+        /* Do nothing. */
+    }
+}
+
+double obelisk_schedule_mean(const obelisk_schedule_t * sp)
+{
+    return (sp->count > 0) ? (sp->sum / sp->count) : 0.0;
+}
+
+double obelisk_schedule_rms(const obelisk_schedule_t * sp)
+{
+    return (sp->count > 0) ? sqrt(sp->squares / sp->count) : 0.0;
+}
@@ -0,0 +1,108 @@
+/* vim: set ts=4 expandtab shiftwidth=4: */
+
+/**
+ * @file
+ *
+ * Copyright 2018 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in LICENSE.txt<BR>
+ * Chip Overclock<BR>
+ * mailto:coverclock@diag.com<BR>
+ * http://github.com/coverclock/com-diag-obelisk<BR>
+ */
+
+#include <assert.h>
+#include <math.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include "com/diag/obelisk/obelisk_shm.h"
+
+obelisk_shm_t * obelisk_shm_attach(int unit)
+{
+    obelisk_shm_t * shmp = (obelisk_shm_t *)0;
+    int id = -1;
+    void * address = (void *)0;
+
+    assert(unit >= 0);
+
+    if ((id = shmget(OBELISK_SHM_KEY + unit, sizeof(obelisk_shm_t), IPC_CREAT | ((unit < OBELISK_SHM_PRIVATE) ? 0600 : 0666))) < 0) {
+        /* Do nothing. */
+    } else if ((address = shmat(id, (void *)0, 0)) == (void *)-1) {
+        /* Do nothing. */
+    } else {
+        shmp = (obelisk_shm_t *)address;
+        shmp->mode = OBELISK_SHM_MODE;
+        shmp->valid = 0;
+    }
+
+    return shmp;
+}
+
+int obelisk_shm_detach(obelisk_shm_t * shmp)
+{
+    return shmdt(shmp);
+}
+
+int obelisk_shm_precision(int64_t nanoseconds)
+{
+    int precision = 0;
+
+    if (nanoseconds > 0) {
+        precision = (int)ceil(log2(nanoseconds / 1000000000.0));
+    } else {
+        precision = -30;
+    }
+
+    return precision;
+}
+
+void obelisk_shm_post(obelisk_shm_t * shmp, const struct timespec * clockp, const struct timespec * receivep, obelisk_shm_leap_t leap, int precision)
+{
+    /*
+     * The barriers keep the compiler and the processor from moving the
+     * writes of the fields outside of the two bumps of the count.
+     */
+
+    shmp->valid = 0;
+    shmp->count += 1;
+    __sync_synchronize();
+
+    shmp->mode = OBELISK_SHM_MODE;
+    shmp->clockTimeStampSec = clockp->tv_sec;
+    shmp->clockTimeStampUSec = clockp->tv_nsec / 1000;
+    shmp->clockTimeStampNSec = clockp->tv_nsec;
+    shmp->receiveTimeStampSec = receivep->tv_sec;
+    shmp->receiveTimeStampUSec = receivep->tv_nsec / 1000;
+    shmp->receiveTimeStampNSec = receivep->tv_nsec;
+    shmp->leap = leap;
+    shmp->precision = precision;
+
+    __sync_synchronize();
+    shmp->count += 1;
+    __sync_synchronize();
+    shmp->valid = 1;
+}
+
+int obelisk_shm_fetch(obelisk_shm_t * shmp, struct timespec * clockp, struct timespec * receivep, obelisk_shm_leap_t * leapp)
+{
+    int rc = 1;
+    int count = 0;
+
+    if (shmp->valid) {
+
+        count = shmp->count;
+        __sync_synchronize();
+
+        clockp->tv_sec = shmp->clockTimeStampSec;
+        clockp->tv_nsec = shmp->clockTimeStampNSec;
+        receivep->tv_sec = shmp->receiveTimeStampSec;
+        receivep->tv_nsec = shmp->receiveTimeStampNSec;
+        *leapp = (obelisk_shm_leap_t)shmp->leap;
+
+        __sync_synchronize();
+        rc = (count == shmp->count) ? 0 : -1;
+        shmp->valid = 0;
+
+    }
+
+    return rc;
+}
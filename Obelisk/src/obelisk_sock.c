@@ -0,0 +1,80 @@
+/* vim: set ts=4 expandtab shiftwidth=4: */
+
+/**
+ * @file
+ *
+ * Copyright 2018 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in LICENSE.txt<BR>
+ * Chip Overclock<BR>
+ * mailto:coverclock@diag.com<BR>
+ * http://github.com/coverclock/com-diag-obelisk<BR>
+ */
+
+#include <assert.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "com/diag/obelisk/obelisk_sock.h"
+
+int obelisk_sock_open(const char * path)
+{
+    int sock = -1;
+    struct sockaddr_un address = { 0 };
+
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, path, sizeof(address.sun_path) - 1);
+
+    if (strlen(path) >= sizeof(address.sun_path)) {
+        errno = ENAMETOOLONG;
+    } else if ((sock = socket(AF_UNIX, SOCK_DGRAM, 0)) < 0) {
+        /* Do nothing. */
+    } else if (connect(sock, (struct sockaddr *)&address, sizeof(address)) < 0) {
+        (void)close(sock);
+        sock = -1;
+    } else {
+        /* Do nothing. */
+    }
+
+    return sock;
+}
+
+int obelisk_sock_close(int sock)
+{
+    return close(sock);
+}
+
+void obelisk_sock_prepare(obelisk_sock_sample_t * samplep, const struct timespec * systemp, const struct timespec * referencep, obelisk_sock_leap_t leap)
+{
+    double fraction = 0.0;
+
+    memset(samplep, 0, sizeof(*samplep));
+
+    samplep->tv.tv_sec = systemp->tv_sec;
+    samplep->tv.tv_usec = systemp->tv_nsec / 1000;
+    samplep->leap = leap;
+    samplep->magic = OBELISK_SOCK_MAGIC;
+
+    if (referencep != (const struct timespec *)0) {
+
+        samplep->offset = (double)(referencep->tv_sec - systemp->tv_sec) + ((referencep->tv_nsec - systemp->tv_nsec) / 1000000000.0);
+        samplep->pulse = 0;
+
+    } else {
+
+        /*
+         * The true time is on the second nearest the system time.
+         */
+
+        fraction = systemp->tv_nsec / 1000000000.0;
+        samplep->offset = (fraction < 0.5) ? -fraction : (1.0 - fraction);
+        samplep->pulse = !0;
+
+    }
+}
+
+int obelisk_sock_send(int sock, const obelisk_sock_sample_t * samplep)
+{
+    return send(sock, samplep, sizeof(*samplep), 0);
+}
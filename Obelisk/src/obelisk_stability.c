@@ -0,0 +1,213 @@
+/* vim: set ts=4 expandtab shiftwidth=4: */
+
+/**
+ * @file
+ *
+ * Copyright 2018 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in LICENSE.txt<BR>
+ * Chip Overclock<BR>
+ * mailto:coverclock@diag.com<BR>
+ * http://github.com/coverclock/com-diag-obelisk<BR>
+ *
+ * REFERENCES
+ *
+ * W. Riley, D. Howe, "Handbook of Frequency Stability Analysis",
+ * NIST Special Publication 1065, 2008
+ */
+
+#include <assert.h>
+#include <string.h>
+#include <math.h>
+#include "com/diag/obelisk/obelisk_stability.h"
+
+static const int64_t MASK = OBELISK_STABILITY_SAMPLES - 1;
+
+void obelisk_stability_init(obelisk_stability_t * sp)
+{
+    memset(sp, 0, sizeof(*sp));
+}
+
+int obelisk_stability_tau(int index)
+{
+    assert((0 <= index) && (index < OBELISK_STABILITY_TAUS));
+
+    return 1 << index;
+}
+
+void obelisk_stability_sample(obelisk_stability_t * sp, int64_t phase)
+{
+    int64_t n = 0;
+    int64_t m = 0;
+    int64_t d = 0;
+    int index = 0;
+    int base = 0;
+    int capacity = 0;
+    obelisk_stability_tau_t * tp = (obelisk_stability_tau_t *)0;
+
+    assert((3 * (1 << (OBELISK_STABILITY_TAUS - 1))) < OBELISK_STABILITY_SAMPLES);
+
+    n = sp->samples;
+    sp->phase[n & MASK] = phase;
+
+    /*
+     * The prefix sums are allowed to wrap: only differences between them
+     * are used, and those are small enough to come out right regardless.
+     */
+
+    sp->sum[(n + 1) & MASK] = sp->sum[n & MASK] + (uint64_t)phase;
+
+    for (index = 0; index < OBELISK_STABILITY_TAUS; ++index) {
+
+        tp = &(sp->tau[index]);
+        m = 1 << index;
+        base = (1 << index) - 1 + index;
+        capacity = (1 << index) + 1;
+
+        /*
+         * ADEV squares the second difference of the phase at this tau.
+         */
+
+        if (n >= (2 * m)) {
+            d = sp->phase[n & MASK] - (2 * sp->phase[(n - m) & MASK]) + sp->phase[(n - (2 * m)) & MASK];
+            tp->adev += (double)d * (double)d;
+            tp->adevs += 1;
+        }
+
+        /*
+         * TDEV squares the sum of tau consecutive second differences,
+         * which telescopes into four prefix sums.
+         */
+
+        if (n >= ((3 * m) - 1)) {
+            d = (int64_t)(sp->sum[(n + 1) & MASK] - (3 * sp->sum[(n + 1 - m) & MASK]) + (3 * sp->sum[(n + 1 - (2 * m)) & MASK]) - sp->sum[(n + 1 - (3 * m)) & MASK]);
+            tp->tdev += (double)d * (double)d;
+            tp->tdevs += 1;
+        }
+
+        /*
+         * MTIE is the largest peak to peak phase in any window of tau,
+         * which monotonic deques of maxima and minima track as the window
+         * slides.
+         */
+
+        while ((tp->maxcount > 0) && (sp->maxima[base + tp->maxhead] < (n - m))) {
+            tp->maxhead = (tp->maxhead + 1) % capacity;
+            tp->maxcount -= 1;
+        }
+        while ((tp->maxcount > 0) && (sp->phase[sp->maxima[base + ((tp->maxhead + tp->maxcount - 1) % capacity)] & MASK] <= phase)) {
+            tp->maxcount -= 1;
+        }
+        sp->maxima[base + ((tp->maxhead + tp->maxcount) % capacity)] = n;
+        tp->maxcount += 1;
+
+        while ((tp->mincount > 0) && (sp->minima[base + tp->minhead] < (n - m))) {
+            tp->minhead = (tp->minhead + 1) % capacity;
+            tp->mincount -= 1;
+        }
+        while ((tp->mincount > 0) && (sp->phase[sp->minima[base + ((tp->minhead + tp->mincount - 1) % capacity)] & MASK] >= phase)) {
+            tp->mincount -= 1;
+        }
+        sp->minima[base + ((tp->minhead + tp->mincount) % capacity)] = n;
+        tp->mincount += 1;
+
+        if (n >= m) {
+            d = sp->phase[sp->maxima[base + tp->maxhead] & MASK] - sp->phase[sp->minima[base + tp->minhead] & MASK];
+            if (d > tp->mtie) {
+                tp->mtie = d;
+            }
+        }
+
+    }
+
+    sp->samples += 1;
+}
+
+static void restart(obelisk_stability_t * sp, int64_t edge)
+{
+    obelisk_stability_init(sp);
+    sp->origin = edge;
+    sp->last = edge;
+    obelisk_stability_sample(sp, 0);
+}
+
+int obelisk_stability_edge(obelisk_stability_t * sp, int64_t edge)
+{
+    int rc = 0;
+    int64_t elapsed = 0;
+    int64_t seconds = 0;
+    int64_t error = 0;
+    int64_t previous = 0;
+    int64_t next = 0;
+    int64_t second = 0;
+
+    if (sp->samples == 0) {
+
+        restart(sp, edge);
+
+    } else {
+
+        elapsed = edge - sp->last;
+        seconds = llround((double)elapsed / OBELISK_STABILITY_SECOND);
+        error = elapsed - (seconds * OBELISK_STABILITY_SECOND);
+
+        if (seconds < 1) {
+            rc = 1;
+        } else if ((error > OBELISK_STABILITY_CAPTURE) || (error < -OBELISK_STABILITY_CAPTURE)) {
+            rc = 1;
+        } else if (seconds > OBELISK_STABILITY_GAP) {
+            restart(sp, edge);
+            rc = -1;
+        } else {
+            previous = sp->phase[(sp->samples - 1) & MASK];
+            next = edge - sp->origin - ((sp->seconds + seconds) * OBELISK_STABILITY_SECOND);
+            for (second = 1; second < seconds; ++second) {
+                obelisk_stability_sample(sp, previous + (((next - previous) * second) / seconds));
+            }
+            obelisk_stability_sample(sp, next);
+            sp->seconds += seconds;
+            sp->last = edge;
+        }
+
+    }
+
+    return rc;
+}
+
+double obelisk_stability_adev(const obelisk_stability_t * sp, int index)
+{
+    double result = -1.0;
+    const obelisk_stability_tau_t * tp = (const obelisk_stability_tau_t *)0;
+
+    tp = &(sp->tau[index]);
+
+    if (tp->adevs > 0) {
+        result = sqrt(tp->adev / (2.0 * tp->adevs)) / ((double)obelisk_stability_tau(index) * OBELISK_STABILITY_SECOND);
+    }
+
+    return result;
+}
+
+double obelisk_stability_tdev(const obelisk_stability_t * sp, int index)
+{
+    double result = -1.0;
+    const obelisk_stability_tau_t * tp = (const obelisk_stability_tau_t *)0;
+
+    tp = &(sp->tau[index]);
+
+    if (tp->tdevs > 0) {
+        result = sqrt(tp->tdev / (6.0 * tp->tdevs)) / obelisk_stability_tau(index);
+    }
+
+    return result;
+}
+
+int64_t obelisk_stability_mtie(const obelisk_stability_t * sp, int index)
+{
+    int64_t result = -1;
+
+    if (sp->samples > obelisk_stability_tau(index)) {
+        result = sp->tau[index].mtie;
+    }
+
+    return result;
+}
@@ -0,0 +1,176 @@
+/* vim: set ts=4 expandtab shiftwidth=4: */
+
+/**
+ * @file
+ *
+ * Copyright 2018 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in LICENSE.txt<BR>
+ * Chip Overclock<BR>
+ * mailto:coverclock@diag.com<BR>
+ * http://github.com/coverclock/com-diag-obelisk<BR>
+ */
+
+#include <assert.h>
+#include <string.h>
+#include "com/diag/obelisk/obelisk.h"
+#include "com/diag/obelisk/obelisk_table.h"
+#include "obelisk.h"
+#include "obelisk_calendar.h"
+
+/*
+ * The frames carry only a two digit year, so the leap year indicator must
+ * agree with the Gregorian year that obelisk_decode() will assign to it.
+ */
+static int leapyear(int year)
+{
+    return OBELISK_CALENDAR_LEAP(OBELISK_CALENDAR_YEAR(year % 100));
+}
+
+obelisk_dst_t obelisk_table_dst(int year, int day)
+{
+    int leap = -1;
+    int begins = -1;
+    int ends = -1;
+    int start = -1;
+    int end = -1;
+
+    leap = leapyear(year);
+
+    /*
+     * The second Sunday in March is the 8th through the 14th, and the first
+     * Sunday in November is the 1st through the 7th.
+     */
+
+    for (begins = 8; obelisk_zeller(year, 3, begins) != OBELISK_ZELLER_SUNDAY; ++begins) {
+        assert(begins < 14);
+    }
+    begins += 31 + 28 + leap;
+
+    for (ends = 1; obelisk_zeller(year, 11, ends) != OBELISK_ZELLER_SUNDAY; ++ends) {
+        assert(ends < 7);
+    }
+    ends += 304 + leap;
+
+    /*
+     * The first DST bit says whether DST is in effect at 00:00Z, the start
+     * of the UTC day, and the second whether it is at 24:00Z, its end.
+     */
+
+    start = (begins < day) && (day <= ends);
+    end = (begins <= day) && (day < ends);
+
+    return (obelisk_dst_t)((end << 1) | start);
+}
+
+size_t obelisk_table_size(int year)
+{
+    return sizeof(obelisk_table_t) + ((leapyear(year) ? 366 : 365) * 24 * 60 * sizeof(obelisk_buffer_t));
+}
+
+int obelisk_table_generate(obelisk_table_t * tablep, size_t size, int year, int dut1, int month)
+{
+    int rc = -1;
+    struct tm time = { 0 };
+    time_t epoch = -1;
+    int lyi = -1;
+    int lsw = -1;
+    int previous = -1;
+    int day = -1;
+    obelisk_dst_t dst = OBELISK_DST_OFF;
+
+    assert(tablep != (obelisk_table_t *)0);
+    assert((-9 <= dut1) && (dut1 <= 9));
+    assert((0 <= month) && (month <= 12));
+
+    if (size >= obelisk_table_size(year)) {
+
+        memset(tablep, 0, sizeof(*tablep));
+
+        time.tm_year = year - 1900;
+        time.tm_mon = 0;
+        time.tm_mday = 1;
+
+        tablep->magic = OBELISK_TABLE_MAGIC;
+        tablep->version = OBELISK_TABLE_VERSION;
+        tablep->year = year;
+        tablep->minutes = (obelisk_table_size(year) - sizeof(obelisk_table_t)) / sizeof(obelisk_buffer_t);
+        tablep->dut1 = dut1;
+        tablep->first = timegm(&time);
+
+        lyi = leapyear(year);
+
+        for (uint32_t mm = 0; mm < tablep->minutes; ++mm) {
+            epoch = tablep->first + (mm * 60);
+            day = (mm / (24 * 60)) + 1;
+            if (day != previous) {
+                gmtime_r(&epoch, &time);
+                lsw = ((time.tm_mon + 1) == month);
+                dst = obelisk_table_dst(year, day);
+                previous = day;
+            }
+            tablep->frame[mm] = obelisk_encode(epoch, dut1, lyi, lsw, dst);
+        }
+
+        rc = 0;
+
+    }
+
+    return rc;
+}
+
+int obelisk_table_check(const obelisk_table_t * tablep, size_t size)
+{
+    int rc = -1;
+
+    if (size < sizeof(*tablep)) {
+        /* Do nothing. */
+    } else if (tablep->magic != OBELISK_TABLE_MAGIC) {
+        /* Do nothing. */
+    } else if (tablep->version != OBELISK_TABLE_VERSION) {
+        /* Do nothing. */
+    } else if (size < obelisk_table_size(tablep->year)) {
+        /* Do nothing. */
+    } else if (tablep->minutes != ((obelisk_table_size(tablep->year) - sizeof(*tablep)) / sizeof(tablep->frame[0]))) {
+        /* Do nothing. */
+    } else {
+        rc = 0;
+    }
+
+    return rc;
+}
+
+int obelisk_table_frame(const obelisk_table_t * tablep, time_t epoch, obelisk_buffer_t * bufferp)
+{
+    int rc = -1;
+
+    if (epoch < tablep->first) {
+        /* Do nothing. */
+    } else if (((epoch - tablep->first) / 60) >= tablep->minutes) {
+        /* Do nothing. */
+    } else {
+        *bufferp = tablep->frame[(epoch - tablep->first) / 60];
+        rc = 0;
+    }
+
+    return rc;
+}
+
+time_t obelisk_table_epoch(const obelisk_table_t * tablep, obelisk_buffer_t buffer)
+{
+    time_t epoch = -1;
+
+    epoch = obelisk_epoch(buffer);
+    if (epoch < 0) {
+        /* Do nothing. */
+    } else if (epoch < tablep->first) {
+        epoch = -1;
+    } else if (((epoch - tablep->first) / 60) >= tablep->minutes) {
+        epoch = -1;
+    } else if (tablep->frame[(epoch - tablep->first) / 60] != (buffer & OBELISK_FRAME)) {
+        epoch = -1;
+    } else {
+        /* Do nothing. */
+    }
+
+    return epoch;
+}
@@ -0,0 +1,223 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ *
+ * Copyright 2018 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in README.h<BR>
+ * Chip Overclock (coverclock@diag.com)<BR>
+ * http://www.diag.com/navigation/downloads/Diminuto.html<BR>
+ */
+
+#include "com/diag/diminuto/diminuto_unittest.h"
+#include "com/diag/diminuto/diminuto_log.h"
+#include "com/diag/diminuto/diminuto_core.h"
+#include "com/diag/obelisk/obelisk.h"
+#include "obelisk.h"
+#include <stdio.h>
+#include <errno.h>
+
+/*
+ * 2008-066T07:30Z, dUT1 -0.3s, leap year, no leap second, no DST.
+ */
+static const char SENTENCE[] = "0MM01100000M000000111M000000110M011000010M001100000M100001000M";
+
+static obelisk_buffer_t parse(const char * sentence)
+{
+    obelisk_state_t state = OBELISK_STATE_START;
+    obelisk_token_t token;
+    obelisk_buffer_t buffer = 0;
+    obelisk_frame_t frame;
+    int field;
+    int length;
+    const char * ss;
+
+    for (ss = sentence; *ss != '\0'; ++ss) {
+        token = (*ss == 'M') ? OBELISK_TOKEN_MARKER : (*ss == '1') ? OBELISK_TOKEN_ONE : OBELISK_TOKEN_ZERO;
+        (void)obelisk_parse(&state, token, &field, &length, &buffer, &frame);
+    }
+
+    return buffer;
+}
+
+int main(int argc, char ** argv)
+{
+    SETLOGMASK();
+
+    diminuto_core_enable();
+
+    {
+        obelisk_accumulator_t accumulator;
+        obelisk_buffer_t buffer = 0;
+        obelisk_buffer_t voted = 0;
+        obelisk_frame_t frame = { 0 };
+
+        TEST();
+
+        buffer = parse(SENTENCE);
+        EXPECT(buffer != 0);
+
+        obelisk_accumulator_init(&accumulator);
+        EXPECT(accumulator.count == 0);
+        EXPECT(obelisk_accumulator_vote(&accumulator, 1, &voted, &frame) == -60);
+
+        obelisk_accumulator_add(&accumulator, 0, buffer, 59);
+        EXPECT(accumulator.count == 1);
+        EXPECT(obelisk_accumulator_vote(&accumulator, 1, &voted, &frame) == 0);
+        EXPECT(voted == buffer);
+        EXPECT(frame.minutes10 == 3);
+        EXPECT(frame.minutes1 == 0);
+        EXPECT(frame.hours1 == 7);
+        EXPECT(frame.day10 == 6);
+        EXPECT(frame.day1 == 6);
+        EXPECT(frame.year1 == 8);
+        EXPECT(obelisk_validate(&frame) >= 0);
+
+        EXPECT(obelisk_accumulator_vote(&accumulator, 2, &voted, &frame) == -60);
+
+        STATUS();
+    }
+
+    {
+        obelisk_accumulator_t accumulator;
+        obelisk_buffer_t buffer = 0;
+        obelisk_buffer_t voted = 0;
+        obelisk_frame_t frame = { 0 };
+
+        TEST();
+
+        /*
+         * Five consecutive minutes, each with a different bit in error.
+         * None of them is valid by itself; by majority they are.
+         */
+
+        buffer = parse(SENTENCE);
+        obelisk_accumulator_init(&accumulator);
+
+        for (int minute = 0; minute < 5; ++minute) {
+            obelisk_buffer_t noisy = obelisk_advance(buffer, minute);
+            noisy ^= OBELISK_BIT(2 + (minute * 11));
+            obelisk_accumulator_add(&accumulator, minute, noisy, 59);
+        }
+
+        EXPECT(obelisk_accumulator_vote(&accumulator, 1, &voted, &frame) == 0);
+        EXPECT(voted == obelisk_advance(buffer, 4));
+        EXPECT(frame.minutes1 == 4);
+        EXPECT(obelisk_accumulator_vote(&accumulator, 3, &voted, &frame) == 0);
+        EXPECT(obelisk_accumulator_vote(&accumulator, 4, &voted, &frame) == -5);
+
+        STATUS();
+    }
+
+    {
+        obelisk_accumulator_t accumulator;
+        obelisk_buffer_t buffer = 0;
+        obelisk_buffer_t voted = 0;
+        obelisk_frame_t frame = { 0 };
+
+        TEST();
+
+        /*
+         * Frames straddling the top of the hour, and a gap of a minute
+         * in which nothing was received.
+         */
+
+        buffer = obelisk_advance(parse(SENTENCE), 28);
+        obelisk_accumulator_init(&accumulator);
+
+        obelisk_accumulator_add(&accumulator, 100, buffer ^ OBELISK_BIT(7), 59);
+        obelisk_accumulator_add(&accumulator, 101, obelisk_advance(buffer, 1) ^ OBELISK_BIT(16), 59);
+        obelisk_accumulator_add(&accumulator, 103, obelisk_advance(buffer, 3), 59);
+
+        EXPECT(obelisk_accumulator_vote(&accumulator, 1, &voted, &frame) == 0);
+        EXPECT(voted == obelisk_advance(buffer, 3));
+        EXPECT(frame.hours1 == 8);
+        EXPECT(frame.minutes10 == 0);
+        EXPECT(frame.minutes1 == 1);
+
+        STATUS();
+    }
+
+    {
+        obelisk_accumulator_t accumulator;
+        obelisk_buffer_t buffer = 0;
+        obelisk_buffer_t voted = 0;
+        obelisk_frame_t frame = { 0 };
+
+        TEST();
+
+        /*
+         * Partial frames received up to :34 only decide the bits up to :34.
+         * A later frame received from :00 up to :59 is all it takes to
+         * fill in the rest.
+         */
+
+        buffer = parse(SENTENCE);
+        obelisk_accumulator_init(&accumulator);
+
+        obelisk_accumulator_add(&accumulator, 0, buffer >> (59 - 34), 34);
+        obelisk_accumulator_add(&accumulator, 1, obelisk_advance(buffer, 1) >> (59 - 34), 34);
+        EXPECT(obelisk_accumulator_vote(&accumulator, 1, &voted, &frame) == -(59 - 34));
+        EXPECT(obelisk_accumulator_vote(&accumulator, 2, &voted, &frame) == -(59 - 34));
+
+        obelisk_accumulator_add(&accumulator, 2, obelisk_advance(buffer, 2), 59);
+        EXPECT(obelisk_accumulator_vote(&accumulator, 1, &voted, &frame) == 0);
+        EXPECT(voted == obelisk_advance(buffer, 2));
+        EXPECT(obelisk_accumulator_vote(&accumulator, 2, &voted, &frame) == -(59 - 34));
+
+        STATUS();
+    }
+
+    {
+        obelisk_accumulator_t accumulator;
+        obelisk_buffer_t buffer = 0;
+        obelisk_buffer_t voted = 0;
+        obelisk_frame_t frame = { 0 };
+
+        TEST();
+
+        /*
+         * A partial frame that lacks the units digit of the minutes can't
+         * be advanced with any confidence into the hours and beyond.
+         */
+
+        buffer = parse(SENTENCE);
+        obelisk_accumulator_init(&accumulator);
+
+        obelisk_accumulator_add(&accumulator, 0, buffer >> (59 - 6), 6);
+        obelisk_accumulator_add(&accumulator, 1, obelisk_advance(buffer, 1), 59);
+        obelisk_accumulator_add(&accumulator, 2, obelisk_advance(buffer, 2), 59);
+
+        EXPECT(obelisk_accumulator_vote(&accumulator, 2, &voted, &frame) == 0);
+        EXPECT(voted == obelisk_advance(buffer, 2));
+
+        STATUS();
+    }
+
+    {
+        obelisk_accumulator_t accumulator;
+        obelisk_buffer_t buffer = 0;
+        obelisk_buffer_t voted = 0;
+        obelisk_frame_t frame = { 0 };
+
+        TEST();
+
+        /*
+         * The oldest frames are replaced once the accumulator is full.
+         */
+
+        buffer = parse(SENTENCE);
+        obelisk_accumulator_init(&accumulator);
+
+        for (int minute = 0; minute < (OBELISK_ACCUMULATOR_FRAMES * 2); ++minute) {
+            obelisk_accumulator_add(&accumulator, minute, obelisk_advance(buffer, minute), 59);
+        }
+
+        EXPECT(accumulator.count == OBELISK_ACCUMULATOR_FRAMES);
+        EXPECT(obelisk_accumulator_vote(&accumulator, OBELISK_ACCUMULATOR_FRAMES, &voted, &frame) == 0);
+        EXPECT(voted == obelisk_advance(buffer, (OBELISK_ACCUMULATOR_FRAMES * 2) - 1));
+
+        STATUS();
+    }
+
+    EXIT();
+}
@@ -0,0 +1,194 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ *
+ * Copyright 2018 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in README.h<BR>
+ * Chip Overclock (coverclock@diag.com)<BR>
+ * http://www.diag.com/navigation/downloads/Diminuto.html<BR>
+ */
+
+#include "com/diag/diminuto/diminuto_unittest.h"
+#include "com/diag/diminuto/diminuto_log.h"
+#include "com/diag/diminuto/diminuto_core.h"
+#include "com/diag/obelisk/obelisk.h"
+#include "obelisk.h"
+#include <stdio.h>
+#include <errno.h>
+#include <time.h>
+
+/*
+ * 2018-03-07T07:30:00Z, which is 2018-066T07:30.
+ */
+static const time_t EPOCH = 1520407800;
+
+/*
+ * Returns the token transmitted at the specified time.
+ */
+static obelisk_token_t transmit(time_t seconds)
+{
+    obelisk_token_t token = OBELISK_TOKEN_ZERO;
+    int second = seconds % 60;
+
+    if ((second == 0) || ((second % 10) == 9)) {
+        token = OBELISK_TOKEN_MARKER;
+    } else if ((obelisk_encode(seconds, -3, 0, 1, OBELISK_DST_ON) & OBELISK_BIT(second)) != 0) {
+        token = OBELISK_TOKEN_ONE;
+    } else {
+        token = OBELISK_TOKEN_ZERO;
+    }
+
+    return token;
+}
+
+int main(int argc, char ** argv)
+{
+    SETLOGMASK();
+
+    diminuto_core_enable();
+
+    {
+        static const int ERRORS[] = { -OBELISK_ACQUIRE_SECONDS, -17, -1, 0, 1, 23, OBELISK_ACQUIRE_SECONDS, };
+        obelisk_acquire_t acquire;
+        obelisk_state_t state;
+        obelisk_buffer_t buffer;
+        time_t now;
+        time_t epoch;
+        int field;
+        int length;
+        int rc;
+        int tokens;
+        int longest = 0;
+        int total = 0;
+        int count = 0;
+
+        TEST();
+
+        /*
+         * Start receiving at every second of the minute with the prior off
+         * by every amount up to the tolerance.
+         */
+
+        for (int ee = 0; ee < (sizeof(ERRORS) / sizeof(ERRORS[0])); ++ee) {
+            for (int start = 0; start < 60; ++start) {
+                now = EPOCH + start;
+                obelisk_acquire_init(&acquire, now + ERRORS[ee]);
+                state = OBELISK_STATE_START;
+                buffer = 0;
+                field = 0;
+                length = 0;
+                epoch = -1;
+                rc = 0;
+                for (tokens = 1; rc == 0; ++tokens, ++now) {
+                    rc = obelisk_acquire(&acquire, transmit(now), &epoch, &state, &field, &length, &buffer);
+                }
+                --tokens;
+                if ((rc <= 0) || (epoch != now - 1)) {
+                    CHECKPOINT("error=%d start=%d rc=%d tokens=%d epoch=%ld now=%ld best=%d margin=%d\n", ERRORS[ee], start, rc, tokens, (long)epoch, (long)(now - 1), acquire.best, acquire.margin);
+                }
+                EXPECT(rc > 0);
+                EXPECT(epoch == (now - 1));
+                if (tokens > longest) {
+                    longest = tokens;
+                }
+                total += tokens;
+                ++count;
+            }
+        }
+
+        CHECKPOINT("longest=%d average=%d\n", longest, total / count);
+        EXPECT(longest < 60);
+
+        STATUS();
+    }
+
+    {
+        obelisk_acquire_t acquire;
+        obelisk_state_t state = OBELISK_STATE_START;
+        obelisk_event_t event;
+        obelisk_buffer_t buffer = 0;
+        obelisk_frame_t frame;
+        time_t now;
+        time_t epoch = -1;
+        int field = 0;
+        int length = 0;
+        int rc = 0;
+        int frames = 0;
+
+        TEST();
+
+        /*
+         * Once locked, the parser carries on from where acquisition left
+         * off, with no INVALID events, and every frame it recognizes is
+         * exactly what was transmitted including the unpredictable fields.
+         * One pulse during acquisition is received in error.
+         */
+
+        now = EPOCH + 37;
+        obelisk_acquire_init(&acquire, now + 3);
+
+        while (rc == 0) {
+            rc = obelisk_acquire(&acquire, ((now - EPOCH) == 40) ? OBELISK_TOKEN_ONE : transmit(now), &epoch, &state, &field, &length, &buffer);
+            ++now;
+        }
+        EXPECT(rc > 0);
+        EXPECT(epoch == (now - 1));
+
+        for (; now < (EPOCH + (60 * 4)); ++now) {
+            event = obelisk_parse(&state, transmit(now), &field, &length, &buffer, &frame);
+            EXPECT(event != OBELISK_EVENT_INVALID);
+            EXPECT(event != OBELISK_EVENT_WAITING);
+            if (event == OBELISK_EVENT_FRAME) {
+                EXPECT((now % 60) == 59);
+                EXPECT(buffer == obelisk_encode(now, -3, 0, 1, OBELISK_DST_ON));
+                ++frames;
+            }
+        }
+
+        EXPECT(frames >= 3);
+
+        STATUS();
+    }
+
+    {
+        obelisk_acquire_t acquire;
+        obelisk_state_t state = OBELISK_STATE_START;
+        obelisk_buffer_t buffer = 0;
+        time_t epoch = -1;
+        int field = 0;
+        int length = 0;
+        int rc = 0;
+        int tokens = 0;
+
+        TEST();
+
+        /*
+         * Nothing but ONEs, or a stream of INVALIDs, never locks.
+         */
+
+        obelisk_acquire_init(&acquire, EPOCH);
+        while (rc == 0) {
+            rc = obelisk_acquire(&acquire, OBELISK_TOKEN_ONE, &epoch, &state, &field, &length, &buffer);
+            ++tokens;
+        }
+        EXPECT(rc < 0);
+        EXPECT(tokens < OBELISK_ACQUIRE_TOKENS);
+        EXPECT(epoch == -1);
+
+        obelisk_acquire_init(&acquire, EPOCH);
+        rc = 0;
+        tokens = 0;
+        while (rc == 0) {
+            rc = obelisk_acquire(&acquire, OBELISK_TOKEN_INVALID, &epoch, &state, &field, &length, &buffer);
+            ++tokens;
+        }
+        EXPECT(rc < 0);
+        EXPECT(tokens == OBELISK_ACQUIRE_TOKENS);
+        EXPECT(epoch == -1);
+        EXPECT(state == OBELISK_STATE_START);
+
+        STATUS();
+    }
+
+    EXIT();
+}
@@ -0,0 +1,94 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ *
+ * Copyright 2018 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in README.h<BR>
+ * Chip Overclock (coverclock@diag.com)<BR>
+ * http://www.diag.com/navigation/downloads/Diminuto.html<BR>
+ */
+
+#include "com/diag/diminuto/diminuto_unittest.h"
+#include "com/diag/diminuto/diminuto_log.h"
+#include "com/diag/diminuto/diminuto_core.h"
+#include "com/diag/obelisk/obelisk.h"
+#include "obelisk.h"
+#include <stdio.h>
+#include <errno.h>
+
+#define ADVANCE(_Y0_, _D0_, _H0_, _M0_, _L0_, _MINUTES_, _Y1_, _D1_, _H1_, _M1_, _L1_) \
+    do { \
+        obelisk_buffer_t before = obelisk_compose(_Y0_, _D0_, _H0_, _M0_, -3, _L0_, 0, OBELISK_DST_OFF); \
+        obelisk_buffer_t after = obelisk_advance(before, _MINUTES_); \
+        obelisk_buffer_t expected = obelisk_compose(_Y1_, _D1_, _H1_, _M1_, -3, _L1_, 0, OBELISK_DST_OFF); \
+        if (after != expected) { CHECKPOINT("0x%016llx 0x%016llx 0x%016llx\n", (long long unsigned)before, (long long unsigned)after, (long long unsigned)expected); } \
+        EXPECT(after == expected); \
+    } while (0)
+
+int main(int argc, char ** argv)
+{
+    SETLOGMASK();
+
+    diminuto_core_enable();
+
+    {
+        TEST();
+
+        ADVANCE(17,   1,  0,  0, 0,     0, 17,   1,  0,  0, 0);
+        ADVANCE(17,   1,  0,  0, 0,     1, 17,   1,  0,  1, 0);
+        ADVANCE(17,   1,  0,  9, 0,     1, 17,   1,  0, 10, 0);
+        ADVANCE(17,   1,  0, 59, 0,     1, 17,   1,  1,  0, 0);
+        ADVANCE(17,   1,  9, 59, 0,     1, 17,   1, 10,  0, 0);
+        ADVANCE(17,   1, 23, 59, 0,     1, 17,   2,  0,  0, 0);
+        ADVANCE(17,  99, 23, 59, 0,     1, 17, 100,  0,  0, 0);
+        ADVANCE(17, 365, 23, 59, 0,     1, 18,   1,  0,  0, 0);
+        ADVANCE(19, 365, 23, 59, 0,     1, 20,   1,  0,  0, 1);
+        ADVANCE(20, 365, 23, 59, 1,     1, 20, 366,  0,  0, 1);
+        ADVANCE(20, 366, 23, 59, 1,     1, 21,   1,  0,  0, 0);
+        ADVANCE(99, 365, 23, 59, 0,     1,  0,   1,  0,  0, 0);
+        ADVANCE( 0, 365, 23, 59, 0,     1,  1,   1,  0,  0, 0);
+        ADVANCE( 3, 365, 23, 59, 0,     1,  4,   1,  0,  0, 1);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        ADVANCE(18,  66,  7, 30, 0,    60, 18,  66,  8, 30, 0);
+        ADVANCE(18,  66,  7, 30, 0,  1440, 18,  67,  7, 30, 0);
+        ADVANCE(18, 365,  7, 30, 0,  1440, 19,   1,  7, 30, 0);
+        ADVANCE(18,   1,  0,  0, 0, 525600, 19,  1,  0,  0, 0);
+        ADVANCE(19,   1,  0,  0, 0, 525600, 20,  1,  0,  0, 1);
+        ADVANCE(20,   1,  0,  0, 1, 525600, 20, 366,  0,  0, 1);
+
+        STATUS();
+    }
+
+    {
+        obelisk_buffer_t before;
+        obelisk_buffer_t after;
+
+        TEST();
+
+        before = obelisk_compose(18, 66, 7, 59, -3, 0, 0, OBELISK_DST_OFF);
+        before = OBELISK_INSERT(before, LSW, 1);
+        before = OBELISK_INSERT(before, DST, OBELISK_DST_ON);
+        before = OBELISK_INSERT(before, DUTONESIGN, OBELISK_SIGN_POSITIVE);
+        before = OBELISK_INSERT(before, DUTONE1, 7);
+
+        after = obelisk_advance(before, 1);
+
+        EXPECT(OBELISK_EXTRACT(after, HOURS1) == 8);
+        EXPECT(OBELISK_EXTRACT(after, MINUTES10) == 0);
+        EXPECT(OBELISK_EXTRACT(after, LSW) == 1);
+        EXPECT(OBELISK_EXTRACT(after, DST) == OBELISK_DST_ON);
+        EXPECT(OBELISK_EXTRACT(after, DUTONESIGN) == OBELISK_SIGN_POSITIVE);
+        EXPECT(OBELISK_EXTRACT(after, DUTONE1) == 7);
+        EXPECT((after & ~OBELISK_FRAME) == 0);
+
+        STATUS();
+    }
+
+    EXIT();
+}
@@ -0,0 +1,240 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ *
+ * Copyright 2018 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in README.h<BR>
+ * Chip Overclock (coverclock@diag.com)<BR>
+ * http://www.diag.com/navigation/downloads/Diminuto.html<BR>
+ */
+
+#include "com/diag/diminuto/diminuto_unittest.h"
+#include "com/diag/diminuto/diminuto_log.h"
+#include "com/diag/diminuto/diminuto_core.h"
+#include "com/diag/obelisk/obelisk.h"
+#include "com/diag/obelisk/obelisk_batch.h"
+#include "obelisk.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+
+/*
+ * 2017-01-01T00:00:00Z
+ */
+static const time_t FIRST = 1483228800;
+
+/*
+ * 2117-01-01T00:00:00Z
+ */
+static const time_t LAST = 4638902400;
+
+static uint64_t seed = 1;
+
+static uint64_t randomize(void)
+{
+    seed = (seed * 6364136223846793005ULL) + 1442695040888963407ULL;
+    return seed;
+}
+
+/*
+ * Returns the buffer for the minute containing the time, with random
+ * dUT1, leap second warning, and DST.
+ */
+static obelisk_buffer_t compose(time_t seconds)
+{
+    int dut1;
+    int lsw;
+    obelisk_dst_t dst;
+
+    dut1 = (int)((randomize() >> 8) % 19) - 9;
+    lsw = randomize() & 1;
+    dst = (obelisk_dst_t)(randomize() & 3);
+
+    return obelisk_encode(seconds, dut1, -1, lsw, dst);
+}
+
+/*
+ * This is what an application has to do without the batch decoder.
+ */
+static time_t reference(obelisk_buffer_t buffer)
+{
+    obelisk_frame_t frame;
+    struct tm time;
+    time_t epoch = -1;
+
+    obelisk_extract(&frame, buffer);
+    if (obelisk_validate(&frame) < 0) {
+        /* Do nothing. */
+    } else if (obelisk_decode(&time, &frame) < 0) {
+        /* Do nothing. */
+    } else {
+        epoch = timegm(&time);
+    }
+
+    return epoch;
+}
+
+static double elapsed(const struct timespec * startp, const struct timespec * stopp)
+{
+    return (stopp->tv_sec - startp->tv_sec) + ((stopp->tv_nsec - startp->tv_nsec) / 1000000000.0);
+}
+
+int main(int argc, char ** argv)
+{
+    SETLOGMASK();
+
+    diminuto_core_enable();
+
+    {
+        static const size_t COUNT = 100003; /* Not a multiple of any vector width. */
+        obelisk_buffer_t * buffers;
+        time_t * epochs1;
+        time_t * epochs2;
+        uint8_t * valid1;
+        uint8_t * valid2;
+        size_t total1;
+        size_t total2;
+        size_t good = 0;
+
+        TEST();
+
+        CHECKPOINT("implementation=\"%s\"\n", obelisk_batch_implementation());
+#if defined(__aarch64__) && defined(__ARM_NEON)
+        EXPECT(strcmp(obelisk_batch_implementation(), "neon") == 0);
+#endif
+
+        buffers = (obelisk_buffer_t *)malloc(COUNT * sizeof(buffers[0]));
+        epochs1 = (time_t *)malloc(COUNT * sizeof(epochs1[0]));
+        epochs2 = (time_t *)malloc(COUNT * sizeof(epochs2[0]));
+        valid1 = (uint8_t *)malloc(COUNT * sizeof(valid1[0]));
+        valid2 = (uint8_t *)malloc(COUNT * sizeof(valid2[0]));
+
+        /*
+         * Half are valid, and the rest are either entirely random or
+         * valid but for one flipped bit.
+         */
+
+        for (size_t ii = 0; ii < COUNT; ++ii) {
+            buffers[ii] = compose(FIRST + (randomize() % (LAST - FIRST)));
+            switch (ii % 4) {
+            case 2:
+                buffers[ii] ^= ((obelisk_buffer_t)1) << (randomize() % 60);
+                break;
+            case 3:
+                buffers[ii] = randomize();
+                break;
+            default:
+                ++good;
+                break;
+            }
+        }
+
+        total1 = obelisk_batch(epochs1, valid1, buffers, COUNT);
+        total2 = obelisk_batch_scalar(epochs2, valid2, buffers, COUNT);
+
+        CHECKPOINT("count=%zu good=%zu total=%zu\n", COUNT, good, total1);
+        EXPECT(total1 == total2);
+        EXPECT(total1 >= good);
+        EXPECT(total1 < COUNT);
+
+        for (size_t ii = 0; ii < COUNT; ++ii) {
+            if ((valid1[ii] != valid2[ii]) || (epochs1[ii] != epochs2[ii])) {
+                CHECKPOINT("ii=%zu buffer=0x%016llx valid=%d,%d epoch=%lld,%lld\n", ii, (long long unsigned)buffers[ii], valid1[ii], valid2[ii], (long long)epochs1[ii], (long long)epochs2[ii]);
+            }
+            EXPECT(valid1[ii] == valid2[ii]);
+            EXPECT(epochs1[ii] == epochs2[ii]);
+            EXPECT(valid1[ii] == ((obelisk_verify(buffers[ii]) == 0) && (obelisk_epoch(buffers[ii]) >= 0)));
+            if (!valid1[ii]) {
+                EXPECT(epochs1[ii] == -1);
+            }
+            /*
+             * The reference uses the leap year indicator, which may be
+             * one of the flipped bits, to find the month; the epoch
+             * doesn't need the month at all.
+             */
+            if ((ii % 4) < 2) {
+                EXPECT(valid1[ii]);
+                EXPECT(epochs1[ii] == reference(buffers[ii]));
+            }
+        }
+
+        /* Every short tail. */
+
+        for (size_t nn = 0; nn <= 9; ++nn) {
+            EXPECT(obelisk_batch(epochs1, valid1, &buffers[COUNT - nn], nn) == obelisk_batch_scalar(epochs2, valid2, &buffers[COUNT - nn], nn));
+            for (size_t ii = 0; ii < nn; ++ii) {
+                EXPECT(epochs1[ii] == epochs2[ii]);
+                EXPECT(valid1[ii] == valid2[ii]);
+            }
+        }
+
+        free(buffers);
+        free(epochs1);
+        free(epochs2);
+        free(valid1);
+        free(valid2);
+
+        STATUS();
+    }
+
+    {
+        static const size_t COUNT = 1 << 20;
+        obelisk_buffer_t * buffers;
+        time_t * epochs;
+        uint8_t * valid;
+        struct timespec start;
+        struct timespec stop;
+        double batch;
+        double individual;
+        size_t total = 0;
+
+        TEST();
+
+        /*
+         * Compare the batch decoder with extracting, validating, and
+         * decoding each buffer in turn.
+         */
+
+        buffers = (obelisk_buffer_t *)malloc(COUNT * sizeof(buffers[0]));
+        epochs = (time_t *)malloc(COUNT * sizeof(epochs[0]));
+        valid = (uint8_t *)malloc(COUNT * sizeof(valid[0]));
+
+        for (size_t ii = 0; ii < COUNT; ++ii) {
+            buffers[ii] = compose(FIRST + (ii * 60 * 97));
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        total = obelisk_batch(epochs, valid, buffers, COUNT);
+        clock_gettime(CLOCK_MONOTONIC, &stop);
+        batch = elapsed(&start, &stop);
+        EXPECT(total == COUNT);
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        total = 0;
+        for (size_t ii = 0; ii < COUNT; ++ii) {
+            epochs[ii] = reference(buffers[ii]);
+            valid[ii] = (epochs[ii] >= 0);
+            total += valid[ii];
+        }
+        clock_gettime(CLOCK_MONOTONIC, &stop);
+        individual = elapsed(&start, &stop);
+        EXPECT(total == COUNT);
+
+        /*
+         * Wall clock times vary with load (and under valgrind), so they
+         * are only reported.
+         */
+
+        CHECKPOINT("buffers=%zu %s=%.1fns individual=%.1fns\n", COUNT, obelisk_batch_implementation(), batch * 1000000000.0 / COUNT, individual * 1000000000.0 / COUNT);
+
+        free(buffers);
+        free(epochs);
+        free(valid);
+
+        STATUS();
+    }
+
+    EXIT();
+}
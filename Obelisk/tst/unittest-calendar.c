@@ -0,0 +1,128 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ *
+ * Copyright 2018 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in README.h<BR>
+ * Chip Overclock (coverclock@diag.com)<BR>
+ * http://www.diag.com/navigation/downloads/Diminuto.html<BR>
+ */
+
+#include "com/diag/diminuto/diminuto_unittest.h"
+#include "com/diag/diminuto/diminuto_log.h"
+#include "com/diag/diminuto/diminuto_core.h"
+#include "com/diag/diminuto/diminuto_countof.h"
+#include "com/diag/obelisk/obelisk.h"
+#include "obelisk.h"
+#include "obelisk_calendar.h"
+#include <stdio.h>
+#include <errno.h>
+#include <time.h>
+
+int main(int argc, char ** argv)
+{
+    SETLOGMASK();
+
+    diminuto_core_enable();
+
+    {
+        struct tm time;
+        time_t epoch;
+        int yy;
+        int month;
+        int day;
+        int leap;
+        int days = 0;
+
+        TEST();
+
+        /*
+         * Every day of the century obelisk_decode() uses, checked against
+         * the C library.
+         */
+
+        for (epoch = 1483228800; epoch < 4638902400; epoch += 24 * 60 * 60) {
+            EXPECT(gmtime_r(&epoch, &time) == &time);
+            yy = time.tm_year % 100;
+            leap = OBELISK_CALENDAR_LEAP(OBELISK_CALENDAR_YEAR(yy));
+            if (time.tm_yday == 0) {
+                EXPECT(OBELISK_YEARDAYS[yy] == (epoch / (24 * 60 * 60)));
+                EXPECT(OBELISK_CALENDAR_WEEKDAY[yy] == time.tm_wday);
+            }
+            EXPECT(OBELISK_CALENDAR_CUMULATIVE[leap][time.tm_mon] == (time.tm_yday + 1 - time.tm_mday));
+            EXPECT(obelisk_julian2gregorian(time.tm_yday + 1, leap, &month, &day) == 0);
+            EXPECT(month == (time.tm_mon + 1));
+            EXPECT(day == time.tm_mday);
+            EXPECT(obelisk_zeller(time.tm_year + 1900, time.tm_mon + 1, time.tm_mday) == time.tm_wday);
+            ++days;
+        }
+
+        EXPECT(days == ((365 * 100) + 24));
+
+        STATUS();
+    }
+
+    {
+        struct tm time;
+        time_t epoch;
+
+        TEST();
+
+        for (int yy = 0; yy < diminuto_countof(OBELISK_CALENDAR_CENTURY); ++yy) {
+            epoch = (time_t)(10957 + OBELISK_CALENDAR_CENTURY[yy]) * 24 * 60 * 60;
+            EXPECT(gmtime_r(&epoch, &time) == &time);
+            EXPECT(time.tm_year == (100 + yy));
+            EXPECT(time.tm_yday == 0);
+        }
+
+        STATUS();
+    }
+
+    {
+        obelisk_buffer_t buffer;
+        time_t epoch;
+
+        TEST();
+
+        /*
+         * Year 00 is 2100, which is not a leap year, no matter which century
+         * the epoch handed to obelisk_encode() was in.
+         */
+
+        EXPECT(OBELISK_CALENDAR_YEAR(0) == 2100);
+        EXPECT(!OBELISK_CALENDAR_LEAP(OBELISK_CALENDAR_YEAR(0)));
+        EXPECT(OBELISK_CALENDAR_LEAP(OBELISK_CALENDAR_YEAR(96)));
+
+        epoch = 946684800; /* 2000-01-01T00:00:00Z */
+        buffer = obelisk_encode(epoch, 0, -1, 0, OBELISK_DST_OFF);
+        EXPECT(OBELISK_EXTRACT(buffer, LYI) == 0);
+        EXPECT(obelisk_epoch(buffer) == 4102444800); /* 2100-01-01T00:00:00Z */
+
+        epoch = 4102444800; /* 2100-01-01T00:00:00Z */
+        buffer = obelisk_encode(epoch, 0, -1, 0, OBELISK_DST_OFF);
+        EXPECT(OBELISK_EXTRACT(buffer, LYI) == 0);
+        EXPECT(obelisk_epoch(buffer) == epoch);
+
+        epoch = 4133894400; /* 2100-12-31T00:00:00Z, day 365 */
+        buffer = obelisk_encode(epoch, 0, -1, 0, OBELISK_DST_OFF);
+        EXPECT(obelisk_epoch(buffer) == epoch);
+        buffer = OBELISK_INSERT(buffer, DAY1, 6); /* Day 366 */
+        EXPECT(obelisk_epoch(buffer) < 0);
+
+        epoch = 4070908800; /* 2099-01-01T00:00:00Z */
+        buffer = obelisk_encode(epoch, 0, -1, 0, OBELISK_DST_OFF);
+        EXPECT(OBELISK_EXTRACT(buffer, LYI) == 0);
+
+        epoch = 4039372800; /* 2098-01-01T00:00:00Z */
+        buffer = obelisk_encode(epoch, 0, -1, 0, OBELISK_DST_OFF);
+        EXPECT(OBELISK_EXTRACT(buffer, LYI) == 0);
+
+        epoch = 3976214400; /* 2096-01-01T00:00:00Z */
+        buffer = obelisk_encode(epoch, 0, -1, 0, OBELISK_DST_OFF);
+        EXPECT(OBELISK_EXTRACT(buffer, LYI) == 1);
+
+        STATUS();
+    }
+
+    EXIT();
+}
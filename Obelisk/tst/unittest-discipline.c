@@ -0,0 +1,131 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ *
+ * Copyright 2018 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in README.h<BR>
+ * Chip Overclock (coverclock@diag.com)<BR>
+ * http://www.diag.com/navigation/downloads/Diminuto.html<BR>
+ */
+
+#include "com/diag/diminuto/diminuto_unittest.h"
+#include "com/diag/diminuto/diminuto_log.h"
+#include "com/diag/diminuto/diminuto_core.h"
+#include "com/diag/obelisk/obelisk_discipline.h"
+#include <stdio.h>
+#include <errno.h>
+
+/*
+ * Nothing here calls obelisk_discipline_adjust(): run as root, it would
+ * really discipline the clock of the system running the unit tests.
+ */
+
+int main(int argc, char ** argv)
+{
+    SETLOGMASK();
+
+    diminuto_core_enable();
+
+    {
+        struct timespec system;
+        struct timespec reference;
+
+        TEST();
+
+        system.tv_sec = 1514764800;
+        system.tv_nsec = 250000000;
+        reference.tv_sec = 1514764800;
+        reference.tv_nsec = 0;
+        EXPECT(obelisk_discipline_offset(&system, &reference) == 250000000LL);
+        EXPECT(obelisk_discipline_offset(&reference, &system) == -250000000LL);
+
+        system.tv_sec = 1514764799;
+        system.tv_nsec = 999999000;
+        EXPECT(obelisk_discipline_offset(&system, &reference) == -1000LL);
+
+        system.tv_sec = 1514764800 + 3600;
+        system.tv_nsec = 0;
+        EXPECT(obelisk_discipline_offset(&system, &reference) == 3600000000000LL);
+
+        STATUS();
+    }
+
+    {
+        obelisk_discipline_t discipline;
+        struct timex timex;
+
+        TEST();
+
+        obelisk_discipline_init(&discipline, OBELISK_DISCIPLINE_THRESHOLD, OBELISK_DISCIPLINE_CONSTANT);
+        EXPECT(discipline.threshold == 128000000LL);
+        EXPECT(discipline.steps == 0);
+        EXPECT(discipline.slews == 0);
+
+        /* Small offsets are slewed by the kernel PLL. */
+
+        EXPECT(obelisk_discipline_prepare(&discipline, &timex, 5000000LL) == 0);
+        EXPECT(timex.modes == (ADJ_OFFSET | ADJ_STATUS | ADJ_NANO | ADJ_TIMECONST | ADJ_MAXERROR | ADJ_ESTERROR));
+        EXPECT(timex.offset == -5000000L);
+        EXPECT(timex.status == STA_PLL);
+        EXPECT(timex.constant == OBELISK_DISCIPLINE_CONSTANT);
+        EXPECT(timex.esterror == 5000);
+
+        EXPECT(obelisk_discipline_prepare(&discipline, &timex, -128000000LL) == 0);
+        EXPECT(timex.offset == 128000000L);
+
+        /* A leap second pending today is passed along. */
+
+        discipline.leap = !0;
+        EXPECT(obelisk_discipline_prepare(&discipline, &timex, 0) == 0);
+        EXPECT(timex.status == (STA_PLL | STA_INS));
+        discipline.leap = 0;
+
+        STATUS();
+    }
+
+    {
+        obelisk_discipline_t discipline;
+        struct timex timex;
+
+        TEST();
+
+        obelisk_discipline_init(&discipline, OBELISK_DISCIPLINE_THRESHOLD, OBELISK_DISCIPLINE_CONSTANT);
+
+        /* Large offsets are stepped away. */
+
+        EXPECT(obelisk_discipline_prepare(&discipline, &timex, 128000001LL) > 0);
+        EXPECT(timex.modes == (ADJ_SETOFFSET | ADJ_NANO));
+        EXPECT(timex.time.tv_sec == -1);
+        EXPECT(timex.time.tv_usec == 871999999);
+
+        EXPECT(obelisk_discipline_prepare(&discipline, &timex, -2500000000LL) > 0);
+        EXPECT(timex.time.tv_sec == 2);
+        EXPECT(timex.time.tv_usec == 500000000);
+
+        EXPECT(obelisk_discipline_prepare(&discipline, &timex, 3600000000000LL) > 0);
+        EXPECT(timex.time.tv_sec == -3600);
+        EXPECT(timex.time.tv_usec == 0);
+
+        STATUS();
+    }
+
+    {
+        obelisk_discipline_t discipline;
+        struct timex timex;
+
+        TEST();
+
+        /* Slews are limited to what the kernel will accept. */
+
+        obelisk_discipline_init(&discipline, 2000, OBELISK_DISCIPLINE_CONSTANT);
+
+        EXPECT(obelisk_discipline_prepare(&discipline, &timex, 1500000000LL) == 0);
+        EXPECT(timex.offset == -500000000L);
+        EXPECT(obelisk_discipline_prepare(&discipline, &timex, -1500000000LL) == 0);
+        EXPECT(timex.offset == 500000000L);
+
+        STATUS();
+    }
+
+    EXIT();
+}
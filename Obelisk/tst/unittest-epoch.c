@@ -0,0 +1,115 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ *
+ * Copyright 2018 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in README.h<BR>
+ * Chip Overclock (coverclock@diag.com)<BR>
+ * http://www.diag.com/navigation/downloads/Diminuto.html<BR>
+ */
+
+#include "com/diag/diminuto/diminuto_unittest.h"
+#include "com/diag/diminuto/diminuto_log.h"
+#include "com/diag/diminuto/diminuto_core.h"
+#include "com/diag/obelisk/obelisk.h"
+#include "obelisk.h"
+#include <stdio.h>
+#include <errno.h>
+#include <time.h>
+
+/*
+ * 2017-01-01T00:00:00Z
+ */
+static const time_t FIRST = 1483228800;
+
+/*
+ * 2117-01-01T00:00:00Z
+ */
+static const time_t LAST = 4638902400;
+
+int main(int argc, char ** argv)
+{
+    SETLOGMASK();
+
+    diminuto_core_enable();
+
+    {
+        obelisk_buffer_t buffer;
+        obelisk_frame_t frame;
+        struct tm decoded;
+        int count = 0;
+
+        TEST();
+
+        /*
+         * Every 37 minutes of the century that obelisk_decode() handles
+         * agrees with it and timegm(3).
+         */
+
+        for (time_t epoch = FIRST; epoch < LAST; epoch += 37 * 60) {
+            buffer = obelisk_encode(epoch, 2, -1, 0, OBELISK_DST_OFF);
+            EXPECT(obelisk_epoch(buffer) == epoch);
+            obelisk_extract(&frame, buffer);
+            EXPECT(obelisk_decode(&decoded, &frame) >= 0);
+            EXPECT(timegm(&decoded) == epoch);
+            ++count;
+        }
+
+        EXPECT(count > 1000000);
+
+        STATUS();
+    }
+
+    {
+        struct timespec time;
+        obelisk_dst_t dst;
+        int leap;
+
+        TEST();
+
+        EXPECT(obelisk_timespec(&time, &leap, &dst, obelisk_compose(17, 181, 23, 59, 2, 0, 1, OBELISK_DST_ON)) == 0);
+        EXPECT(time.tv_sec == 1498867140);
+        EXPECT(time.tv_nsec == 0);
+        EXPECT(leap);
+        EXPECT(dst == OBELISK_DST_ON);
+
+        EXPECT(obelisk_timespec(&time, &leap, &dst, obelisk_compose(17, 181, 23, 58, 2, 0, 1, OBELISK_DST_ON)) == 0);
+        EXPECT(!leap);
+
+        EXPECT(obelisk_timespec(&time, &leap, &dst, obelisk_compose(17, 180, 23, 59, 2, 0, 1, OBELISK_DST_ON)) == 0);
+        EXPECT(!leap);
+
+        EXPECT(obelisk_timespec(&time, &leap, &dst, obelisk_compose(17, 181, 23, 59, 2, 0, 0, OBELISK_DST_ENDS)) == 0);
+        EXPECT(!leap);
+        EXPECT(dst == OBELISK_DST_ENDS);
+
+        EXPECT(obelisk_timespec(&time, &leap, (obelisk_dst_t *)0, obelisk_compose(20, 60, 23, 59, 2, 1, 1, OBELISK_DST_OFF)) == 0);
+        EXPECT(leap);
+
+        EXPECT(obelisk_timespec(&time, (int *)0, (obelisk_dst_t *)0, obelisk_compose(16, 366, 23, 59, 2, 1, 1, OBELISK_DST_OFF)) == 0);
+        EXPECT(time.tv_sec == 4638902340);
+
+        STATUS();
+    }
+
+    {
+        struct timespec time;
+
+        TEST();
+
+        /* 2017 and 2100 are not leap years; 2116 is. */
+
+        EXPECT(obelisk_epoch(obelisk_compose(17, 365, 0, 0, 2, 0, 0, OBELISK_DST_OFF)) >= 0);
+        EXPECT(obelisk_epoch(obelisk_compose(17, 366, 0, 0, 2, 0, 0, OBELISK_DST_OFF)) < 0);
+        EXPECT(obelisk_epoch(obelisk_compose(0, 366, 0, 0, 2, 0, 0, OBELISK_DST_OFF)) < 0);
+        EXPECT(obelisk_epoch(obelisk_compose(16, 366, 0, 0, 2, 1, 0, OBELISK_DST_OFF)) >= 0);
+        EXPECT(obelisk_epoch(obelisk_compose(17, 0, 0, 0, 2, 0, 0, OBELISK_DST_OFF)) < 0);
+        EXPECT(obelisk_epoch(obelisk_compose(17, 1, 24, 0, 2, 0, 0, OBELISK_DST_OFF)) < 0);
+        EXPECT(obelisk_epoch(obelisk_compose(17, 1, 0, 60, 2, 0, 0, OBELISK_DST_OFF)) < 0);
+        EXPECT(obelisk_timespec(&time, (int *)0, (obelisk_dst_t *)0, obelisk_compose(17, 1, 0, 60, 2, 0, 0, OBELISK_DST_OFF)) < 0);
+
+        STATUS();
+    }
+
+    EXIT();
+}
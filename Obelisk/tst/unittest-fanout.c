@@ -0,0 +1,164 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ *
+ * Copyright 2018 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in README.h<BR>
+ * Chip Overclock (coverclock@diag.com)<BR>
+ * http://www.diag.com/navigation/downloads/Diminuto.html<BR>
+ */
+
+#include "com/diag/diminuto/diminuto_unittest.h"
+#include "com/diag/diminuto/diminuto_log.h"
+#include "com/diag/diminuto/diminuto_core.h"
+#include "com/diag/obelisk/obelisk_fanout.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+static int calls = 0;
+
+static ssize_t function(void * context, int fd, const void * buffer, size_t length)
+{
+    calls += 1;
+    *(size_t *)context += length;
+    return length;
+}
+
+int main(int argc, char ** argv)
+{
+    SETLOGMASK();
+
+    diminuto_core_enable();
+
+    {
+        obelisk_fanout_t fanout;
+        obelisk_fanout_statistics_t statistics;
+        int one[2];
+        int two[2];
+        char buffer[OBELISK_FANOUT_SIZE + 1];
+        char message[sizeof("MESSAGE 00\n")];
+        int ii;
+
+        TEST();
+
+        ASSERT(pipe(one) == 0);
+        ASSERT(pipe(two) == 0);
+
+        ASSERT(obelisk_fanout_init(&fanout) == 0);
+        EXPECT(obelisk_fanout_add(&fanout, one[1], (obelisk_fanout_function_t *)0, (void *)0) == 0);
+        EXPECT(obelisk_fanout_add(&fanout, two[1], (obelisk_fanout_function_t *)0, (void *)0) == 1);
+        ASSERT(obelisk_fanout_start(&fanout) == 0);
+        EXPECT(obelisk_fanout_add(&fanout, two[1], (obelisk_fanout_function_t *)0, (void *)0) < 0);
+
+        for (ii = 0; ii < 10; ++ii) {
+            snprintf(message, sizeof(message), "MESSAGE %02d\n", ii);
+            EXPECT(obelisk_fanout_post(&fanout, message, strlen(message)) == 2);
+            EXPECT(read(one[0], buffer, strlen(message)) == strlen(message));
+            EXPECT(strncmp(buffer, message, strlen(message)) == 0);
+            EXPECT(read(two[0], buffer, strlen(message)) == strlen(message));
+            EXPECT(strncmp(buffer, message, strlen(message)) == 0);
+        }
+
+        EXPECT(obelisk_fanout_post(&fanout, buffer, sizeof(buffer)) < 0);
+        EXPECT(errno == EMSGSIZE);
+
+        EXPECT(obelisk_fanout_stop(&fanout) == 0);
+
+        obelisk_fanout_statistics(&fanout, 0, &statistics);
+        EXPECT(statistics.queued == 10);
+        EXPECT(statistics.written == 10);
+        EXPECT(statistics.dropped == 0);
+        EXPECT(statistics.failed == 0);
+
+        obelisk_fanout_fini(&fanout);
+
+        EXPECT(close(one[0]) == 0);
+        EXPECT(close(one[1]) == 0);
+        EXPECT(close(two[0]) == 0);
+        EXPECT(close(two[1]) == 0);
+
+        STATUS();
+    }
+
+    {
+        obelisk_fanout_t fanout;
+        obelisk_fanout_statistics_t statistics;
+        int stalled[2];
+        int healthy[2];
+        int other[2];
+        char buffer[64];
+        size_t length = 0;
+        int ii;
+
+        TEST();
+
+        /*
+         * A FIFO whose reader has stopped reading fills up. Its messages
+         * are dropped, and the sinks that are keeping up get every one.
+         * The pipes are handed over blocking; the fan out makes them
+         * non-blocking, without which filling the stalled one would hang.
+         */
+
+        ASSERT(pipe(stalled) == 0);
+        ASSERT(pipe(healthy) == 0);
+        ASSERT(pipe(other) == 0);
+        EXPECT((fcntl(stalled[1], F_GETFL) & O_NONBLOCK) == 0);
+        EXPECT((fcntl(healthy[1], F_GETFL) & O_NONBLOCK) == 0);
+
+        ASSERT(obelisk_fanout_init(&fanout) == 0);
+        EXPECT(obelisk_fanout_add(&fanout, stalled[1], (obelisk_fanout_function_t *)0, (void *)0) == 0);
+        EXPECT(obelisk_fanout_add(&fanout, healthy[1], (obelisk_fanout_function_t *)0, (void *)0) == 1);
+        ASSERT((fcntl(stalled[1], F_GETFL) & O_NONBLOCK) != 0);
+        EXPECT((fcntl(healthy[1], F_GETFL) & O_NONBLOCK) != 0);
+
+        memset(buffer, 'X', sizeof(buffer));
+        while (write(stalled[1], buffer, sizeof(buffer)) > 0) {
+            /* Do nothing. */
+        }
+        EXPECT(errno == EAGAIN);
+
+        /* The function writes; the file descriptor is only polled. */
+
+        EXPECT(obelisk_fanout_add(&fanout, other[1], function, &length) == 2);
+        ASSERT(obelisk_fanout_start(&fanout) == 0);
+
+        for (ii = 0; ii < (3 * OBELISK_FANOUT_DEPTH); ++ii) {
+            EXPECT(obelisk_fanout_post(&fanout, "HELLO\n", 6) >= 2);
+            EXPECT(read(healthy[0], buffer, 6) == 6);
+        }
+
+        EXPECT(obelisk_fanout_stop(&fanout) == 0);
+
+        obelisk_fanout_statistics(&fanout, 0, &statistics);
+        CHECKPOINT("stalled queued=%llu written=%llu dropped=%llu failed=%llu\n", (unsigned long long)statistics.queued, (unsigned long long)statistics.written, (unsigned long long)statistics.dropped, (unsigned long long)statistics.failed);
+        EXPECT(statistics.queued == OBELISK_FANOUT_DEPTH);
+        EXPECT(statistics.written == 0);
+        EXPECT(statistics.dropped == (2 * OBELISK_FANOUT_DEPTH));
+
+        obelisk_fanout_statistics(&fanout, 1, &statistics);
+        EXPECT(statistics.queued == (3 * OBELISK_FANOUT_DEPTH));
+        EXPECT(statistics.written == (3 * OBELISK_FANOUT_DEPTH));
+        EXPECT(statistics.dropped == 0);
+
+        obelisk_fanout_statistics(&fanout, 2, &statistics);
+        EXPECT((statistics.written + statistics.dropped) == (3 * OBELISK_FANOUT_DEPTH));
+        EXPECT(calls == statistics.written);
+        EXPECT(length == (6 * statistics.written));
+
+        obelisk_fanout_fini(&fanout);
+
+        EXPECT(close(stalled[0]) == 0);
+        EXPECT(close(stalled[1]) == 0);
+        EXPECT(close(healthy[0]) == 0);
+        EXPECT(close(healthy[1]) == 0);
+        EXPECT(close(other[0]) == 0);
+        EXPECT(close(other[1]) == 0);
+
+        STATUS();
+    }
+
+    EXIT();
+}
@@ -48,6 +48,8 @@ int main(int argc, char ** argv)
         BADDATA(  0, !0);
         BADDATA(366,  0);
         BADDATA(367, !0);
+        BADDATA(  1, -1);
+        BADDATA(  1,  2);
 
         STATUS();
     }
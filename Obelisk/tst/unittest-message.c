@@ -0,0 +1,161 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ *
+ * Copyright 2018 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in README.h<BR>
+ * Chip Overclock (coverclock@diag.com)<BR>
+ * http://www.diag.com/navigation/downloads/Diminuto.html<BR>
+ */
+
+#include "com/diag/diminuto/diminuto_unittest.h"
+#include "com/diag/diminuto/diminuto_log.h"
+#include "com/diag/diminuto/diminuto_core.h"
+#include "com/diag/obelisk/obelisk_message.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+int main(int argc, char ** argv)
+{
+    SETLOGMASK();
+
+    diminuto_core_enable();
+
+    {
+        obelisk_message_t message;
+
+        TEST();
+
+        /* The layout is the protocol. */
+
+        EXPECT(sizeof(message) == 32);
+        EXPECT(offsetof(obelisk_message_t, magic) == 0);
+        EXPECT(offsetof(obelisk_message_t, version) == 4);
+        EXPECT(offsetof(obelisk_message_t, lock) == 5);
+        EXPECT(offsetof(obelisk_message_t, leap) == 6);
+        EXPECT(offsetof(obelisk_message_t, dst) == 7);
+        EXPECT(offsetof(obelisk_message_t, seconds) == 8);
+        EXPECT(offsetof(obelisk_message_t, nanoseconds) == 16);
+        EXPECT(offsetof(obelisk_message_t, uncertainty) == 20);
+        EXPECT(offsetof(obelisk_message_t, dut1) == 24);
+        EXPECT(offsetof(obelisk_message_t, sequence) == 26);
+        EXPECT(offsetof(obelisk_message_t, reserved) == 28);
+
+        obelisk_message_init(&message);
+        EXPECT(message.magic == OBELISK_MESSAGE_MAGIC);
+        EXPECT(message.version == OBELISK_MESSAGE_VERSION);
+        EXPECT(message.lock == OBELISK_MESSAGE_LOCK_NONE);
+        EXPECT(message.uncertainty == -1);
+        EXPECT(message.sequence == 0);
+        EXPECT(obelisk_message_valid(&message, sizeof(message)));
+        EXPECT(!obelisk_message_valid(&message, sizeof(message) - 1));
+
+        obelisk_message_status(&message, -3, !0, OBELISK_DST_BEGINS);
+        EXPECT(message.dut1 == -300);
+        EXPECT(message.leap == 1);
+        EXPECT(message.dst == OBELISK_DST_BEGINS);
+
+        obelisk_message_prepare(&message, OBELISK_MESSAGE_LOCK_ACQUIRED, 1520139967, 123456, 2500);
+        EXPECT(message.lock == OBELISK_MESSAGE_LOCK_ACQUIRED);
+        EXPECT(message.seconds == 1520139967);
+        EXPECT(message.nanoseconds == 123456);
+        EXPECT(message.uncertainty == 2500);
+        EXPECT(message.sequence == 1);
+
+        obelisk_message_prepare(&message, OBELISK_MESSAGE_LOCK_HOLDOVER, 1520139968, 0, 5000000000LL);
+        EXPECT(message.uncertainty == INT32_MAX);
+        EXPECT(message.sequence == 2);
+
+        obelisk_message_prepare(&message, OBELISK_MESSAGE_LOCK_HOLDOVER, 1520139969, 0, -1);
+        EXPECT(message.uncertainty == -1);
+
+        message.magic = __builtin_bswap32(OBELISK_MESSAGE_MAGIC);
+        EXPECT(!obelisk_message_valid(&message, sizeof(message)));
+        message.magic = OBELISK_MESSAGE_MAGIC;
+        message.version = OBELISK_MESSAGE_VERSION + 1;
+        EXPECT(!obelisk_message_valid(&message, sizeof(message)));
+
+        STATUS();
+    }
+
+    {
+        static const char PATH[] = "/tmp/unittest-message.sock";
+        static const char JUNK[] = "$ZVRMC,000000.00,A,,,,,,,010170,,,D*00\r\n";
+        obelisk_message_t message;
+        obelisk_message_t received[OBELISK_MESSAGE_BATCH];
+        char large[sizeof(message) + 1];
+        int server;
+        int client;
+        int ii;
+
+        TEST();
+
+        (void)unlink(PATH);
+        server = obelisk_message_bind(PATH);
+        ASSERT(server >= 0);
+
+        client = obelisk_message_open(PATH);
+        ASSERT(client >= 0);
+
+        /*
+         * Interleave datagrams that aren't messages, which the receiver
+         * discards while keeping the rest in order.
+         */
+
+        obelisk_message_init(&message);
+        obelisk_message_status(&message, 2, 0, OBELISK_DST_ON);
+        for (ii = 0; ii < 3; ++ii) {
+            obelisk_message_prepare(&message, OBELISK_MESSAGE_LOCK_ACQUIRED, 1520139967 + ii, 1000 * ii, 100);
+            EXPECT(obelisk_message_send(client, &message) == sizeof(message));
+            if (ii == 0) {
+                EXPECT(send(client, JUNK, sizeof(JUNK) - 1, 0) == (sizeof(JUNK) - 1));
+            } else if (ii == 1) {
+                memcpy(large, &message, sizeof(message));
+                EXPECT(send(client, large, sizeof(large), 0) == sizeof(large));
+            } else {
+                /* Do nothing. */
+            }
+        }
+
+        memset(received, 0, sizeof(received));
+        EXPECT(obelisk_message_receive(server, received, OBELISK_MESSAGE_BATCH) == 3);
+        for (ii = 0; ii < 3; ++ii) {
+            EXPECT(received[ii].magic == OBELISK_MESSAGE_MAGIC);
+            EXPECT(received[ii].lock == OBELISK_MESSAGE_LOCK_ACQUIRED);
+            EXPECT(received[ii].seconds == (1520139967 + ii));
+            EXPECT(received[ii].nanoseconds == (1000 * ii));
+            EXPECT(received[ii].uncertainty == 100);
+            EXPECT(received[ii].dut1 == 200);
+            EXPECT(received[ii].dst == OBELISK_DST_ON);
+            EXPECT(received[ii].sequence == (ii + 1));
+        }
+
+        /* Batches are no larger than asked for. */
+
+        for (ii = 0; ii < 5; ++ii) {
+            obelisk_message_prepare(&message, OBELISK_MESSAGE_LOCK_HOLDOVER, 1520139970 + ii, 0, -1);
+            EXPECT(obelisk_message_send(client, &message) == sizeof(message));
+        }
+        EXPECT(obelisk_message_receive(server, received, 2) == 2);
+        EXPECT(received[0].seconds == 1520139970);
+        EXPECT(received[1].seconds == 1520139971);
+        EXPECT(obelisk_message_receive(server, received, OBELISK_MESSAGE_BATCH) == 3);
+        EXPECT(received[2].seconds == 1520139974);
+        EXPECT(received[2].lock == OBELISK_MESSAGE_LOCK_HOLDOVER);
+
+        EXPECT(obelisk_message_close(client) == 0);
+        EXPECT(obelisk_message_close(server) == 0);
+        EXPECT(unlink(PATH) == 0);
+
+        /* Nobody listening. */
+
+        EXPECT(obelisk_message_open(PATH) < 0);
+
+        STATUS();
+    }
+
+    EXIT();
+}
@@ -0,0 +1,177 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ *
+ * Copyright 2018 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in README.h<BR>
+ * Chip Overclock (coverclock@diag.com)<BR>
+ * http://www.diag.com/navigation/downloads/Diminuto.html<BR>
+ */
+
+#include "com/diag/diminuto/diminuto_unittest.h"
+#include "com/diag/diminuto/diminuto_log.h"
+#include "com/diag/diminuto/diminuto_core.h"
+#include "com/diag/obelisk/obelisk_multicast.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+
+static const char GROUP[] = "239.255.77.1";
+
+/*
+ * A receiver on the loopback interface.
+ */
+static int receiver(int port)
+{
+    int sock = -1;
+    int one = 1;
+    struct sockaddr_in address = { 0 };
+    struct ip_mreqn mreqn = { 0 };
+    struct timeval timeout = { 1, 0 };
+
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    inet_pton(AF_INET, GROUP, &mreqn.imr_multiaddr);
+    mreqn.imr_ifindex = if_nametoindex("lo");
+
+    if ((sock = socket(AF_INET, SOCK_DGRAM, 0)) < 0) {
+        /* Do nothing. */
+    } else if ((setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) < 0) || (bind(sock, (struct sockaddr *)&address, sizeof(address)) < 0) || (setsockopt(sock, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreqn, sizeof(mreqn)) < 0) || (setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) < 0)) {
+        close(sock);
+        sock = -1;
+    } else {
+        /* Do nothing. */
+    }
+
+    return sock;
+}
+
+int main(int argc, char ** argv)
+{
+    SETLOGMASK();
+
+    diminuto_core_enable();
+
+    {
+        obelisk_multicast_announcement_t announcement;
+        obelisk_multicast_announcement_t decoded;
+        uint8_t buffer[OBELISK_MULTICAST_LENGTH];
+
+        TEST();
+
+        announcement.version = OBELISK_MULTICAST_VERSION;
+        announcement.flags = OBELISK_MULTICAST_FLAG_ACQUIRED | OBELISK_MULTICAST_FLAG_LEAP;
+        announcement.sequence = 0xfedc;
+        announcement.seconds = 1520139967;
+        announcement.previous = 123456;
+        obelisk_multicast_encode(buffer, &announcement);
+
+        EXPECT(memcmp(buffer, "WWVB\001\005\376\334", 8) == 0);
+        EXPECT(memcmp(&buffer[8], "\000\000\000\000\132\233\176\277", 8) == 0);
+        EXPECT(memcmp(&buffer[16], "\000\001\342\100", 4) == 0);
+
+        EXPECT(obelisk_multicast_decode(&decoded, buffer, sizeof(buffer)) == 0);
+        EXPECT(decoded.version == announcement.version);
+        EXPECT(decoded.flags == announcement.flags);
+        EXPECT(decoded.sequence == announcement.sequence);
+        EXPECT(decoded.seconds == announcement.seconds);
+        EXPECT(decoded.previous == announcement.previous);
+
+        announcement.previous = -1;
+        obelisk_multicast_encode(buffer, &announcement);
+        EXPECT(obelisk_multicast_decode(&decoded, buffer, sizeof(buffer)) == 0);
+        EXPECT(decoded.previous == -1);
+
+        EXPECT(obelisk_multicast_decode(&decoded, buffer, sizeof(buffer) - 1) < 0);
+        buffer[0] = 'X';
+        EXPECT(obelisk_multicast_decode(&decoded, buffer, sizeof(buffer)) < 0);
+
+        STATUS();
+    }
+
+    {
+        obelisk_multicast_t multicast;
+
+        TEST();
+
+        EXPECT(obelisk_multicast_init(&multicast, "nonesuch0", OBELISK_MULTICAST_TTL) < 0);
+        EXPECT(obelisk_multicast_init(&multicast, (const char *)0, OBELISK_MULTICAST_TTL) == 0);
+        EXPECT(obelisk_multicast_add(&multicast, "127.0.0.1", 5000) < 0);
+        EXPECT(obelisk_multicast_add(&multicast, "not an address", 5000) < 0);
+        EXPECT(obelisk_multicast_add(&multicast, GROUP, 0) < 0);
+        EXPECT(obelisk_multicast_add(&multicast, "ff02::1", 5000) == 0);
+        EXPECT(multicast.sock6 >= 0);
+        EXPECT(multicast.count == 1);
+        obelisk_multicast_fini(&multicast);
+
+        STATUS();
+    }
+
+    {
+        obelisk_multicast_t multicast;
+        obelisk_multicast_announcement_t decoded;
+        uint8_t buffer[OBELISK_MULTICAST_LENGTH + 1];
+        struct timespec edge;
+        int one;
+        int two;
+
+        TEST();
+
+        /*
+         * Two ports are sent to with one sendmmsg(2). The second
+         * announcement carries when the first was sent.
+         */
+
+        one = receiver(60147);
+        ASSERT(one >= 0);
+        two = receiver(60148);
+        ASSERT(two >= 0);
+
+        ASSERT(obelisk_multicast_init(&multicast, "lo", OBELISK_MULTICAST_TTL) == 0);
+        ASSERT(obelisk_multicast_add(&multicast, GROUP, 60147) == 0);
+        ASSERT(obelisk_multicast_add(&multicast, GROUP, 60148) == 0);
+
+        clock_gettime(CLOCK_REALTIME, &edge);
+        EXPECT(obelisk_multicast_send(&multicast, 1520139967, &edge, OBELISK_MULTICAST_FLAG_ACQUIRED) == 2);
+
+        EXPECT(recv(one, buffer, sizeof(buffer), 0) == OBELISK_MULTICAST_LENGTH);
+        EXPECT(obelisk_multicast_decode(&decoded, buffer, OBELISK_MULTICAST_LENGTH) == 0);
+        EXPECT(decoded.seconds == 1520139967);
+        EXPECT(decoded.sequence == 0);
+        EXPECT(decoded.flags == OBELISK_MULTICAST_FLAG_ACQUIRED);
+        EXPECT(decoded.previous == -1);
+        EXPECT(recv(two, buffer, sizeof(buffer), 0) == OBELISK_MULTICAST_LENGTH);
+        EXPECT(obelisk_multicast_decode(&decoded, buffer, OBELISK_MULTICAST_LENGTH) == 0);
+        EXPECT(decoded.seconds == 1520139967);
+
+        usleep(10000);
+
+        clock_gettime(CLOCK_REALTIME, &edge);
+        EXPECT(obelisk_multicast_send(&multicast, 1520139968, &edge, OBELISK_MULTICAST_FLAG_HOLDOVER) == 2);
+
+        EXPECT(recv(one, buffer, sizeof(buffer), 0) == OBELISK_MULTICAST_LENGTH);
+        EXPECT(obelisk_multicast_decode(&decoded, buffer, OBELISK_MULTICAST_LENGTH) == 0);
+        EXPECT(decoded.seconds == 1520139968);
+        EXPECT(decoded.sequence == 1);
+        EXPECT(decoded.flags == OBELISK_MULTICAST_FLAG_HOLDOVER);
+        CHECKPOINT("previous=%ldns\n", (long)decoded.previous);
+        EXPECT(decoded.previous >= 0);
+        EXPECT(decoded.previous < 10000000);
+        EXPECT(recv(two, buffer, sizeof(buffer), 0) == OBELISK_MULTICAST_LENGTH);
+
+        obelisk_multicast_fini(&multicast);
+        EXPECT(close(one) == 0);
+        EXPECT(close(two) == 0);
+
+        STATUS();
+    }
+
+    EXIT();
+}
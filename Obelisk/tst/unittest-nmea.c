@@ -0,0 +1,168 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ *
+ * Copyright 2018 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in README.h<BR>
+ * Chip Overclock (coverclock@diag.com)<BR>
+ * http://www.diag.com/navigation/downloads/Diminuto.html<BR>
+ */
+
+#include "com/diag/diminuto/diminuto_unittest.h"
+#include "com/diag/diminuto/diminuto_log.h"
+#include "com/diag/diminuto/diminuto_core.h"
+#include "com/diag/obelisk/obelisk_nmea.h"
+#include <stdio.h>
+#include <string.h>
+
+/*
+ * Check every sentence in the buffer against a checksum computed from
+ * scratch.
+ */
+static int valid(const char * buffer, size_t length)
+{
+    const char * here = buffer;
+    const char * end = buffer + length;
+    unsigned char checksum = 0;
+    char expected[sizeof("XX")];
+    int sentences = 0;
+
+    while (here < end) {
+        if (*(here++) != '$') {
+            return -1;
+        }
+        for (checksum = 0; (here < end) && (*here != '*'); ++here) {
+            checksum ^= (unsigned char)*here;
+        }
+        snprintf(expected, sizeof(expected), "%02X", checksum);
+        if ((end - here) < 5) {
+            return -1;
+        } else if (strncmp(here + 1, expected, 2) != 0) {
+            return -1;
+        } else if (strncmp(here + 3, "\r\n", 2) != 0) {
+            return -1;
+        } else {
+            here += 5;
+            sentences += 1;
+        }
+    }
+
+    return sentences;
+}
+
+int main(int argc, char ** argv)
+{
+    SETLOGMASK();
+
+    diminuto_core_enable();
+
+    {
+        obelisk_nmea_t nmea;
+
+        TEST();
+
+        obelisk_nmea_init(&nmea, "ZV", 0);
+        EXPECT(nmea.length == strlen("$ZVRMC,000000.00,A,,,,,,,010170,,,D*XX\r\n"));
+        EXPECT(strncmp(nmea.buffer, "$ZVRMC,000000.00,A,,,,,,,010170,,,D*", 36) == 0);
+        EXPECT(valid(nmea.buffer, nmea.length) == 1);
+
+        obelisk_nmea_init(&nmea, "GP", !0);
+        EXPECT(strlen(nmea.buffer) == nmea.length);
+        EXPECT(valid(nmea.buffer, nmea.length) == 3);
+
+        /* 2018-03-04T05:06:07Z */
+
+        obelisk_nmea_time(&nmea, 1520139967);
+        obelisk_nmea_hundredths(&nmea, 12);
+        obelisk_nmea_mode(&nmea, 'E');
+        obelisk_nmea_status(&nmea, -3, !0, OBELISK_DST_BEGINS, 58);
+        CHECKPOINT("\"%s\"\n", nmea.buffer);
+        EXPECT(strncmp(&nmea.buffer[0], "$GPRMC,050607.12,A,,,,,,,040318,,,E*", 36) == 0);
+        EXPECT(strncmp(&nmea.buffer[40], "$GPZDA,050607.12,04,03,2018,00,00*", 34) == 0);
+        EXPECT(strncmp(&nmea.buffer[78], "$PWWVB,-0.3,1,2,58*", 19) == 0);
+        EXPECT(valid(nmea.buffer, nmea.length) == 3);
+
+        obelisk_nmea_status(&nmea, 9, 0, OBELISK_DST_ON, 60);
+        EXPECT(strncmp(&nmea.buffer[78], "$PWWVB,+0.9,0,3,60*", 19) == 0);
+        EXPECT(valid(nmea.buffer, nmea.length) == 3);
+
+        STATUS();
+    }
+
+    {
+        obelisk_nmea_t nmea;
+        obelisk_nmea_t fresh;
+        time_t seconds;
+
+        TEST();
+
+        /*
+         * Patching one second at a time, across minutes, hours, days,
+         * months, and years (including a leap day), always yields what
+         * formatting the same time from scratch would.
+         */
+
+        obelisk_nmea_init(&nmea, "ZV", !0);
+
+        for (seconds = 951868800 - 3600; seconds < (951868800 + (2 * 86400)); seconds += 1) {
+            obelisk_nmea_time(&nmea, seconds);
+            obelisk_nmea_init(&fresh, "ZV", !0);
+            obelisk_nmea_time(&fresh, seconds);
+            if (memcmp(nmea.buffer, fresh.buffer, sizeof(nmea.buffer)) != 0) {
+                break;
+            }
+        }
+        EXPECT(seconds == (951868800 + (2 * 86400)));
+
+        for (seconds = 946684800 - 120; seconds < (946684800 + 120); seconds += 1) {
+            obelisk_nmea_time(&nmea, seconds);
+            if (valid(nmea.buffer, nmea.length) != 3) {
+                break;
+            }
+        }
+        EXPECT(seconds == (946684800 + 120));
+        EXPECT(strncmp(nmea.buffer, "$ZVRMC,000159.00,A,,,,,,,010100,,,D*", 36) == 0);
+
+        /* And jumping around. */
+
+        obelisk_nmea_time(&nmea, 1520139967);
+        obelisk_nmea_time(&nmea, 0);
+        obelisk_nmea_init(&fresh, "ZV", !0);
+        EXPECT(memcmp(nmea.buffer, fresh.buffer, sizeof(nmea.buffer)) == 0);
+
+        STATUS();
+    }
+
+    {
+        obelisk_nmea_t nmea;
+        obelisk_nmea_t fresh;
+        obelisk_nmea_t table[OBELISK_NMEA_SENTENCES];
+        int ii;
+
+        TEST();
+
+        obelisk_nmea_init(&nmea, "ZV", !0);
+        obelisk_nmea_status(&nmea, 2, 0, OBELISK_DST_OFF, 60);
+        obelisk_nmea_time(&nmea, 1520139959);
+
+        obelisk_nmea_precompute(&nmea, table, OBELISK_NMEA_SENTENCES);
+
+        for (ii = 0; ii < OBELISK_NMEA_SENTENCES; ++ii) {
+            obelisk_nmea_init(&fresh, "ZV", !0);
+            obelisk_nmea_status(&fresh, 2, 0, OBELISK_DST_OFF, 60);
+            obelisk_nmea_time(&fresh, 1520139959 + 1 + ii);
+            if (table[ii].seconds != fresh.seconds) {
+                break;
+            }
+            if (memcmp(table[ii].buffer, fresh.buffer, sizeof(fresh.buffer)) != 0) {
+                break;
+            }
+        }
+        EXPECT(ii == OBELISK_NMEA_SENTENCES);
+        EXPECT(strncmp(table[OBELISK_NMEA_SENTENCES - 1].buffer, "$ZVRMC,050659.00,A,,,,,,,040318,,,D*", 36) == 0);
+
+        STATUS();
+    }
+
+    EXIT();
+}
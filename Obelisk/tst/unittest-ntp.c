@@ -0,0 +1,286 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ *
+ * Copyright 2018 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in README.h<BR>
+ * Chip Overclock (coverclock@diag.com)<BR>
+ * http://www.diag.com/navigation/downloads/Diminuto.html<BR>
+ */
+
+#include "com/diag/diminuto/diminuto_unittest.h"
+#include "com/diag/diminuto/diminuto_log.h"
+#include "com/diag/diminuto/diminuto_core.h"
+#include "com/diag/obelisk/obelisk_ntp.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <poll.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+static uint32_t get(const uint8_t * buffer)
+{
+    return ((uint32_t)buffer[0] << 24) | ((uint32_t)buffer[1] << 16) | ((uint32_t)buffer[2] << 8) | buffer[3];
+}
+
+/*
+ * Build a client request as ntpdate or chrony would.
+ */
+static void ask(uint8_t * request, int version, int mode, uint32_t seconds)
+{
+    memset(request, 0, OBELISK_NTP_LENGTH);
+    request[0] = (version << 3) | mode;
+    request[2] = 6;
+    request[40] = seconds >> 24;
+    request[41] = seconds >> 16;
+    request[42] = seconds >> 8;
+    request[43] = seconds;
+    request[47] = 0x5a;
+}
+
+int main(int argc, char ** argv)
+{
+    SETLOGMASK();
+
+    diminuto_core_enable();
+
+    {
+        uint8_t buffer[8];
+        struct timespec time;
+
+        TEST();
+
+        time.tv_sec = 0;
+        time.tv_nsec = 0;
+        obelisk_ntp_timestamp(buffer, &time);
+        EXPECT(get(&buffer[0]) == 2208988800UL);
+        EXPECT(get(&buffer[4]) == 0);
+
+        /* 2018-03-04T05:06:07.5Z */
+
+        time.tv_sec = 1520139967;
+        time.tv_nsec = 500000000;
+        obelisk_ntp_timestamp(buffer, &time);
+        EXPECT(get(&buffer[0]) == (1520139967UL + 2208988800UL));
+        EXPECT(get(&buffer[4]) == 0x80000000UL);
+
+        time.tv_nsec = 999999999;
+        obelisk_ntp_timestamp(buffer, &time);
+        EXPECT(get(&buffer[4]) == 0xfffffffbUL);
+
+        STATUS();
+    }
+
+    {
+        uint8_t request[OBELISK_NTP_LENGTH];
+        uint8_t response[OBELISK_NTP_LENGTH];
+        obelisk_ntp_status_t status = { 0 };
+        struct timespec receive;
+        struct timespec transmit;
+
+        TEST();
+
+        status.reference.tv_sec = 1520139967;
+        status.reference.tv_nsec = 0;
+        status.dispersion = 500000000;
+        status.leap = OBELISK_NTP_LEAP_ADDSECOND;
+        status.stratum = OBELISK_NTP_STRATUM;
+        receive.tv_sec = 1520139967;
+        receive.tv_nsec = 250000000;
+        transmit.tv_sec = 1520139967;
+        transmit.tv_nsec = 250001000;
+
+        ask(request, 4, OBELISK_NTP_MODE_CLIENT, 0xdeadbeef);
+        EXPECT(obelisk_ntp_respond(response, request, sizeof(request), &status, &receive, &transmit) == OBELISK_NTP_LENGTH);
+        EXPECT(response[0] == ((OBELISK_NTP_LEAP_ADDSECOND << 6) | (4 << 3) | OBELISK_NTP_MODE_SERVER));
+        EXPECT(response[1] == OBELISK_NTP_STRATUM);
+        EXPECT(response[2] == 6);
+        EXPECT((int8_t)response[3] == OBELISK_NTP_PRECISION);
+        EXPECT(get(&response[4]) == 0);
+        EXPECT(get(&response[8]) == 0x8000);
+        EXPECT(memcmp(&response[12], "WWVB", 4) == 0);
+        EXPECT(get(&response[16]) == (1520139967UL + 2208988800UL));
+        EXPECT(memcmp(&response[24], &request[40], 8) == 0);
+        EXPECT(get(&response[32]) == (1520139967UL + 2208988800UL));
+        EXPECT(get(&response[36]) == 0x40000000UL);
+        EXPECT(get(&response[40]) == (1520139967UL + 2208988800UL));
+        EXPECT(get(&response[44]) > 0x40000000UL);
+
+        /* Older clients get their own version back. */
+
+        ask(request, 3, OBELISK_NTP_MODE_CLIENT, 1);
+        EXPECT(obelisk_ntp_respond(response, request, sizeof(request), &status, &receive, &transmit) == OBELISK_NTP_LENGTH);
+        EXPECT(((response[0] >> 3) & 0x7) == 3);
+
+        /* Unsynchronized, or stratum 0, which is a Kiss-o'-Death. */
+
+        status.leap = OBELISK_NTP_LEAP_NOTINSYNC;
+        status.stratum = OBELISK_NTP_UNSYNCHRONIZED;
+        EXPECT(obelisk_ntp_respond(response, request, sizeof(request), &status, &receive, &transmit) < 0);
+        status.leap = OBELISK_NTP_LEAP_NOWARNING;
+        EXPECT(obelisk_ntp_respond(response, request, sizeof(request), &status, &receive, &transmit) < 0);
+        status.stratum = 0;
+        EXPECT(obelisk_ntp_respond(response, request, sizeof(request), &status, &receive, &transmit) < 0);
+        status.leap = OBELISK_NTP_LEAP_NOTINSYNC;
+        status.stratum = OBELISK_NTP_STRATUM;
+        EXPECT(obelisk_ntp_respond(response, request, sizeof(request), &status, &receive, &transmit) < 0);
+        status.leap = OBELISK_NTP_LEAP_NOWARNING;
+
+        /* Anything but a client request is ignored. */
+
+        ask(request, 4, OBELISK_NTP_MODE_SERVER, 1);
+        EXPECT(obelisk_ntp_respond(response, request, sizeof(request), &status, &receive, &transmit) < 0);
+        ask(request, 1, 1, 1);
+        EXPECT(obelisk_ntp_respond(response, request, sizeof(request), &status, &receive, &transmit) < 0);
+        ask(request, 0, OBELISK_NTP_MODE_CLIENT, 1);
+        EXPECT(obelisk_ntp_respond(response, request, sizeof(request), &status, &receive, &transmit) < 0);
+        ask(request, 5, OBELISK_NTP_MODE_CLIENT, 1);
+        EXPECT(obelisk_ntp_respond(response, request, sizeof(request), &status, &receive, &transmit) < 0);
+        ask(request, 4, OBELISK_NTP_MODE_CLIENT, 1);
+        EXPECT(obelisk_ntp_respond(response, request, sizeof(request) - 1, &status, &receive, &transmit) < 0);
+
+        STATUS();
+    }
+
+    {
+        obelisk_ntp_t server;
+        obelisk_ntp_status_t status;
+        obelisk_ntp_statistics_t statistics;
+        struct sockaddr_in address = { 0 };
+        struct timespec reference;
+        struct timespec before;
+        struct timespec after;
+        struct pollfd fd;
+        uint8_t request[OBELISK_NTP_LENGTH];
+        uint8_t response[OBELISK_NTP_LENGTH];
+        int client;
+        int ii;
+
+        TEST();
+
+        ASSERT(obelisk_ntp_init(&server, 0) == 0);
+        EXPECT(server.port > 0);
+
+        obelisk_ntp_status(&server, &status);
+        EXPECT(status.stratum == OBELISK_NTP_UNSYNCHRONIZED);
+        EXPECT(status.leap == OBELISK_NTP_LEAP_NOTINSYNC);
+
+        ASSERT(clock_gettime(CLOCK_REALTIME, &reference) == 0);
+        obelisk_ntp_update(&server, &reference, OBELISK_NTP_LEAP_NOWARNING, 1000);
+        obelisk_ntp_status(&server, &status);
+        EXPECT(status.stratum == OBELISK_NTP_STRATUM);
+        EXPECT(status.leap == OBELISK_NTP_LEAP_NOWARNING);
+        EXPECT(status.dispersion == 1000);
+
+        /* An IPv4 client of the dual stack socket, one batch. */
+
+        client = socket(AF_INET, SOCK_DGRAM, 0);
+        ASSERT(client >= 0);
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(server.port);
+        ASSERT(connect(client, (struct sockaddr *)&address, sizeof(address)) == 0);
+
+        ASSERT(clock_gettime(CLOCK_REALTIME, &before) == 0);
+        for (ii = 0; ii < 3; ++ii) {
+            ask(request, 4, OBELISK_NTP_MODE_CLIENT, ii);
+            EXPECT(send(client, request, sizeof(request), 0) == sizeof(request));
+        }
+        ask(request, 4, OBELISK_NTP_MODE_SERVER, 3);
+        EXPECT(send(client, request, sizeof(request), 0) == sizeof(request));
+
+        fd.fd = server.sock;
+        fd.events = POLLIN;
+        EXPECT(poll(&fd, 1, 1000) == 1);
+        EXPECT(obelisk_ntp_serve(&server) == 3);
+        ASSERT(clock_gettime(CLOCK_REALTIME, &after) == 0);
+
+        for (ii = 0; ii < 3; ++ii) {
+            EXPECT(recv(client, response, sizeof(response), 0) == sizeof(response));
+            EXPECT((response[0] & 0x7) == OBELISK_NTP_MODE_SERVER);
+            EXPECT(response[1] == OBELISK_NTP_STRATUM);
+            EXPECT(get(&response[24]) == ii);
+            EXPECT(get(&response[32]) >= (before.tv_sec + 2208988800UL));
+            EXPECT(get(&response[32]) <= (after.tv_sec + 2208988800UL));
+        }
+
+        obelisk_ntp_statistics(&server, &statistics);
+        EXPECT(statistics.received == 4);
+        EXPECT(statistics.answered == 3);
+        EXPECT(statistics.ignored == 1);
+        EXPECT(statistics.failed == 0);
+
+        /* The same through the thread. */
+
+        ASSERT(obelisk_ntp_start(&server) == 0);
+
+        ask(request, 4, OBELISK_NTP_MODE_CLIENT, 7);
+        EXPECT(send(client, request, sizeof(request), 0) == sizeof(request));
+        fd.fd = client;
+        fd.events = POLLIN;
+        EXPECT(poll(&fd, 1, 1000) == 1);
+        EXPECT(recv(client, response, sizeof(response), 0) == sizeof(response));
+        EXPECT(get(&response[24]) == 7);
+
+        EXPECT(obelisk_ntp_stop(&server) == 0);
+
+        obelisk_ntp_statistics(&server, &statistics);
+        EXPECT(statistics.answered == 4);
+
+        EXPECT(close(client) == 0);
+        obelisk_ntp_fini(&server);
+
+        STATUS();
+    }
+
+    {
+        obelisk_ntp_t server;
+        obelisk_ntp_statistics_t statistics;
+        struct sockaddr_in address = { 0 };
+        struct pollfd fd;
+        uint8_t request[OBELISK_NTP_LENGTH];
+        uint8_t response[OBELISK_NTP_LENGTH];
+        int client;
+
+        TEST();
+
+        /* A server that has never known the time says nothing. */
+
+        ASSERT(obelisk_ntp_init(&server, 0) == 0);
+
+        client = socket(AF_INET, SOCK_DGRAM, 0);
+        ASSERT(client >= 0);
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(server.port);
+        ASSERT(connect(client, (struct sockaddr *)&address, sizeof(address)) == 0);
+
+        ask(request, 4, OBELISK_NTP_MODE_CLIENT, 1);
+        EXPECT(send(client, request, sizeof(request), 0) == sizeof(request));
+
+        fd.fd = server.sock;
+        fd.events = POLLIN;
+        EXPECT(poll(&fd, 1, 1000) == 1);
+        EXPECT(obelisk_ntp_serve(&server) == 0);
+
+        fd.fd = client;
+        fd.events = POLLIN;
+        EXPECT(poll(&fd, 1, 100) == 0);
+        EXPECT(recv(client, response, sizeof(response), MSG_DONTWAIT) < 0);
+
+        obelisk_ntp_statistics(&server, &statistics);
+        EXPECT(statistics.received == 1);
+        EXPECT(statistics.answered == 0);
+        EXPECT(statistics.ignored == 1);
+
+        EXPECT(close(client) == 0);
+        obelisk_ntp_fini(&server);
+
+        STATUS();
+    }
+
+    EXIT();
+}
@@ -0,0 +1,224 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ *
+ * Copyright 2018 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in README.h<BR>
+ * Chip Overclock (coverclock@diag.com)<BR>
+ * http://www.diag.com/navigation/downloads/Diminuto.html<BR>
+ */
+
+#include "com/diag/diminuto/diminuto_unittest.h"
+#include "com/diag/diminuto/diminuto_log.h"
+#include "com/diag/diminuto/diminuto_core.h"
+#include "com/diag/obelisk/obelisk_page.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+
+static const char NAME[] = "/unittest-page";
+
+static int64_t monotonic(void)
+{
+    struct timespec now;
+
+    (void)clock_gettime(CLOCK_MONOTONIC_RAW, &now);
+
+    return (now.tv_sec * 1000000000LL) + now.tv_nsec;
+}
+
+/*
+ * Publish states whose every field says the same thing as fast as
+ * possible, so a torn read would show up as a disagreement.
+ */
+
+static volatile int done = 0;
+
+static void * writer(void * arg)
+{
+    obelisk_page_t * pp = (obelisk_page_t *)arg;
+    obelisk_page_data_t data = { 0 };
+    int64_t ii = 0;
+
+    while (!done) {
+        ++ii;
+        data.edge = ii;
+        data.seconds = ii;
+        data.period = ii;
+        data.uncertainty = ii;
+        data.residual = ii;
+        data.pps = ii;
+        data.frame = ii;
+        data.lock = ii;
+        data.leap = ii;
+        data.dst = ii;
+        data.dut1 = ii;
+        obelisk_page_publish(pp, &data);
+    }
+
+    return (void *)0;
+}
+
+int main(int argc, char ** argv)
+{
+    SETLOGMASK();
+
+    diminuto_core_enable();
+
+    {
+        obelisk_page_t * pp;
+        const obelisk_page_t * rp;
+        obelisk_page_data_t data = { 0 };
+        obelisk_page_data_t copy;
+        struct timespec time;
+        int64_t now;
+
+        TEST();
+
+        (void)shm_unlink(NAME);
+
+        EXPECT(obelisk_page_map(NAME) == (const obelisk_page_t *)0);
+        EXPECT(errno == ENOENT);
+
+        pp = obelisk_page_create(NAME);
+        ASSERT(pp != (obelisk_page_t *)0);
+        EXPECT(pp->magic == OBELISK_PAGE_MAGIC);
+        EXPECT(pp->version == OBELISK_PAGE_VERSION);
+        EXPECT((pp->sequence & 1) == 0);
+
+        rp = obelisk_page_map(NAME);
+        ASSERT(rp != (const obelisk_page_t *)0);
+
+        /* Nothing known yet. */
+
+        EXPECT(obelisk_page_time(rp, &time, &copy) == OBELISK_PAGE_LOCK_NONE);
+        EXPECT(copy.uncertainty == -1);
+
+        /* Half a second after an edge, with a clock running 100ppm fast. */
+
+        now = monotonic();
+        data.edge = now - 500050000LL;
+        data.seconds = 1520139967;
+        data.period = 1000100000.0;
+        data.uncertainty = 1500;
+        data.residual = -212341;
+        data.pps = 1250;
+        data.frame = 0x123456789abcdefULL;
+        data.lock = OBELISK_PAGE_LOCK_ACQUIRED;
+        data.leap = 1;
+        data.dst = OBELISK_DST_ON;
+        data.dut1 = -3;
+        obelisk_page_publish(pp, &data);
+        EXPECT((pp->sequence & 1) == 0);
+
+        EXPECT(obelisk_page_time(rp, &time, &copy) == OBELISK_PAGE_LOCK_ACQUIRED);
+        EXPECT(time.tv_sec == 1520139967);
+        EXPECT(time.tv_nsec >= 500000000);
+        EXPECT(time.tv_nsec < 600000000);
+        EXPECT(memcmp(&copy, &data, sizeof(data)) == 0);
+
+        /* In holdover the second rolls over too. */
+
+        data.edge = now - 1250125000LL;
+        data.lock = OBELISK_PAGE_LOCK_HOLDOVER;
+        obelisk_page_publish(pp, &data);
+        EXPECT(obelisk_page_time(rp, &time, (obelisk_page_data_t *)0) == OBELISK_PAGE_LOCK_HOLDOVER);
+        EXPECT(time.tv_sec == 1520139968);
+        EXPECT(time.tv_nsec >= 250000000);
+        EXPECT(time.tv_nsec < 350000000);
+
+        /* The edge is on the same clock as wwvbtool's, not CLOCK_MONOTONIC. */
+
+        EXPECT(OBELISK_PAGE_CLOCK == CLOCK_MONOTONIC_RAW);
+        data.edge = monotonic();
+        data.period = 1000000000.0;
+        data.lock = OBELISK_PAGE_LOCK_ACQUIRED;
+        obelisk_page_publish(pp, &data);
+        EXPECT(obelisk_page_time(rp, &time, (obelisk_page_data_t *)0) == OBELISK_PAGE_LOCK_ACQUIRED);
+        EXPECT(time.tv_sec == 1520139967);
+        EXPECT(time.tv_nsec < 100000000);
+
+        /* A page nobody has updated lately knows nothing. */
+
+        data.period = 1000100000.0;
+
+        data.edge = now - (5 * 1000100000LL);
+        obelisk_page_publish(pp, &data);
+        EXPECT(obelisk_page_time(rp, &time, (obelisk_page_data_t *)0) == OBELISK_PAGE_LOCK_NONE);
+
+        EXPECT(obelisk_page_unmap(rp) == 0);
+        EXPECT(obelisk_page_destroy(pp, NAME) == 0);
+        EXPECT(obelisk_page_map(NAME) == (const obelisk_page_t *)0);
+
+        STATUS();
+    }
+
+    {
+        int fd;
+
+        TEST();
+
+        /* Something else by the same name. */
+
+        (void)shm_unlink(NAME);
+        fd = shm_open(NAME, O_RDWR | O_CREAT, 0600);
+        ASSERT(fd >= 0);
+        ASSERT(ftruncate(fd, sizeof(obelisk_page_t)) == 0);
+        EXPECT(close(fd) == 0);
+
+        EXPECT(obelisk_page_map(NAME) == (const obelisk_page_t *)0);
+        EXPECT(errno == EPROTO);
+
+        EXPECT(shm_unlink(NAME) == 0);
+
+        STATUS();
+    }
+
+    {
+        obelisk_page_t * pp;
+        const obelisk_page_t * rp;
+        obelisk_page_data_t data;
+        pthread_t thread;
+        int ii;
+        int torn = 0;
+        int64_t last = 0;
+
+        TEST();
+
+        (void)shm_unlink(NAME);
+        pp = obelisk_page_create(NAME);
+        ASSERT(pp != (obelisk_page_t *)0);
+        rp = obelisk_page_map(NAME);
+        ASSERT(rp != (const obelisk_page_t *)0);
+
+        memset(&data, 0, sizeof(data));
+        obelisk_page_publish(pp, &data);
+
+        done = 0;
+        ASSERT(pthread_create(&thread, (pthread_attr_t *)0, writer, pp) == 0);
+
+        for (ii = 0; ii < 1000000; ++ii) {
+            obelisk_page_snapshot(rp, &data);
+            if ((data.seconds != data.edge) || (data.period != data.edge) || (data.uncertainty != data.edge) || (data.residual != data.edge) || (data.pps != data.edge) || (data.frame != data.edge) || (data.lock != (int32_t)data.edge) || (data.dut1 != (int32_t)data.edge)) {
+                ++torn;
+            }
+            if (data.edge < last) {
+                ++torn;
+            }
+            last = data.edge;
+        }
+
+        done = !0;
+        EXPECT(pthread_join(thread, (void **)0) == 0);
+        CHECKPOINT("published=%lld\n", (long long int)last);
+        EXPECT(torn == 0);
+
+        EXPECT(obelisk_page_unmap(rp) == 0);
+        EXPECT(obelisk_page_destroy(pp, NAME) == 0);
+
+        STATUS();
+    }
+
+    EXIT();
+}
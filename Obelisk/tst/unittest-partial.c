@@ -0,0 +1,214 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ *
+ * Copyright 2018 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in README.h<BR>
+ * Chip Overclock (coverclock@diag.com)<BR>
+ * http://www.diag.com/navigation/downloads/Diminuto.html<BR>
+ */
+
+#include "com/diag/diminuto/diminuto_unittest.h"
+#include "com/diag/diminuto/diminuto_log.h"
+#include "com/diag/diminuto/diminuto_core.h"
+#include "com/diag/obelisk/obelisk.h"
+#include "obelisk.h"
+#include <stdio.h>
+#include <errno.h>
+
+#include "../inc/com/diag/obelisk/wwvbtool.h"
+
+/*
+ * Returns the groups completed while parsing the sentence, and leaves the
+ * most recent partial result in the caller's structure.
+ */
+static obelisk_group_t parse(obelisk_partial_t * partialp, const char * sentence, int * secondsp)
+{
+    obelisk_group_t groups = OBELISK_GROUP_NONE;
+    obelisk_group_t group = OBELISK_GROUP_NONE;
+    obelisk_event_t event = OBELISK_EVENT_INVALID;
+    obelisk_state_t state = OBELISK_STATE_START;
+    obelisk_token_t token;
+    obelisk_buffer_t buffer;
+    obelisk_frame_t frame;
+    int field;
+    int length;
+    const char * ss;
+
+    for (ss = sentence; *ss != '\0'; ++ss) {
+        switch (*ss) {
+        case 'M': token = OBELISK_TOKEN_MARKER; break;
+        case '0': token = OBELISK_TOKEN_ZERO;   break;
+        case '1': token = OBELISK_TOKEN_ONE;    break;
+        case '?': token = OBELISK_TOKEN_INVALID; break;
+        default:  token = OBELISK_TOKEN_ZERO;   break;
+        }
+        event = obelisk_parse(&state, token, &field, &length, &buffer, &frame);
+        group = obelisk_partial(partialp, state, field, length, buffer);
+        if (group != OBELISK_GROUP_NONE) {
+            secondsp[(group == OBELISK_GROUP_MINUTES) ? 0 : (group == OBELISK_GROUP_HOURS) ? 1 : (group == OBELISK_GROUP_DAY) ? 2 : 3] = partialp->second;
+        }
+        groups |= group;
+        fprintf(stderr, "partial %s %s %d 0x%x 0x%x\n", STATE[state], EVENT[event], partialp->second, partialp->complete, partialp->confident);
+    }
+
+    return groups;
+}
+
+int main(int argc, char ** argv)
+{
+    SETLOGMASK();
+
+    diminuto_core_enable();
+
+    {
+        obelisk_partial_t partial = { 0 };
+
+        TEST();
+
+        EXPECT(obelisk_partial(&partial, OBELISK_STATE_START, -1, -1, 0) == OBELISK_GROUP_NONE);
+        EXPECT(partial.second == -1);
+        EXPECT(partial.complete == OBELISK_GROUP_NONE);
+        EXPECT(partial.confident == OBELISK_GROUP_NONE);
+
+        EXPECT(obelisk_partial(&partial, OBELISK_STATE_WAIT, -1, -1, 0) == OBELISK_GROUP_NONE);
+        EXPECT(partial.second == -1);
+
+        EXPECT(obelisk_partial(&partial, OBELISK_STATE_SYNC, 0, 8, 0) == OBELISK_GROUP_NONE);
+        EXPECT(partial.second == 0);
+        EXPECT(partial.complete == OBELISK_GROUP_NONE);
+
+        EXPECT(obelisk_partial(&partial, OBELISK_STATE_MARK, 0, 0, 0) == OBELISK_GROUP_NONE);
+        EXPECT(partial.second == 8);
+
+        EXPECT(obelisk_partial(&partial, OBELISK_STATE_DATA, 1, 9, 0) == OBELISK_GROUP_MINUTES);
+        EXPECT(partial.second == 9);
+
+        EXPECT(obelisk_partial(&partial, OBELISK_STATE_END, 5, 0, 0) == OBELISK_GROUP_NONE);
+        EXPECT(partial.second == 58);
+
+        EXPECT(obelisk_partial(&partial, OBELISK_STATE_BEGIN, 5, 0, 0) == OBELISK_GROUP_NONE);
+        EXPECT(partial.second == 59);
+        EXPECT(partial.complete == OBELISK_GROUP_ALL);
+
+        STATUS();
+    }
+
+    {
+        obelisk_partial_t partial = { 0 };
+        int seconds[4] = { -1, -1, -1, -1 };
+
+        TEST();
+
+        EXPECT(parse(&partial, "0MM01100000M", seconds) == OBELISK_GROUP_MINUTES);
+        EXPECT(seconds[0] == 9);
+        EXPECT(partial.complete == OBELISK_GROUP_MINUTES);
+        EXPECT(partial.confident == OBELISK_GROUP_MINUTES);
+        EXPECT(partial.minutes == 30);
+
+        STATUS();
+    }
+
+    {
+        obelisk_partial_t partial = { 0 };
+        int seconds[4] = { -1, -1, -1, -1 };
+
+        TEST();
+
+        EXPECT(parse(&partial, "0MM01100000M000000111M00000011", seconds) == (OBELISK_GROUP_MINUTES | OBELISK_GROUP_HOURS));
+        EXPECT(seconds[0] == 9);
+        EXPECT(seconds[1] == 19);
+        EXPECT(partial.second == 27);
+        EXPECT(partial.complete == (OBELISK_GROUP_MINUTES | OBELISK_GROUP_HOURS));
+        EXPECT(partial.confident == (OBELISK_GROUP_MINUTES | OBELISK_GROUP_HOURS));
+        EXPECT(partial.minutes == 30);
+        EXPECT(partial.hours == 7);
+
+        STATUS();
+    }
+
+    {
+        obelisk_partial_t partial = { 0 };
+        int seconds[4] = { -1, -1, -1, -1 };
+
+        TEST();
+
+        EXPECT(parse(&partial, "0MM01100000M000000111M000000110M01100", seconds) == (OBELISK_GROUP_MINUTES | OBELISK_GROUP_HOURS | OBELISK_GROUP_DAY));
+        EXPECT(seconds[2] == 34);
+        EXPECT(partial.second == 34);
+        EXPECT(partial.confident == (OBELISK_GROUP_MINUTES | OBELISK_GROUP_HOURS | OBELISK_GROUP_DAY));
+        EXPECT(partial.minutes == 30);
+        EXPECT(partial.hours == 7);
+        EXPECT(partial.day == 66);
+
+        STATUS();
+    }
+
+    {
+        obelisk_partial_t partial = { 0 };
+        int seconds[4] = { -1, -1, -1, -1 };
+
+        TEST();
+
+        EXPECT(parse(&partial, "0MM01100000M000000111M000000110M011000010M001100000M100001000M", seconds) == OBELISK_GROUP_ALL);
+        EXPECT(seconds[0] == 9);
+        EXPECT(seconds[1] == 19);
+        EXPECT(seconds[2] == 34);
+        EXPECT(seconds[3] == 54);
+        EXPECT(partial.second == 59);
+        EXPECT(partial.complete == OBELISK_GROUP_ALL);
+        EXPECT(partial.confident == OBELISK_GROUP_ALL);
+        EXPECT(partial.minutes == 30);
+        EXPECT(partial.hours == 7);
+        EXPECT(partial.day == 66);
+        EXPECT(partial.year == 8);
+
+        STATUS();
+    }
+
+    {
+        obelisk_partial_t partial = { 0 };
+        int seconds[4] = { -1, -1, -1, -1 };
+
+        TEST();
+
+        /* Minutes1 of 0xf is out of range; unused :10 is set. */
+
+        EXPECT(parse(&partial, "0MM01101111M100000111M", seconds) == (OBELISK_GROUP_MINUTES | OBELISK_GROUP_HOURS));
+        EXPECT(partial.complete == (OBELISK_GROUP_MINUTES | OBELISK_GROUP_HOURS));
+        EXPECT(partial.confident == OBELISK_GROUP_NONE);
+
+        STATUS();
+    }
+
+    {
+        obelisk_partial_t partial = { 0 };
+        int seconds[4] = { -1, -1, -1, -1 };
+
+        TEST();
+
+        /* Unused :34 is set. */
+
+        EXPECT(parse(&partial, "0MM01100000M000000111M000000110M01101", seconds) == (OBELISK_GROUP_MINUTES | OBELISK_GROUP_HOURS | OBELISK_GROUP_DAY));
+        EXPECT(partial.confident == (OBELISK_GROUP_MINUTES | OBELISK_GROUP_HOURS));
+
+        STATUS();
+    }
+
+    {
+        obelisk_partial_t partial = { 0 };
+        int seconds[4] = { -1, -1, -1, -1 };
+
+        TEST();
+
+        /* A leap second MARKER delays the frame by a second. */
+
+        EXPECT(parse(&partial, "0MMM01100000M", seconds) == OBELISK_GROUP_MINUTES);
+        EXPECT(seconds[0] == 9);
+        EXPECT(partial.minutes == 30);
+
+        STATUS();
+    }
+
+    EXIT();
+}
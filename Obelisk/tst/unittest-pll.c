@@ -0,0 +1,182 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ *
+ * Copyright 2018 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in README.h<BR>
+ * Chip Overclock (coverclock@diag.com)<BR>
+ * http://www.diag.com/navigation/downloads/Diminuto.html<BR>
+ */
+
+#include "com/diag/diminuto/diminuto_unittest.h"
+#include "com/diag/diminuto/diminuto_log.h"
+#include "com/diag/diminuto/diminuto_core.h"
+#include "com/diag/obelisk/obelisk_pll.h"
+#include <stdio.h>
+#include <errno.h>
+#include <math.h>
+
+/*
+ * The local clock runs 50ppm fast, and the first edge arrives at an
+ * arbitrary time on it.
+ */
+static const double PERIOD = 1000050000.0;
+static const int64_t ORIGIN = 123456789012LL;
+
+/*
+ * Each edge is measured late by up to the 10ms period of the sampling
+ * timer, uniformly distributed.
+ */
+static const int64_t SAMPLING = 10000000;
+
+static int64_t truth(int second)
+{
+    return ORIGIN + llround(second * PERIOD);
+}
+
+static int64_t measure(int second, unsigned int * seedp)
+{
+    *seedp = (*seedp * 1103515245) + 12345;
+    return truth(second) + (int64_t)(((*seedp >> 8) & 0xffff) * (double)SAMPLING / 65536.0);
+}
+
+int main(int argc, char ** argv)
+{
+    SETLOGMASK();
+
+    diminuto_core_enable();
+
+    {
+        obelisk_pll_t pll;
+        unsigned int seed = 1;
+        int64_t edge;
+        double raw = 0.0;
+        double smoothed = 0.0;
+        double bias = 0.0;
+        int samples = 0;
+
+        TEST();
+
+        /*
+         * Once locked, the estimated edges should be steadier than the
+         * measured ones by an order of magnitude.
+         */
+
+        obelisk_pll_init(&pll, 64);
+
+        for (int second = 0; second < 1200; ++second) {
+            edge = measure(second, &seed);
+            EXPECT(obelisk_pll_update(&pll, edge) == 0);
+            EXPECT(obelisk_pll_locked(&pll) == (second >= (64 - 1)));
+            if (second < 600) {
+                continue;
+            }
+            bias += (double)(pll.phase - truth(second));
+            ++samples;
+        }
+
+        bias /= samples;
+
+        seed = 1;
+        obelisk_pll_init(&pll, 64);
+
+        for (int second = 0; second < 1200; ++second) {
+            edge = measure(second, &seed);
+            (void)obelisk_pll_update(&pll, edge);
+            if (second < 600) {
+                continue;
+            }
+            raw += pow((double)(edge - truth(second)) - (SAMPLING / 2.0), 2.0);
+            smoothed += pow((double)(pll.phase - truth(second)) - bias, 2.0);
+        }
+
+        raw = sqrt(raw / samples);
+        smoothed = sqrt(smoothed / samples);
+
+        CHECKPOINT("period=%.1fns bias=%.0fns raw=%.0fns smoothed=%.0fns jitter=%.0fns\n", pll.period, bias, raw, smoothed, pll.jitter);
+        EXPECT(fabs(pll.period - PERIOD) < 5000.0);
+        EXPECT(fabs(bias - (SAMPLING / 2.0)) < 1000000.0);
+        EXPECT((smoothed * 10.0) < raw);
+
+        STATUS();
+    }
+
+    {
+        obelisk_pll_t pll;
+        unsigned int seed = 1;
+        int64_t edge;
+        int64_t before;
+
+        TEST();
+
+        obelisk_pll_init(&pll, OBELISK_PLL_CONSTANT);
+
+        for (int second = 0; second < 120; ++second) {
+            (void)obelisk_pll_update(&pll, measure(second, &seed));
+        }
+        EXPECT(obelisk_pll_locked(&pll));
+
+        /* Missing edges are bridged. */
+
+        EXPECT(obelisk_pll_update(&pll, measure(125, &seed)) == 0);
+
+        /* Glitches and edges far from the expected ones are rejected. */
+
+        before = pll.phase;
+        EXPECT(obelisk_pll_update(&pll, measure(125, &seed) + 300000000) == 1);
+        EXPECT(obelisk_pll_update(&pll, measure(126, &seed) + 150000000) == 2);
+        EXPECT(obelisk_pll_update(&pll, measure(127, &seed) - 60000000) == 3);
+        EXPECT(pll.phase == before);
+        EXPECT(obelisk_pll_update(&pll, measure(128, &seed)) == 0);
+        EXPECT(pll.rejected == 0);
+
+        /* The estimate continues between edges. */
+
+        edge = obelisk_pll_edge(&pll, truth(130) + 500000000);
+        CHECKPOINT("edge=%lldns truth=%lldns\n", (long long)edge, (long long)truth(130));
+        EXPECT(llabs(edge - truth(130)) < SAMPLING);
+        EXPECT(obelisk_pll_edge(&pll, pll.phase) == pll.phase);
+
+        /* The estimate gets worse the longer it goes without edges. */
+
+        EXPECT(obelisk_pll_uncertainty(&pll, pll.phase) == llround(pll.jitter));
+        EXPECT(llabs(obelisk_pll_uncertainty(&pll, pll.phase + llround(600 * pll.period)) - (llround(pll.jitter) + (600 * OBELISK_PLL_STABILITY))) <= 1);
+
+        STATUS();
+    }
+
+    {
+        obelisk_pll_t pll;
+        unsigned int seed = 1;
+        int rc;
+        int restarted = -1;
+
+        TEST();
+
+        /*
+         * If the edges move for good, the loop starts over and locks again.
+         */
+
+        obelisk_pll_init(&pll, OBELISK_PLL_CONSTANT);
+
+        for (int second = 0; second < 120; ++second) {
+            (void)obelisk_pll_update(&pll, measure(second, &seed));
+        }
+
+        for (int second = 120; second < 240; ++second) {
+            rc = obelisk_pll_update(&pll, measure(second, &seed) + 400000000);
+            if (rc < 0) {
+                EXPECT(restarted < 0);
+                restarted = second;
+            }
+        }
+
+        EXPECT(restarted == (120 + OBELISK_PLL_RESTART - 1));
+        EXPECT(obelisk_pll_locked(&pll));
+        EXPECT(llabs(obelisk_pll_edge(&pll, truth(240) + 400000000 + SAMPLING) - (truth(240) + 400000000)) < SAMPLING);
+
+        STATUS();
+    }
+
+    EXIT();
+}
@@ -0,0 +1,295 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ *
+ * Copyright 2018 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in README.h<BR>
+ * Chip Overclock (coverclock@diag.com)<BR>
+ * http://www.diag.com/navigation/downloads/Diminuto.html<BR>
+ */
+
+#include "com/diag/diminuto/diminuto_unittest.h"
+#include "com/diag/diminuto/diminuto_log.h"
+#include "com/diag/diminuto/diminuto_core.h"
+#include "com/diag/obelisk/obelisk.h"
+#include "com/diag/obelisk/obelisk_pm.h"
+#include "obelisk.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <math.h>
+
+/*
+ * 2000-01-01T00:00:00Z
+ */
+static const time_t CENTURY = 946684800;
+
+static time_t decode(obelisk_buffer_t buffer, int * correctedp, obelisk_frame_t * framep)
+{
+    struct tm time;
+    time_t epoch = -1;
+
+    *correctedp = obelisk_pm_decode(framep, buffer);
+    if (*correctedp < 0) {
+        /* Do nothing. */
+    } else if (obelisk_validate(framep) < 0) {
+        /* Do nothing. */
+    } else if (obelisk_decode(&time, framep) < 0) {
+        /* Do nothing. */
+    } else if (obelisk_revalidate(&time) < 0) {
+        /* Do nothing. */
+    } else {
+        epoch = timegm(&time);
+    }
+
+    return epoch;
+}
+
+/*
+ * Convert the bits of a frame, in the order they are received, to a buffer.
+ */
+static obelisk_buffer_t parse(const char * bits)
+{
+    obelisk_buffer_t buffer = 0;
+
+    for (int second = 0; bits[second] != '\0'; ++second) {
+        if (bits[second] == '1') {
+            buffer |= OBELISK_BIT(second);
+        }
+    }
+
+    return buffer;
+}
+
+/*
+ * A cheap deterministic noise source uniform in [-1.0 .. +1.0].
+ */
+static double noise(unsigned int * seedp)
+{
+    *seedp = (*seedp * 1103515245) + 12345;
+    return ((double)((*seedp >> 8) & 0xffff) / 32767.5) - 1.0;
+}
+
+int main(int argc, char ** argv)
+{
+    SETLOGMASK();
+
+    diminuto_core_enable();
+
+    {
+        /*
+         * obelisk_decode() places two digit years before 17 in the next
+         * century, so these are all from 2017 on.
+         */
+        static const int32_t MINUTES[] = {
+            8942400,    /* 2017-01-01T00:00 */
+            8942401,    /* 2017-01-01T00:01 */
+            9467999,    /* 2017-12-31T23:59 */
+            9468000,    /* 2018-01-01T00:00 */
+            9489394,    /* 2018-01-15T20:34 */
+            10605599,   /* 2020-02-29T23:59 */
+            11046239,   /* 2020-12-31T23:59 */
+            11046240,   /* 2021-01-01T00:00 */
+            52595999,   /* 2099-12-31T23:59 */
+        };
+        obelisk_frame_t frame;
+        obelisk_buffer_t buffer;
+        int corrected;
+
+        TEST();
+
+        for (int ii = 0; ii < (sizeof(MINUTES) / sizeof(MINUTES[0])); ++ii) {
+            buffer = obelisk_pm_encode(MINUTES[ii], OBELISK_DST_OFF, 0);
+            EXPECT(decode(buffer, &corrected, &frame) == (CENTURY + ((time_t)MINUTES[ii] * 60)));
+            EXPECT(corrected == 0);
+        }
+
+        STATUS();
+    }
+
+    {
+        /*
+         * Known answers worked out by hand from the field and Hamming parity
+         * tables of the NIST Enhanced WWVB Broadcast Format, independently
+         * of obelisk_pm_encode(): sync_T, time_par[4:0], time[25], time[0],
+         * time[24:16], reserved, time[15:7], reserved, time[6:1]. Only
+         * seconds :00 through :45 are compared.
+         */
+        static const struct {
+            int32_t minutes;
+            const char * bits;
+        } KNOWN[] = {
+            { 9489394,  /* 2018-01-15T20:34 */
+              "0011101101000" "00111" "0" "0" "010010000" "0" "110010111" "0" "111001" },
+            { 52595999, /* 2099-12-31T23:59 */
+              "0011101101000" "00011" "1" "1" "100100010" "0" "100011010" "0" "001111" },
+        };
+        static const obelisk_buffer_t MASK = ~(((obelisk_buffer_t)1 << (60 - 46)) - 1) & ((((obelisk_buffer_t)1) << 60) - 1);
+        obelisk_frame_t decoded;
+        obelisk_buffer_t known;
+        obelisk_buffer_t buffer;
+        int corrected;
+
+        TEST();
+
+        for (int ii = 0; ii < (sizeof(KNOWN) / sizeof(KNOWN[0])); ++ii) {
+            ASSERT(strlen(KNOWN[ii].bits) == 46);
+            known = parse(KNOWN[ii].bits);
+            buffer = obelisk_pm_encode(KNOWN[ii].minutes, OBELISK_DST_OFF, 0);
+            CHECKPOINT("known=0x%016llx encoded=0x%016llx\n", (long long unsigned)known, (long long unsigned)(buffer & MASK));
+            EXPECT((buffer & MASK) == known);
+            /* The DST and leap second code, which isn't compared, is kept. */
+            buffer = known | (buffer & ~MASK);
+            EXPECT(decode(buffer, &corrected, &decoded) == (CENTURY + ((time_t)KNOWN[ii].minutes * 60)));
+            EXPECT(corrected == 0);
+        }
+
+        STATUS();
+    }
+
+    {
+        obelisk_frame_t frame;
+        obelisk_buffer_t buffer;
+        int corrected;
+
+        TEST();
+
+        for (obelisk_dst_t dst = OBELISK_DST_OFF; dst <= OBELISK_DST_ON; ++dst) {
+            for (int lsw = 0; lsw <= 1; ++lsw) {
+                buffer = obelisk_pm_encode(9489394, dst, lsw);
+                EXPECT(decode(buffer, &corrected, &frame) == (CENTURY + (9489394 * 60)));
+                EXPECT(frame.dst == dst);
+                EXPECT(frame.lsw == lsw);
+                EXPECT(frame.dut1sign == OBELISK_SIGN_POSITIVE);
+                EXPECT(frame.dut1magnitude == 0);
+            }
+        }
+
+        STATUS();
+    }
+
+    {
+        obelisk_frame_t frame;
+        obelisk_buffer_t buffer;
+        int corrected;
+
+        TEST();
+
+        /* Any single bit error in the time or its parity is corrected. */
+
+        for (int second = 13; second <= 45; ++second) {
+            if ((second == 29) || (second == 39)) {
+                continue;
+            }
+            buffer = obelisk_pm_encode(9489394, OBELISK_DST_ON, 0) ^ OBELISK_BIT(second);
+            EXPECT(decode(buffer, &corrected, &frame) == (CENTURY + (9489394 * 60)));
+            EXPECT(corrected == 1);
+        }
+
+        /* Any single bit error in the DST and leap second code is detected. */
+
+        for (int second = 46; second <= 52; ++second) {
+            if ((second == 48) || (second == 49)) {
+                continue;
+            }
+            buffer = obelisk_pm_encode(9489394, OBELISK_DST_ON, 0) ^ OBELISK_BIT(second);
+            EXPECT(obelisk_pm_decode(&frame, buffer) < 0);
+        }
+
+        STATUS();
+    }
+
+    {
+        static const int RATE = 100;
+        static const double FREQUENCY = 0.002;  /* Residual carrier offset. */
+        static const double PHASE = 1.0;        /* Initial carrier phase. */
+        static const double NOISE = 0.5;        /* Peak noise per component. */
+        static const int32_t FIRST = 9489394;
+        obelisk_pm_t pm;
+        obelisk_event_t event;
+        obelisk_buffer_t buffer;
+        obelisk_buffer_t frames[5];
+        obelisk_frame_t frame;
+        unsigned int seed = 1;
+        double theta;
+        double amplitude;
+        double ii;
+        double qq;
+        int corrected;
+        int minute;
+        int second;
+        int sample;
+        int ending;
+        int offset;
+        int received = 0;
+        int errors = 0;
+        time_t epoch;
+
+        TEST();
+
+        for (int mm = 0; mm < (sizeof(frames) / sizeof(frames[0])); ++mm) {
+            frames[mm] = obelisk_pm_encode(FIRST + mm, OBELISK_DST_BEGINS, 0);
+        }
+
+        /*
+         * One phase reversal in the third minute is received in error.
+         */
+
+        frames[2] ^= OBELISK_BIT(31);
+
+        obelisk_pm_init(&pm, RATE);
+
+        /*
+         * Start receiving 23.37 seconds into the first minute. The carrier
+         * drops by 17dB for the first 200ms of every second as it does for
+         * the AM time code, the phase drifts, and there is a lot of noise.
+         */
+
+        for (int tt = 2337; tt < (RATE * 60 * 5); ++tt) {
+            minute = tt / (RATE * 60);
+            second = (tt / RATE) % 60;
+            sample = tt % RATE;
+            theta = PHASE + (2.0 * M_PI * FREQUENCY * tt / RATE);
+            if ((frames[minute] & OBELISK_BIT(second)) != 0) {
+                theta += M_PI;
+            }
+            amplitude = (sample < (RATE / 5)) ? 0.141 : 1.0;
+            ii = (amplitude * cos(theta)) + (NOISE * noise(&seed));
+            qq = (amplitude * sin(theta)) + (NOISE * noise(&seed));
+            event = obelisk_pm_sample(&pm, ii, qq, &buffer);
+            if (event != OBELISK_EVENT_FRAME) {
+                continue;
+            }
+            /*
+             * The symbol timing is only as good as one tenth of a second,
+             * so the frame may be recognized slightly before or after the
+             * minute it contains actually ends.
+             */
+            ending = ((tt + 1 + (RATE * 30)) / (RATE * 60)) - 1;
+            offset = ((tt + 1 + (RATE * 30)) % (RATE * 60)) - (RATE * 30);
+            epoch = decode(buffer, &corrected, &frame);
+            CHECKPOINT("tt=%d minute=%d second=%d sample=%d ending=%d offset=%d phase=%d polarity=%d buffer=0x%016llx epoch=%ld corrected=%d\n", tt, minute, second, sample, ending, offset, pm.phase, pm.polarity, (long long unsigned)buffer, (long)epoch, corrected);
+            if (epoch != (CENTURY + ((FIRST + ending) * 60))) {
+                ++errors;
+                continue;
+            }
+            EXPECT((-(RATE / OBELISK_PM_PHASES) <= offset) && (offset <= (RATE / OBELISK_PM_PHASES)));
+            EXPECT(frame.dst == OBELISK_DST_BEGINS);
+            EXPECT(corrected == ((ending == 2) ? 1 : 0));
+            ++received;
+        }
+
+        /*
+         * The first partial minute can't be decoded, and the last minute
+         * may end a little after the input does.
+         */
+
+        EXPECT((received == 3) || (received == 4));
+        EXPECT(errors == 0);
+
+        STATUS();
+    }
+
+    EXIT();
+}
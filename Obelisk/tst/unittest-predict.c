@@ -0,0 +1,109 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ *
+ * Copyright 2018 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in README.h<BR>
+ * Chip Overclock (coverclock@diag.com)<BR>
+ * http://www.diag.com/navigation/downloads/Diminuto.html<BR>
+ */
+
+#include "com/diag/diminuto/diminuto_unittest.h"
+#include "com/diag/diminuto/diminuto_log.h"
+#include "com/diag/diminuto/diminuto_core.h"
+#include "com/diag/obelisk/obelisk.h"
+#include "obelisk.h"
+#include <stdio.h>
+#include <errno.h>
+
+#define PREDICT(_Y0_, _D0_, _H0_, _M0_, _L0_, _W0_, _S0_, _Y1_, _D1_, _H1_, _M1_, _L1_, _W1_, _S1_) \
+    do { \
+        obelisk_buffer_t before = obelisk_compose(_Y0_, _D0_, _H0_, _M0_, 2, _L0_, _W0_, _S0_); \
+        obelisk_buffer_t after = obelisk_predict(before); \
+        obelisk_buffer_t expected = obelisk_compose(_Y1_, _D1_, _H1_, _M1_, 2, _L1_, _W1_, _S1_); \
+        if (after != expected) { CHECKPOINT("0x%016llx 0x%016llx 0x%016llx\n", (long long unsigned)before, (long long unsigned)after, (long long unsigned)expected); } \
+        EXPECT(after == expected); \
+    } while (0)
+
+int main(int argc, char ** argv)
+{
+    SETLOGMASK();
+
+    diminuto_core_enable();
+
+    {
+        TEST();
+
+        PREDICT(18,  66,  7, 30, 0, 0, OBELISK_DST_OFF,     18,  66,  7, 31, 0, 0, OBELISK_DST_OFF);
+        PREDICT(18,  66,  7, 59, 0, 0, OBELISK_DST_OFF,     18,  66,  8,  0, 0, 0, OBELISK_DST_OFF);
+        PREDICT(18,  66, 23, 59, 0, 0, OBELISK_DST_OFF,     18,  67,  0,  0, 0, 0, OBELISK_DST_OFF);
+        PREDICT(18, 365, 23, 59, 0, 0, OBELISK_DST_OFF,     19,   1,  0,  0, 0, 0, OBELISK_DST_OFF);
+        PREDICT(19, 365, 23, 59, 0, 0, OBELISK_DST_OFF,     20,   1,  0,  0, 1, 0, OBELISK_DST_OFF);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        /* DST changes only at the end of the UTC day. */
+
+        PREDICT(18,  70, 12,  0, 0, 0, OBELISK_DST_BEGINS,  18,  70, 12,  1, 0, 0, OBELISK_DST_BEGINS);
+        PREDICT(18,  70, 23, 59, 0, 0, OBELISK_DST_BEGINS,  18,  71,  0,  0, 0, 0, OBELISK_DST_ON);
+        PREDICT(18,  71, 23, 59, 0, 0, OBELISK_DST_ON,      18,  72,  0,  0, 0, 0, OBELISK_DST_ON);
+        PREDICT(18, 308, 12,  0, 0, 0, OBELISK_DST_ENDS,    18, 308, 12,  1, 0, 0, OBELISK_DST_ENDS);
+        PREDICT(18, 308, 23, 59, 0, 0, OBELISK_DST_ENDS,    18, 309,  0,  0, 0, 0, OBELISK_DST_OFF);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        /* The leap second warning lasts until the end of the month. */
+
+        PREDICT(16, 182, 23, 59, 1, 1, OBELISK_DST_ON,      16, 183,  0,  0, 1, 0, OBELISK_DST_ON);
+        PREDICT(16, 181, 23, 59, 1, 1, OBELISK_DST_ON,      16, 182,  0,  0, 1, 1, OBELISK_DST_ON);
+        PREDICT(16, 182, 12, 59, 1, 1, OBELISK_DST_ON,      16, 182, 13,  0, 1, 1, OBELISK_DST_ON);
+        PREDICT(16, 183, 23, 59, 1, 1, OBELISK_DST_ON,      16, 184,  0,  0, 1, 1, OBELISK_DST_ON);
+        PREDICT(16, 366, 23, 59, 1, 1, OBELISK_DST_OFF,     17,   1,  0,  0, 0, 0, OBELISK_DST_OFF);
+        PREDICT(17, 181, 23, 59, 0, 1, OBELISK_DST_ON,      17, 182,  0,  0, 0, 0, OBELISK_DST_ON);
+
+        STATUS();
+    }
+
+    {
+        obelisk_buffer_t expected;
+        obelisk_buffer_t buffer;
+        int second;
+
+        TEST();
+
+        expected = obelisk_compose(18, 66, 7, 31, 2, 0, 0, OBELISK_DST_OFF);
+
+        /*
+         * Simulate obelisk_parse() shifting in each bit as it arrives, with
+         * the :00 MARKER never in the buffer.
+         */
+
+        buffer = 0;
+        for (second = 1; second <= 59; ++second) {
+            buffer = (buffer << 1) | ((expected & OBELISK_BIT(second)) ? 1 : 0);
+            EXPECT(obelisk_mismatch(expected, buffer, second) == 0);
+        }
+        EXPECT(buffer == expected);
+
+        buffer = 0;
+        for (second = 1; second <= 59; ++second) {
+            buffer = (buffer << 1) | ((expected & OBELISK_BIT(second)) ? 1 : 0);
+            if ((second == 8) || (second == 25) || (second == 40)) {
+                buffer ^= 1;
+            }
+            EXPECT(obelisk_mismatch(expected, buffer, second) == ((second < 8) ? 0 : (second < 25) ? 1 : (second < 40) ? 2 : 3));
+        }
+
+        STATUS();
+    }
+
+    EXIT();
+}
@@ -13,6 +13,7 @@
 #include "com/diag/diminuto/diminuto_core.h"
 #include "com/diag/obelisk/obelisk.h"
 #include "obelisk.h"
+#include "obelisk_calendar.h"
 #include <stdio.h>
 #include <errno.h>
 
@@ -41,7 +42,7 @@ int main(int argc, char ** argv)
 
         time.tm_wday = 5; /* 2016-01-01 */
         for (int year = 2016; year <= 2017; ++year) {
-            leap = (((year % 4) == 0) && ((year % 400) != 0));
+            leap = OBELISK_CALENDAR_LEAP(OBELISK_CALENDAR_YEAR(year % 100));
             time.tm_year = year - 1900;
             time.tm_yday = 0;
             for (int month = 1; month <= 12; ++month) {
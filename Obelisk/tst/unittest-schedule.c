@@ -0,0 +1,109 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ *
+ * Copyright 2018 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in README.h<BR>
+ * Chip Overclock (coverclock@diag.com)<BR>
+ * http://www.diag.com/navigation/downloads/Diminuto.html<BR>
+ */
+
+#include "com/diag/diminuto/diminuto_unittest.h"
+#include "com/diag/diminuto/diminuto_log.h"
+#include "com/diag/diminuto/diminuto_core.h"
+#include "com/diag/obelisk/obelisk_schedule.h"
+#include <stdio.h>
+#include <errno.h>
+#include <time.h>
+#include <math.h>
+
+static int64_t monotonic(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC_RAW, &now);
+
+    return ((int64_t)now.tv_sec * 1000000000LL) + now.tv_nsec;
+}
+
+int main(int argc, char ** argv)
+{
+    SETLOGMASK();
+
+    diminuto_core_enable();
+
+    {
+        obelisk_schedule_t schedule;
+
+        TEST();
+
+        obelisk_schedule_init(&schedule);
+        EXPECT(schedule.compensation == 0);
+        EXPECT(schedule.count == 0);
+        EXPECT(obelisk_schedule_mean(&schedule) == 0.0);
+        EXPECT(obelisk_schedule_rms(&schedule) == 0.0);
+
+        /* Landing late teaches the schedule to wake earlier. */
+
+        obelisk_schedule_land(&schedule, 1000000000LL, 1000080000LL);
+        EXPECT(schedule.compensation == (80000 / OBELISK_SCHEDULE_GAIN));
+        EXPECT(schedule.minimum == 80000);
+        EXPECT(schedule.maximum == 80000);
+
+        obelisk_schedule_land(&schedule, 2000000000LL, 1999960000LL);
+        EXPECT(schedule.compensation == ((80000 - 40000) / OBELISK_SCHEDULE_GAIN));
+        EXPECT(schedule.minimum == -40000);
+        EXPECT(schedule.maximum == 80000);
+        EXPECT(schedule.count == 2);
+        EXPECT(obelisk_schedule_mean(&schedule) == 20000.0);
+        EXPECT(fabs(obelisk_schedule_rms(&schedule) - 63245.553) < 1.0);
+
+        /* But not too early, nor later than on time. */
+
+        obelisk_schedule_land(&schedule, 3000000000LL, 4000000000LL);
+        EXPECT(schedule.compensation == OBELISK_SCHEDULE_LIMIT);
+        obelisk_schedule_land(&schedule, 4000000000LL, 3000000000LL);
+        EXPECT(schedule.compensation == 0);
+
+        STATUS();
+    }
+
+    {
+        obelisk_schedule_t schedule;
+        int64_t now;
+        int64_t moment;
+        int64_t actual;
+        int ii;
+
+        TEST();
+
+        /*
+         * Waits end no earlier than asked for. How much later depends on
+         * the system running the tests, so that is only reported.
+         */
+
+        obelisk_schedule_init(&schedule);
+
+        for (ii = 0; ii < 20; ++ii) {
+            now = monotonic();
+            moment = now + 10000000;
+            EXPECT(obelisk_schedule_wait(&schedule, moment, now) == 0);
+            actual = monotonic();
+            EXPECT(actual >= (moment - schedule.compensation - 100000));
+            obelisk_schedule_land(&schedule, moment, actual);
+        }
+
+        CHECKPOINT("compensation=%lldns mean=%.0fns rms=%.0fns minimum=%lldns maximum=%lldns\n", (long long)schedule.compensation, obelisk_schedule_mean(&schedule), obelisk_schedule_rms(&schedule), (long long)schedule.minimum, (long long)schedule.maximum);
+        EXPECT(schedule.count == 20);
+
+        /* A moment already past doesn't wait. */
+
+        now = monotonic();
+        EXPECT(obelisk_schedule_wait(&schedule, now - 1000000000LL, now) == 0);
+        EXPECT((monotonic() - now) < 500000000LL);
+
+        STATUS();
+    }
+
+    EXIT();
+}
@@ -0,0 +1,110 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ *
+ * Copyright 2018 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in README.h<BR>
+ * Chip Overclock (coverclock@diag.com)<BR>
+ * http://www.diag.com/navigation/downloads/Diminuto.html<BR>
+ */
+
+#include "com/diag/diminuto/diminuto_unittest.h"
+#include "com/diag/diminuto/diminuto_log.h"
+#include "com/diag/diminuto/diminuto_core.h"
+#include "com/diag/obelisk/obelisk_shm.h"
+#include <stdio.h>
+#include <errno.h>
+#include <stddef.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+
+/*
+ * A unit well away from the ones ntpd and gpsd use, so that the test
+ * doesn't disturb the time on the system running it.
+ */
+static const int UNIT = 200;
+
+int main(int argc, char ** argv)
+{
+    SETLOGMASK();
+
+    diminuto_core_enable();
+
+    {
+        TEST();
+
+        /* The layout is that of struct shmTime in ntpd. */
+
+        EXPECT(offsetof(obelisk_shm_t, count) == sizeof(int));
+        EXPECT(offsetof(obelisk_shm_t, valid) == (offsetof(obelisk_shm_t, nsamples) + sizeof(int)));
+        EXPECT(offsetof(obelisk_shm_t, clockTimeStampNSec) == (offsetof(obelisk_shm_t, valid) + sizeof(int)));
+        EXPECT(offsetof(obelisk_shm_t, dummy) == (offsetof(obelisk_shm_t, receiveTimeStampNSec) + sizeof(unsigned)));
+
+        EXPECT(obelisk_shm_precision(1000000000LL) == 0);
+        EXPECT(obelisk_shm_precision(10000000LL) == -6);
+        EXPECT(obelisk_shm_precision(1000LL) == -19);
+        EXPECT(obelisk_shm_precision(0) == -30);
+
+        STATUS();
+    }
+
+    {
+        obelisk_shm_t * shmp;
+        obelisk_shm_t * readerp;
+        struct timespec clock;
+        struct timespec receive;
+        struct timespec clock2;
+        struct timespec receive2;
+        obelisk_shm_leap_t leap;
+        int id;
+        int count;
+
+        TEST();
+
+        shmp = obelisk_shm_attach(UNIT);
+        ASSERT(shmp != (obelisk_shm_t *)0);
+        EXPECT(shmp->mode == OBELISK_SHM_MODE);
+        EXPECT(!shmp->valid);
+
+        /* The reader (ntpd) has its own mapping of the segment. */
+
+        readerp = obelisk_shm_attach(UNIT);
+        ASSERT(readerp != (obelisk_shm_t *)0);
+        EXPECT(obelisk_shm_fetch(readerp, &clock2, &receive2, &leap) > 0);
+
+        clock.tv_sec = 1514764800;
+        clock.tv_nsec = 0;
+        receive.tv_sec = 1514764800;
+        receive.tv_nsec = 5123456;
+        count = shmp->count;
+        obelisk_shm_post(shmp, &clock, &receive, OBELISK_SHM_LEAP_ADDSECOND, -6);
+        EXPECT(shmp->count == (count + 2));
+        EXPECT(readerp->valid);
+        EXPECT(readerp->clockTimeStampSec == 1514764800);
+        EXPECT(readerp->clockTimeStampUSec == 0);
+        EXPECT(readerp->receiveTimeStampUSec == 5123);
+        EXPECT(readerp->receiveTimeStampNSec == 5123456);
+        EXPECT(readerp->precision == -6);
+
+        EXPECT(obelisk_shm_fetch(readerp, &clock2, &receive2, &leap) == 0);
+        EXPECT(clock2.tv_sec == clock.tv_sec);
+        EXPECT(clock2.tv_nsec == clock.tv_nsec);
+        EXPECT(receive2.tv_sec == receive.tv_sec);
+        EXPECT(receive2.tv_nsec == receive.tv_nsec);
+        EXPECT(leap == OBELISK_SHM_LEAP_ADDSECOND);
+
+        /* Samples are consumed. */
+
+        EXPECT(obelisk_shm_fetch(readerp, &clock2, &receive2, &leap) > 0);
+
+        id = shmget(OBELISK_SHM_KEY + UNIT, sizeof(obelisk_shm_t), 0);
+        EXPECT(id >= 0);
+        EXPECT(obelisk_shm_detach(readerp) == 0);
+        EXPECT(obelisk_shm_detach(shmp) == 0);
+        EXPECT(shmctl(id, IPC_RMID, (struct shmid_ds *)0) == 0);
+
+        STATUS();
+    }
+
+    EXIT();
+}
@@ -0,0 +1,114 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ *
+ * Copyright 2018 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in README.h<BR>
+ * Chip Overclock (coverclock@diag.com)<BR>
+ * http://www.diag.com/navigation/downloads/Diminuto.html<BR>
+ */
+
+#include "com/diag/diminuto/diminuto_unittest.h"
+#include "com/diag/diminuto/diminuto_log.h"
+#include "com/diag/diminuto/diminuto_core.h"
+#include "com/diag/obelisk/obelisk_sock.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+int main(int argc, char ** argv)
+{
+    SETLOGMASK();
+
+    diminuto_core_enable();
+
+    {
+        obelisk_sock_sample_t sample;
+        struct timespec system;
+        struct timespec reference;
+
+        TEST();
+
+        system.tv_sec = 1514764800;
+        system.tv_nsec = 5123456;
+        reference.tv_sec = 1514764800;
+        reference.tv_nsec = 0;
+
+        obelisk_sock_prepare(&sample, &system, &reference, OBELISK_SOCK_LEAP_INSERT);
+        EXPECT(sample.tv.tv_sec == 1514764800);
+        EXPECT(sample.tv.tv_usec == 5123);
+        EXPECT(fabs(sample.offset - -0.005123456) < 1e-12);
+        EXPECT(!sample.pulse);
+        EXPECT(sample.leap == OBELISK_SOCK_LEAP_INSERT);
+        EXPECT(sample.magic == OBELISK_SOCK_MAGIC);
+
+        reference.tv_sec = 1514764801;
+        obelisk_sock_prepare(&sample, &system, &reference, OBELISK_SOCK_LEAP_NORMAL);
+        EXPECT(fabs(sample.offset - 0.994876544) < 1e-12);
+
+        /* A pulse knows only the nearest second. */
+
+        obelisk_sock_prepare(&sample, &system, (struct timespec *)0, OBELISK_SOCK_LEAP_NORMAL);
+        EXPECT(sample.pulse);
+        EXPECT(fabs(sample.offset - -0.005123456) < 1e-12);
+
+        system.tv_nsec = 995000000;
+        obelisk_sock_prepare(&sample, &system, (struct timespec *)0, OBELISK_SOCK_LEAP_NORMAL);
+        EXPECT(fabs(sample.offset - 0.005) < 1e-12);
+
+        STATUS();
+    }
+
+    {
+        static const char PATH[] = "/tmp/unittest-sock.sock";
+        struct sockaddr_un address = { 0 };
+        obelisk_sock_sample_t sample;
+        obelisk_sock_sample_t received;
+        struct timespec system;
+        int server;
+        int client;
+
+        TEST();
+
+        /* A local stand-in for chronyd. */
+
+        (void)unlink(PATH);
+        address.sun_family = AF_UNIX;
+        strncpy(address.sun_path, PATH, sizeof(address.sun_path) - 1);
+        server = socket(AF_UNIX, SOCK_DGRAM, 0);
+        ASSERT(server >= 0);
+        ASSERT(bind(server, (struct sockaddr *)&address, sizeof(address)) == 0);
+
+        client = obelisk_sock_open(PATH);
+        ASSERT(client >= 0);
+
+        system.tv_sec = 1514764800;
+        system.tv_nsec = 250000000;
+        obelisk_sock_prepare(&sample, &system, (struct timespec *)0, OBELISK_SOCK_LEAP_NORMAL);
+        EXPECT(obelisk_sock_send(client, &sample) == sizeof(sample));
+
+        memset(&received, 0, sizeof(received));
+        EXPECT(recv(server, &received, sizeof(received), 0) == sizeof(received));
+        EXPECT(received.magic == OBELISK_SOCK_MAGIC);
+        EXPECT(received.tv.tv_sec == 1514764800);
+        EXPECT(received.tv.tv_usec == 250000);
+        EXPECT(received.pulse);
+        EXPECT(received.offset == -0.25);
+
+        EXPECT(obelisk_sock_close(client) == 0);
+        EXPECT(close(server) == 0);
+        EXPECT(unlink(PATH) == 0);
+
+        /* Nobody listening. */
+
+        EXPECT(obelisk_sock_open(PATH) < 0);
+
+        STATUS();
+    }
+
+    EXIT();
+}
@@ -0,0 +1,167 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ *
+ * Copyright 2018 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in README.h<BR>
+ * Chip Overclock (coverclock@diag.com)<BR>
+ * http://www.diag.com/navigation/downloads/Diminuto.html<BR>
+ */
+
+#include "com/diag/diminuto/diminuto_unittest.h"
+#include "com/diag/diminuto/diminuto_log.h"
+#include "com/diag/diminuto/diminuto_core.h"
+#include "com/diag/obelisk/obelisk_stability.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <math.h>
+
+/*
+ * Enough samples to wrap the ring, with a 50ppm frequency offset, a
+ * random walk, and up to 10ms of white phase noise.
+ */
+enum { SAMPLES = 20000 };
+
+static int64_t phase[SAMPLES];
+
+static int64_t noise(unsigned int * seedp, int64_t range)
+{
+    *seedp = (*seedp * 1103515245) + 12345;
+    return (int64_t)(((*seedp >> 8) & 0xffff) * (double)range / 65536.0);
+}
+
+static int near(double actual, double expected)
+{
+    return (fabs(actual - expected) <= (fabs(expected) * 1e-9));
+}
+
+int main(int argc, char ** argv)
+{
+    SETLOGMASK();
+
+    diminuto_core_enable();
+
+    {
+        static obelisk_stability_t stability;
+        unsigned int seed = 1;
+        int64_t walk = 0;
+        int index;
+        int64_t m;
+        int64_t i;
+        int64_t j;
+        double adev;
+        double tdev;
+        double inner;
+        int64_t mtie;
+        int64_t maximum;
+        int64_t minimum;
+
+        TEST();
+
+        for (i = 0; i < SAMPLES; ++i) {
+            walk += noise(&seed, 20000) - 10000;
+            phase[i] = (i * 50000) + walk + noise(&seed, 10000000);
+        }
+
+        obelisk_stability_init(&stability);
+        for (i = 0; i < SAMPLES; ++i) {
+            obelisk_stability_sample(&stability, phase[i]);
+        }
+        EXPECT(stability.samples == SAMPLES);
+
+        /*
+         * Compare with the definitions computed the slow way.
+         */
+
+        for (index = 0; index < OBELISK_STABILITY_TAUS; ++index) {
+
+            m = obelisk_stability_tau(index);
+            EXPECT(m == (1 << index));
+
+            adev = 0.0;
+            for (i = 0; i < (SAMPLES - (2 * m)); ++i) {
+                adev += pow((double)(phase[i + (2 * m)] - (2 * phase[i + m]) + phase[i]), 2.0);
+            }
+            adev = sqrt(adev / (2.0 * (SAMPLES - (2 * m)))) / (m * 1e9);
+
+            tdev = 0.0;
+            for (j = 0; j < (SAMPLES - (3 * m) + 1); ++j) {
+                inner = 0.0;
+                for (i = j; i < (j + m); ++i) {
+                    inner += (double)(phase[i + (2 * m)] - (2 * phase[i + m]) + phase[i]);
+                }
+                tdev += inner * inner;
+            }
+            tdev = sqrt(tdev / (6.0 * m * m * (SAMPLES - (3 * m) + 1)));
+
+            mtie = 0;
+            for (j = 0; j < (SAMPLES - m); ++j) {
+                maximum = phase[j];
+                minimum = phase[j];
+                for (i = j; i <= (j + m); ++i) {
+                    if (phase[i] > maximum) { maximum = phase[i]; }
+                    if (phase[i] < minimum) { minimum = phase[i]; }
+                }
+                if ((maximum - minimum) > mtie) { mtie = maximum - minimum; }
+            }
+
+            CHECKPOINT("tau=%llds adev=%.3e tdev=%.0fns mtie=%lldns\n", (long long)m, obelisk_stability_adev(&stability, index), obelisk_stability_tdev(&stability, index), (long long)obelisk_stability_mtie(&stability, index));
+            EXPECT(near(obelisk_stability_adev(&stability, index), adev));
+            EXPECT(near(obelisk_stability_tdev(&stability, index), tdev));
+            EXPECT(obelisk_stability_mtie(&stability, index) == mtie);
+
+        }
+
+        /*
+         * White phase noise dominates at short taus, so ADEV falls about
+         * as fast as tau grows.
+         */
+
+        EXPECT(obelisk_stability_adev(&stability, 3) < (obelisk_stability_adev(&stability, 0) / 4.0));
+
+        STATUS();
+    }
+
+    {
+        static obelisk_stability_t stability;
+
+        TEST();
+
+        obelisk_stability_init(&stability);
+        EXPECT(obelisk_stability_adev(&stability, 0) < 0.0);
+        EXPECT(obelisk_stability_tdev(&stability, 0) < 0.0);
+        EXPECT(obelisk_stability_mtie(&stability, 0) < 0);
+
+        EXPECT(obelisk_stability_edge(&stability, 5000000000LL) == 0);
+        EXPECT(obelisk_stability_edge(&stability, 6000001000LL) == 0);
+        EXPECT(stability.samples == 2);
+        EXPECT(stability.phase[1] == 1000);
+        EXPECT(obelisk_stability_mtie(&stability, 0) == 1000);
+
+        /* Glitches are rejected. */
+
+        EXPECT(obelisk_stability_edge(&stability, 6300000000LL) > 0);
+        EXPECT(obelisk_stability_edge(&stability, 6000002000LL) > 0);
+        EXPECT(stability.samples == 2);
+
+        /* Short gaps are filled. */
+
+        EXPECT(obelisk_stability_edge(&stability, 10000005000LL) == 0);
+        EXPECT(stability.samples == 6);
+        EXPECT(stability.phase[2] == 2000);
+        EXPECT(stability.phase[3] == 3000);
+        EXPECT(stability.phase[4] == 4000);
+        EXPECT(stability.phase[5] == 5000);
+
+        /* Long ones start over. */
+
+        EXPECT(obelisk_stability_edge(&stability, 10000005000LL + ((OBELISK_STABILITY_GAP + 1) * 1000000000LL)) < 0);
+        EXPECT(stability.samples == 1);
+        EXPECT(stability.phase[0] == 0);
+
+        STATUS();
+    }
+
+    EXIT();
+}
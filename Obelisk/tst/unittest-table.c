@@ -0,0 +1,221 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ *
+ * Copyright 2018 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in README.h<BR>
+ * Chip Overclock (coverclock@diag.com)<BR>
+ * http://www.diag.com/navigation/downloads/Diminuto.html<BR>
+ */
+
+#include "com/diag/diminuto/diminuto_unittest.h"
+#include "com/diag/diminuto/diminuto_log.h"
+#include "com/diag/diminuto/diminuto_core.h"
+#include "com/diag/obelisk/obelisk.h"
+#include "com/diag/obelisk/obelisk_table.h"
+#include "obelisk.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+
+/*
+ * 2018-01-01T00:00:00Z
+ */
+static const time_t YEAR2018 = 1514764800;
+
+int main(int argc, char ** argv)
+{
+    SETLOGMASK();
+
+    diminuto_core_enable();
+
+    {
+        obelisk_buffer_t buffer;
+        obelisk_frame_t frame;
+        struct tm time;
+
+        TEST();
+
+        /* 2008-066T07:30, the example in the NIST documentation. */
+
+        buffer = obelisk_encode(1204788600, -3, -1, 0, OBELISK_DST_OFF);
+        EXPECT(obelisk_verify(buffer) == 0);
+        EXPECT(obelisk_epoch(buffer) == 4360462200); /* 2108 since the year is only two digits. */
+        obelisk_extract(&frame, buffer);
+        EXPECT(frame.year10 == 0);
+        EXPECT(frame.year1 == 8);
+        EXPECT(frame.day100 == 0);
+        EXPECT(frame.day10 == 6);
+        EXPECT(frame.day1 == 6);
+        EXPECT(frame.hours10 == 0);
+        EXPECT(frame.hours1 == 7);
+        EXPECT(frame.minutes10 == 3);
+        EXPECT(frame.minutes1 == 0);
+        EXPECT(frame.dut1sign == OBELISK_SIGN_NEGATIVE);
+        EXPECT(frame.dut1magnitude == 3);
+        EXPECT(frame.lyi == 1);
+        EXPECT(frame.lsw == 0);
+        EXPECT(frame.dst == OBELISK_DST_OFF);
+
+        /* Any second of the minute encodes the minute. */
+
+        EXPECT(obelisk_encode(YEAR2018 + 59, 0, -1, 1, OBELISK_DST_ON) == obelisk_encode(YEAR2018, 0, -1, 1, OBELISK_DST_ON));
+
+        buffer = obelisk_encode(YEAR2018 + (180 * 86400) + (23 * 3600) + (59 * 60), 9, 0, 1, OBELISK_DST_ENDS);
+        obelisk_extract(&frame, buffer);
+        EXPECT(obelisk_validate(&frame) == 0);
+        EXPECT(obelisk_decode(&time, &frame) == 0);
+        EXPECT(time.tm_mon == 5);
+        EXPECT(time.tm_mday == 30);
+        EXPECT(frame.dut1sign == OBELISK_SIGN_POSITIVE);
+        EXPECT(frame.dut1magnitude == 9);
+        EXPECT(frame.lyi == 0);
+        EXPECT(frame.lsw == 1);
+        EXPECT(frame.dst == OBELISK_DST_ENDS);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        /* 2018: March 11 and November 4. */
+
+        EXPECT(obelisk_table_dst(2018, 1) == OBELISK_DST_OFF);
+        EXPECT(obelisk_table_dst(2018, 69) == OBELISK_DST_OFF);
+        EXPECT(obelisk_table_dst(2018, 70) == OBELISK_DST_BEGINS);
+        EXPECT(obelisk_table_dst(2018, 71) == OBELISK_DST_ON);
+        EXPECT(obelisk_table_dst(2018, 307) == OBELISK_DST_ON);
+        EXPECT(obelisk_table_dst(2018, 308) == OBELISK_DST_ENDS);
+        EXPECT(obelisk_table_dst(2018, 309) == OBELISK_DST_OFF);
+        EXPECT(obelisk_table_dst(2018, 365) == OBELISK_DST_OFF);
+
+        /* 2020, a leap year: March 8 and November 1. */
+
+        EXPECT(obelisk_table_dst(2020, 67) == OBELISK_DST_OFF);
+        EXPECT(obelisk_table_dst(2020, 68) == OBELISK_DST_BEGINS);
+        EXPECT(obelisk_table_dst(2020, 69) == OBELISK_DST_ON);
+        EXPECT(obelisk_table_dst(2020, 305) == OBELISK_DST_ON);
+        EXPECT(obelisk_table_dst(2020, 306) == OBELISK_DST_ENDS);
+        EXPECT(obelisk_table_dst(2020, 307) == OBELISK_DST_OFF);
+
+        STATUS();
+    }
+
+    {
+        obelisk_table_t * table;
+        obelisk_buffer_t buffer;
+        obelisk_dst_t dst;
+        size_t size;
+        int day;
+        int changes = 0;
+
+        TEST();
+
+        EXPECT(obelisk_table_size(2020) == (sizeof(obelisk_table_t) + (527040 * sizeof(obelisk_buffer_t))));
+
+        size = obelisk_table_size(2018);
+        EXPECT(size == (sizeof(obelisk_table_t) + (525600 * sizeof(obelisk_buffer_t))));
+        table = (obelisk_table_t *)malloc(size);
+
+        EXPECT(obelisk_table_generate(table, size - 1, 2018, -2, 6) < 0);
+        EXPECT(obelisk_table_generate(table, size, 2018, -2, 6) == 0);
+        EXPECT(obelisk_table_check(table, size) == 0);
+        EXPECT(obelisk_table_check(table, size - 1) < 0);
+        EXPECT(table->minutes == 525600);
+        EXPECT(table->first == YEAR2018);
+
+        /*
+         * Every frame is valid, is where its time says it is, and except
+         * where the DST schedule changes or the leap second warning starts
+         * is what obelisk_predict() expects from the one before it.
+         */
+
+        for (uint32_t mm = 0; mm < table->minutes; ++mm) {
+            buffer = table->frame[mm];
+            EXPECT(obelisk_verify(buffer) == 0);
+            EXPECT(obelisk_epoch(buffer) == (YEAR2018 + (mm * 60)));
+            EXPECT(obelisk_table_epoch(table, buffer) == (YEAR2018 + (mm * 60)));
+            EXPECT(OBELISK_EXTRACT(buffer, LSW) == (((151 * 24 * 60) <= mm) && (mm < (181 * 24 * 60))));
+            day = (mm / (24 * 60)) + 1;
+            dst = obelisk_table_dst(2018, day);
+            EXPECT(OBELISK_EXTRACT(buffer, DST) == dst);
+            if (mm == 0) {
+                /* Do nothing. */
+            } else if (((mm % (24 * 60)) == 0) && ((dst == OBELISK_DST_BEGINS) || (dst == OBELISK_DST_ENDS))) {
+                ++changes;
+            } else if (mm == (151 * 24 * 60)) {
+                ++changes; /* The leap second warning can't be predicted. */
+            } else {
+                EXPECT(obelisk_predict(table->frame[mm - 1]) == buffer);
+            }
+        }
+
+        EXPECT(changes == 3);
+
+        EXPECT(obelisk_table_frame(table, YEAR2018 - 1, &buffer) < 0);
+        EXPECT(obelisk_table_frame(table, YEAR2018 + (365 * 86400), &buffer) < 0);
+        EXPECT(obelisk_table_frame(table, YEAR2018 + (365 * 86400) - 1, &buffer) == 0);
+        EXPECT(buffer == table->frame[525599]);
+        EXPECT(obelisk_table_frame(table, YEAR2018 + 3599, &buffer) == 0);
+        EXPECT(buffer == table->frame[59]);
+
+        /* A frame that differs in any field isn't in the table. */
+
+        EXPECT(obelisk_table_epoch(table, table->frame[1000] ^ OBELISK_BIT(56)) < 0);
+        EXPECT(obelisk_table_epoch(table, obelisk_encode(YEAR2018 - 60, -2, 0, 0, OBELISK_DST_OFF)) < 0);
+
+        free(table);
+
+        STATUS();
+    }
+
+    {
+        char path[] = "/tmp/unittest-table-XXXXXX";
+        obelisk_table_t * table;
+        const obelisk_table_t * mapped;
+        obelisk_buffer_t buffer;
+        size_t size;
+        int fd;
+
+        TEST();
+
+        /*
+         * The table is position independent, so it can be written to a
+         * file and mapped back in.
+         */
+
+        size = obelisk_table_size(2020);
+        table = (obelisk_table_t *)malloc(size);
+        EXPECT(obelisk_table_generate(table, size, 2020, 4, 0) == 0);
+
+        fd = mkstemp(path);
+        ASSERT(fd >= 0);
+        EXPECT(write(fd, table, size) == size);
+
+        mapped = (const obelisk_table_t *)mmap((void *)0, size, PROT_READ, MAP_SHARED, fd, 0);
+        ASSERT(mapped != (const obelisk_table_t *)MAP_FAILED);
+        EXPECT(obelisk_table_check(mapped, size) == 0);
+        EXPECT(mapped->year == 2020);
+        EXPECT(mapped->minutes == 527040);
+        EXPECT(mapped->dut1 == 4);
+        EXPECT(obelisk_table_frame(mapped, 1582934340, &buffer) == 0); /* 2020-02-28T23:59Z */
+        EXPECT(buffer == obelisk_encode(1582934340, 4, 1, 0, OBELISK_DST_OFF));
+        EXPECT(obelisk_table_epoch(mapped, buffer) == 1582934340);
+        EXPECT(memcmp(mapped, table, size) == 0);
+
+        EXPECT(munmap((void *)mapped, size) == 0);
+        EXPECT(close(fd) == 0);
+        EXPECT(unlink(path) == 0);
+        free(table);
+
+        STATUS();
+    }
+
+    EXIT();
+}
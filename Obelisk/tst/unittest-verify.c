@@ -0,0 +1,136 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ *
+ * Copyright 2018 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in README.h<BR>
+ * Chip Overclock (coverclock@diag.com)<BR>
+ * http://www.diag.com/navigation/downloads/Diminuto.html<BR>
+ */
+
+#include "com/diag/diminuto/diminuto_unittest.h"
+#include "com/diag/diminuto/diminuto_log.h"
+#include "com/diag/diminuto/diminuto_core.h"
+#include "com/diag/obelisk/obelisk.h"
+#include "obelisk.h"
+#include <stdio.h>
+#include <errno.h>
+
+#define FIELD(_FIELD_, _MAXIMUM_) \
+    do { \
+        for (int value = 0; value <= OBELISK_MASK_ ## _FIELD_; ++value) { \
+            obelisk_buffer_t buffer = OBELISK_INSERT(valid, _FIELD_, value); \
+            int failures = obelisk_verify(buffer); \
+            obelisk_frame_t frame; \
+            obelisk_extract(&frame, buffer); \
+            EXPECT(failures == ((value > (_MAXIMUM_)) ? OBELISK_FAILURE_ ## _FIELD_ : 0)); \
+            EXPECT((failures == 0) == (obelisk_validate(&frame) == 0)); \
+        } \
+    } while (0)
+
+int main(int argc, char ** argv)
+{
+    SETLOGMASK();
+
+    diminuto_core_enable();
+
+    {
+        obelisk_buffer_t valid;
+        obelisk_frame_t frame;
+
+        TEST();
+
+        valid = 0;
+        valid = OBELISK_INSERT(valid, MINUTES10, 3);
+        valid = OBELISK_INSERT(valid, MINUTES1, 0);
+        valid = OBELISK_INSERT(valid, HOURS10, 0);
+        valid = OBELISK_INSERT(valid, HOURS1, 7);
+        valid = OBELISK_INSERT(valid, DAY100, 0);
+        valid = OBELISK_INSERT(valid, DAY10, 6);
+        valid = OBELISK_INSERT(valid, DAY1, 6);
+        valid = OBELISK_INSERT(valid, DUTONESIGN, OBELISK_SIGN_NEGATIVE);
+        valid = OBELISK_INSERT(valid, DUTONE1, 3);
+        valid = OBELISK_INSERT(valid, YEAR10, 0);
+        valid = OBELISK_INSERT(valid, YEAR1, 8);
+        valid = OBELISK_INSERT(valid, LYI, 1);
+        valid = OBELISK_INSERT(valid, DST, OBELISK_DST_ON);
+
+        obelisk_extract(&frame, valid);
+        EXPECT(obelisk_validate(&frame) == 0);
+        EXPECT(obelisk_verify(valid) == OBELISK_FAILURE_NONE);
+
+        /* The MARKERs and unused bits are not checked. */
+
+        EXPECT(obelisk_verify(valid | ~OBELISK_FRAME) == OBELISK_FAILURE_NONE);
+        EXPECT(obelisk_verify(valid | OBELISK_BIT(0) | OBELISK_BIT(4) | OBELISK_BIT(9) | OBELISK_BIT(10) | OBELISK_BIT(14) | OBELISK_BIT(24) | OBELISK_BIT(34) | OBELISK_BIT(44) | OBELISK_BIT(49) | OBELISK_BIT(54) | OBELISK_BIT(59)) == OBELISK_FAILURE_NONE);
+
+        FIELD(MINUTES10, 5);
+        FIELD(MINUTES1, 9);
+        FIELD(HOURS10, 2);
+        FIELD(HOURS1, 9);
+        FIELD(DAY100, 3);
+        FIELD(DAY10, 9);
+        FIELD(DAY1, 9);
+        FIELD(DUTONE1, 9);
+        FIELD(YEAR10, 9);
+        FIELD(YEAR1, 9);
+
+        for (int value = 0; value <= OBELISK_MASK_DUTONESIGN; ++value) {
+            EXPECT(obelisk_verify(OBELISK_INSERT(valid, DUTONESIGN, value)) == (((value == OBELISK_SIGN_NEGATIVE) || (value == OBELISK_SIGN_POSITIVE)) ? 0 : OBELISK_FAILURE_DUTONESIGN));
+        }
+
+        STATUS();
+    }
+
+    {
+        obelisk_buffer_t buffer;
+        obelisk_frame_t frame;
+        uint64_t seed = 1;
+        int failures;
+        int rc;
+        int valid = 0;
+        int multiple = 0;
+
+        TEST();
+
+        /*
+         * Every failure is reported, and a buffer is valid exactly when
+         * obelisk_validate() says its frame is.
+         */
+
+        for (int ii = 0; ii < 1000000; ++ii) {
+            seed = (seed * 6364136223846793005ULL) + 1442695040888963407ULL;
+            buffer = seed;
+            failures = obelisk_verify(buffer);
+            obelisk_extract(&frame, buffer);
+            rc = obelisk_validate(&frame);
+            EXPECT((failures == 0) == (rc == 0));
+            if (failures == 0) {
+                ++valid;
+            } else if ((failures & (failures - 1)) != 0) {
+                ++multiple;
+            } else {
+                /* Do nothing. */
+            }
+            EXPECT(((failures & OBELISK_FAILURE_MINUTES10) != 0) == (frame.minutes10 > 5));
+            EXPECT(((failures & OBELISK_FAILURE_MINUTES1) != 0) == (frame.minutes1 > 9));
+            EXPECT(((failures & OBELISK_FAILURE_HOURS10) != 0) == (frame.hours10 > 2));
+            EXPECT(((failures & OBELISK_FAILURE_HOURS1) != 0) == (frame.hours1 > 9));
+            EXPECT(((failures & OBELISK_FAILURE_DAY100) != 0) == (frame.day100 > 3));
+            EXPECT(((failures & OBELISK_FAILURE_DAY10) != 0) == (frame.day10 > 9));
+            EXPECT(((failures & OBELISK_FAILURE_DAY1) != 0) == (frame.day1 > 9));
+            EXPECT(((failures & OBELISK_FAILURE_DUTONESIGN) != 0) == ((frame.dut1sign != OBELISK_SIGN_NEGATIVE) && (frame.dut1sign != OBELISK_SIGN_POSITIVE)));
+            EXPECT(((failures & OBELISK_FAILURE_DUTONE1) != 0) == (frame.dut1magnitude > 9));
+            EXPECT(((failures & OBELISK_FAILURE_YEAR10) != 0) == (frame.year10 > 9));
+            EXPECT(((failures & OBELISK_FAILURE_YEAR1) != 0) == (frame.year1 > 9));
+        }
+
+        CHECKPOINT("valid=%d multiple=%d\n", valid, multiple);
+        EXPECT(valid > 0);
+        EXPECT(multiple > 0);
+
+        STATUS();
+    }
+
+    EXIT();
+}
@@ -0,0 +1,303 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ *
+ * Copyright 2018 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in README.h<BR>
+ * Chip Overclock (coverclock@diag.com)<BR>
+ * http://www.diag.com/navigation/downloads/Diminuto.html<BR>
+ */
+
+#include "com/diag/diminuto/diminuto_unittest.h"
+#include "com/diag/diminuto/diminuto_log.h"
+#include "com/diag/diminuto/diminuto_core.h"
+#include "com/diag/obelisk/obelisk.h"
+#include "obelisk.h"
+#include <stdio.h>
+#include <errno.h>
+
+#include "../inc/com/diag/obelisk/wwvbtool.h"
+
+/*
+ * 2008-066T07:30 followed by as many minutes as we need.
+ */
+static const char SENTENCE[] = "0MM01100000M000000111M000000110M011000010M001100000M100001000M";
+
+static const int NOMINAL[] = { 200, 500, 800, };
+
+/*
+ * Returns the pulse width of the token at the specified second of the
+ * minute for a frame.
+ */
+static int pulse(obelisk_buffer_t buffer, int second)
+{
+    obelisk_token_t token = OBELISK_TOKEN_ZERO;
+
+    if ((second == 0) || (second == 60) || ((second % 10) == 9)) {
+        token = OBELISK_TOKEN_MARKER;
+    } else if ((buffer & OBELISK_BIT(second)) != 0) {
+        token = OBELISK_TOKEN_ONE;
+    } else {
+        token = OBELISK_TOKEN_ZERO;
+    }
+
+    return NOMINAL[token];
+}
+
+/*
+ * Returns the buffer the parser assembles from the sentence.
+ */
+static obelisk_buffer_t base(void)
+{
+    obelisk_state_t state = OBELISK_STATE_START;
+    obelisk_buffer_t buffer = 0;
+    obelisk_frame_t frame;
+    int field = 0;
+    int length = 0;
+    const char * ss;
+
+    for (ss = SENTENCE; *ss != '\0'; ++ss) {
+        (void)obelisk_parse(&state, (*ss == 'M') ? OBELISK_TOKEN_MARKER : (*ss == '1') ? OBELISK_TOKEN_ONE : OBELISK_TOKEN_ZERO, &field, &length, &buffer, &frame);
+    }
+
+    return buffer;
+}
+
+int main(int argc, char ** argv)
+{
+    SETLOGMASK();
+
+    diminuto_core_enable();
+
+    {
+        int cost[OBELISK_VITERBI_TOKENS];
+
+        TEST();
+
+        obelisk_likelihood(cost, 200);
+        EXPECT(cost[OBELISK_TOKEN_ZERO] == 0);
+        EXPECT(cost[OBELISK_TOKEN_ONE] == OBELISK_VITERBI_COST);
+        EXPECT(cost[OBELISK_TOKEN_MARKER] == OBELISK_VITERBI_COST);
+
+        obelisk_likelihood(cost, 500);
+        EXPECT(cost[OBELISK_TOKEN_ZERO] == OBELISK_VITERBI_COST);
+        EXPECT(cost[OBELISK_TOKEN_ONE] == 0);
+        EXPECT(cost[OBELISK_TOKEN_MARKER] == OBELISK_VITERBI_COST);
+
+        obelisk_likelihood(cost, 800);
+        EXPECT(cost[OBELISK_TOKEN_MARKER] == 0);
+
+        /* Ambiguous between ZERO and ONE. */
+
+        obelisk_likelihood(cost, 350);
+        EXPECT(cost[OBELISK_TOKEN_ZERO] == cost[OBELISK_TOKEN_ONE]);
+        EXPECT(cost[OBELISK_TOKEN_ZERO] < cost[OBELISK_TOKEN_MARKER]);
+
+        obelisk_likelihood(cost, 380);
+        EXPECT(cost[OBELISK_TOKEN_ONE] < cost[OBELISK_TOKEN_ZERO]);
+
+        /* Missing. */
+
+        obelisk_likelihood(cost, 0);
+        EXPECT(cost[OBELISK_TOKEN_ZERO] == OBELISK_VITERBI_COST);
+        EXPECT(cost[OBELISK_TOKEN_ONE] == OBELISK_VITERBI_COST);
+        EXPECT(cost[OBELISK_TOKEN_MARKER] == OBELISK_VITERBI_COST);
+
+        STATUS();
+    }
+
+    {
+        obelisk_viterbi_t viterbi;
+        obelisk_state_t state1 = OBELISK_STATE_START;
+        obelisk_state_t state2 = OBELISK_STATE_START;
+        obelisk_event_t event1;
+        obelisk_event_t event2;
+        obelisk_buffer_t buffer1 = 0;
+        obelisk_buffer_t buffer2 = 0;
+        obelisk_buffer_t expected;
+        obelisk_frame_t frame1;
+        obelisk_frame_t frame2;
+        int field1 = 0;
+        int field2 = 0;
+        int length1 = 0;
+        int length2 = 0;
+        int cost[OBELISK_VITERBI_TOKENS];
+        int locked = -1;
+        int compared = 0;
+        int frames = 0;
+
+        TEST();
+
+        /*
+         * With clean pulses the synchronizer must agree with the parser
+         * once both are synchronized. Start in the middle of a minute.
+         */
+
+        obelisk_viterbi_init(&viterbi);
+        expected = base();
+
+        for (int minute = 0; minute < 4; ++minute) {
+            for (int second = (minute == 0) ? 37 : 0; second < 60; ++second) {
+                obelisk_likelihood(cost, pulse(expected, second));
+                event1 = obelisk_parse(&state1, obelisk_tokenize(pulse(expected, second)), &field1, &length1, &buffer1, &frame1);
+                event2 = obelisk_viterbi(&viterbi, cost, &state2, &field2, &length2, &buffer2, &frame2);
+                if ((locked < 0) && (event2 != OBELISK_EVENT_WAITING)) {
+                    locked = (minute * 60) + second;
+                }
+                if ((state1 == OBELISK_STATE_START) || (state1 == OBELISK_STATE_WAIT) || (state2 == OBELISK_STATE_START)) {
+                    continue;
+                }
+                if ((event1 != event2) || (state1 != state2) || (field1 != field2) || (length1 != length2) || (buffer1 != buffer2)) {
+                    CHECKPOINT(":%02d %s %s %s %s %d %d %d %d 0x%llx 0x%llx\n", second, EVENT[event1], EVENT[event2], STATE[state1], STATE[state2], field1, field2, length1, length2, (long long unsigned)buffer1, (long long unsigned)buffer2);
+                }
+                EXPECT(event1 == event2);
+                EXPECT(state1 == state2);
+                EXPECT(field1 == field2);
+                EXPECT(length1 == length2);
+                EXPECT(buffer1 == buffer2);
+                EXPECT(viterbi.second == second);
+                if (event2 == OBELISK_EVENT_FRAME) {
+                    EXPECT(buffer2 == expected);
+                    ++frames;
+                }
+                ++compared;
+            }
+            expected = obelisk_predict(expected);
+        }
+
+        CHECKPOINT("locked=%d compared=%d frames=%d confidence=%d\n", locked, compared, frames, viterbi.confidence);
+        EXPECT(locked > 37);
+        EXPECT(locked <= 120);
+        EXPECT(compared >= 120);
+        EXPECT(frames == 2);
+
+        STATUS();
+    }
+
+    {
+        obelisk_viterbi_t viterbi;
+        obelisk_state_t state1 = OBELISK_STATE_START;
+        obelisk_state_t state2 = OBELISK_STATE_START;
+        obelisk_event_t event1;
+        obelisk_event_t event2;
+        obelisk_buffer_t buffer1 = 0;
+        obelisk_buffer_t buffer2 = 0;
+        obelisk_buffer_t expected;
+        obelisk_frame_t frame1;
+        obelisk_frame_t frame2;
+        int field1 = 0;
+        int field2 = 0;
+        int length1 = 0;
+        int length2 = 0;
+        int cost[OBELISK_VITERBI_TOKENS];
+        int milliseconds;
+        int invalid1 = 0;
+        int invalid2 = 0;
+        int frames1 = 0;
+        int frames2 = 0;
+        unsigned int seed = 1;
+
+        TEST();
+
+        /*
+         * Degrade the pulses: every pulse jitters, the ZEROs and ONEs at
+         * :05, :22, and :56 are barely distinguishable, the MARKER at :29
+         * is missing, and the MARKER at :39 looks like a ONE. The parser
+         * gives up on every such frame; the synchronizer should not.
+         */
+
+        obelisk_viterbi_init(&viterbi);
+        expected = base();
+
+        for (int minute = 0; minute < 8; ++minute) {
+            for (int second = 0; second < 60; ++second) {
+                milliseconds = pulse(expected, second);
+                seed = (seed * 1103515245) + 12345;
+                milliseconds += (int)((seed >> 16) % 121) - 60;
+                if ((minute > 1) && ((second % 17) == 5)) {
+                    milliseconds = (milliseconds < 350) ? 340 : 360;
+                }
+                if ((minute > 1) && (second == 29)) {
+                    milliseconds = 0;
+                }
+                if ((minute > 1) && (second == 39)) {
+                    milliseconds = 600;
+                }
+                obelisk_likelihood(cost, milliseconds);
+                event1 = obelisk_parse(&state1, obelisk_tokenize(milliseconds), &field1, &length1, &buffer1, &frame1);
+                event2 = obelisk_viterbi(&viterbi, cost, &state2, &field2, &length2, &buffer2, &frame2);
+                if (event1 == OBELISK_EVENT_INVALID) { ++invalid1; }
+                if (event2 == OBELISK_EVENT_INVALID) { ++invalid2; }
+                if (event1 == OBELISK_EVENT_FRAME) { ++frames1; }
+                if (event2 == OBELISK_EVENT_FRAME) {
+                    ++frames2;
+                    EXPECT(buffer2 == expected);
+                }
+            }
+            expected = obelisk_predict(expected);
+        }
+
+        CHECKPOINT("invalid1=%d invalid2=%d frames1=%d frames2=%d confidence=%d\n", invalid1, invalid2, frames1, frames2, viterbi.confidence);
+        EXPECT(invalid2 == 0);
+        EXPECT(frames2 >= 7);
+        EXPECT(frames1 < frames2);
+
+        STATUS();
+    }
+
+    {
+        obelisk_viterbi_t viterbi;
+        obelisk_state_t state1 = OBELISK_STATE_START;
+        obelisk_state_t state2 = OBELISK_STATE_START;
+        obelisk_event_t event1;
+        obelisk_event_t event2;
+        obelisk_buffer_t buffer1 = 0;
+        obelisk_buffer_t buffer2 = 0;
+        obelisk_buffer_t expected;
+        obelisk_frame_t frame1;
+        obelisk_frame_t frame2;
+        int field1 = 0;
+        int field2 = 0;
+        int length1 = 0;
+        int length2 = 0;
+        int cost[OBELISK_VITERBI_TOKENS];
+        int leaps = 0;
+        int times = 0;
+
+        TEST();
+
+        /*
+         * A leap second at the end of the third minute.
+         */
+
+        obelisk_viterbi_init(&viterbi);
+        expected = base();
+
+        for (int minute = 0; minute < 5; ++minute) {
+            for (int second = 0; second < ((minute == 2) ? 61 : 60); ++second) {
+                obelisk_likelihood(cost, pulse(expected, second));
+                event1 = obelisk_parse(&state1, obelisk_tokenize(pulse(expected, second)), &field1, &length1, &buffer1, &frame1);
+                event2 = obelisk_viterbi(&viterbi, cost, &state2, &field2, &length2, &buffer2, &frame2);
+                if (event2 == OBELISK_EVENT_LEAP) { ++leaps; }
+                if (event2 == OBELISK_EVENT_TIME) { ++times; }
+                if (minute < 2) {
+                    continue;
+                }
+                if ((event1 != event2) || (state1 != state2) || (buffer1 != buffer2)) {
+                    CHECKPOINT("%d:%02d %s %s %s %s 0x%llx 0x%llx\n", minute, second, EVENT[event1], EVENT[event2], STATE[state1], STATE[state2], (long long unsigned)buffer1, (long long unsigned)buffer2);
+                }
+                EXPECT(event1 == event2);
+                EXPECT(state1 == state2);
+                EXPECT(buffer1 == buffer2);
+            }
+            expected = obelisk_predict(expected);
+        }
+
+        EXPECT(leaps == 1);
+        EXPECT(times >= 3);
+
+        STATUS();
+    }
+
+    EXIT();
+}